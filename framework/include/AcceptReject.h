@@ -5,6 +5,35 @@
  * @brief Class for generating toy data from a PDF.
  *        Can inherit from this to implement preselection for a particular PDF.
  *
+ * The generation is split into independent streams, each with its own copy of the PDF and its own TRandom3.
+ * The number of streams depends only on the number of events, see RAPIDFIT_GENERATION_EVENTS_PER_STREAM, or is set with SetNumberStreams,
+ * and the streams are shared out between the threads, so the number of cores only changes how quickly a toy is made.
+ * The seed of each stream is drawn from RapidFitRandom::GetRandomFunction(), so a toy depends only on the seed and the number of events.
+ * With a single stream the TRandom3 from RapidFitRandom is used directly, as was always done.
+ *
+ * Each stream reuses one DataPoint for all of its trials and keeps the values of the accepted events in a flat array,
+ * these are only turned into DataPoints when the streams are merged, in stream order, at the end.
+ *
+ * Trials are made in blocks of up to RAPIDFIT_GENERATION_BLOCK_SIZE: all of the random numbers for the block are drawn first,
+ * the trials which pass the Preselection are handed to IPDF::EvaluateForNumericGenerationBatch in one call,
+ * and while the block stays under the maximum the accept/reject test is a plain loop over arrays.
+ * SetBlockSize(1) gives the old one trial at a time path, with IPDF::Evaluate.
+ *
+ * For larger datasets the single maximum is replaced by a piecewise constant envelope. The continuous Observables are split into cells
+ * with MakeFoam::MakeCells, each cell gets a bound from the largest value of the PDF seen in it, and the trials are drawn from the envelope:
+ * a cell with probability proportional to bound x volume, then a uniform point in the cell, accepted with probability value / bound.
+ * For a PDF which is strongly peaked this wastes far fewer trials than a flat bound at the height of the peak.
+ * Without the envelope there is a single cell, covering the whole phase space, with the bound moreThanMaximum.
+ *
+ * When the PDF is found above the bound of a cell only that bound is raised, doubling it until it is above the value.
+ * The events the stream had accepted are then thrown away and the stream starts again with the new envelope:
+ * where the PDF was above the old bound too few events were accepted, and thinning can't put back events which were never accepted.
+ * Any trials left in a block were drawn from the old envelope and are thrown away as well.
+ * Once the streams finish, any stream whose envelope is below the highest bound found by any stream starts again in the same way.
+ *
+ * With an envelope the number of generated events in each cell is compared with the integral of the PDF over the cell estimated
+ * while building the envelope, and a warning is printed if they disagree, see CheckEnvelope.
+ *
  * @author Benjamin M Wynne bwynne@cern.ch
  */
 
@@ -20,9 +49,66 @@
 #include "IPDF.h"
 #include "PhaseSpaceBoundary.h"
 #include "IDataSet.h"
+///	System Headers
+#include <vector>
+#include <string>
+#include <pthread.h>
+
+#ifdef __CINT__
+#undef __GNUC__
+#define _SYS__SELECT_H_
+struct pthread_t;
+#undef __SYS__SELECT_H_
+#define __GNUC__
+#endif
+
+//	Fewest events worth giving a stream of their own, and the most streams a dataset is split into unless SetNumberStreams is used
+#define RAPIDFIT_GENERATION_EVENTS_PER_STREAM 1000
+#define RAPIDFIT_GENERATION_MAXIMUM_STREAMS 16
+
+//	Most trials evaluated in one call to IPDF::EvaluateForNumericGenerationBatch
+#define RAPIDFIT_GENERATION_BLOCK_SIZE 4096
+
+//	Fewest events worth building an envelope for
+#define RAPIDFIT_ENVELOPE_MIN_EVENTS 10000
+//	Samples used by MakeFoam::MakeCells to decide whether to split each cell, and the most cells in the envelope
+#define RAPIDFIT_ENVELOPE_CELL_SAMPLES 1000
+#define RAPIDFIT_ENVELOPE_MAXIMUM_CELLS 100
+//	Samples used to find the bound of each cell, and the factor the largest value seen is multiplied by
+#define RAPIDFIT_ENVELOPE_BOUND_SAMPLES 256
+#define RAPIDFIT_ENVELOPE_SAFETY 1.5
 
 using namespace::std;
 
+class AcceptReject;
+
+//	Everything one generation stream needs, and what it produced
+struct AcceptReject_Thread{
+	explicit AcceptReject_Thread() :
+		generator(NULL), nextStream(NULL), generationPDF(NULL), random(NULL), trialPoints(), trialValues(), trialRandoms(), trialCells(), selectedPoints(), selectedTrials(), selectedResults(),
+		accepted(), acceptedCells(), numberWanted(0), bounds(), cumulative(), numberAttempts(0), numberAccepted(0), zeroValue(false)
+	{}
+	AcceptReject* generator;	/*!	Generator which owns this stream, for the Preselection	*/
+	AcceptReject_Thread* nextStream;	/*!	Next stream run by the same thread, or NULL	*/
+	IPDF* generationPDF;		/*!	Copy of the PDF used by this stream			*/
+	TRandom3* random;		/*!	Random numbers for this stream only			*/
+	vector<DataPoint*> trialPoints;	/*!	DataPoints reused for every block of trials		*/
+	vector<double> trialValues;	/*!	Values of the trials in the block, one after the other	*/
+	vector<double> trialRandoms;	/*!	Uniform random number of each trial for the accept/reject	*/
+	vector<unsigned int> trialCells;	/*!	Envelope cell each trial was drawn in			*/
+	vector<DataPoint*> selectedPoints;	/*!	Trials which passed the Preselection			*/
+	vector<unsigned int> selectedTrials;	/*!	Position of each of these in the block			*/
+	vector<double> selectedResults;	/*!	Value of the PDF for each of these			*/
+	vector<double> accepted;	/*!	Values of the accepted events, one after the other	*/
+	vector<unsigned int> acceptedCells;	/*!	Envelope cell of each accepted event			*/
+	unsigned int numberWanted;	/*!	Number of accepted events wanted in this stream		*/
+	vector<double> bounds;		/*!	Bound of the PDF in each envelope cell assumed by this stream	*/
+	vector<double> cumulative;	/*!	Running sum of bound x volume over the cells		*/
+	int numberAttempts;		/*!	Number of trials made					*/
+	unsigned int numberAccepted;	/*!	Number of trials accepted, including any thrown away since	*/
+	bool zeroValue;			/*!	Stopped because the PDF was zero			*/
+};
+
 class AcceptReject : public IDataGenerator
 {
 	public:
@@ -60,6 +146,30 @@ class AcceptReject : public IDataGenerator
 		 */
 		virtual IDataSet * GetDataSet() const;
 
+		/*!
+		 * @brief Set the most threads GenerateData will use, the default is the number of cores
+		 *
+		 * No more threads are used than there are streams, this doesn't change the events which are generated
+		 */
+		void SetNumberThreads( const unsigned int Input );
+
+		/*!
+		 * @brief Set the number of streams each dataset is generated in, this changes the events which are generated
+		 *
+		 * 0, the default, gives one stream per RAPIDFIT_GENERATION_EVENTS_PER_STREAM events, up to RAPIDFIT_GENERATION_MAXIMUM_STREAMS
+		 */
+		void SetNumberStreams( const unsigned int Input );
+
+		/*!
+		 * @brief Set the most trials evaluated in one call to the PDF, 1 uses IPDF::Evaluate one trial at a time
+		 */
+		void SetBlockSize( const unsigned int Input );
+
+		/*!
+		 * @brief Should large datasets be generated with an envelope rather than a single maximum, the default is true
+		 */
+		void SetUseEnvelope( const bool Input );
+
 	protected:
 		/*!
 		 * Don't Copy the class this way!
@@ -71,7 +181,84 @@ class AcceptReject : public IDataGenerator
 		 */
 		AcceptReject& operator = ( const AcceptReject& );
 
-		virtual bool Preselection( DataPoint*, double );	/*!	Undocumented!	*/
+		/*!
+		 * @brief Quick test which can reject a trial before the PDF is evaluated
+		 *
+		 * This is called from all of the generation threads at once, so it must not change the state of the generator
+		 */
+		virtual bool Preselection( DataPoint*, double );
+
+		/*!
+		 * @brief Generate the events wanted by one stream, starting from its current maximum
+		 */
+		void GenerateStream( AcceptReject_Thread* stream );
+
+		/*!
+		 * @brief GenerateStream one trial at a time
+		 */
+		void GenerateStreamScalar( AcceptReject_Thread* stream );
+
+		/*!
+		 * @brief GenerateStream one block of trials at a time
+		 */
+		void GenerateStreamBlocks( AcceptReject_Thread* stream );
+
+		/*!
+		 * @brief Set up the cells of the envelope, building it if it is wanted and doesn't exist yet
+		 */
+		void SetupCells( const int DataAmount );
+
+		/*!
+		 * @brief Split the phase space into cells with MakeFoam::MakeCells and find the bound of each cell
+		 */
+		void BuildEnvelope();
+
+		/*!
+		 * @brief Choose the envelope cell of a trial, with probability proportional to bound x volume
+		 */
+		unsigned int DrawCell( AcceptReject_Thread* stream ) const;
+
+		/*!
+		 * @brief Draw the values of all Observables for one trial in this cell, in the same order of random numbers as CreateObservable
+		 */
+		void DrawTrial( TRandom3* random, const unsigned int cell, double* values ) const;
+
+		/*!
+		 * @brief Set the bounds assumed by a stream
+		 */
+		void SetStreamBounds( AcceptReject_Thread* stream, const vector<double>& bounds ) const;
+
+		/*!
+		 * @brief Put the values of a trial into a DataPoint and clear anything cached against its old values
+		 */
+		void SetTrialPoint( DataPoint* thisPoint, const double* values ) const;
+
+		/*!
+		 * @brief Account for a trial above the bound of its cell: double the bound until it is above the value and start the stream again
+		 */
+		void RaiseBound( AcceptReject_Thread* stream, const unsigned int cell, const double functionValue ) const;
+
+		/*!
+		 * @brief Throw away the events accepted by a stream, which then starts again with its current envelope
+		 */
+		void RestartStream( AcceptReject_Thread* stream ) const;
+
+		/*!
+		 * @brief Compare the number of generated events in each envelope cell with the integral of the PDF over the cell
+		 *
+		 * The integrals are those estimated by BuildEnvelope, the chi2 includes their statistical errors. A warning is printed
+		 * if the chi2 is more than 5 standard deviations above the number of degrees of freedom.
+		 *
+		 * @param cellCounts  Number of generated events in each cell
+		 *
+		 * @return false if the events don't follow the PDF
+		 */
+		bool CheckEnvelope( const vector<unsigned int>& cellCounts ) const;
+
+		/*!
+		 * @brief Run GenerateStream on a stream and each nextStream after it, this is run by pthread_create
+		 */
+		static void* GenerateStream_pthread( void* input_data );
 
 		IPDF * generationFunction;			/*!	Pointer to the PDF given at construction	*/
 		PhaseSpaceBoundary * generationBoundary;	/*!	Pointer to PhaseSpaceBoundary given at constructtion	*/
@@ -82,6 +269,22 @@ class AcceptReject : public IDataGenerator
 
 		double moreThanMaximum;		/*!	Undocumented!	*/
 		int numberAttempts;		/*!	Undocumented!	*/
+
+		unsigned int numberThreads;	/*!	Most threads to generate with			*/
+		unsigned int numberStreams;	/*!	Number of streams set by SetNumberStreams, 0 if none	*/
+		unsigned int blockSize;		/*!	Most trials evaluated in one call to the PDF	*/
+		vector<string> allNames;	/*!	Observables in the order they are generated	*/
+		vector<string> allUnits;	/*!	Unit of each Observable				*/
+		vector<vector<double> > discreteValues;	/*!	Values of each discrete Observable, empty for continuous ones	*/
+
+		bool useEnvelope;		/*!	Build an envelope for large datasets		*/
+		bool envelopeBuilt;		/*!	Have the cells been made by BuildEnvelope	*/
+		vector<double> cellMinima;	/*!	Minimum of each continuous Observable in each cell, one cell after the other	*/
+		vector<double> cellRanges;	/*!	Width of each continuous Observable in each cell	*/
+		vector<double> cellVolumes;	/*!	Volume of each cell in the continuous Observables	*/
+		vector<double> cellBounds;	/*!	Bound of the PDF in each cell			*/
+		vector<double> cellIntegrals;	/*!	Integral of the PDF over each cell estimated by BuildEnvelope	*/
+		vector<double> cellIntegralErrors;	/*!	Statistical error of each of these				*/
 };
 
 #endif
@@ -218,17 +218,126 @@ class BasePDF : public BasePDF_Framework, public BasePDF_MCCaching, public IPDF
 		 */
 		virtual double Evaluate( DataPoint* Input );
 
+		/*!
+		 * @brief   Interface Function:  Evaluate the PDF for a whole block of events
+		 *
+		 * In BasePDF this simply calls Evaluate for each event in turn.
+		 * PDFs which can share work between events, or vectorise over them, should overload this
+		 * and must give the same result as calling Evaluate on each event.
+		 *
+		 * @param Input   Block of events that should be Evaluated
+		 * @param out     Output, one value per event in the block
+		 *
+		 * @return Void
+		 */
+		virtual void EvaluateBatch( const EventBlock& Input, double* out );
+
+		/*!
+		 * @brief   Interface Function:  Can this PDF provide EvaluateGradient
+		 *
+		 * In BasePDF this is false, the minimiser then falls back to finite differences of the whole function.
+		 *
+		 * @return true if EvaluateGradient has been implemented for this PDF and its present configuration
+		 */
+		virtual bool GetAnalyticGradient() const;
+
+		/*!
+		 * @brief   Interface Function:  Derivative of the log of the normalised PDF with respect to each of the given parameters
+		 *
+		 * This must be the derivative of ln( Evaluate( Input ) / Integral( Input, Boundary ) ).
+		 * Parameters which this PDF doesn't depend on must be set to 0.
+		 *
+		 * In BasePDF this is an error, see GetAnalyticGradient.
+		 *
+		 * @param Input     DataPoint that should be Evaluated
+		 * @param Boundary  PhaseSpaceBoundary the PDF is normalised over
+		 * @param Names     Parameters to differentiate with respect to, this should be the same object for every call in a fit
+		 * @param gradient  Output, one value per entry in Names
+		 *
+		 * @return Void
+		 */
+		virtual void EvaluateGradient( DataPoint* Input, PhaseSpaceBoundary* Boundary, const vector<string>& Names, double* gradient );
+
+		/*!
+		 * @brief   Interface Function:  Number of amplitude terms this PDF is a bilinear form in
+		 *
+		 * PDFs whose value is w(x) Re sum_ij H_ij a_i(x) a_j(x)* can provide the a_i, so that the numerical integrator
+		 * can store the integrals of w a_i a_j* and, while only the couplings H change, normalise without evaluating the PDF at all.
+		 *
+		 * In BasePDF this is 0, i.e. the PDF is always integrated by evaluating it.
+		 *
+		 * @return the number of terms, or 0 if EvaluateAmplitudeTerms and ContractAmplitudeIntegrals are not provided in the present configuration
+		 */
+		virtual unsigned int GetNumberAmplitudeTerms() const;
+
+		/*!
+		 * @brief   Interface Function:  The amplitude terms and the weight at this point
+		 *
+		 * In BasePDF this is an error, see GetNumberAmplitudeTerms.
+		 *
+		 * @param Input   DataPoint that should be Evaluated
+		 * @param terms   Output, one value per amplitude term
+		 * @param weight  Output, the real weight w
+		 *
+		 * @return Void
+		 */
+		virtual void EvaluateAmplitudeTerms( DataPoint* Input, complex<double>* terms, double& weight );
+
+		/*!
+		 * @brief   Interface Function:  Names of the parameters which only enter through the couplings
+		 *
+		 * A change of any other parameter means the integrals of the amplitude terms have to be calculated again.
+		 *
+		 * In BasePDF this is empty.
+		 */
+		virtual vector<string> GetAmplitudeCouplingNames() const;
+
+		/*!
+		 * @brief   Interface Function:  Integral of the PDF with the current couplings
+		 *
+		 * In BasePDF this is an error, see GetNumberAmplitudeTerms.
+		 *
+		 * @param integrals  integrals[i*n+j] is the integral of w a_i a_j*, n = GetNumberAmplitudeTerms()
+		 *
+		 * @return the integral of Evaluate
+		 */
+		virtual double ContractAmplitudeIntegrals( const vector<complex<double> >& integrals );
+
 		virtual complex<double> EvaluteComplex( DataPoint* );
 
 		/*!
 		 * @brief   Interface Function:  This is a new wrapper between this PDF and the framework in RapidFit
 		 *
+		 * Only the parameters of this PDF are compared with the input.
+		 * If none of them have changed since the last call, SetPhysicsParameters is NOT called and all caches are left alone.
+		 * Otherwise the normalisation caches are invalidated only if a parameter they depend on has changed, see SetCacheDependencies.
+		 *
 		 * @param Input   This is the Input ParameterSet which is to be updated in the PDF
 		 *
 		 * @return Void
 		 */
 		void UpdatePhysicsParameters( ParameterSet* Input );
 
+		/*!
+		 * @brief Did this parameter change in the most recent call to UpdatePhysicsParameters
+		 *
+		 * This is intended to be used within SetPhysicsParameters so that only what depends on the changed parameters is recalculated
+		 *
+		 * @param Name   Name of the parameter, parameters which aren't part of this PDF are reported as unchanged
+		 *
+		 * @return true if the value has changed, or if the PDF has not been given any parameters yet
+		 */
+		bool ParameterChanged( const string& Name ) const;
+
+		/*!
+		 * @brief Counter which is incremented each time UpdatePhysicsParameters or SetComponentStatus actually changes this PDF
+		 *
+		 * Values cached from Evaluate remain valid for as long as this doesn't change, see ComponentValueCache
+		 *
+		 * @return the present version, this starts at 0 for new and copied objects
+		 */
+		unsigned int GetParameterVersion() const;
+
 		/*!
 		 * @brief Return the integral of the function over the given boundary
 		 *
@@ -255,6 +364,17 @@ class BasePDF : public BasePDF_Framework, public BasePDF_MCCaching, public IPDF
 		 */
 		virtual double EvaluateForNumericGeneration( DataPoint* Input );
 
+		/*!
+		 * @brief Return the function value at every point in the block for generation
+		 *
+		 * By default this is EvaluateBatch, a PDF which overloads EvaluateForNumericGeneration should overload this as well
+		 *
+		 * @param Input   Block of DataPoints to be evaluated, these are re-used with new values between calls
+		 *
+		 * @param out     Array of one value per DataPoint to be filled
+		 */
+		virtual void EvaluateForNumericGenerationBatch( const EventBlock& Input, double* out );
+
 		/*!
 		 * @brief Return the function value at the given point for use in numeric integral
 		 *
@@ -422,6 +542,25 @@ class BasePDF : public BasePDF_Framework, public BasePDF_MCCaching, public IPDF
 		 */
 		virtual double Normalisation( DataPoint* InputDataPoint, PhaseSpaceBoundary* InputPhaseSpace );
 
+		/*!
+		 * @brief Declare the parameters which the normalisation, and anything cached alongside it, depends on
+		 *
+		 * By default the caches are invalidated whenever any of the parameters of this PDF change.
+		 * Once this has been called they are only invalidated when one of these parameters changes.
+		 *
+		 * @param Names  Names of the parameters the normalisation depends on
+		 */
+		void SetCacheDependencies( const vector<string>& Names );
+
+		/*!
+		 * @brief Position of one of the parameters of this PDF within the Names passed to EvaluateGradient
+		 *
+		 * The lookup is cached for as long as the same Names object is passed in
+		 *
+		 * @return the index in Names, or -1 if the parameter isn't there (i.e. isn't floated)
+		 */
+		int GetGradientSlot( const vector<string>& Names, const ObservableRef& Param );
+
 		ParameterSet allParameters;		/*!	The internal ParameterSet object which contains all of the PhysicsParameters required for the PDF	*/
 
 		vector<string> allObservables;		/*!	A list of all the Observable Names this PDF requires			*/
@@ -469,6 +608,24 @@ class BasePDF : public BasePDF_Framework, public BasePDF_MCCaching, public IPDF
 
 		bool _basePDFComponentStatus;
 
+		/*!
+		 * @brief Compare the parameters of this PDF with the input and fill changedParameters
+		 *
+		 * @return true if any parameter has changed
+		 */
+		bool FindChangedParameters( ParameterSet* Input );
+
+		vector<ObservableRef> parameterRefs;	/*!	Names of allParameters, looked up in allParameters		*/
+		vector<ObservableRef> inputRefs;	/*!	Names of allParameters, looked up in the input ParameterSet	*/
+		vector<bool> changedParameters;		/*!	Which parameters changed in the last UpdatePhysicsParameters	*/
+		vector<string> cacheDependencies;	/*!	Parameters the caches depend on, empty means all of them	*/
+		bool parametersApplied;			/*!	Has SetPhysicsParameters been called on this object yet		*/
+		unsigned int parameterVersion;		/*!	Incremented whenever this PDF changes, see GetParameterVersion	*/
+
+		const vector<string>* gradientNames;	/*!	Names last passed to GetGradientSlot				*/
+		size_t gradientNamesSize;		/*!	Size of gradientNames when gradientSlots was filled		*/
+		vector<int> gradientSlots;		/*!	Position in gradientNames of each parameter of allParameters	*/
+
 };
 
 #endif
@@ -0,0 +1,410 @@
+/*!
+ * @class ColumnarDataSet
+ *
+ * @brief A DataSet which stores each Observable as one contiguous, aligned array of doubles
+ *
+ * MemoryDataSet stores a DataPoint per event, each of which holds a vector of Observables which each carry two strings.
+ * For large datasets this costs several hundred bytes per stored value and spreads the data for a single observable across the heap.
+ *
+ * Here the data is held in structure-of-arrays form:
+ *
+ *	one aligned double array per Observable			(the values)
+ *	one int and one double array per Observable		(the mutable bin_num and acceptance caches)
+ *	one double array per event for the initialNLL and the event weight
+ *
+ * Code which wants to run over the whole dataset quickly should use GetColumn and friends directly.
+ *
+ * GetDataPoint still returns a DataPoint so that existing PDFs continue to work.
+ * These DataPoints are views built from the columns the first time that each event is requested.
+ * They are kept until the dataset is destroyed as the rest of RapidFit keeps hold of the pointers, see IDataSet::GetDataPoint.
+ * The views are seeded from the side arrays when created, after that each view keeps its own copy of the per-event caches.
+ * Code which runs over every event, e.g. NegativeLogLikelihoodThreaded, should instead fill a few reusable DataPoints a block at a time
+ * with FillBlock and hand the caches back with StoreBlock, so no event needs a DataPoint of its own.
+ *
+ * The values can be written to a binary cache file with WriteCache. ReadCache maps such a file straight into the columns,
+ * so a later job on the same events doesn't parse anything. The file holds:
+ *
+ *	a header with the format version, the number of events and Observables, and a checksum of the header
+ *	the key describing where the events came from, a file written for any other key is rejected
+ *	the names of the Observables in column order
+ *	a checksum of each block of RAPIDFIT_CACHE_CHECKSUM_EVENTS events of each column
+ *	the columns, each starting on a RAPIDFIT_COLUMN_ALIGNMENT boundary
+ *
+ * As each block has its own checksum only the blocks which are actually read need to be checked, see StreamingDataSet,
+ * and the blocks of a mapped file are checked on all cores at once.
+ *
+ * The mapping is private, so sorting or reweighting a mapped dataset never touches the file.
+ */
+
+#pragma once
+#ifndef COLUMNAR_DATA_SET_H
+#define COLUMNAR_DATA_SET_H
+
+//	RapidFit Headers
+#include "IDataSet.h"
+#include "DataPoint.h"
+#include "ObservableRef.h"
+#include "PhaseSpaceBoundary.h"
+//	System Headers
+#include <vector>
+#include <string>
+#include <pthread.h>
+#include <stdint.h>
+
+#ifdef __CINT__
+#undef __GNUC__
+#define _SYS__SELECT_H_
+struct pthread_mutex_t;
+#undef __SYS__SELECT_H_
+#define __GNUC__
+#endif
+
+//	Alignment in bytes of each of the columns, this is a cache line and is enough for any vector unit we care about
+#define RAPIDFIT_COLUMN_ALIGNMENT 64
+
+//	Version of the binary cache format written by WriteCache, files with any other version are ignored
+#define RAPIDFIT_EVENT_CACHE_VERSION 2
+
+//	Number of events in each block of a column which has its own checksum in the binary cache
+#define RAPIDFIT_CACHE_CHECKSUM_EVENTS 65536
+
+using namespace::std;
+
+class ColumnarDataSet : public IDataSet
+{
+	public:
+		/*!
+		 * @brief Constructor, the Observables stored are those in the PhaseSpaceBoundary in the order they appear there
+		 *
+		 * @param NewBoundary  PhaseSpaceBoundary the data is contained within, this is copied
+		 */
+		ColumnarDataSet( PhaseSpaceBoundary* NewBoundary );
+
+		/*!
+		 * @brief Destructor, frees the columns and any DataPoint views which have been handed out
+		 */
+		~ColumnarDataSet();
+
+		//Interface functions
+		virtual DataPoint * GetDataPoint( int );
+		virtual bool AddDataPoint( DataPoint* );
+		virtual int GetDataNumber( DataPoint* templateDataPoint =NULL ) const;
+		virtual PhaseSpaceBoundary * GetBoundary() const;
+		virtual void SetBoundary( const PhaseSpaceBoundary* );
+
+		virtual void SortBy( string );
+
+		virtual IDataSet* GetDiscreteDataSet( const vector<ObservableRef> discreteParam, const vector<double> discreteVal ) const;
+
+		virtual vector<DataPoint> GetDiscreteSubSet( const vector<ObservableRef> discreteParam, const vector<double> discreteVal ) const;
+		virtual vector<DataPoint> GetDiscreteSubSet( const vector<string> discreteParam, const vector<double> discreteVal ) const;
+		virtual vector<DataPoint> GetDiscreteSubSet( DataPoint* input ) const;
+
+		virtual void Print();
+		virtual void PrintYield();
+
+		virtual double Yield();
+		virtual double YieldError();
+
+		virtual void UseEventWeights( const string Name );
+		virtual bool GetWeightsWereUsed() const;
+		virtual string GetWeightName() const;
+
+		virtual double GetSumWeights();
+		virtual double GetSumWeightsSq();
+		virtual void ApplyAlpha( const double, const double );
+		virtual double GetAlpha();
+		virtual void ApplyExternalAlpha( const string alphaName );
+		virtual void NormaliseWeights();
+
+		/*!
+		 * @brief Add the event without checking the PhaseSpaceBoundary, the input is NOT deleted
+		 */
+		void SafeAddDataPoint( DataPoint* NewDataPoint );
+
+		/*!
+		 * @brief Add an event directly from an array of values, one per Observable in the order of GetObservableNames
+		 *
+		 * This performs NO checks on the values and is intended for loaders which have already checked the event
+		 */
+		void AddEvent( const double* values );
+
+		/*!
+		 * @brief Make sure that there is space for at least this many events without reallocating the columns
+		 */
+		void Reserve( const unsigned int numberEvents );
+
+		/*!
+		 * @brief Remove all of the events, this invalidates all DataPoints returned from GetDataPoint
+		 */
+		void Clear();
+
+		/*!
+		 * @brief Number of Observables (columns) stored per event
+		 */
+		unsigned int GetNumberObservables() const;
+
+		/*!
+		 * @brief Names of the Observables in column order
+		 */
+		vector<string> GetObservableNames() const;
+
+		/*!
+		 * @brief Get the column number of an Observable, the lookup is cached in the ObservableRef
+		 *
+		 * The column order is the same as the order of the Observables in the DataPoints returned by this class
+		 * so the cached index can be used with either
+		 *
+		 * @return the column number, or -1 if this Observable isn't stored
+		 */
+		int GetColumnIndex( const ObservableRef& Name ) const;
+
+		/*!
+		 * @brief Get the values of one Observable for all events, this is aligned to RAPIDFIT_COLUMN_ALIGNMENT
+		 *
+		 * @warning The pointer is invalidated by adding events
+		 */
+		const double* GetColumn( const unsigned int column ) const;
+
+		/*!
+		 * @brief Per-event cache of the bin number of one Observable (-1 if unset)
+		 */
+		int* GetBinNumberColumn( const unsigned int column ) const;
+
+		/*!
+		 * @brief Per-event cache of the acceptance of one Observable (-1 if unset)
+		 */
+		double* GetAcceptanceColumn( const unsigned int column ) const;
+
+		/*!
+		 * @brief Per-event initial NLL (NaN if unset)
+		 */
+		double* GetInitialNLLColumn() const;
+
+		/*!
+		 * @brief Per-event weights used in the fit, all 1 unless UseEventWeights has been called
+		 */
+		const double* GetEventWeightColumn() const;
+
+		/*!
+		 * @brief Identifier of the values held in the columns, never reused
+		 *
+		 * This changes whenever the values of events already stored may have changed, e.g. by SortBy or Clear,
+		 * but not when events are added. Together with the index of an event it identifies its values, see ComponentValueCache
+		 */
+		size_t GetValuesID() const;
+
+		/*!
+		 * @brief Fill DataPoints with events first to first+number-1, including their per-event caches from the side arrays
+		 *
+		 * Any per-event data left by the previous event in each DataPoint is cleared.
+		 *
+		 * @param points  DataPoints to fill, more are made if there are fewer than number, these belong to the caller and are meant to be reused
+		 */
+		void FillBlock( const unsigned int first, const unsigned int number, vector<DataPoint*>& points ) const;
+
+		/*!
+		 * @brief Copy the per-event caches of DataPoints filled by FillBlock back into the side arrays
+		 */
+		void StoreBlock( const unsigned int first, const unsigned int number, DataPoint* const* points ) const;
+
+		/*!
+		 * @brief Write the values of all events to a binary cache file which ReadCache can map straight back into memory
+		 *
+		 * The file is written under a temporary name and then renamed, so a job reading the cache never sees a partial file
+		 *
+		 * @param path  File to write
+		 * @param key   Description of where the events came from, ReadCache only accepts the file for exactly the same key
+		 *
+		 * @return true if the file was written
+		 */
+		bool WriteCache( const string path, const string key ) const;
+
+		/*!
+		 * @brief Map a cache file written by WriteCache into a new dataset
+		 *
+		 * Only the values come from the file, the per-event caches and weights start out unset as for a freshly loaded dataset
+		 *
+		 * @param path         File to read
+		 * @param key          Description of where the events should have come from
+		 * @param NewBoundary  PhaseSpaceBoundary of the dataset, the Observables must match those in the file
+		 *
+		 * @return the dataset, or NULL if the file is missing, is for a different key or version, or fails its checksums
+		 */
+		static ColumnarDataSet* ReadCache( const string path, const string key, PhaseSpaceBoundary* NewBoundary );
+
+		/*!
+		 * @brief Where the columns are in a cache file written by WriteCache
+		 */
+		struct CacheLayout
+		{
+			uint64_t events;		/*!	Number of events in the file				*/
+			uint64_t stride;		/*!	Bytes from the start of one column to the next		*/
+			uint64_t dataOffset;		/*!	Bytes from the start of the file to the first column	*/
+			uint64_t blockEvents;		/*!	Number of events in each checksummed block, the last block of a column may be shorter	*/
+			vector<uint64_t> blockChecksums;	/*!	Checksum of each block, all blocks of the first column then all of the second...	*/
+		};
+
+		/*!
+		 * @brief Check the header of a cache file and find its layout
+		 *
+		 * @param input        Start of the file
+		 * @param bytes        Size of the whole file, only the header is read
+		 * @param key          Key the file should have been written for
+		 * @param wantedNames  Observables the file should contain, in column order
+		 * @param layout       Set to the layout of the columns
+		 *
+		 * @return empty if the header is valid, otherwise a description of the problem
+		 */
+		static string ReadCacheHeader( const char* input, const size_t bytes, const string key, const vector<string>& wantedNames, CacheLayout& layout );
+
+		/*!
+		 * @brief Replace all of the events with events first to first+number-1 of an open cache file, reusing the columns where possible
+		 *
+		 * This is used to stream a cache file through a small dataset, see StreamingDataSet. The event weights are reset to 1
+		 * Every block these events are in is checked against its checksum, reading the rest of any block only partly in range
+		 *
+		 * @return true if all of the values could be read and match their checksums
+		 */
+		bool ReadCacheRange( const int fileDescriptor, const CacheLayout& layout, const unsigned int first, const unsigned int number );
+
+		/*!
+		 * @brief Set the event weights to Observable weightName times scale, times Observable scaleName if given, without any output
+		 *
+		 * This is what UseEventWeights followed by ApplyAlpha or ApplyExternalAlpha leave, for a dataset with values which changed
+		 */
+		void SetEventWeights( const string weightName, const double scale, const string scaleName="" );
+
+		/*!
+		 * @brief 64 bit FNV-1a checksum of a block of memory, pass the result of a previous call as initial to continue it
+		 */
+		static uint64_t Checksum( const void* data, const size_t bytes, const uint64_t initial=14695981039346656037ULL );
+
+		/*!
+		 * @brief Number of checksummed blocks in each column of a cache file
+		 */
+		static uint64_t NumberCacheBlocks( const CacheLayout& layout );
+
+	private:
+		//	Uncopyable!
+		ColumnarDataSet( const ColumnarDataSet& );
+		ColumnarDataSet& operator = ( const ColumnarDataSet& );
+
+		/*!
+		 * @brief Make sure there is room for the requested number of events in all columns
+		 */
+		void Grow( const unsigned int wantedCapacity );
+
+		/*!
+		 * @brief Aligned allocation and free of a single column
+		 */
+		static void* AllocateColumn( const size_t bytes );
+		static void FreeColumn( void* column );
+
+		/*!
+		 * @brief Use the columns in a mapped cache file as the values, the other columns are allocated and reset
+		 */
+		void AdoptMapping( void* region, const size_t bytes, const uint64_t dataOffset, const uint64_t stride, const unsigned int events );
+
+		/*!
+		 * @brief Release the mapped cache file, the value columns must no longer point into it
+		 */
+		void Unmap();
+
+		/*!
+		 * @brief Blocks of a mapped cache file checked by one thread, see CheckMappedBlocks
+		 */
+		struct BlockCheck_Thread
+		{
+			const char* input;		/*!	Start of the mapped file				*/
+			const CacheLayout* layout;	/*!	Layout of the columns in the file			*/
+			uint64_t firstBlock;		/*!	First block to check, counting through all columns	*/
+			uint64_t numberBlocks;		/*!	Number of blocks to check				*/
+			bool isOK;			/*!	Set to whether all of these blocks match their checksums	*/
+		};
+
+		/*!
+		 * @brief Check every block of every column of a mapped cache file, splitting the blocks over all cores
+		 *
+		 * @return true if all of the blocks match their checksums
+		 */
+		static bool CheckMappedBlocks( const char* input, const CacheLayout& layout, const unsigned int numberColumns );
+
+		/*!
+		 * @brief Check the blocks given in a BlockCheck_Thread
+		 */
+		static void* CheckMappedBlocks_pthread( void* input );
+
+		/*!
+		 * @brief Check the blocks holding events first to first+number-1 of one column against their checksums
+		 *
+		 * @param values  The values of these events, any other events in the same blocks are read from the file
+		 *
+		 * @return true if all of these blocks match their checksums
+		 */
+		static bool CheckCacheRange( const int fileDescriptor, const CacheLayout& layout, const unsigned int column, const double* values, const unsigned int first, const unsigned int number );
+
+		/*!
+		 * @brief Append event number index from another ColumnarDataSet with the same Observables
+		 */
+		void CopyEvent( const ColumnarDataSet* source, const unsigned int index );
+
+		/*!
+		 * @brief Construct a DataPoint with the values of the given event
+		 */
+		DataPoint* MakeDataPoint( const unsigned int index ) const;
+
+		/*!
+		 * @brief Copy the content of the columns for this event into an existing DataPoint with the same Observables
+		 */
+		void FillDataPoint( const unsigned int index, DataPoint* output ) const;
+
+		/*!
+		 * @brief Copy the content of the columns for this event into an existing view
+		 */
+		void RefreshView( const unsigned int index ) const;
+
+		/*!
+		 * @brief Update all views which have been handed out, used when the columns have been changed in place
+		 */
+		void RefreshAllViews() const;
+
+		/*!
+		 * @brief Get the event numbers of all events with the given values of the discrete Observables
+		 */
+		vector<unsigned int> GetDiscreteIndices( const vector<ObservableRef> discreteParam, const vector<double> discreteVal ) const;
+
+		PhaseSpaceBoundary* dataBoundary;	/*!	PhaseSpace this data lies within			*/
+		DataPoint* templatePoint;		/*!	DataPoint with the correct names and units, copied to make views	*/
+
+		vector<string> allNames;		/*!	Names of the Observables in column order		*/
+		vector<double*> allColumns;		/*!	One column per Observable				*/
+		vector<int*> binNumColumns;		/*!	One bin number cache per Observable			*/
+		vector<double*> acceptanceColumns;	/*!	One acceptance cache per Observable			*/
+		double* initialNLLColumn;		/*!	Initial NLL for each event				*/
+		double* weightColumn;			/*!	Event weight for each event				*/
+
+		unsigned int numberEvents;		/*!	Number of events stored					*/
+		unsigned int capacity;			/*!	Number of events there is room for			*/
+
+		void* mappedRegion;			/*!	Cache file the value columns point into, NULL if they were allocated	*/
+		size_t mappedBytes;
+
+		mutable vector<DataPoint*> allViews;	/*!	DataPoint views, NULL until requested			*/
+		mutable pthread_mutex_t view_lock;	/*!	Protects creation of views				*/
+
+		bool useWeights;
+		string WeightName;
+		double alpha;
+		string alphaName;
+
+		size_t valuesID;			/*!	See GetValuesID						*/
+
+		/*!
+		 * @brief Get the next unused identifier for GetValuesID
+		 */
+		static size_t NewValuesID();
+};
+
+#endif
+
@@ -0,0 +1,119 @@
+/*!
+ * @class ComponentValueCache
+ *
+ * @brief Per-event store of the values returned by one daughter PDF of a composite PDF
+ *
+ * In a SumPDF or NormalisedSumPDF fit most steps only move the fraction or the parameters of one of the daughters.
+ * The other daughter returns exactly the same values as in the previous call, yet every event is evaluated again.
+ *
+ * This class remembers the result of IPDF::EvaluateBatch for each block of events it has seen, stored contiguously.
+ * Each block is tagged with IPDF::GetParameterVersion of the daughter at the time it was evaluated,
+ * and the stored values are returned as long as that version is unchanged.
+ *
+ * Blocks taken from a ColumnarDataSet are found by ColumnarDataSet::GetValuesID and the index of their first event.
+ * The DataPoints of these blocks are scratch objects refilled for every block, so their identity says nothing about the event.
+ *
+ * Any other block is found by its DataPoint pointers, and the stored values of an event are only used while it has the same
+ * DataPoint::GetDataID and DataPoint::GetDataGeneration as when it was evaluated. So events whose values are rewritten in place,
+ * e.g. the points of an IntegrationGrid, and new events at the address of deleted ones, e.g. when streaming, are evaluated again.
+ *
+ * At most maxCachedEvents events are stored, the cache starts again once it is full.
+ *
+ * Each PDF instance (and therefore each thread) needs its own cache, the class is not thread safe.
+ */
+
+#pragma once
+#ifndef RAPIDFIT_COMPONENT_VALUE_CACHE_H
+#define RAPIDFIT_COMPONENT_VALUE_CACHE_H
+
+//	RapidFit Headers
+#include "IPDF.h"
+#include "EventBlock.h"
+#include "DataPoint.h"
+//	System Headers
+#include <vector>
+#include <map>
+
+using namespace::std;
+
+class ComponentValueCache
+{
+	public:
+		/*!
+		 * @brief Constructor, the cache starts empty
+		 */
+		ComponentValueCache();
+
+		/*!
+		 * @brief Copies start empty, the cached values belong to the events of the original object
+		 */
+		ComponentValueCache( const ComponentValueCache& );
+
+		~ComponentValueCache();
+
+		/*!
+		 * @brief Get the values of the PDF for all events in the block, evaluating the PDF only if the stored values are out of date
+		 *
+		 * @param thisPDF  PDF to be evaluated, this must always be the same PDF for a given cache
+		 * @param Input    Events to be evaluated
+		 * @param out      Array of at least Input.GetNumberEvents() doubles to be filled
+		 */
+		void EvaluateBatch( IPDF* thisPDF, const EventBlock& Input, double* out );
+
+		/*!
+		 * @brief Forget all stored values
+		 */
+		void Clear();
+
+		/*!
+		 * @brief Number of events which have a stored value
+		 */
+		unsigned int GetNumberEvents() const;
+
+	private:
+		//	Uncopyable this way!
+		ComponentValueCache& operator= ( const ComponentValueCache& );
+
+		//	Location and state of one block of events in the cache
+		struct CachedBlock {
+			unsigned int offset;	/*!	Index of the first event in cachedEvents and cachedValues	*/
+			unsigned int nEvents;	/*!	Number of events in this block					*/
+			unsigned int version;	/*!	Parameter version of the PDF when the values were stored	*/
+			bool columnar;		/*!	Found by its position in a ColumnarDataSet, not by its DataPoints	*/
+		};
+
+		//	Identity and values of one event when it was stored
+		struct CachedEvent {
+			DataPoint* point;		/*!	Address of the event						*/
+			size_t dataID;			/*!	DataPoint::GetDataID of the event				*/
+			unsigned int dataGeneration;	/*!	DataPoint::GetDataGeneration of the event when it was evaluated	*/
+		};
+
+		/*!
+		 * @brief Find the stored block for this EventBlock
+		 *
+		 * @return index in allBlocks, or -1 if this block hasn't been seen or its events are at different addresses or positions
+		 */
+		int FindBlock( const EventBlock& Input ) const;
+
+		/*!
+		 * @brief Whether the events of a block found with FindBlock still hold the values they were evaluated with
+		 */
+		bool IsCurrent( const CachedBlock& thisBlock, const EventBlock& Input ) const;
+
+		/*!
+		 * @brief Store the identity and values of the events of this block
+		 */
+		void StoreEvents( const CachedBlock& thisBlock, const EventBlock& Input );
+
+		static const unsigned int maxCachedEvents;	/*!	Limit on the size of cachedEvents		*/
+
+		map<DataPoint*, unsigned int> blockLookup;	/*!	First event of each block -> index in allBlocks	*/
+		map<pair<size_t, unsigned int>, unsigned int> columnLookup;	/*!	Values ID and first event of each columnar block -> index in allBlocks	*/
+		vector<CachedBlock> allBlocks;			/*!	All blocks seen so far				*/
+		vector<CachedEvent> cachedEvents;		/*!	Events of all blocks, contiguous per block	*/
+		vector<double> cachedValues;			/*!	Stored PDF value for each entry in cachedEvents	*/
+};
+
+#endif
+
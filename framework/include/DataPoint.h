@@ -88,6 +88,46 @@ class DataPoint
 		 */
 		Observable* GetObservable( const ObservableRef& NameRef, const bool silence=false );
 
+		/*!
+		 * @brief Get the slot holding the requested Observable, this is for use with value()
+		 *
+		 * A slot is only meaningful for DataPoints with the same GetLayoutID() as the DataPoint it was found from.
+		 * PDFs should look up their slots once per layout and then use value() for each event.
+		 *
+		 * @param NameRef  Name of the Observable being requested
+		 *
+		 * @return returns the slot, or -1 if this DataPoint doesn't contain the Observable
+		 */
+		int GetSlot( const ObservableRef& NameRef ) const;
+
+		/*!
+		 * @brief Identifier for the names and order of the Observables in this DataPoint
+		 *
+		 * DataPoints with the same names in the same order have the same identifier, so share the same slots.
+		 * Each distinct list of names is given the next identifier the first time it is seen, so different lists never share one.
+		 *
+		 * @return returns the layout identifier, never 0
+		 */
+		size_t GetLayoutID() const
+		{
+			return layoutID;
+		}
+
+		/*!
+		 * @brief Get the value of the Observable in a slot found with GetSlot
+		 *
+		 * The slot must have been found from a DataPoint with the same GetLayoutID(), only its range is checked
+		 *
+		 * @param slot   Slot of the wanted Observable
+		 *
+		 * @return returns the value of the Observable
+		 */
+		double value( const unsigned int slot ) const
+		{
+			if( slot >= allObservables.size() ) this->SlotOutOfRange( slot );
+			return allObservables[slot].GetValue();
+		}
+
 		/*!
 		 * @brief Remove the requested Observable
 		 *
@@ -266,9 +306,35 @@ class DataPoint
 
 		/*!
 		 * @brief This clears the vector of PerEvent Data values
+		 *
+		 * This is done whenever the values of the Observables are changed in place, so it also starts a new data generation
 		 */
 		void ClearPerEventData();
 
+		/*!
+		 * @brief Identifier of this DataPoint object which is never reused, even by a DataPoint at the same address after this one is deleted
+		 */
+		size_t GetDataID() const
+		{
+			return dataID;
+		}
+
+		/*!
+		 * @brief Counter which changes whenever the values in this DataPoint may have changed
+		 *
+		 * Together with GetDataID this identifies the values of an event, see ComponentValueCache
+		 */
+		unsigned int GetDataGeneration() const
+		{
+			return dataGeneration;
+		}
+
+		/*!
+		 * @brief Start a new data generation, this must be called after changing the value of an Observable in place,
+		 *        e.g. through Observable::ExternallySetValue, unless ClearPerEventData is called
+		 */
+		void NewDataGeneration();
+
 	private:
 
 		vector<double> PerEventData;
@@ -306,6 +372,29 @@ class DataPoint
 		mutable int nameIndex;
 
 		map< size_t, int > DiscreteIndexMap;
+
+		/*!
+		 * Hash of the names of the Observables in order, see GetLayoutID
+		 */
+		size_t layoutID;
+
+		/*!
+		 * @brief Recalculate layoutID, this must be called whenever allNames changes
+		 */
+		void UpdateLayoutID();
+
+		/*!
+		 * @brief Complain about a slot passed to value() which this DataPoint doesn't have, this throws
+		 */
+		void SlotOutOfRange( const unsigned int slot ) const;
+
+		size_t dataID;			/*!	Unique identifier of this object, see GetDataID	*/
+		unsigned int dataGeneration;	/*!	See GetDataGeneration				*/
+
+		/*!
+		 * @brief Get the next unused identifier for a new DataPoint
+		 */
+		static size_t NewDataID();
 };
 
 #endif
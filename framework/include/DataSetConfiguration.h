@@ -186,7 +186,24 @@ class DataSetConfiguration
 
 		IDataSet * LoadDataFile( vector<string>, vector<string>, PhaseSpaceBoundary*, long );	/*! @brief Undocumented	*/
 		IDataSet * LoadAsciiFileIntoMemory( string, long, PhaseSpaceBoundary* );		/*! @brief Undocumented	*/
-		IDataSet * LoadRootFileIntoMemory( string, string, long, PhaseSpaceBoundary* );		/*! @brief Undocumented	*/
+		IDataSet * LoadRootFileIntoMemory( string, string, long, PhaseSpaceBoundary* );		/*! @brief Read the cut and Observable formulas from an ntuple in a single pass over only the branches they use	*/
+
+		/*!
+		 * @brief Load a ROOT file through a binary event cache in cacheDirectory
+		 *
+		 * If a cache for exactly this file, ntuple, cut, entries and PhaseSpaceBoundary exists it is mapped into memory,
+		 * otherwise the file is loaded with LoadRootFileIntoMemory and the cache is written for the next job
+		 *
+		 * With a non-zero streamChunkSize the events are left in the cache file and a StreamingDataSet reading this many at a time is returned
+		 */
+		IDataSet * LoadCachedRootFile( string, string, long, PhaseSpaceBoundary*, string cacheDirectory, unsigned int streamChunkSize=0 );
+
+		/*!
+		 * @brief Description of everything the events read from a ROOT file depend on, this is the key of the event cache
+		 *
+		 * This includes the size and modification time of the file so a cache is stale as soon as the file is replaced
+		 */
+		string EventCacheKey( string, string, long, PhaseSpaceBoundary* ) const;
 
 		/*!
 		 * @brief Private method for polling a ROOT file for the ntuple path
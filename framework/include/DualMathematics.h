@@ -0,0 +1,177 @@
+/*!
+ * @namespace Mathematics
+ *
+ * DualNumber versions of the time dependent functions in Mathematics.
+ *
+ * These return the same values as the double versions and, in addition, the exact derivatives with respect to
+ * whichever of the inputs carry derivatives. Nested DualNumbers give the second derivatives as well.
+ *
+ * The complex error function itself is evaluated with the double code and its derivatives are added analytically:
+ *
+ *	F = exp(-u^2) w(z),	z = swt*c + i(u+c)
+ *	dF = ( -2zF + 2i exp(-u^2) / sqrt(pi) ) dz - 2uF du
+ *
+ * @author RapidFit Developers
+ */
+
+#pragma once
+#ifndef RAPIDFIT_DUAL_MATHEMATICS
+#define RAPIDFIT_DUAL_MATHEMATICS
+
+///	RapidFit Headers
+#include "Mathematics.h"
+#include "DualNumber.h"
+///	System Headers
+#include <complex>
+#include <utility>
+
+using namespace::std;
+
+#ifndef __CINT__
+
+namespace Mathematics
+{
+	/*!
+	 * @brief Real and imaginary parts of evalCerf, this is the end of the recursion in the DualNumber version below
+	 */
+	inline void evalCerf( const double swt, const double u, const double c, double& re, double& im )
+	{
+		const complex<double> returnable = evalCerf( swt, u, c );
+		re = returnable.real();
+		im = returnable.imag();
+	}
+
+	/*!
+	 * @brief Real and imaginary parts of evalCerf including the derivatives with respect to swt, u and c
+	 */
+	template<unsigned int N, typename T> void evalCerf( const DualNumber<N,T>& swt, const DualNumber<N,T>& u, const DualNumber<N,T>& c,
+								DualNumber<N,T>& re, DualNumber<N,T>& im )
+	{
+		T F_re, F_im;
+		evalCerf( swt.GetValue(), u.GetValue(), c.GetValue(), F_re, F_im );
+
+		const T x = swt.GetValue() * c.GetValue();
+		const T y = u.GetValue() + c.GetValue();
+		const T expu2 = exp( -u.GetValue()*u.GetValue() );
+
+		//	dF/dz = A + iB
+		const T A = -2. * ( x*F_re - y*F_im );
+		const T B = -2. * ( x*F_im + y*F_re ) + ( 2. / rootpi ) * expu2;
+
+		const T two_u = 2. * u.GetValue();
+
+		re = DualNumber<N,T>( F_re );
+		im = DualNumber<N,T>( F_im );
+		for( unsigned int i=0; i< N; ++i )
+		{
+			const T dx = swt.GetDerivative(i) * c.GetValue() + swt.GetValue() * c.GetDerivative(i);
+			const T dy = u.GetDerivative(i) + c.GetDerivative(i);
+			const T du = u.GetDerivative(i);
+			re.SetDerivative( i, A*dx - B*dy - two_u*F_re*du );
+			im.SetDerivative( i, B*dx + A*dy - two_u*F_im*du );
+		}
+	}
+
+	/*!
+	 * @brief Exp( t, gamma, resolution ) with derivatives
+	 */
+	template<unsigned int N, typename T> DualNumber<N,T> Exp( const DualNumber<N,T>& t, const DualNumber<N,T>& gamma, const DualNumber<N,T>& resolution )
+	{
+		if( PrimalValue( resolution ) > 0. )
+		{
+			const DualNumber<N,T> resolution_2_gamma = resolution*resolution*gamma;
+			const DualNumber<N,T> theExp = exp( -t*gamma + resolution_2_gamma*gamma*0.5 );
+			const DualNumber<N,T> theErfc = erfc( -( t - resolution_2_gamma ) * _over_sqrt_2 / resolution );
+			return theExp * theErfc * 0.5;
+		}
+		else
+		{
+			if( PrimalValue( t ) < 0.0 ) return DualNumber<N,T>( 0. );
+			return exp( -t*gamma );
+		}
+	}
+
+	/*!
+	 * @brief ExpInt( tlow, thigh, gamma, resolution ) with derivatives with respect to gamma and the resolution
+	 */
+	template<unsigned int N, typename T> DualNumber<N,T> ExpInt( const double tlow, const double thigh, const DualNumber<N,T>& gamma, const DualNumber<N,T>& resolution )
+	{
+		if( thigh < tlow )
+		{
+			std::cerr << " Mathematics::ExpInt: thigh is < tlow " << std::endl ;
+			return DualNumber<N,T>( -1.0 );
+		}
+
+		const DualNumber<N,T> invgamma = 1. / gamma;
+		if( PrimalValue( resolution ) > 0. )
+		{
+			const DualNumber<N,T> sigma_2 = resolution*resolution;
+			const DualNumber<N,T> inv_tau2 = gamma*gamma;
+			const DualNumber<N,T> inv_r2_sigma = 1. / ( sqrt_2*resolution );
+			const DualNumber<N,T> inv_r2_sigma_tau = inv_r2_sigma*gamma;
+			const DualNumber<N,T> half_sigma_2 = sigma_2*0.5;
+
+			const DualNumber<N,T> int_tHigh = erf( thigh*inv_r2_sigma )
+				- exp( ( half_sigma_2 - invgamma*thigh )*inv_tau2 ) * erfc( ( sigma_2 - invgamma*thigh )*inv_r2_sigma_tau );
+
+			const DualNumber<N,T> int_tLow = erf( tlow*inv_r2_sigma )
+				- exp( ( half_sigma_2 - invgamma*tlow )*inv_tau2 ) * erfc( ( sigma_2 - invgamma*tlow )*inv_r2_sigma_tau );
+
+			return 0.5 * invgamma * ( int_tHigh - int_tLow );
+		}
+		else
+		{
+			const DualNumber<N,T> exp_gamma_thigh = exp( -gamma*thigh );
+			if( tlow < 0. ) return invgamma * ( 1.0 - exp_gamma_thigh );
+			else return invgamma * ( exp( -gamma*tlow ) - exp_gamma_thigh );
+		}
+	}
+
+	/*!
+	 * @brief ExpCos and ExpSin with derivatives, both come from the same two evaluations of the complex error function
+	 */
+	template<unsigned int N, typename T> pair<DualNumber<N,T>,DualNumber<N,T> > ExpCosSin( const DualNumber<N,T>& t, const DualNumber<N,T>& gamma,
+												const DualNumber<N,T>& deltaM, const DualNumber<N,T>& resolution )
+	{
+		if( PrimalValue( resolution ) > 0. )
+		{
+			const DualNumber<N,T> c = gamma * resolution * _over_sqrt_2;
+			const DualNumber<N,T> u = ( t / resolution ) * _over_sqrt_2;
+			const DualNumber<N,T> wt = deltaM / gamma;
+
+			DualNumber<N,T> plus_re, plus_im, minus_re, minus_im;
+			evalCerf( wt, -u, c, plus_re, plus_im );
+			evalCerf( -wt, -u, c, minus_re, minus_im );
+
+			return make_pair( ( plus_re + minus_re ) * 0.25, ( plus_im - minus_im ) * 0.25 );
+		}
+		else
+		{
+			if( PrimalValue( t ) < 0.0 ) return make_pair( DualNumber<N,T>( 0. ), DualNumber<N,T>( 0. ) );
+			const DualNumber<N,T> theExp = exp( -gamma*t );
+			const DualNumber<N,T> deltaM_t = deltaM*t;
+			return make_pair( theExp * cos( deltaM_t ), theExp * sin( deltaM_t ) );
+		}
+	}
+
+	/*!
+	 * @brief ExpCos( t, gamma, deltaM, resolution ) with derivatives
+	 */
+	template<unsigned int N, typename T> DualNumber<N,T> ExpCos( const DualNumber<N,T>& t, const DualNumber<N,T>& gamma, const DualNumber<N,T>& deltaM, const DualNumber<N,T>& resolution )
+	{
+		return ExpCosSin( t, gamma, deltaM, resolution ).first;
+	}
+
+	/*!
+	 * @brief ExpSin( t, gamma, deltaM, resolution ) with derivatives
+	 */
+	template<unsigned int N, typename T> DualNumber<N,T> ExpSin( const DualNumber<N,T>& t, const DualNumber<N,T>& gamma, const DualNumber<N,T>& deltaM, const DualNumber<N,T>& resolution )
+	{
+		return ExpCosSin( t, gamma, deltaM, resolution ).second;
+	}
+}
+
+#endif
+
+#endif
+
@@ -0,0 +1,237 @@
+/*!
+ * @class DualNumber
+ *
+ * @brief Forward mode automatic differentiation number, holding a value and its derivatives with respect to N parameters
+ *
+ * Code written for double which only uses the arithmetic operators, the comparisons and the functions defined below
+ * can be instantiated on this type and then returns the exact derivatives of its result alongside the value, in a single pass.
+ *
+ * To differentiate with respect to parameter i construct the input with DualNumber::Variable( value, i ),
+ * anything built from a plain double is a constant.
+ *
+ * The value type T may itself be a DualNumber, which gives second derivatives (forward over forward):
+ *
+ *	typedef DualNumber<N> First;
+ *	typedef DualNumber<N,First> Second;
+ *	Second x = Second::Variable( First::Variable( x0, i ), i );
+ *	...
+ *	result.GetValue().GetValue()		is the value
+ *	result.GetValue().GetDerivative(i)	is d/dx_i
+ *	result.GetDerivative(i).GetDerivative(j)	is d2/dx_i dx_j
+ *
+ * Comparisons only look at the value so branches in the calling code are taken exactly as they would be for a double.
+ *
+ * @author RapidFit Developers
+ */
+
+#pragma once
+#ifndef RAPIDFIT_DUAL_NUMBER_H
+#define RAPIDFIT_DUAL_NUMBER_H
+
+//	System Headers
+#include <cmath>
+
+using namespace::std;
+
+#ifndef __CINT__
+
+template<unsigned int N, typename T=double> class DualNumber
+{
+	public:
+		/*!
+		 * @brief A constant with value zero
+		 */
+		DualNumber() : value( 0. )
+		{
+			for( unsigned int i=0; i< N; ++i ) derivative[i] = T( 0. );
+		}
+
+		/*!
+		 * @brief A constant, from anything the value type can be made from
+		 */
+		template<typename U> DualNumber( const U& input ) : value( input )
+		{
+			for( unsigned int i=0; i< N; ++i ) derivative[i] = T( 0. );
+		}
+
+		/*!
+		 * @brief The independent variable number index, i.e. with derivative 1 with respect to itself and 0 for everything else
+		 */
+		static DualNumber Variable( const T& input, const unsigned int index )
+		{
+			DualNumber returnable( input );
+			if( index < N ) returnable.derivative[index] = T( 1. );
+			return returnable;
+		}
+
+		const T& GetValue() const { return value; }
+		const T& GetDerivative( const unsigned int index ) const { return derivative[index]; }
+
+		void SetValue( const T& input ) { value = input; }
+		void SetDerivative( const unsigned int index, const T& input ) { derivative[index] = input; }
+
+		/*!
+		 * @brief Number of derivatives carried
+		 */
+		static unsigned int Size() { return N; }
+
+		/*!
+		 * @brief The result of a function f of this number, given f(value) and f'(value)
+		 *
+		 * All of the elementary functions below are written in terms of this
+		 */
+		DualNumber Chain( const T& functionValue, const T& functionDerivative ) const
+		{
+			DualNumber returnable( functionValue );
+			for( unsigned int i=0; i< N; ++i ) returnable.derivative[i] = functionDerivative * derivative[i];
+			return returnable;
+		}
+
+		DualNumber operator - () const
+		{
+			DualNumber returnable( -value );
+			for( unsigned int i=0; i< N; ++i ) returnable.derivative[i] = -derivative[i];
+			return returnable;
+		}
+
+		DualNumber& operator += ( const DualNumber& input )
+		{
+			value += input.value;
+			for( unsigned int i=0; i< N; ++i ) derivative[i] += input.derivative[i];
+			return *this;
+		}
+
+		DualNumber& operator -= ( const DualNumber& input )
+		{
+			value -= input.value;
+			for( unsigned int i=0; i< N; ++i ) derivative[i] -= input.derivative[i];
+			return *this;
+		}
+
+		DualNumber& operator *= ( const DualNumber& input )
+		{
+			for( unsigned int i=0; i< N; ++i ) derivative[i] = derivative[i] * input.value + value * input.derivative[i];
+			value *= input.value;
+			return *this;
+		}
+
+		DualNumber& operator /= ( const DualNumber& input )
+		{
+			const T inverse = T( 1. ) / input.value;
+			value *= inverse;
+			for( unsigned int i=0; i< N; ++i ) derivative[i] = ( derivative[i] - value * input.derivative[i] ) * inverse;
+			return *this;
+		}
+
+		DualNumber& operator += ( const double input ) { value += input; return *this; }
+		DualNumber& operator -= ( const double input ) { value -= input; return *this; }
+
+		DualNumber& operator *= ( const double input )
+		{
+			value *= input;
+			for( unsigned int i=0; i< N; ++i ) derivative[i] *= input;
+			return *this;
+		}
+
+		DualNumber& operator /= ( const double input ) { return (*this) *= ( 1. / input ); }
+
+		friend DualNumber operator + ( const DualNumber& a, const DualNumber& b ) { DualNumber r( a ); return r += b; }
+		friend DualNumber operator - ( const DualNumber& a, const DualNumber& b ) { DualNumber r( a ); return r -= b; }
+		friend DualNumber operator * ( const DualNumber& a, const DualNumber& b ) { DualNumber r( a ); return r *= b; }
+		friend DualNumber operator / ( const DualNumber& a, const DualNumber& b ) { DualNumber r( a ); return r /= b; }
+
+		friend DualNumber operator + ( const DualNumber& a, const double b ) { DualNumber r( a ); return r += b; }
+		friend DualNumber operator - ( const DualNumber& a, const double b ) { DualNumber r( a ); return r -= b; }
+		friend DualNumber operator * ( const DualNumber& a, const double b ) { DualNumber r( a ); return r *= b; }
+		friend DualNumber operator / ( const DualNumber& a, const double b ) { DualNumber r( a ); return r /= b; }
+
+		friend DualNumber operator + ( const double a, const DualNumber& b ) { DualNumber r( b ); return r += a; }
+		friend DualNumber operator - ( const double a, const DualNumber& b ) { DualNumber r( -b ); return r += a; }
+		friend DualNumber operator * ( const double a, const DualNumber& b ) { DualNumber r( b ); return r *= a; }
+		friend DualNumber operator / ( const double a, const DualNumber& b ) { DualNumber r( a ); return r /= b; }
+
+		friend bool operator <  ( const DualNumber& a, const DualNumber& b ) { return a.value <  b.value; }
+		friend bool operator >  ( const DualNumber& a, const DualNumber& b ) { return a.value >  b.value; }
+		friend bool operator <= ( const DualNumber& a, const DualNumber& b ) { return a.value <= b.value; }
+		friend bool operator >= ( const DualNumber& a, const DualNumber& b ) { return a.value >= b.value; }
+		friend bool operator == ( const DualNumber& a, const DualNumber& b ) { return a.value == b.value; }
+		friend bool operator != ( const DualNumber& a, const DualNumber& b ) { return a.value != b.value; }
+
+		friend bool operator <  ( const DualNumber& a, const double b ) { return a.value <  b; }
+		friend bool operator >  ( const DualNumber& a, const double b ) { return a.value >  b; }
+		friend bool operator <= ( const DualNumber& a, const double b ) { return a.value <= b; }
+		friend bool operator >= ( const DualNumber& a, const double b ) { return a.value >= b; }
+
+	private:
+		T value;		/*!	Value of the function				*/
+		T derivative[N];	/*!	Derivative with respect to each parameter	*/
+};
+
+/*!
+ * @brief The plain double value of a number, however many levels of DualNumber it is wrapped in
+ */
+inline double PrimalValue( const double input )
+{
+	return input;
+}
+
+template<unsigned int N, typename T> double PrimalValue( const DualNumber<N,T>& input )
+{
+	return PrimalValue( input.GetValue() );
+}
+
+//	Elementary functions, each is f(x) with df = f'(x) dx
+
+template<unsigned int N, typename T> DualNumber<N,T> exp( const DualNumber<N,T>& x )
+{
+	const T value = exp( x.GetValue() );
+	return x.Chain( value, value );
+}
+
+template<unsigned int N, typename T> DualNumber<N,T> log( const DualNumber<N,T>& x )
+{
+	return x.Chain( log( x.GetValue() ), T( 1. ) / x.GetValue() );
+}
+
+template<unsigned int N, typename T> DualNumber<N,T> sqrt( const DualNumber<N,T>& x )
+{
+	const T value = sqrt( x.GetValue() );
+	return x.Chain( value, T( 0.5 ) / value );
+}
+
+template<unsigned int N, typename T> DualNumber<N,T> pow( const DualNumber<N,T>& x, const double power )
+{
+	return x.Chain( pow( x.GetValue(), power ), power * pow( x.GetValue(), power - 1. ) );
+}
+
+template<unsigned int N, typename T> DualNumber<N,T> sin( const DualNumber<N,T>& x )
+{
+	return x.Chain( sin( x.GetValue() ), cos( x.GetValue() ) );
+}
+
+template<unsigned int N, typename T> DualNumber<N,T> cos( const DualNumber<N,T>& x )
+{
+	return x.Chain( cos( x.GetValue() ), -sin( x.GetValue() ) );
+}
+
+template<unsigned int N, typename T> DualNumber<N,T> fabs( const DualNumber<N,T>& x )
+{
+	return x < 0. ? -x : x;
+}
+
+template<unsigned int N, typename T> DualNumber<N,T> erf( const DualNumber<N,T>& x )
+{
+	const T value = x.GetValue();
+	return x.Chain( erf( value ), ( 2. / sqrt( atan(1.)*4. ) ) * exp( -value*value ) );
+}
+
+template<unsigned int N, typename T> DualNumber<N,T> erfc( const DualNumber<N,T>& x )
+{
+	const T value = x.GetValue();
+	return x.Chain( erfc( value ), ( -2. / sqrt( atan(1.)*4. ) ) * exp( -value*value ) );
+}
+
+#endif
+
+#endif
+
@@ -0,0 +1,109 @@
+/*!
+ * @class EventBlock
+ *
+ * @brief A contiguous block of events which is passed to IPDF::EvaluateBatch
+ *
+ * This always gives access to the events through the DataPoint interface.
+ * When the events come from a ColumnarDataSet the block also knows where they sit in the columns,
+ * so a PDF can read the values of an Observable for the whole block as a plain array of doubles.
+ *
+ * The block does NOT own any of the objects it points to, it is cheap to copy and should be treated as a view.
+ */
+
+#pragma once
+#ifndef RAPIDFIT_EVENT_BLOCK_H
+#define RAPIDFIT_EVENT_BLOCK_H
+
+//	RapidFit Headers
+#include "DataPoint.h"
+#include "ObservableRef.h"
+//	System Headers
+#include <vector>
+
+//	Number of events handed to IPDF::EvaluateBatch at a time by the fit functions
+#define RAPIDFIT_EVENT_BLOCK_SIZE 256
+
+using namespace::std;
+
+class ColumnarDataSet;
+
+class EventBlock
+{
+	public:
+		/*!
+		 * @brief Constructor for a block of events only accessible as DataPoints
+		 *
+		 * @param Points        Pointer to the first of numberEvents contiguous DataPoint pointers
+		 * @param numberEvents  Number of events in this block
+		 */
+		EventBlock( DataPoint** Points, const unsigned int numberEvents );
+
+		/*!
+		 * @brief Constructor for a block of events which also live in a ColumnarDataSet
+		 *
+		 * @param Points        Pointer to the first of numberEvents contiguous DataPoint pointers
+		 * @param numberEvents  Number of events in this block
+		 * @param Columns       DataSet the events were taken from, may be NULL
+		 * @param FirstEvent    Index of the first event of this block within Columns
+		 */
+		EventBlock( DataPoint** Points, const unsigned int numberEvents, const ColumnarDataSet* Columns, const unsigned int FirstEvent );
+
+		EventBlock( const EventBlock& );
+		EventBlock& operator= ( const EventBlock& );
+
+		~EventBlock();
+
+		/*!
+		 * @brief Number of events in this block
+		 */
+		unsigned int GetNumberEvents() const;
+
+		/*!
+		 * @brief Get the given event in this block as a DataPoint
+		 */
+		DataPoint* GetDataPoint( const unsigned int index ) const;
+
+		/*!
+		 * @brief Get the pointer to the array of DataPoint pointers in this block
+		 */
+		DataPoint** GetDataPoints() const;
+
+		/*!
+		 * @brief Can the Observables in this block be accessed through GetColumn
+		 */
+		bool HasColumns() const;
+
+		/*!
+		 * @brief Get the values of an Observable for all events in this block
+		 *
+		 * @return Pointer to GetNumberEvents() doubles, or NULL if this block has no columns or the Observable isn't stored
+		 */
+		const double* GetColumn( const ObservableRef& Name ) const;
+
+		/*!
+		 * @brief Get the DataSet holding the events of this block in columns, or NULL if this block has no columns
+		 */
+		const ColumnarDataSet* GetColumnData() const;
+
+		/*!
+		 * @brief Index within GetColumnData of the first event of this block
+		 */
+		unsigned int GetFirstEvent() const;
+
+		/*!
+		 * @brief Get a block which covers part of this block
+		 *
+		 * @param first         Index within this block of the first event of the new block
+		 * @param numberEvents  Number of events in the new block, this is reduced to fit within this block
+		 */
+		EventBlock SubBlock( const unsigned int first, const unsigned int numberEvents ) const;
+
+	private:
+		DataPoint** allPoints;			/*!	The events in this block, NOT owned by this class	*/
+		unsigned int nEvents;			/*!	Number of events in this block				*/
+		const ColumnarDataSet* columnData;	/*!	DataSet holding these events in columns, may be NULL	*/
+		unsigned int firstEvent;		/*!	Index of the first event in this block in columnData	*/
+};
+
+#endif
+
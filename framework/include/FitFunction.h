@@ -92,6 +92,23 @@ class FitFunction : public IFitFunction
 		 */
 		virtual double Evaluate();
 
+		/*!
+		 * @brief Can EvaluateGradient be used, this requires the derived class and every PDF in the PhysicsBottle to provide a gradient
+		 */
+		bool GetAnalyticGradient();
+
+		/*!
+		 * @brief Evaluate the gradient of the FitFunction with respect to each parameter
+		 *
+		 * The contribution of the data is summed on the ThreadPool, see EvaluateDataSetGradient.
+		 * The contribution of the constraints is found by central differences as these are cheap to evaluate.
+		 *
+		 * @param Gradient  Output, one value per parameter in the order of GetParameterSet()->GetAllNames(), 0 for Fixed parameters
+		 *
+		 * @return true on success, false if any event gave an invalid gradient
+		 */
+		bool EvaluateGradient( vector<double>& Gradient );
+
 		/*!
 		 * @brief Set the Name of the Weights to use and the fact that Weights were used in the fit
 		 *
@@ -163,6 +180,19 @@ class FitFunction : public IFitFunction
 
 		bool GetOffSetNLL() const;
 
+		/*!
+		 * @brief Make a new function of the same type and configuration with its own copy of the PhysicsBottle, the DataSets are shared
+		 *
+		 * Evaluating writes into the DataPoints, so the copy and the original must not be evaluated at the same time in one process
+		 *
+		 * The copy doesn't write a trace and doesn't test the integrators again
+		 *
+		 * @param nThreads  Number of threads the copy evaluates with
+		 *
+		 * @return a new function which belongs to the caller, as does its PhysicsBottle
+		 */
+		IFitFunction* Clone( const int nThreads ) const;
+
 	protected:
 		/*!
 		 * Don't Copy the class this way!
@@ -180,6 +210,22 @@ class FitFunction : public IFitFunction
 		 */
 		virtual double EvaluateDataSet( IPDF*, IDataSet*, int );
 
+		/*!
+		 * @brief Does this FitFunction implement EvaluateDataSetGradient, false in FitFunction
+		 */
+		virtual bool ProvidesDataSetGradient() const;
+
+		/*!
+		 * @brief Gradient of EvaluateDataSet with respect to each of gradientNames
+		 *
+		 * @param gradient  Output, one value per entry in gradientNames
+		 *
+		 * @return true on success
+		 */
+		virtual bool EvaluateDataSetGradient( IPDF*, IDataSet*, int, double* gradient );
+
+		vector<string> gradientNames;		/*!	Floated parameters passed to IPDF::EvaluateGradient, kept here so the PDFs see the same object every call	*/
+
 		PhysicsBottle * allData;			/*!	Undocumented	*/
 		double testDouble;			/*!	Undocumented	*/
 		bool useWeights;			/*!	Undocumented	*/
@@ -204,6 +250,7 @@ class FitFunction : public IFitFunction
 		vector<RapidFitIntegrator*> StoredIntegrals;			/*	Undocumented	*/
 		bool finalised;				/*!	Undocumented	*/
 		struct Fitting_Thread* fit_thread_data;	/*!	Undocumented	*/
+		class ThreadPool* thread_pool;		/*!	Persistent worker threads used to evaluate fit_thread_data, created in SetPhysicsBottle	*/
 
 		bool testIntegrator;			/*!	Undocumented	*/
 
@@ -92,6 +92,11 @@ class FitFunctionConfiguration
 		 */
 		void SetThreads( int );
 
+		/*!
+		 * Get the Number of Threads the FitFunction is Constructed with, 0 if this is left to the FitFunction
+		 */
+		int GetThreads() const;
+
 		/*!
 		 * Set wether The FitFunction should test the Integrator
 		 */
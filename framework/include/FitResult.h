@@ -17,6 +17,7 @@
 #include "RapidFitMatrix.h"
 ///	System Headers
 #include <vector>
+#include <string>
 
 using namespace::std;
 
@@ -81,6 +82,22 @@ class FitResult
 		 */
 		void Print() const;
 
+		/*!
+		 * @brief Write this result into a string of bytes which Unpack can turn back into a FitResult, used to pass results between processes
+		 *
+		 * The parameters, minimum, fit status and covariance matrix are kept. The contours and the PDFs and data in the PhysicsBottle are not
+		 */
+		string Pack() const;
+
+		/*!
+		 * @brief Construct a FitResult from the output of Pack
+		 *
+		 * The PhysicsBottle of the result only holds the fitted parameters
+		 *
+		 * @return the new FitResult, or NULL if the input is truncated or not from Pack
+		 */
+		static FitResult* Unpack( const string& input );
+
 	private:
 		/*!
 		 * Don't Copy the class this way!
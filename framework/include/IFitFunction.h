@@ -86,6 +86,22 @@ class IFitFunction
 		 */
 		virtual double Evaluate() = 0;
 
+		/*!
+		 * @brief Can EvaluateGradient be used with the present PhysicsBottle
+		 *
+		 * @return true if the function and all of the PDFs it uses provide an analytic gradient
+		 */
+		virtual bool GetAnalyticGradient() = 0;
+
+		/*!
+		 * @brief Evaluate the derivative of Evaluate() with respect to each parameter
+		 *
+		 * @param Gradient  Output, one value per parameter in the order of GetParameterSet()->GetAllNames(), 0 for Fixed parameters
+		 *
+		 * @return true on success, false if the gradient couldn't be calculated at this point
+		 */
+		virtual bool EvaluateGradient( vector<double>& Gradient ) = 0;
+
 		/*!
 		 * @brief Set the Name of the Weights to use and the fact that Weights were used in the fit
 		 *
@@ -153,6 +169,17 @@ class IFitFunction
 
 		virtual bool GetOffSetNLL() const = 0;
 
+		/*!
+		 * @brief Make a new function of the same type and configuration with its own copy of the PhysicsBottle, the DataSets are shared
+		 *
+		 * Evaluating writes into the DataPoints, so the copy and the original must not be evaluated at the same time in one process
+		 *
+		 * @param nThreads  Number of threads the copy evaluates with
+		 *
+		 * @return a new function which belongs to the caller, as does its PhysicsBottle
+		 */
+		virtual IFitFunction* Clone( const int nThreads ) const = 0;
+
 	protected:
 		IFitFunction() {};
 
@@ -21,6 +21,7 @@
 #include "IPDF_NormalisationCaching.h"
 #include "ParameterSet.h"
 #include "ComponentRef.h"
+#include "EventBlock.h"
 ///	System Headers
 #include <vector>
 #include <string>
@@ -49,6 +50,12 @@ class IPDF : public virtual IPDF_NormalisationCaching, public virtual IPDF_MCCac
 		 */
 		virtual void UpdatePhysicsParameters( ParameterSet* ) = 0;
 
+		/*!
+		 * Interface Function:
+		 * Counter which changes every time the values returned by Evaluate may have changed
+		 */
+		virtual unsigned int GetParameterVersion() const = 0;
+
 		/*!
 		 * Interface Function:
 		 * Return the integral of the function over the given boundary
@@ -61,6 +68,50 @@ class IPDF : public virtual IPDF_NormalisationCaching, public virtual IPDF_MCCac
 		 */
 		virtual double Evaluate( DataPoint* ) = 0;
 
+		/*!
+		 * Interface Function:
+		 * Evaluate the function for every event in the block, out must have room for one value per event
+		 */
+		virtual void EvaluateBatch( const EventBlock&, double* out ) = 0;
+
+		/*!
+		 * Interface Function:
+		 * Can this PDF provide the gradient of its normalised log-likelihood through EvaluateGradient
+		 */
+		virtual bool GetAnalyticGradient() const = 0;
+
+		/*!
+		 * Interface Function:
+		 * d ln( Evaluate / Integral ) / d theta at the given point, for each parameter theta in Names
+		 */
+		virtual void EvaluateGradient( DataPoint*, PhaseSpaceBoundary*, const vector<string>& Names, double* gradient ) = 0;
+
+		/*!
+		 * Interface Function:
+		 * Number of complex amplitude terms a_i this PDF is a bilinear form in, 0 if it isn't one
+		 *
+		 * Evaluate(x) = w(x) Re sum_ij H_ij a_i(x) a_j(x)*, where w and the a_i don't depend on the parameters in GetAmplitudeCouplingNames and H only depends on these
+		 */
+		virtual unsigned int GetNumberAmplitudeTerms() const = 0;
+
+		/*!
+		 * Interface Function:
+		 * The amplitude terms a_i at the given point, terms must have room for GetNumberAmplitudeTerms values, and the real weight w
+		 */
+		virtual void EvaluateAmplitudeTerms( DataPoint*, complex<double>* terms, double& weight ) = 0;
+
+		/*!
+		 * Interface Function:
+		 * Parameters which only enter Evaluate through the couplings H
+		 */
+		virtual vector<string> GetAmplitudeCouplingNames() const = 0;
+
+		/*!
+		 * Interface Function:
+		 * Integral of Evaluate with the current couplings, given integrals[i*n+j] = Integral of w a_i a_j*
+		 */
+		virtual double ContractAmplitudeIntegrals( const vector<complex<double> >& integrals ) = 0;
+
 		virtual complex<double> EvaluteComplex( DataPoint* ) = 0;
 
 		/*!
@@ -69,6 +120,14 @@ class IPDF : public virtual IPDF_NormalisationCaching, public virtual IPDF_MCCac
 		 */
 		virtual double EvaluateForNumericGeneration( DataPoint* ) = 0;
 
+		/*!
+		 * Interface Function:
+		 * EvaluateForNumericGeneration for every event in the block, out must have room for one value per event
+		 *
+		 * The generators re-use the same DataPoints with new values for every block, so nothing may be cached against the DataPoints
+		 */
+		virtual void EvaluateForNumericGenerationBatch( const EventBlock&, double* out ) = 0;
+
 		/*!
 		 * Interface Function
 		 * Return the function value at the given point for use by numeric integral
@@ -15,8 +15,11 @@
 #include "ParameterSet.h"
 
 #include "PDFConfigurator.h"
+#include "EventBlock.h"
 #include "Observable.h"
+#include "DualNumber.h"
 //	System Headers
+#include <cmath>
 #include <iostream>
 #include <fstream>
 #include <cstdlib>
@@ -32,6 +35,15 @@ class IResolutionModel;
  */
 typedef IResolutionModel* CreateResModel_t( PDFConfigurator*, bool );
 
+#ifndef __CINT__
+/*!
+ * @brief Dual number passed through the resolution models, this carries the derivative along a single direction
+ *
+ * A PDF which needs the derivatives with respect to several of its parameters calls the Dual functions once per parameter
+ */
+typedef DualNumber<1> ResolutionDual;
+#endif
+
 class IResolutionModel
 {
 	public:
@@ -55,6 +67,71 @@ class IResolutionModel
 		virtual pair<double,double> ExpCosSinInt( double tlow, double thigh, double gamma, double dms )
 		{ (void) time; (void) gamma; (void) dms; (void) tlow; (void) thigh; return make_pair(0.,0.); };
 
+		/*!
+		 * @brief Exp for every event in a block, time[i] is the decay time of event i
+		 *
+		 * The default calls setObservables and Exp for each event in turn, so afterwards the model holds the observables of the last event
+		 */
+		virtual void ExpBatch( const EventBlock& Input, const double* time, double gamma, double* output )
+		{
+			for( unsigned int i=0; i< Input.GetNumberEvents(); ++i )
+			{
+				this->setObservables( Input.GetDataPoint( i ) );
+				output[i] = this->Exp( time[i], gamma );
+			}
+		}
+
+		/*!
+		 * @brief ExpCos and ExpSin for every event in a block, time[i] is the decay time of event i
+		 *
+		 * The default calls setObservables, ExpCos and ExpSin for each event in turn, so afterwards the model holds the observables of the last event
+		 */
+		virtual void ExpCosSinBatch( const EventBlock& Input, const double* time, double gamma, double dms, double* expCos, double* expSin )
+		{
+			for( unsigned int i=0; i< Input.GetNumberEvents(); ++i )
+			{
+				this->setObservables( Input.GetDataPoint( i ) );
+				expCos[i] = this->ExpCos( time[i], gamma, dms );
+				expSin[i] = this->ExpSin( time[i], gamma, dms );
+			}
+		}
+
+#ifndef __CINT__
+		/*!
+		 * @brief Exp, ExpInt, ExpCos and ExpSin carrying the derivatives of gamma and dms through to the result
+		 *
+		 * The parameters of the resolution model itself are treated as constants.
+		 *
+		 * The defaults take the derivatives with respect to gamma and dms by central differences of the double functions,
+		 * models built on the Mathematics functions should override these with the exact versions from DualMathematics.h
+		 */
+		virtual ResolutionDual ExpDual( double time, const ResolutionDual& gamma )
+		{
+			const double g = gamma.GetValue();
+			const double step = 1E-6 * ( fabs( g ) > 1. ? fabs( g ) : 1. );
+			const double dg = ( this->Exp( time, g+step ) - this->Exp( time, g-step ) ) / ( 2.*step );
+			return gamma.Chain( this->Exp( time, g ), dg );
+		}
+
+		virtual ResolutionDual ExpIntDual( double tlow, double thigh, const ResolutionDual& gamma )
+		{
+			const double g = gamma.GetValue();
+			const double step = 1E-6 * ( fabs( g ) > 1. ? fabs( g ) : 1. );
+			const double dg = ( this->ExpInt( tlow, thigh, g+step ) - this->ExpInt( tlow, thigh, g-step ) ) / ( 2.*step );
+			return gamma.Chain( this->ExpInt( tlow, thigh, g ), dg );
+		}
+
+		virtual ResolutionDual ExpCosDual( double time, const ResolutionDual& gamma, const ResolutionDual& dms )
+		{
+			return this->NumericalDual( &IResolutionModel::ExpCos, time, gamma, dms );
+		}
+
+		virtual ResolutionDual ExpSinDual( double time, const ResolutionDual& gamma, const ResolutionDual& dms )
+		{
+			return this->NumericalDual( &IResolutionModel::ExpSin, time, gamma, dms );
+		}
+#endif
+
 		virtual bool isPerEvent() = 0;
 
 		virtual ~IResolutionModel() {};
@@ -69,6 +146,29 @@ class IResolutionModel
 		virtual double GetFraction( unsigned int ) = 0;
 
 		IResolutionModel() {};
+
+#ifndef __CINT__
+	private:
+		/*!
+		 * @brief Chain rule through one of ExpCos or ExpSin using central differences in gamma and dms
+		 */
+		ResolutionDual NumericalDual( double (IResolutionModel::*function)( double, double, double ), double time, const ResolutionDual& gamma, const ResolutionDual& dms )
+		{
+			const double g = gamma.GetValue();
+			const double m = dms.GetValue();
+			const double g_step = 1E-6 * ( fabs( g ) > 1. ? fabs( g ) : 1. );
+			const double m_step = 1E-6 * ( fabs( m ) > 1. ? fabs( m ) : 1. );
+			const double dg = ( (this->*function)( time, g+g_step, m ) - (this->*function)( time, g-g_step, m ) ) / ( 2.*g_step );
+			const double dm = ( (this->*function)( time, g, m+m_step ) - (this->*function)( time, g, m-m_step ) ) / ( 2.*m_step );
+
+			ResolutionDual returnable( (this->*function)( time, g, m ) );
+			for( unsigned int i=0; i< ResolutionDual::Size(); ++i )
+			{
+				returnable.SetDerivative( i, dg * gamma.GetDerivative( i ) + dm * dms.GetDerivative( i ) );
+			}
+			return returnable;
+		}
+#endif
 };
 
 #ifndef __CINT__
@@ -0,0 +1,270 @@
+/*!
+ * @class IntegrationGrid
+ *
+ * @brief Persistent quasi-random grid used by RapidFitIntegrator::PseudoRandomNumberIntegralThreaded
+ *
+ * The Niederreiter points are generated once and stored as one flat array per integrated Observable, on the unit interval.
+ * They are turned into DataPoints once, and these are split into contiguous slices, one per thread, each with its own copy of the PDF.
+ *
+ * A normalisation request then only has to:
+ *
+ *	copy any non-integrated Observables which differ from the last request into the stored DataPoints
+ *	update the parameters of the PDF copies
+ *	evaluate each slice on the ThreadPool and sum the results
+ *
+ * The points are only rescaled when the integration ranges change. Asking for more points extends the sequence, the existing points are kept.
+ *
+ * Every integral also gets an error estimate for free: the first half of a Niederreiter sequence is itself a good sequence,
+ * so the difference between the sums over the first N/2 and over all N points estimates the error of the integral.
+ *
+ * With a target precision the number of points is doubled, evaluating only the new points, until this estimate is below the target
+ * or the maximum number of points is reached. The number of points needed is remembered for each discrete combination,
+ * and the next integral of that combination, normally at the next Minuit step, starts from there.
+ * The number of points of a combination only ever grows: a normalisation which jumped back and forth between
+ * precisions would make the NLL jump by far more than Minuit's steps change it.
+ * While the points are frozen, see SetFreezePoints, combinations which have been seen before use exactly as many points as last time.
+ *
+ * A proxy PDF with a known integral can be given as a control variate. The integral is then
+ *
+ *	I(f) = V < f - beta g > + beta I(g)
+ *
+ * with beta = cov(f,g)/var(g) from the same points. When g follows f closely the spread of f - beta g is much smaller than that of f,
+ * so far fewer points are needed for the same precision. The proxy is only evaluated again when the points change.
+ *
+ * For PDFs which are a bilinear form in complex amplitude terms, see IPDF::GetNumberAmplitudeTerms, the integrals of w a_i a_j* are stored instead.
+ * They are only calculated again when a parameter which isn't a coupling changes, otherwise the integral is a contraction with the couplings
+ * which costs nothing compared to evaluating the points.
+ *
+ * Each grid is for one PDF label, one layout of DataPoint and one set of integrated Observables.
+ * A grid is shared between all copies of the same PDF, Integrate holds a lock for the whole evaluation.
+ * Daughter PDFs have their own labels and so their own grids, which allows a PDF to integrate its daughters while being integrated.
+ */
+
+#pragma once
+#ifndef RAPIDFIT_INTEGRATION_GRID_H
+#define RAPIDFIT_INTEGRATION_GRID_H
+
+//	RapidFit Headers
+#include "IPDF.h"
+#include "DataPoint.h"
+#include "ComponentRef.h"
+#include "Threading.h"
+//	System Headers
+#include <vector>
+#include <string>
+#include <map>
+#include <complex>
+#include <pthread.h>
+
+//	Number of shape configurations and combinations whose amplitude integrals are kept
+#define RAPIDFIT_AMPLITUDE_CACHE_SIZE 32
+
+#ifdef __CINT__
+#undef __GNUC__
+#define _SYS__SELECT_H_
+struct pthread_mutex_t;
+#undef __SYS__SELECT_H_
+#define __GNUC__
+#endif
+
+using namespace::std;
+
+class IntegrationGrid
+{
+	public:
+		/*!
+		 * @brief Constructor, no points are generated until the first call to Integrate
+		 *
+		 * @param Label              Label of the PDF this grid is used for
+		 * @param templateDataPoint  DataPoint with the Observables the PDF expects, this is copied
+		 * @param doIntegrate        Names of the Observables to be integrated over
+		 */
+		IntegrationGrid( const string Label, const DataPoint* templateDataPoint, const vector<string> doIntegrate );
+
+		/*!
+		 * @brief Destructor, frees the points and the PDF copies
+		 */
+		~IntegrationGrid();
+
+		/*!
+		 * @brief Is this the grid for this PDF with DataPoints like this one, integrating over these Observables
+		 */
+		bool Matches( const string& Label, const DataPoint* templateDataPoint, const vector<string>& doIntegrate ) const;
+
+		/*!
+		 * @brief Integrate the PDF over the requested ranges with the non-integrated Observables taken from templateDataPoint
+		 *
+		 * @param functionToWrap     PDF to be integrated, this is not evaluated directly, only its parameters are used
+		 * @param templateDataPoint  DataPoint giving the values of the Observables which are not integrated
+		 * @param componentIndex     Component to be integrated, NULL for the whole PDF
+		 * @param minima, maxima     Range of each of the integrated Observables, in the order passed to the constructor
+		 * @param numberPoints       Number of quasi-random points to use, with a target precision this is the most that will be used
+		 * @param numberThreads      Number of slices the points are evaluated in
+		 * @param targetPrecision    Relative precision wanted, <= 0 to always use numberPoints
+		 * @param combination        Description of the discrete combination being integrated, the warm start is kept per combination
+		 * @param proxyPDF           PDF used as a control variate, NULL for none, its parameters are taken to be fixed
+		 * @param proxyIntegral      Integral of proxyPDF over exactly the same Observables and ranges
+		 *
+		 * @return the integral, or -99999. if RapidFit was built without GSL
+		 */
+		double Integrate( IPDF* functionToWrap, const DataPoint* templateDataPoint, ComponentRef* componentIndex,
+				const vector<double>& minima, const vector<double>& maxima, const unsigned int numberPoints, const unsigned int numberThreads,
+				const double targetPrecision=0., const string& combination="", IPDF* proxyPDF=NULL, const double proxyIntegral=0. );
+
+		/*!
+		 * @brief Print the precision achieved by the integrals since the last call, then reset the counters
+		 *
+		 * Nothing is printed if there have been no integrals
+		 */
+		void PrintPrecision();
+
+		/*!
+		 * @brief Stop the number of points of any combination integrated before from changing, e.g. while the Hessian is being evaluated
+		 *
+		 * This applies to all grids in this process
+		 */
+		static void SetFreezePoints( const bool freeze );
+
+	private:
+		//	Uncopyable!
+		IntegrationGrid( const IntegrationGrid& );
+		IntegrationGrid& operator= ( const IntegrationGrid& );
+
+		/*!
+		 * @brief Make sure there are at least numberPoints Niederreiter points and DataPoints, the existing points are kept
+		 */
+		void Generate( const unsigned int numberPoints );
+
+		/*!
+		 * @brief Set the integrated Observables of every DataPoint from the unit points and the given ranges
+		 */
+		void Rescale( const vector<double>& minima, const vector<double>& maxima );
+
+		/*!
+		 * @brief Set the integrated Observables of one DataPoint from the unit points and the current ranges
+		 */
+		void SetIntegrated( const unsigned int index );
+
+		/*!
+		 * @brief Copy the values of the non-integrated Observables into every DataPoint if they have changed
+		 */
+		void SyncTemplate( const DataPoint* templateDataPoint );
+
+		/*!
+		 * @brief Clear all of the per-event caches of a DataPoint, used whenever any of its values change
+		 */
+		static void ClearCaches( DataPoint* thisPoint );
+
+		/*!
+		 * @brief Make sure there is a copy of the PDF for each thread with the current parameters
+		 */
+		void SetupSlices( IPDF* functionToWrap, ComponentRef* componentIndex, const unsigned int numberThreads );
+
+		/*!
+		 * @brief Evaluate the points first to last-1 with the PDF copies in slices on the ThreadPool and store the results in values
+		 */
+		void EvaluateRange( Fitting_Thread* slices, const unsigned int first, const unsigned int last, vector<double>& values );
+
+		/*!
+		 * @brief Make sure there is a copy of the proxy PDF for each thread
+		 */
+		void SetupProxy( IPDF* proxyPDF );
+
+		/*!
+		 * @brief Delete the copies of the proxy PDF
+		 */
+		void RemoveProxy();
+
+		/*!
+		 * @brief Evaluate the proxy PDF on any of the first number points which it hasn't been evaluated on
+		 */
+		void EvaluateProxy( const unsigned int number );
+
+		/*!
+		 * @brief Control variate estimate of the integral from the first number points
+		 */
+		double ControlVariateEstimate( const unsigned int number, const double volume, const double proxyIntegral ) const;
+
+		/*!
+		 * @brief Integrate a PDF with amplitude terms by contracting the stored integrals of the terms, calculating these if the shape has changed
+		 */
+		double IntegrateAmplitudes( IPDF* functionToWrap, const DataPoint* templateDataPoint, const vector<double>& minima, const vector<double>& maxima,
+				const unsigned int numberPoints, const unsigned int numberThreads, const double volume );
+
+		/*!
+		 * @brief Add the sums of w a_i a_j* over the points first to last-1 to sum
+		 *
+		 * @return the number of points included
+		 */
+		double SumAmplitudeTerms( const unsigned int first, const unsigned int last, const unsigned int nTerms, vector<complex<double> >& sum );
+
+		/*!
+		 * @brief Sum w a_i a_j* over the points in one slice, this is run on the ThreadPool
+		 */
+		static void* AmplitudeTerms_pthread( void* input_data );
+
+		/*!
+		 * @brief Stored integrals of the amplitude terms for one set of shape parameters and one set of points
+		 */
+		struct AmplitudeIntegrals
+		{
+			vector<double> pointKey;		/*!	Non-integrated values, ranges and number of points	*/
+			vector<double> shapeKey;		/*!	Values of the parameters which aren't couplings		*/
+			vector<complex<double> > all;		/*!	Integrals from all of the points			*/
+			vector<complex<double> > half;		/*!	Integrals from the first half, for the error estimate	*/
+		};
+
+		/*!
+		 * @brief Sum of the finite values of the first number points, in order
+		 *
+		 * @param number_good   Set to the number of points which were included
+		 */
+		double SumPoints( const unsigned int number, double& number_good ) const;
+
+		/*!
+		 * @brief Evaluate all of the points in one slice, this is run on the ThreadPool
+		 */
+		static void* Evaluate_pthread( void* input_data );
+
+		DataPoint* templatePoint;			/*!	Copy of the DataPoint the grid was made for		*/
+		vector<string> integrateNames;			/*!	Observables integrated over				*/
+		vector<unsigned int> integrateIndex;		/*!	Position of each integrated Observable in the DataPoints	*/
+		vector<unsigned int> otherIndex;		/*!	Position of each Observable which isn't integrated	*/
+		vector<double> otherValues;			/*!	Values of these Observables currently in the DataPoints	*/
+
+		vector<vector<double> > unitPoints;		/*!	Niederreiter points on [0,1), one array per integrated Observable	*/
+		vector<double> currentMinima;			/*!	Ranges the DataPoints currently correspond to		*/
+		vector<double> currentMaxima;
+		vector<DataPoint*> allPoints;			/*!	One DataPoint per quasi-random point			*/
+
+		vector<double> pointValues;			/*!	Value of the PDF at each point, for the current Integrate only	*/
+
+		Fitting_Thread* sliceData;			/*!	Per-thread slice of allPoints and copy of the PDF	*/
+		unsigned int numberSlices;
+		unsigned int sliceFirst;			/*!	Range of allPoints the slices currently cover		*/
+		unsigned int sliceLast;
+
+		vector<double> proxyValues;			/*!	Value of the proxy PDF at each point			*/
+		unsigned int proxyPoints;			/*!	Number of points proxyValues is valid for		*/
+		Fitting_Thread* proxySliceData;			/*!	Per-thread copy of the proxy PDF			*/
+		string proxyLabel;				/*!	Label of the proxy PDF the copies were made from	*/
+
+		vector<string> amplitudeShapeNames;		/*!	Parameters of the PDF which aren't amplitude couplings	*/
+		vector<AmplitudeIntegrals> amplitudeCaches;	/*!	Most recent amplitude integrals, oldest first		*/
+
+		string gridLabel;				/*!	Label of the PDF this grid is for			*/
+
+		map<string,unsigned int> warmStart;		/*!	Number of points to start with for each discrete combination	*/
+		static bool freezePoints;			/*!	See SetFreezePoints						*/
+
+		unsigned int numberIntegrals;			/*!	Integrals since the last PrintPrecision			*/
+		unsigned int numberNotConverged;		/*!	How many of these stopped at the maximum number of points	*/
+		unsigned int mostPoints;			/*!	Most points used by one of these			*/
+		double worstPrecision;				/*!	Largest relative error estimate of these		*/
+		double sumPrecision;				/*!	Sum of the relative error estimates			*/
+
+		pthread_mutex_t grid_lock;			/*!	Held for the whole of Integrate				*/
+};
+
+#endif
+
@@ -3,10 +3,13 @@
 #ifndef MAKE_FOAM_H
 #define MAKE_FOAM_H
 
+//	ROOT Headers
+#include "TRandom3.h"
 //	RapidFit Headers
 #include "PhaseSpaceBoundary.h"
 
 #include <vector>
+#include <string>
 
 class IPDF;
 
@@ -22,6 +25,25 @@ class MakeFoam
 		void Debug();
 		double Integral();
 
+		/*!
+		 * @brief Split the phase space into cells over which the projections of the PDF onto each integrated Observable are roughly flat
+		 *
+		 * This is the cell building done by the constructor, AcceptReject also uses it to seed its envelope
+		 *
+		 * @param InputPDF       PDF to be explored
+		 * @param InputBoundary  Phase space to be split, this is copied
+		 * @param InputPoint     DataPoint giving the values of the Observables in dontIntegrate
+		 * @param doIntegrate    Continuous Observables the cells are split in
+		 * @param dontIntegrate  Observables kept at their values in InputPoint
+		 * @param samples        Number of PDF evaluations used to decide whether to split each cell
+		 * @param maximumCells   Most cells to make, any cells not yet examined when this is reached are kept as they are
+		 * @param random         Random numbers for the samples, NULL to use CreateObservable() with its own TRandom3(0)
+		 *
+		 * @return the cells, which belong to the caller
+		 */
+		static vector<PhaseSpaceBoundary*> MakeCells( IPDF* InputPDF, PhaseSpaceBoundary* InputBoundary, DataPoint* InputPoint, const vector<string>& doIntegrate,
+				const vector<string>& dontIntegrate, const int samples, const int maximumCells, TRandom3* random=NULL );
+
 	private:
 		//	Uncopyable!
 		MakeFoam& operator = ( const MakeFoam& );
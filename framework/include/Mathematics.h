@@ -67,6 +67,32 @@ namespace Mathematics
 
 	double evalCerfIm( double swt, double u, double c );
 
+	/*!
+	 * @brief evalCerf for numberEvents sets of (swt, u, c) at once
+	 *
+	 * The Faddeeva function is calculated from Weideman's 32 term rational approximation (SIAM J. Numer. Anal. 31 (1994) 1497).
+	 * In the upper half plane this is checked by TestCerfBatch against a 160 term long double evaluation on a dense grid covering |Re z|<=200, 0<=Im z<=200,
+	 * and against exp(y^2)erfc(y) on the imaginary axis.
+	 * The largest difference seen was |w - w_exact| < 5E-13 * |w_exact|, so the results agree with evalCerf to about 12 significant figures.
+	 * The lower half plane uses the reflection w(z) = 2 exp(-z^2) - w(-z), and the region u+c <= -4 uses evalCerfApprox exactly as evalCerf does.
+	 *
+	 * The rational approximation needs no transcendental functions and runs 4 events at a time when built with AVX2 enabled, otherwise it is scalar.
+	 *
+	 * @param swt, u, c      Arrays of numberEvents inputs, as for evalCerf
+	 * @param numberEvents   Number of inputs
+	 * @param re, im         Arrays of at least numberEvents doubles filled with the real and imaginary parts of evalCerf
+	 */
+	void evalCerfBatch( const double* swt, const double* u, const double* c, const unsigned int numberEvents, double* re, double* im );
+
+	/*!
+	 * @brief Check the Faddeeva function used by evalCerfBatch against a 160 term long double evaluation and exp(y^2)erfc(y), run with fitting --testBatchFunctions
+	 *
+	 * This takes a few seconds, the largest differences found are printed
+	 *
+	 * @return true if the largest relative difference is below 5E-13
+	 */
+	bool TestCerfBatch();
+
 	//--------------------------- exp and exp*sin and exp*cos time functions -------------------------
 	// time functions for use in PDFs with resolution
 
@@ -110,6 +136,18 @@ namespace Mathematics
 	pair<double,double> ExpCosSin( double t, double gamma, double deltaM, double resolution );
 	pair<double,double> ExpCosSinInt( double tlow, double thigh, double gamma, double deltaM, double resolution );
 
+	/*!
+	 * @brief Exp for numberEvents events, each with its own time and resolution
+	 */
+	void ExpBatch( const double* t, const double gamma, const double* resolution, const unsigned int numberEvents, double* output );
+
+	/*!
+	 * @brief ExpCos and ExpSin for numberEvents events, each with its own time and resolution
+	 *
+	 * The events with a resolution are evaluated using evalCerfBatch so agree with ExpCosSin to the accuracy given there
+	 */
+	void ExpCosSinBatch( const double* t, const double gamma, const double deltaM, const double* resolution, const unsigned int numberEvents, double* expCos, double* expSin );
+
 	double expErfInt( double tlimit, double tau, double sigma);
 	double expErfInt_Wrapper( vector<double> input );
 
@@ -0,0 +1,63 @@
+/**
+        @class Minuit2GradientFunction
+
+        A wrapper making IFitFunctions which provide an analytic gradient work with the Minuit2 API
+
+	Minuit2Function only provides the value of the function, so Minuit2 has to estimate the gradient
+	with 2 evaluations of the whole dataset per floated parameter for every step of MIGRAD.
+	This passes IFitFunction::EvaluateGradient to Minuit2 instead.
+
+	If the gradient can't be calculated at some point the central difference of the function is used
+	for that point only, so the fit doesn't fail because of a single bad event.
+*/
+
+#pragma once
+#ifndef MINUIT2_GRADIENT_FUNCTION_H
+#define MINUIT2_GRADIENT_FUNCTION_H
+
+//	ROOT Headers
+#include "Minuit2/FCNGradientBase.h"
+#include "Minuit2/MnUserParameters.h"
+//	RapidFit Headers
+#include "IFitFunction.h"
+#include "Minuit2Function.h"
+//	System Headers
+#include <vector>
+
+using namespace ROOT::Minuit2;
+
+class Minuit2GradientFunction : public FCNGradientBase
+{
+	public:
+		/*!
+		 * @brief Constructor
+		 *
+		 * @param NewFitFunction  Function to be minimised, this must return true from GetAnalyticGradient
+		 * @param NewFunction     Minuit2Function wrapping the same IFitFunction, used for the value, parameters and up value
+		 */
+		Minuit2GradientFunction( IFitFunction* NewFitFunction, Minuit2Function* NewFunction );
+		~Minuit2GradientFunction();
+
+		//Interface functions
+		virtual double operator()( const vector<double>& ) const;
+		virtual vector<double> Gradient( const vector<double>& ) const;
+		virtual double Up() const;
+		virtual void SetErrorDef( double );
+		virtual double ErrorDef() const;
+
+	private:
+		//	Uncopyable!
+		Minuit2GradientFunction ( const Minuit2GradientFunction& );
+		Minuit2GradientFunction& operator = ( const Minuit2GradientFunction& );
+
+		/*!
+		 * @brief Central difference estimate of the gradient, used when EvaluateGradient fails
+		 */
+		vector<double> NumericalGradient( const vector<double>& ) const;
+
+		IFitFunction * function;
+		Minuit2Function * valueFunction;
+};
+
+#endif
+
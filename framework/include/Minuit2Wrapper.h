@@ -14,6 +14,7 @@
 //	ROOT Headers
 #include "Minuit2/MnMigrad.h"
 #include "Minuit2Function.h"
+#include "Minuit2GradientFunction.h"
 #include "RapidFitMatrix.h"
 //	RapidFit Headers
 #include "IMinimiser.h"
@@ -57,6 +58,7 @@ class Minuit2Wrapper : public IMinimiser
 
 		//MnMigrad minuit;
 		Minuit2Function * function;
+		Minuit2GradientFunction * gradientFunction;	//	Only created if the IFitFunction provides an analytic gradient
 		FunctionMinimum* minimum;
 		IFitFunction* RapidFunction;
 		FitResult * fitResult;
@@ -66,6 +68,7 @@ class Minuit2Wrapper : public IMinimiser
                 vector<string> Options;
 		int Quality;
 		int nSigma;
+		RapidFitMatrix* parallelCovariance;	//	Only set if the errors of the last minimisation came from ParallelHessian
 
 };
 
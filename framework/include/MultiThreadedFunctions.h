@@ -8,6 +8,7 @@
 #include "DataPoint.h"
 #include "Threading.h"
 #include "ThreadingConfig.h"
+#include "ThreadPool.h"
 
 #include <stdio.h>
 #include <pthread.h>
@@ -34,6 +35,23 @@ class MultiThreadedFunctions
 		static vector<double>* ParallelIntegrate( IPDF* thisFunction, IDataSet* thesePoints, PhaseSpaceBoundary* thisBoundary, ThreadingConfig* threadingInfo );
 
 		static vector<double>* ParallelIntegrate( vector<IPDF*> thisFunction, vector<IDataSet*> thesePoints, vector<PhaseSpaceBoundary*> thisBoundary, ThreadingConfig* threadingInfo );
+
+		/*!
+		 * @brief Register a pool of persistent worker threads to be used in place of creating new threads on each call
+		 *
+		 * The pool is NOT owned by this class, the owner should call UnsetThreadPool before deleting it
+		 */
+		static void SetThreadPool( ThreadPool* thisPool );
+
+		/*!
+		 * @brief Stop using the given pool, this does nothing if a different pool has been registered since
+		 */
+		static void UnsetThreadPool( ThreadPool* thisPool );
+
+		/*!
+		 * @brief The pool registered with SetThreadPool, or NULL if there isn't one
+		 */
+		static ThreadPool* GetThreadPool();
 	private:
 
 		MultiThreadedFunctions();
@@ -43,20 +61,10 @@ class MultiThreadedFunctions
 
 		static vector<double>* ParallelEvaluate_pthreads( vector<IPDF*> thisFunction, vector<IDataSet*> thesePoints, unsigned int nThreads, ComponentRef* thisRef=NULL );
 
-                #ifndef __CINT__
-                        //      CINT behaves badly with this attribute
-                        //      and,
-                        //      g++ complains that this is a good place for it...
-                        //      let's keep em happy
-                        //
-			static void* Evaluate_pthread( void *input_data ) __attribute__ ((noreturn));
-			static void* EvaluateComponent_pthread( void *input_data ) __attribute__ ((noreturn));
-			static void* Integrate_pthread( void *input_data ) __attribute__ ((noreturn));
-		#else
-			static void* Evaluate_pthread( void *input_data );
-			static void* EvaluateComponent_pthread( void *input_data );
-			static void* Integrate_pthread( void *input_data );
-		#endif
+		//	These are run on the workers of a ThreadPool and so have to return rather than call pthread_exit
+		static void* Evaluate_pthread( void *input_data );
+		static void* EvaluateComponent_pthread( void *input_data );
+		static void* Integrate_pthread( void *input_data );
 
 		static Fitting_Thread* GetFittingThreadData( unsigned int nThreads );
 
@@ -64,11 +72,7 @@ class MultiThreadedFunctions
 
 		static unsigned int stored_thread_data_n;
 
-		static pthread_t* GetFittingThreads( unsigned int nThreads );
-
-		static pthread_t* Thread;
-
-		static unsigned int Threads_n;
+		static ThreadPool* stored_pool;
 
 		static vector<double>* ParallelIntegrate_pthreads( IPDF* thisFunction, IDataSet* thesePoints, PhaseSpaceBoundary* thisBoundary, unsigned int nThreads );
 
@@ -27,16 +27,8 @@ class NegativeLogLikelihoodNumerical : public FitFunction
 		virtual double EvaluateDataSet( IPDF*, IDataSet*, int );
 
 	private:
-		#ifndef __CINT__
-			//	CINT behaves badly with this attribute
-			//	and,
-			//	g++ complains that this is a good place for it...
-			//	let's keep em happy
-			//	
-			static void* ThreadWork( void* ) __attribute__ ((noreturn));
-		#else
-			static void* ThreadWork( void* );
-		#endif
+		//	This is run on the workers of the FitFunction ThreadPool and so has to return rather than call pthread_exit
+		static void* ThreadWork( void* );
 };
 
 #endif
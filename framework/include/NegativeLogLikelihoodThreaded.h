@@ -14,6 +14,7 @@
 //	RapidFit Headers
 #include "FitFunction.h"
 #include "Threading.h"
+#include "StreamingDataSet.h"
 
 class NegativeLogLikelihoodThreaded : public FitFunction
 {
@@ -26,17 +27,24 @@ class NegativeLogLikelihoodThreaded : public FitFunction
 	protected:
 		virtual double EvaluateDataSet( IPDF*, IDataSet*, int );
 
+		virtual bool ProvidesDataSetGradient() const;
+		virtual bool EvaluateDataSetGradient( IPDF*, IDataSet*, int, double* gradient );
+
 	private:
-		#ifndef __CINT__
-			//	CINT behaves badly with this attribute
-			//	and,
-			//	g++ complains that this is a good place for it...
-			//	let's keep em happy
-			//	
-			static void* ThreadWork( void* ) __attribute__ ((noreturn));
-		#else
-			static void* ThreadWork( void* );
-		#endif
+		//	This is run on the workers of the FitFunction ThreadPool and so has to return rather than call pthread_exit
+		static void* ThreadWork( void* );
+
+		//	As ThreadWork, but sums IPDF::EvaluateGradient over the events into gradient_Result
+		static void* GradientThreadWork( void* );
+
+		//	Point each of the Fitting_Thread objects at its part of this DataSet, DataSubSets has one range of events per thread
+		void SetupThreadData( IDataSet*, const vector<vector<DataPoint*> >& DataSubSets, int );
+
+		//	EvaluateDataSet for a DataSet which is read from disk, only the chunk being evaluated and the next one are held in memory
+		double EvaluateStreamedDataSet( StreamingDataSet*, int );
+
+		//	Subtract the gradient of the log-likelihood of the events in DataSubSets from gradient
+		bool AddDataSetGradient( IDataSet*, const vector<vector<DataPoint*> >& DataSubSets, int, double* gradient );
 
 };
 
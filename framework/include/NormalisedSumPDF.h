@@ -16,6 +16,7 @@
 #include "BasePDF.h"
 #include "RapidFitIntegrator.h"
 #include "ComponentRef.h"
+#include "ComponentValueCache.h"
 //	System Headers
 #include <vector>
 #include <string>
@@ -45,8 +46,18 @@ class NormalisedSumPDF : public BasePDF
 
 		//Return the function value at the given point
 		double Evaluate( DataPoint* );
+
+		//Return the function value for a whole block of events
+		//With CacheComponentValues:True the values of each daughter are kept per event until its parameters change
+		void EvaluateBatch( const EventBlock&, double* );
+		//As EvaluateBatch, but never through the per-event caches as the generators re-use their DataPoints
+		void EvaluateForNumericGenerationBatch( const EventBlock&, double* );
 		double EvaluateForNumericIntegral( DataPoint* );
 
+		//Analytic gradient, available when both daughters provide one
+		bool GetAnalyticGradient() const;
+		void EvaluateGradient( DataPoint*, PhaseSpaceBoundary*, const vector<string>&, double* );
+
 		//Set the function parameters
 		bool SetPhysicsParameters( ParameterSet* );
 
@@ -94,6 +105,9 @@ class NormalisedSumPDF : public BasePDF
 		double GetFirstIntegral( DataPoint* );
 		double GetSecondIntegral( DataPoint* );
 
+		void EvaluateBlock( const EventBlock& Input, double* out, const bool forGeneration );
+		void EvaluateDaughter( IPDF* thisPDF, ComponentValueCache& thisCache, const EventBlock& Input, double* out, const bool forGeneration );
+
 		vector<string> prototypeDataPoint, prototypeParameterSet, doNotIntegrateList;
 		IPDF * firstPDF;
 		IPDF * secondPDF;
@@ -102,6 +116,10 @@ class NormalisedSumPDF : public BasePDF
 		PhaseSpaceBoundary * integrationBoundary;
 
 		bool _plotComponents;
+		vector<double> batchBuffer;	//	Values of the second PDF when using EvaluateBatch
+		bool cacheComponents;		//	Store the values of each daughter between calls to EvaluateBatch
+		ComponentValueCache firstCache, secondCache;
+		vector<double> gradientBuffer;	//	Gradient of the second PDF when using EvaluateGradient
 };
 
 #endif
@@ -31,7 +31,10 @@ class Observable
 		 */
 		~Observable();
 
-		double GetValue() const;
+		double GetValue() const
+		{
+			return value;
+		}
 
 		string GetUnit() const;
 
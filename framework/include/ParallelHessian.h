@@ -0,0 +1,103 @@
+/*!
+ * @class ParallelHessian
+ *
+ * @brief Covariance matrix of the floated parameters from a numerical Hessian whose points are evaluated concurrently
+ *
+ * MnHesse evaluates the O(nPar^2) points of its stencil one after another, and each evaluation only threads over the events.
+ * Here whole evaluations of the function are run at the same time in forked worker processes, see ProcessPool.
+ * Each worker evaluates its points on its own clone of the function, see IFitFunction::Clone, and as the worker is a fork
+ * the clone has its own copy of the DataSets. Evaluating a PDF writes per-event state into the DataPoints, so clones
+ * sharing the DataSets of one process must never be evaluated at the same time.
+ *
+ * The Hessian H is found from central second differences about the minimum using
+ *
+ * H_ii = ( f(+i) + f(-i) - 2 f0 ) / h_i^2
+ * H_ij = ( f(+i+j) + f(-i-j) - f(+i) - f(-i) - f(+j) - f(-j) + 2 f0 ) / ( 2 h_i h_j )
+ *
+ * which needs 1 + nPar + nPar^2 evaluations, and the covariance matrix is 2 UP H^-1.
+ *
+ * The first differences of the same points give the gradient g, and so the estimated distance to the minimum
+ * EDM = g^T H^-1 g / 2 in the convention of Minuit2, which tells the caller whether the Hessian was taken at the minimum.
+ */
+
+#pragma once
+#ifndef RAPIDFIT_PARALLEL_HESSIAN_H
+#define RAPIDFIT_PARALLEL_HESSIAN_H
+
+//	RapidFit Headers
+#include "IFitFunction.h"
+#include "FitResult.h"
+#include "RapidFitMatrix.h"
+//	System Headers
+#include <vector>
+
+using namespace::std;
+
+class ParallelHessian
+{
+	public:
+		/*!
+		 * @brief Calculate the covariance matrix of a function about its minimum
+		 *
+		 * @param thisFunction  Function which has been minimised, this is cloned but not evaluated
+		 * @param centre        Value of every parameter at the minimum, in the order of GetAllNames
+		 * @param errors        Estimated error of every parameter in the same order, the steps are a fraction of these
+		 * @param up            Rise in the function which defines the error, see IFitFunction::UpErrorValue
+		 * @param nWorkers      Number of worker processes evaluating at once, each clone evaluates with a single thread
+		 * @param edm           Set to the estimated distance to the minimum from the gradient at the centre
+		 *
+		 * @return the covariance of the parameters in GetAllFloatNames which belongs to the caller,
+		 *         NULL if a point couldn't be evaluated or the Hessian isn't positive definite
+		 */
+		static RapidFitMatrix* GetCovarianceMatrix( IFitFunction* thisFunction, const vector<double>& centre, const vector<double>& errors,
+				const double up, const unsigned int nWorkers, double& edm );
+
+	private:
+		/*!
+		 * @brief Points of the stencil and the function they are evaluated with, the workers each have their own copy
+		 */
+		struct HessianPoints
+		{
+			IFitFunction* original;			/*!	Function which has been minimised			*/
+			const vector<vector<double> >* allPoints;	/*!	Values of every parameter at each point, the centre first	*/
+			IFitFunction* workerFunction;		/*!	Clone made by the first task run in each process	*/
+			vector<double> values;			/*!	Value at each point, only filled in the parent		*/
+			vector<bool> found;			/*!	Whether each point was evaluated, only filled in the parent	*/
+		};
+
+		/*!
+		 * @brief Evaluate the function at one point of the stencil, this is run in the workers, see ProcessPool::FitTask
+		 *
+		 * @return one FitResult holding the value as its minimum, or nothing if the function couldn't be evaluated
+		 */
+		static vector<FitResult*> EvaluatePoint( void* input, const unsigned int index, const FitResult* seed );
+
+		/*!
+		 * @brief Store the value of one point in the parent, see ProcessPool::ResultHandler
+		 */
+		static void StorePoint( void* input, const unsigned int index, vector<FitResult*> theseResults, const double realTime, const double cpuTime );
+
+		/*!
+		 * @brief Evaluate a function with its parameters set to one point
+		 *
+		 * @return the value, or DBL_MAX if the function couldn't be evaluated
+		 */
+		static double EvaluateAt( IFitFunction* thisFunction, const vector<double>& thisPoint );
+
+		/*!
+		 * @brief Invert a symmetric positive definite matrix in place through its Cholesky decomposition
+		 *
+		 * @param matrix  Matrix stored row by row
+		 *
+		 * @return false if the matrix isn't positive definite
+		 */
+		static bool InvertPositiveDefinite( vector<double>& matrix, const unsigned int size );
+
+		/*!
+		 * Don't Construct this class, it's simply a collection of static methods
+		 */
+		ParallelHessian();
+};
+
+#endif
+
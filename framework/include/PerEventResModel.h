@@ -54,6 +54,16 @@ class PerEventResModel : public IResolutionModel
 		pair<double,double> ExpCosSin( double time, double gamma, double dms );
 		pair<double,double> ExpCosSinInt( double tlow, double thigh, double gamma, double dms );
 
+		void ExpBatch( const EventBlock& Input, const double* time, double gamma, double* output );
+		void ExpCosSinBatch( const EventBlock& Input, const double* time, double gamma, double dms, double* expCos, double* expSin );
+
+#ifndef __CINT__
+		ResolutionDual ExpDual( double time, const ResolutionDual& gamma );
+		ResolutionDual ExpIntDual( double tlow, double thigh, const ResolutionDual& gamma );
+		ResolutionDual ExpCosDual( double time, const ResolutionDual& gamma, const ResolutionDual& dms );
+		ResolutionDual ExpSinDual( double time, const ResolutionDual& gamma, const ResolutionDual& dms );
+#endif
+
 		bool isPerEvent() ;
 
 		//Wrappers
@@ -79,6 +89,13 @@ class PerEventResModel : public IResolutionModel
 
 		ObservableRef eventResolutionName;  // Event-by-event resolution observable
 		double eventResolution ;
+		size_t slotLayoutID;			// DataPoint layout eventResolutionSlot was found for
+		int eventResolutionSlot;		// slot of the event resolution in DataPoints with this layout
+		inline double GetEventResolution( DataPoint* measurement );
+
+		//	Fill eventResolutions with the scaled resolution of each event in the block
+		void FillEventResolutions( const EventBlock& Input );
+		vector<double> eventResolutions;	// scaled per-event resolutions for the batch functions
 
 		unsigned int numberComponents;
 
@@ -0,0 +1,128 @@
+/*!
+ * @class ProcessPool
+ *
+ * @brief Runs a list of independent fits in forked worker processes and hands the FitResults back to the parent
+ *
+ * Each worker is a fork of the calling process, so it starts with all of the data, PDFs and parameters already in memory
+ * and with the same number of fitting threads as the parent would use. Every fit then has its own copy of everything
+ * and nothing has to be made thread safe.
+ *
+ * The parent sends each worker the number of one task at a time through a pipe, so a slow fit never holds up the others.
+ * The task can come with a seed FitResult chosen by the parent from the results so far, e.g. to start a fit from a neighbouring one.
+ * Which results have arrived when a task is sent depends on the scheduling, so a seed chosen from them can change with the number of workers.
+ * A caller which wants the same results for any number of workers should only seed from tasks of an earlier Run, as ScanStudies does.
+ * When a worker finishes a task it sends back the packed FitResults of the task, see FitResult::Pack, and is given the next task.
+ * Results are passed to the handler as soon as they arrive, which is not necessarily in task order.
+ *
+ * If a worker dies the task it was running is reported with no results and a new worker is forked for the remaining tasks.
+ * If no worker can be forked the tasks are run in the calling process.
+ */
+
+#pragma once
+#ifndef RAPIDFIT_PROCESS_POOL_H
+#define RAPIDFIT_PROCESS_POOL_H
+
+//	RapidFit Headers
+#include "FitResult.h"
+//	System Headers
+#include <vector>
+#include <sys/types.h>
+
+using namespace::std;
+
+class ProcessPool
+{
+	public:
+		/*!
+		 * @brief Signature of the tasks run by the workers, this is given the task data, the task number and the seed for the task or NULL
+		 *
+		 * @return the FitResults of this task, e.g. several fits to one toy, which are deleted once they have been sent to the parent
+		 */
+		typedef vector<FitResult*> (*FitTask)( void* input, const unsigned int index, const FitResult* seed );
+
+		/*!
+		 * @brief Signature of the function which picks the seed for a task in the parent, this is given the handler data and the task number
+		 *
+		 * @return a FitResult which still belongs to the caller, or NULL for no seed
+		 */
+		typedef const FitResult* (*SeedFunction)( void* input, const unsigned int index );
+
+		/*!
+		 * @brief Signature of the function which receives the results in the parent
+		 *
+		 * This is given the handler data, the task number, the FitResults which it now owns which are empty if the worker died,
+		 * and the real and CPU time the task took in the worker
+		 */
+		typedef void (*ResultHandler)( void* input, const unsigned int index, vector<FitResult*> theseResults, const double realTime, const double cpuTime );
+
+		/*!
+		 * @brief Run the tasks 0 to nTasks-1 in worker processes
+		 *
+		 * This returns once ALL of the results have been passed to the handler and all of the workers have exited
+		 *
+		 * @param thisTask     Function run by the workers for each task
+		 * @param taskData     Data passed to thisTask, the workers each have their own copy of everything this points to
+		 * @param nTasks       Number of tasks to run
+		 * @param handler      Function which is given each result in the parent as it arrives
+		 * @param handlerData  Data passed to handler and seeds
+		 * @param nWorkers     Number of worker processes, no more are started than there are tasks
+		 * @param seeds        Function called just before each task is sent to pick its seed, NULL for no seeds
+		 *
+		 * @return true if every task was run without a worker dying
+		 */
+		static bool Run( FitTask thisTask, void* taskData, const unsigned int nTasks, ResultHandler handler, void* handlerData, const unsigned int nWorkers,
+				SeedFunction seeds=NULL );
+
+	private:
+		/*!
+		 * @brief The parent's view of one worker process
+		 */
+		struct Worker
+		{
+			pid_t pid;		/*!	Process ID of the worker, -1 if it isn't running	*/
+			int taskPipe;		/*!	Write end of the pipe the tasks are sent down		*/
+			int resultPipe;		/*!	Read end of the pipe the results come back up		*/
+			int currentTask;	/*!	Task the worker is running, -1 if none			*/
+		};
+
+		/*!
+		 * @brief Fork a new worker into this slot, the pipes of all of the other workers are closed in the child
+		 *
+		 * @return true if the worker was started
+		 */
+		static bool StartWorker( vector<Worker>& allWorkers, const unsigned int slot, FitTask thisTask, void* taskData );
+
+		/*!
+		 * @brief Send a task and its seed to a worker
+		 *
+		 * @return false if the worker can't be reached
+		 */
+		static bool SendTask( Worker& thisWorker, const unsigned int index, const FitResult* seed );
+
+		/*!
+		 * @brief Wait for the worker to exit and close its pipes
+		 */
+		static void StopWorker( Worker& thisWorker );
+
+		/*!
+		 * @brief Main loop of a worker, this runs the tasks sent by the parent until the task pipe is closed and never returns
+		 */
+		static void WorkerLoop( FitTask thisTask, void* taskData, const int taskPipe, const int resultPipe );
+
+		/*!
+		 * @brief Read exactly this many bytes from a pipe
+		 *
+		 * @return false if the pipe was closed or failed first
+		 */
+		static bool ReadAll( const int fileDescriptor, void* output, const size_t bytes );
+
+		/*!
+		 * @brief Write all of these bytes to a pipe
+		 *
+		 * @return false if the pipe was closed or failed first
+		 */
+		static bool WriteAll( const int fileDescriptor, const void* input, const size_t bytes );
+};
+
+#endif
+
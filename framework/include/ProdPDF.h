@@ -68,6 +68,22 @@ class ProdPDF : public BasePDF
 
 		//Return the function value at the given point
 		double Evaluate( DataPoint* );
+
+		/*!
+		 * @brief Evaluate both daughter PDFs over the whole block and multiply them
+		 */
+		void EvaluateBatch( const EventBlock&, double* );
+
+		/*!
+		 * @brief Evaluate both daughter PDFs over the whole block for generation and multiply them
+		 */
+		void EvaluateForNumericGenerationBatch( const EventBlock&, double* );
+
+		/*!
+		 * @brief The normalisation is the product of the daughter integrals, so the gradient is the sum of the daughter gradients
+		 */
+		bool GetAnalyticGradient() const;
+		void EvaluateGradient( DataPoint*, PhaseSpaceBoundary*, const vector<string>&, double* );
 		double EvaluateForNumericIntegral( DataPoint* );
 
 		//Return a prototype data point
@@ -122,6 +138,8 @@ class ProdPDF : public BasePDF
 		IPDF * secondPDF;
 
 		bool _plotComponents;
+		vector<double> batchBuffer;	/*!	Values of the second PDF when using EvaluateBatch	*/
+		vector<double> gradientBuffer;	/*!	Gradient of the second PDF when using EvaluateGradient	*/
 };
 
 #endif
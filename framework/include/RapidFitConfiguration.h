@@ -32,6 +32,8 @@ class RapidFitConfiguration
 		//Variables to store command line arguments
 		int numberRepeats;
 		unsigned int Nuisencemodel;
+		unsigned int numberWorkers;
+		int threadsPerWorker;
 		int jobNum;
 		int nData;
 		int jackStartNum;
@@ -70,6 +72,7 @@ class RapidFitConfiguration
 		bool saveOneDataSetFlag;
 		bool saveOneFoamDataSetFlag;
 		bool testIntegratorFlag;
+		bool testBatchFunctionsFlag;
 		bool testComponentPlotFlag;
 		bool observableNameFlag;
 		bool doPlottingFlag;
@@ -92,6 +95,9 @@ class RapidFitConfiguration
 		bool FC_LL_PART_Flag;
 		bool GOF_Flag;
 		bool StartAtCenterFlag;
+		bool WarmStartScansFlag;
+		bool WarmStartScanErrorsFlag;
+		bool resumeFlag;
 		bool WeightDataSet;
 		bool OutputLevelSet;
 		bool saveFitXML;
@@ -29,14 +29,11 @@
 class IPDF;
 class FoamIntegrator;
 class IntegratorFunction;
+class IntegrationGrid;
 
 using namespace ROOT::Math;
 using namespace::std;
 
-static vector<DataPoint*> _global_doEval_points;
-static vector<double> _global_range_minima;
-static vector<double> _global_range_maxima;
-static vector<string> _global_observable_names;
 static string GSLvalidFor;
 
 class RapidFitIntegrator
@@ -94,6 +91,26 @@ class RapidFitIntegrator
 
 		void SetFixedIntegralPoints( const unsigned int input );
 
+		/*!
+		 * @brief Set the relative precision wanted from the GSL integral, <= 0 always uses the fixed number of points
+		 */
+		void SetIntegrationPrecision( const double input );
+
+		/*!
+		 * @brief Use a PDF with an analytic integral as a control variate for the GSL integral of the PDF being integrated
+		 *
+		 * Only the difference between the two PDFs is then integrated numerically, which needs far fewer points if they are similar.
+		 * The proxy must depend on the same Observables, its parameters are not changed during the fit.
+		 *
+		 * @param Input   Proxy PDF, a copy is taken. NULL removes the proxy
+		 */
+		void SetNormalisationProxy( const IPDF* Input );
+
+		/*!
+		 * @brief Get the proxy PDF used as a control variate, NULL if there isn't one
+		 */
+		IPDF* GetNormalisationProxy() const;
+
 		void SetNumThreads( const unsigned int input );
 
 		/*!
@@ -273,10 +290,15 @@ class RapidFitIntegrator
 		 */
 		vector<string> DontNumericallyIntegrateList( const DataPoint*, vector<string> = vector<string>() );
 
-		static vector<DataPoint*> getGSLIntegrationPoints( unsigned int number, vector<double> maxima, vector<double> minima, DataPoint* templateDataPoint, vector<string> doIntegrate,
-									PhaseSpaceBoundary* input );
-
+		/*!
+		 * @brief Delete all of the stored quasi-random integration grids, no integration may be running when this is called
+		 */
 		static void clearGSLIntegrationPoints();
+
+		/*!
+		 * @brief Print the precision reached by the GSL integrals of each PDF since the last call
+		 */
+		static void PrintIntegrationPrecision();
 	private:
 
 		/*!
@@ -315,7 +337,8 @@ class RapidFitIntegrator
 				vector<string> doIntegrate, vector<string> doNotIntegrate, unsigned int GSLFixedPoints=10000 );
 
 		static double PseudoRandomNumberIntegralThreaded( IPDF* functionToWrap, const DataPoint * NewDataPoint, const PhaseSpaceBoundary * NewBoundary, ComponentRef* componentIndex,
-				vector<string> doIntegrate, vector<string> doNotIntegrate, unsigned int num_threads=4, unsigned int GSLFixedPoints=10000 );
+				vector<string> doIntegrate, vector<string> doNotIntegrate, unsigned int num_threads=4, unsigned int GSLFixedPoints=10000, double GSLPrecision=0.,
+				IPDF* proxyPDF=NULL, double proxyIntegral=0. );
 
 		/*!
 		 * @brief This is the Interface to The MuliDimentional Integral class within ROOT
@@ -402,12 +425,24 @@ class RapidFitIntegrator
 
 		unsigned int GSLFixedPoints;
 
+		double GSLPrecision;
+
+		/*!
+		 * @brief Copy of the PDF used as a control variate for the GSL integral, may be NULL
+		 */
+		IPDF* normalisationProxy;
 
-		//static vector<double*> initGSLDataPoints( unsigned int number, vector<double> maxima, vector<double> minima );
+		/*!
+		 * @brief Can the proxy be used for these integrated Observables, it must have an analytic integral over exactly the same ones
+		 */
+		bool ProxyMatches( const PhaseSpaceBoundary* NewBoundary, const vector<string>& DontIntegrateThese, const vector<string>& doIntegrate ) const;
 
-		static vector<DataPoint*> initGSLDataPoints( unsigned int number, vector<double> maxima, vector<double> minima, DataPoint* thisDataPoint, vector<string> doIntegrate );
+		/*!
+		 * @brief Get the stored grid for this PDF, layout of DataPoint and integrated Observables, creating it if needed
+		 */
+		static IntegrationGrid* GetIntegrationGrid( IPDF* functionToWrap, const DataPoint* templateDataPoint, const vector<string>& doIntegrate );
 
-		static void ModifiyStoredPoints( DataPoint* NewDataPoint, string ProjectThis );
+		static vector<IntegrationGrid*> integrationGrids;	/*!	Quasi-random grids used by PseudoRandomNumberIntegralThreaded	*/
 
 		mutable RapidFitIntegratorConfig* _storedConfig;
 };
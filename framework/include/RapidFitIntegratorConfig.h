@@ -8,6 +8,8 @@
 #define __DEFAULT_RAPIDFIT_MAXINTEGRALSTEPS 1000000
 #define __DEFAULT_RAPIDFIT_INTABSTOL 1E-9
 #define __DEFAULT_RAPIDFIT_INTRELTOL 1E-9
+#define __DEFAULT_RAPIDFIT_INTEGRATIONPRECISION 0.
+#define __DEFAULT_RAPIDFIT_MININTEGRATIONPOINTS 1024
 
 #include "Threading.h"
 
@@ -19,7 +21,8 @@ class RapidFitIntegratorConfig
 		RapidFitIntegratorConfig() :
 			FixedIntegrationPoints( __DEFAULT_RAPIDFIT_FIXEDINTEGRATIONPOINTS ), useGSLIntegrator( __DEFAULT_RAPIDFIT_USEGSL ),
 			MaxIntegrationSteps( __DEFAULT_RAPIDFIT_MAXINTEGRALSTEPS ), IntegrationAbsTolerance( __DEFAULT_RAPIDFIT_INTABSTOL ),
-			IntegrationRelTolerance( __DEFAULT_RAPIDFIT_INTRELTOL ), numThreads( (unsigned)Threading::numCores() )
+			IntegrationRelTolerance( __DEFAULT_RAPIDFIT_INTRELTOL ), numThreads( (unsigned)Threading::numCores() ),
+			IntegrationPrecision( __DEFAULT_RAPIDFIT_INTEGRATIONPRECISION )
 		{
 		}
 
@@ -29,6 +32,7 @@ class RapidFitIntegratorConfig
 		double IntegrationAbsTolerance;
 		double IntegrationRelTolerance;
 		unsigned int numThreads;
+		double IntegrationPrecision;		/*!	Relative precision wanted from the GSL integral, FixedIntegrationPoints is then the most points used, 0 always uses FixedIntegrationPoints	*/
 };
 
 #endif
@@ -45,6 +45,7 @@ class ResultParameter
 		void ForcePullValue( double );
 		PhysicsParameter* GetDummyPhysicsParameter() const;
 		double GetStepSize() const;
+		void SetStepSize( double );
 		void SetScanStatus( bool );
 		bool GetScanStatus() const;
 
@@ -13,6 +13,9 @@
 #include "FitFunctionConfiguration.h"
 #include "ResultFormatter.h"
 #include "DebugClass.h"
+#include "PhysicsParameter.h"
+#include "ScanParam.h"
+#include "StudyJournal.h"
 //	System Headers
 #include <vector>
 #include <string>
@@ -74,8 +77,130 @@ class ScanStudies
 				const vector< PDFWithData* > inputPDFWithData, const vector< ConstraintFunction* > inputConstraints, OutputConfiguration* inputConfig,
 				const string param, const int output=-999, bool forceContinue=false );
 
+		/*!
+		 * @brief Fit the points of any following scans in forked worker processes, see ProcessPool
+		 *
+		 * The whole grid of a 2D scan is shared out between the workers, not just one row at a time.
+		 * The results are put back in grid order so the output is laid out exactly as for a scan in one process.
+		 *
+		 * @param numberWorkers     Number of worker processes, 1 fits every point in this process
+		 *
+		 * @param threadsPerWorker  Number of threads each worker fits with, 0 to keep the number from the XML
+		 */
+		static void SetWorkers( const unsigned int numberWorkers, const int threadsPerWorker=0 );
+
+		/*!
+		 * @brief Choose how the points of any following scans are started
+		 *
+		 * With a warm start the points are fitted outwards from the starting value of the scanned parameters, one ring of neighbours at a time,
+		 * and the floated parameters of each fit start from the result of the nearest point in an earlier ring which has converged.
+		 * If that fit fails it is retried from the XML starting values as before.
+		 * With worker processes every worker is kept busy, each point is seeded from the nearest point in an earlier ring
+		 * which has converged by the time it is started, and the first points start from the XML values, i.e. the central fit.
+		 * The seeds, and so possibly the results within the fit tolerance, then depend on the order the workers finish in.
+		 *
+		 * @param warmStart    Start each fit from the nearest converged point, false fits every point from the XML values in grid order
+		 *
+		 * @param seedErrors   Also use the errors of that point as the step sizes of the floated parameters, which Minuit starts its error matrix from
+		 */
+		static void SetWarmStart( const bool warmStart, const bool seedErrors=false );
+
 	private:
 
+		/*!
+		 * @brief Everything a worker needs to fit one point of a scan grid
+		 */
+		struct ScanGrid
+		{
+			MinimiserConfiguration* minimiser;
+			FitFunctionConfiguration* function;
+			ParameterSet* parameters;
+			vector<PDFWithData*> data;
+			vector<ConstraintFunction*> constraints;
+			string outerName;			/*!	Parameter of the outer loop of a 2D scan, empty for a 1D scan	*/
+			vector<double> outerValues;
+			string innerName;			/*!	Parameter which is stepped for every fit			*/
+			vector<double> innerValues;
+			double innerStep;			/*!	Step between the inner points, used to wiggle failed fits	*/
+			int outputLevel;
+			bool forceContinue;
+			vector<string> resultNames;		/*!	Names the FitResultVectors of a 2D scan are made with		*/
+			FitResultVector* output1D;		/*!	Where the results of a 1D scan go				*/
+			vector<FitResultVector*>* output2D;	/*!	Where the rows of a 2D scan go					*/
+			StudyJournal* journal;			/*!	Journal of the finished points, numbered in grid order		*/
+			vector<unsigned int> visitOrder;	/*!	Grid point fitted by each task, points in the journal are left out	*/
+			vector<int> gridRings;			/*!	Ring of each grid point, the number of grid steps from the centre	*/
+			vector<FitResult*> gridResults;		/*!	Results in grid order, NULL until the point has been fitted	*/
+			vector<double> realTimes;		/*!	Real time of each fit in grid order				*/
+			vector<double> cpuTimes;		/*!	CPU time of each fit in grid order				*/
+		};
+
+		/*!
+		 * @brief Find the parameter to be scanned and fix it, this exits if it can't be scanned
+		 */
+		static PhysicsParameter* FixScanParameter( ParameterSet*, const string, const double lolim, const double uplim, double& originalValue, string& originalType );
+
+		/*!
+		 * @brief Fit one point of a scan, retrying and wiggling the scanned parameter if the fit fails
+		 *
+		 * If seed isn't NULL the floated parameters start from its values, the first retry then starts from the values in the ParameterSet.
+		 * The floated parameters are always put back as they were
+		 */
+		static FitResult* FitScanPoint( MinimiserConfiguration*, FitFunctionConfiguration*, ParameterSet*, const vector< PDFWithData* >, const vector< ConstraintFunction* >,
+				const string scanName, const double scanVal, const double deltaScan, const FitResult* seed, const int, bool forceContinue );
+
+		/*!
+		 * @brief Start the floated parameters from the values, and if wanted the errors, of a converged fit
+		 */
+		static void SeedScanPoint( ParameterSet*, const vector<string>& floatedNames, const FitResult* seed );
+
+		/*!
+		 * @brief Result for a point whose worker died, this has the status and minimum of a failed fit
+		 */
+		static FitResult* FailedScanPoint( ParameterSet*, const string scanName, const double scanVal );
+
+		/*!
+		 * @brief Fit all of the scan points, in this process or in worker processes, and add the results to the output in grid order
+		 *
+		 * Points finished by an earlier run are taken from the journal and every new point is journalled as soon as it is fitted
+		 *
+		 * @param outerCentre  Value of the outer parameter the warm start works outwards from, unused for a 1D scan
+		 *
+		 * @param innerCentre  Value of the inner parameter the warm start works outwards from
+		 */
+		static void RunScanGrid( ScanGrid* thisGrid, const double outerCentre, const double innerCentre );
+
+		/*!
+		 * @brief Order the grid points which aren't in the journal so that they are fitted in rings moving out from the point closest to the centre
+		 *
+		 * Without a warm start every point is in ring 0 and they are fitted in grid order
+		 */
+		static void OrderScanGrid( ScanGrid* thisGrid, const double outerCentre, const double innerCentre );
+
+		/*!
+		 * @brief Fit task index of a ScanGrid starting from seed, this is run in the worker processes
+		 */
+		static vector<FitResult*> ScanPoint_task( void* input, const unsigned int index, const FitResult* seed );
+
+		/*!
+		 * @brief Find the converged result closest to the point of task index of a ScanGrid, this is run in the parent
+		 *
+		 * Only the rings before the ring of the point are looked at, these have always finished whatever the order the results arrive in
+		 *
+		 * @return the result, or NULL if no point in those rings has converged
+		 */
+		static const FitResult* ScanPoint_seed( void* input, const unsigned int index );
+
+		/*!
+		 * @brief Store and journal the result of task index of a ScanGrid, this is run in the parent
+		 */
+		static void ScanPoint_result( void* input, const unsigned int index, vector<FitResult*> theseResults, const double realTime, const double cpuTime );
+
+		static unsigned int scanWorkers;	/*!	Number of worker processes to fit the scan points in		*/
+		static int scanWorkerThreads;		/*!	Number of threads each worker fits with, 0 for the XML		*/
+		static bool scanWarmStart;		/*!	Start each point from the nearest converged point		*/
+		static bool scanSeedErrors;		/*!	Use the errors of that point as the initial step sizes		*/
+
 		static void DoScan( MinimiserConfiguration *, FitFunctionConfiguration *, ParameterSet*, const vector< PDFWithData* >,
 				const vector< ConstraintFunction* >, ScanParam*, FitResultVector*, const int, bool forceContinue=false );
 
@@ -0,0 +1,238 @@
+/*!
+ * @class StreamingDataSet
+ *
+ * @brief A DataSet which leaves the events in an event cache file on disk and reads them in fixed size chunks
+ *
+ * The file is one written by ColumnarDataSet::WriteCache. Only a few chunks are ever held in memory, each as a small ColumnarDataSet:
+ *
+ *	two chunks for streaming, so chunk k+1 can be read in the background with Prefetch while chunk k is being used
+ *	one chunk for GetDataPoint, which reads whichever chunk the requested event is in
+ *
+ * so the memory used is set by the chunk size rather than by the number of events.
+ *
+ * NegativeLogLikelihoodThreaded evaluates a StreamingDataSet one chunk at a time, splitting each chunk over its threads.
+ * Anything else sees an ordinary IDataSet, but going through all the events with GetDataPoint reads the whole file.
+ * GetDataPoint returns a copy of the event which the dataset keeps until it is destroyed, so any number of these can be held at once
+ * and from any thread, but every distinct event asked for this way costs a DataPoint. Loops over all events should use GetChunk.
+ *
+ * The events can't be changed: AddDataPoint and SortBy are not supported.
+ */
+
+#pragma once
+#ifndef STREAMING_DATA_SET_H
+#define STREAMING_DATA_SET_H
+
+//	RapidFit Headers
+#include "IDataSet.h"
+#include "ColumnarDataSet.h"
+#include "DataPoint.h"
+#include "PhaseSpaceBoundary.h"
+//	System Headers
+#include <vector>
+#include <string>
+#include <map>
+#include <pthread.h>
+
+#ifdef __CINT__
+#undef __GNUC__
+#define _SYS__SELECT_H_
+struct pthread_mutex_t;
+struct pthread_t;
+#undef __SYS__SELECT_H_
+#define __GNUC__
+#endif
+
+//	Default number of events read at a time
+#define RAPIDFIT_STREAMING_CHUNK_SIZE 262144
+
+using namespace::std;
+
+class StreamingDataSet : public IDataSet
+{
+	public:
+		/*!
+		 * @brief Open an event cache file for streaming
+		 *
+		 * @param path         Cache file written by ColumnarDataSet::WriteCache
+		 * @param key          Key the file should have been written for
+		 * @param NewBoundary  PhaseSpaceBoundary of the data, this is copied
+		 * @param ChunkSize    Number of events read at a time
+		 *
+		 * Only the header is checked here, the events are checked against their block checksums as each chunk is read
+		 *
+		 * @return the dataset, or NULL if the file is missing, is for a different key or version, or has a corrupt header
+		 */
+		static StreamingDataSet* Open( const string path, const string key, PhaseSpaceBoundary* NewBoundary, const unsigned int ChunkSize=RAPIDFIT_STREAMING_CHUNK_SIZE );
+
+		/*!
+		 * @brief Destructor, waits for any chunk being read and closes the file
+		 */
+		~StreamingDataSet();
+
+		/*!
+		 * @brief Get a copy of one event, made the first time this event is requested
+		 *
+		 * The pointer stays valid, and carries the current event weight, until this dataset is destroyed. This is thread safe
+		 */
+		virtual DataPoint * GetDataPoint( int );
+
+		//Interface functions
+		virtual bool AddDataPoint( DataPoint* );
+		virtual int GetDataNumber( DataPoint* templateDataPoint =NULL ) const;
+		virtual PhaseSpaceBoundary * GetBoundary() const;
+		virtual void SetBoundary( const PhaseSpaceBoundary* );
+
+		virtual void SortBy( string );
+
+		virtual IDataSet* GetDiscreteDataSet( const vector<ObservableRef> discreteParam, const vector<double> discreteVal ) const;
+
+		virtual vector<DataPoint> GetDiscreteSubSet( const vector<ObservableRef> discreteParam, const vector<double> discreteVal ) const;
+		virtual vector<DataPoint> GetDiscreteSubSet( const vector<string> discreteParam, const vector<double> discreteVal ) const;
+		virtual vector<DataPoint> GetDiscreteSubSet( DataPoint* input ) const;
+
+		virtual void Print();
+		virtual void PrintYield();
+
+		virtual double Yield();
+		virtual double YieldError();
+
+		virtual void UseEventWeights( const string Name );
+		virtual bool GetWeightsWereUsed() const;
+		virtual string GetWeightName() const;
+
+		virtual double GetSumWeights();
+		virtual double GetSumWeightsSq();
+		virtual void ApplyAlpha( const double, const double );
+		virtual double GetAlpha();
+		virtual void ApplyExternalAlpha( const string alphaName );
+		virtual void NormaliseWeights();
+
+		/*!
+		 * @brief Number of events read at a time
+		 */
+		unsigned int GetChunkSize() const;
+
+		/*!
+		 * @brief Number of chunks needed to hold all of the events
+		 */
+		unsigned int GetNumberChunks() const;
+
+		/*!
+		 * @brief Event number in the whole dataset of the first event in this chunk
+		 */
+		unsigned int GetChunkStart( const unsigned int chunk ) const;
+
+		/*!
+		 * @brief Start reading this chunk in the background, if it isn't already in memory
+		 *
+		 * This never replaces the chunk most recently returned by GetChunk
+		 */
+		void Prefetch( const unsigned int chunk );
+
+		/*!
+		 * @brief Get the events in this chunk, waiting for them if they are being prefetched or reading them now otherwise
+		 *
+		 * The events carry the current event weights. The dataset returned stays valid until the next call to GetChunk
+		 *
+		 * @warning Prefetch and GetChunk must only be called from one thread at a time
+		 */
+		ColumnarDataSet* GetChunk( const unsigned int chunk );
+
+		/*!
+		 * @brief Stored offset of the NLL of one chunk, NaN until one is set, see FitFunction::GetOffSetNLL
+		 *
+		 * The per-event initial NLL is lost whenever a chunk is read again so the offset is kept per chunk instead
+		 */
+		double GetChunkOffset( const unsigned int chunk ) const;
+		void SetChunkOffset( const unsigned int chunk, const double offset );
+
+	private:
+		//	Uncopyable!
+		StreamingDataSet( const StreamingDataSet& );
+		StreamingDataSet& operator = ( const StreamingDataSet& );
+
+		/*!
+		 * @brief Constructor, only used by Open once the file has been checked
+		 */
+		StreamingDataSet( const string path, const int fileDescriptor, const ColumnarDataSet::CacheLayout& layout, PhaseSpaceBoundary* NewBoundary, const unsigned int ChunkSize );
+
+		/*!
+		 * @brief One chunk held in memory
+		 */
+		struct ChunkBuffer
+		{
+			StreamingDataSet* owner;	/*!	Dataset this buffer belongs to				*/
+			ColumnarDataSet* data;		/*!	Events of the chunk					*/
+			int chunk;			/*!	Chunk held, -1 if none					*/
+			bool loading;			/*!	Is the chunk being read in the background		*/
+			pthread_t thread;		/*!	Thread reading the chunk				*/
+		};
+
+		/*!
+		 * @brief Read a chunk into a buffer and apply the current event weights
+		 */
+		void LoadChunk( ChunkBuffer* buffer, const unsigned int chunk ) const;
+
+		/*!
+		 * @brief Wait for any background read into this buffer to finish
+		 */
+		void WaitFor( ChunkBuffer* buffer );
+
+		/*!
+		 * @brief Wait for both streaming buffers to finish any background reads
+		 */
+		void FinishPrefetch();
+
+		/*!
+		 * @brief Apply the current event weights to the events in a buffer
+		 */
+		void ApplyWeights( ColumnarDataSet* data ) const;
+
+		/*!
+		 * @brief Apply the current event weights to every buffer which holds a chunk
+		 */
+		void ReweightBuffers();
+
+		/*!
+		 * @brief Get a chunk into the buffer used for GetDataPoint and the whole dataset loops
+		 *
+		 * @warning access_lock must be held from before this is called until the returned dataset is no longer used
+		 */
+		ColumnarDataSet* GetAccessChunk( const unsigned int chunk ) const;
+
+		/*!
+		 * @brief Sum of the values of one Observable, and of their squares, over all events
+		 */
+		void SumColumn( const string Name, double& sum, double& sumSq ) const;
+
+		/*!
+		 * @brief Read a chunk in the background, this is run by pthread_create
+		 */
+		static void* LoadChunk_pthread( void* input_data );
+
+		string filePath;			/*!	Cache file the events are read from			*/
+		int cacheFile;				/*!	Open descriptor of the cache file			*/
+		ColumnarDataSet::CacheLayout cacheLayout;	/*!	Layout of the columns in the cache file		*/
+
+		PhaseSpaceBoundary* dataBoundary;	/*!	PhaseSpace this data lies within			*/
+		unsigned int numberEvents;		/*!	Number of events in the file				*/
+		unsigned int chunkSize;			/*!	Number of events read at a time				*/
+
+		ChunkBuffer streamBuffers[2];		/*!	Buffers for GetChunk and Prefetch			*/
+		int currentChunk;			/*!	Chunk most recently returned by GetChunk, -1 if none	*/
+
+		mutable ChunkBuffer accessBuffer;	/*!	Buffer for GetDataPoint and the whole dataset loops	*/
+		mutable pthread_mutex_t access_lock;	/*!	Protects accessBuffer, handedOut and discreteNumbers	*/
+		mutable map<int,DataPoint*> handedOut;	/*!	Copies of the events returned by GetDataPoint, owned by this object	*/
+		mutable map<string,int> discreteNumbers;	/*!	Number of events in each discrete combination	*/
+
+		vector<double> chunkOffsets;		/*!	NLL offset of each chunk				*/
+
+		bool useWeights;
+		string WeightName;
+		double alpha;
+		string alphaName;
+};
+
+#endif
+
@@ -0,0 +1,127 @@
+/*!
+ * @class StudyJournal
+ *
+ * @brief Journal of the finished steps of a study, written as each step finishes so a study which is stopped can be resumed with --resume
+ *
+ * A step is one toy, scan point or MC step, numbered within a block such as an FC grid point.
+ * Each record holds the block and step, the seed the step was generated from, the real and CPU time it took and its packed
+ * FitResults, see FitResult::Pack. The file is flushed to disk after every record so at most the steps which were running are lost,
+ * and a record which was only partly written is dropped when the journal is read back.
+ *
+ * The header holds the study seed and a hash of the definition of the study: the XML, the parameters given on the command line
+ * and what the study itself says defines it, e.g. the range and number of points of a scan or the number of toys.
+ *
+ * Without --resume any old journal is replaced. With it the finished steps are read back so that only the others are run.
+ * RapidFit refuses to resume from a journal written with a different seed or definition, rather than mixing in the results of another study.
+ */
+
+#pragma once
+#ifndef RAPIDFIT_STUDY_JOURNAL_H
+#define RAPIDFIT_STUDY_JOURNAL_H
+
+//	RapidFit Headers
+#include "FitResult.h"
+//	System Headers
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+using namespace::std;
+
+class StudyJournal
+{
+	public:
+		/*!
+		 * @brief Choose whether the journals of any following studies are read back or started again
+		 */
+		static void SetResume( const bool resume );
+
+		/*!
+		 * @brief Set the part of the definition shared by all studies, this is hashed into the header of every journal
+		 *
+		 * @param xml                Lines of the XML file, see XMLConfigReader::GetXML
+		 * @param commandLineParams  Parameters given on the command line
+		 */
+		static void SetStudyConfiguration( const vector<string>& xml, const vector<string>& commandLineParams );
+
+		/*!
+		 * @brief Open the journal of a study, reading back the finished steps when resuming
+		 *
+		 * @param journalName  Name of the file, this should be unique to the study
+		 *
+		 * @param studySeed    Seed the steps of the study are generated from, 0 for a study which doesn't generate anything
+		 *
+		 * @param studyDefinition  Anything about this study which changes its steps and isn't in the XML, e.g. the number of toys
+		 */
+		StudyJournal( const string journalName, const unsigned int studySeed, const string studyDefinition );
+
+		/*!
+		 * @brief Destructor, this closes the file which is left on disk
+		 */
+		~StudyJournal();
+
+		/*!
+		 * @brief Has this step been finished by an earlier run
+		 */
+		bool IsFinished( const unsigned int block, const unsigned int step ) const;
+
+		/*!
+		 * @brief Get the results of a step finished by an earlier run
+		 *
+		 * @return new copies of the FitResults which belong to the caller, these only hold the fitted parameters as for FitResult::Unpack
+		 */
+		vector<FitResult*> GetResults( const unsigned int block, const unsigned int step, double& realTime, double& cpuTime ) const;
+
+		/*!
+		 * @brief Append a finished step to the journal and flush it to disk
+		 */
+		void Record( const unsigned int block, const unsigned int step, const unsigned int seed, const vector<FitResult*>& theseResults,
+				const double realTime, const double cpuTime );
+
+		/*!
+		 * @brief Number of steps read back from an earlier run
+		 */
+		unsigned int NumberFinished() const;
+
+	private:
+		//	Uncopyable!
+		StudyJournal ( const StudyJournal& );
+		StudyJournal& operator = ( const StudyJournal& );
+
+		/*!
+		 * @brief One finished step as read back from the journal
+		 */
+		struct JournalEntry
+		{
+			unsigned int seed;
+			double realTime;
+			double cpuTime;
+			vector<string> packedResults;
+		};
+
+		/*!
+		 * @brief Read the finished steps and drop anything after the last complete record
+		 *
+		 * This exits if the journal belongs to a different study seed or definition
+		 *
+		 * @return false if the file doesn't exist or isn't a journal
+		 */
+		bool ReadJournal( const unsigned int studySeed, const uint64_t definitionHash );
+
+		/*!
+		 * @brief 64 bit FNV-1a hash of the study configuration followed by this study definition
+		 */
+		static uint64_t HashDefinition( const string& studyDefinition );
+
+		string fileName;						/*!	Name of the journal file					*/
+		FILE* journalFile;						/*!	File the records are appended to, NULL if it couldn't be opened	*/
+		map<pair<unsigned int, unsigned int>, JournalEntry> finishedSteps;	/*!	Steps finished by earlier runs, by block and step		*/
+
+		static bool resumeStudies;					/*!	Read back the journals rather than starting them again		*/
+		static string studyConfiguration;				/*!	See SetStudyConfiguration					*/
+};
+
+#endif
+
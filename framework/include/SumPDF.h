@@ -14,6 +14,7 @@
 //	RapidFit Headers
 #include "IPDF.h"
 #include "BasePDF.h"
+#include "ComponentValueCache.h"
 //	System Headers
 #include <string>
 #include <vector>
@@ -91,6 +92,19 @@ class SumPDF : public BasePDF
 		 */
 		double Evaluate( DataPoint* );
 
+		/*!
+		 * @brief Evaluate both daughter PDFs over the whole block and combine them
+		 *
+		 * With the configuration parameter CacheComponentValues set to True the values of each daughter are stored per event
+		 * and re-used for as long as the parameters of that daughter are unchanged, see ComponentValueCache
+		 */
+		void EvaluateBatch( const EventBlock&, double* );
+
+		/*!
+		 * @brief As EvaluateBatch, but the daughters are never looked up in the CacheComponentValues caches as the DataPoints are re-used
+		 */
+		void EvaluateForNumericGenerationBatch( const EventBlock&, double* );
+
 		/*!
 		 * @brief Interface Function: Return a prototype data point
 		 *
@@ -211,6 +225,16 @@ class SumPDF : public BasePDF
 
 		void TurnThisCachingOff();
 
+		/*!
+		 * @brief Combine the daughters over the block, for EvaluateBatch or for EvaluateForNumericGenerationBatch
+		 */
+		void EvaluateBlock( const EventBlock& Input, double* out, const bool forGeneration );
+
+		/*!
+		 * @brief Evaluate one daughter over the block, through its cache if CacheComponentValues was requested and this isn't for generation
+		 */
+		void EvaluateDaughter( IPDF* thisPDF, ComponentValueCache& thisCache, const EventBlock& Input, double* out, const bool forGeneration );
+
 		vector<string> prototypeDataPoint, prototypeParameterSet, doNotIntegrateList;
 		IPDF * firstPDF;
 		IPDF * secondPDF;
@@ -218,6 +242,9 @@ class SumPDF : public BasePDF
 		string fractionName;
 		PhaseSpaceBoundary * integrationBoundary;
 		bool _plotComponents;
+		vector<double> batchBuffer;	/*!	Values of the second PDF when using EvaluateBatch	*/
+		bool cacheComponents;		/*!	Store the values of each daughter between calls to EvaluateBatch	*/
+		ComponentValueCache firstCache, secondCache;
 };
 
 #endif
@@ -0,0 +1,129 @@
+/*!
+ * @class ThreadPool
+ *
+ * @brief A fixed set of long-lived pthreads which are woken up to process a batch of Fitting_Thread objects
+ *
+ * Creating and joining a new set of threads for every call from Minuit costs a visible fraction of each call
+ * when the per-thread subsets are small. The workers here are created once and then sleep on a condition
+ * variable between calls to Execute.
+ *
+ * Execute blocks until every worker has finished with its Fitting_Thread object.
+ * If the pool is already busy (i.e. Execute is called from within one of the tasks it is running) the batch is
+ * run on freshly created threads instead so that nested parallel calls can never deadlock.
+ */
+
+#pragma once
+#ifndef RAPIDFIT_THREAD_POOL_H
+#define RAPIDFIT_THREAD_POOL_H
+
+//	RapidFit Headers
+#include "Threading.h"
+//	System Headers
+#include <pthread.h>
+#include <vector>
+
+#ifdef __CINT__
+#undef __GNUC__
+#define _SYS__SELECT_H_
+struct pthread_t;
+struct pthread_mutex_t;
+struct pthread_cond_t;
+#undef __SYS__SELECT_H_
+#define __GNUC__
+#endif
+
+using namespace::std;
+
+class ThreadPool;
+
+//	Information handed to each worker so it knows which Fitting_Thread object belongs to it
+struct ThreadPool_Worker{
+	explicit ThreadPool_Worker() : pool(NULL), index(0)
+	{}
+
+	ThreadPool* pool;		/*!	Pool which owns this worker				*/
+	unsigned int index;		/*!	Index of the Fitting_Thread this worker processes	*/
+};
+
+class ThreadPool
+{
+	public:
+		/*!
+		 * @brief Signature of the functions which can be run on the pool, the input is a pointer to a Fitting_Thread
+		 */
+		typedef void* (*ThreadTask)( void* );
+
+		/*!
+		 * @brief Constructor, this creates and starts all of the worker threads
+		 *
+		 * @param nThreads   Number of worker threads to keep alive for the lifetime of this object
+		 */
+		explicit ThreadPool( const unsigned int nThreads );
+
+		/*!
+		 * @brief Wakes up all of the workers, asks them to stop and joins them
+		 */
+		~ThreadPool();
+
+		/*!
+		 * @brief Number of worker threads in the pool
+		 */
+		unsigned int GetNumThreads() const;
+
+		/*!
+		 * @brief Run the task on each of the nTasks Fitting_Thread objects, one per worker
+		 *
+		 * This returns only once ALL of the tasks have finished
+		 *
+		 * @param thisTask   Function to be run by each worker, it must return rather than calling pthread_exit
+		 * @param data       Array of at least nTasks Fitting_Thread objects
+		 * @param nTasks     Number of tasks to run, if this is larger than the pool the work is run on transient threads
+		 */
+		void Execute( ThreadTask thisTask, Fitting_Thread* data, const unsigned int nTasks );
+
+		/*!
+		 * @brief Run the task on each of the nTasks Fitting_Thread objects using threads created and joined for this call only
+		 *
+		 * This is the old behaviour of RapidFit and is used when no pool is available
+		 */
+		static void ExecuteTransient( ThreadTask thisTask, Fitting_Thread* data, const unsigned int nTasks );
+
+		/*!
+		 * @brief Run the task on the pool if one is given and can hold all of the tasks, otherwise on transient threads
+		 */
+		static void Execute( ThreadPool* thisPool, ThreadTask thisTask, Fitting_Thread* data, const unsigned int nTasks );
+
+	private:
+		/*!
+		 * Don't Copy the class this way!
+		 */
+		ThreadPool( const ThreadPool& );
+
+		/*!
+		 * Don't Copy the class this way!
+		 */
+		ThreadPool& operator= ( const ThreadPool& );
+
+		/*!
+		 * @brief Main loop of each worker thread, this sleeps until there is a new batch of work or the pool is being destroyed
+		 */
+		static void* WorkerLoop( void* input );
+
+		vector<pthread_t> workers;		/*!	The worker threads				*/
+		vector<ThreadPool_Worker> worker_info;	/*!	Per-worker information passed to WorkerLoop	*/
+
+		pthread_mutex_t submit_lock;		/*!	Held for the duration of each call to Execute	*/
+		pthread_mutex_t pool_lock;		/*!	Protects all of the state below			*/
+		pthread_cond_t work_ready;		/*!	Signalled when a new batch has been submitted	*/
+		pthread_cond_t work_done;		/*!	Signalled when the last task of a batch is done	*/
+
+		ThreadTask current_task;		/*!	Task for the present batch			*/
+		Fitting_Thread* current_data;		/*!	Data for the present batch			*/
+		unsigned int current_n;			/*!	Number of tasks in the present batch		*/
+		unsigned long generation;		/*!	Incremented once per batch			*/
+		unsigned int pending;			/*!	Number of tasks still running in this batch	*/
+		bool shutdown;				/*!	Set when the workers should exit		*/
+};
+
+#endif
+
@@ -21,17 +21,27 @@ class IDataSet;
 struct Fitting_Thread{
 	explicit Fitting_Thread() :
 		dataSubSet(), fittingPDF(NULL), useWeights(false), dataPoint_Result(), FitBoundary(NULL),
-		stored_integral(0.), weightsSquared(false), dataSet(NULL), thisComponent(NULL)
+		stored_integral(0.), weightsSquared(false), dataSet(NULL), firstEvent(0), numberEvents(0), blockPoints(), gradientNames(NULL), gradient_Result(), thisComponent(NULL)
 	{}
 
+	~Fitting_Thread()
+	{
+		while( !blockPoints.empty() ) { delete blockPoints.back(); blockPoints.pop_back(); }
+	}
+
 	vector<DataPoint*> dataSubSet;		/*!	DataPoints to be evaluated by this thread		*/
 	IDataSet* dataSet;			/*!	DataSet containtaining the DataPoints			*/
+	unsigned int firstEvent;		/*!	Index in dataSet of the first entry in dataSubSet	*/
+	unsigned int numberEvents;		/*!	Number of events from firstEvent when dataSubSet is empty and dataSet is a ColumnarDataSet	*/
+	vector<DataPoint*> blockPoints;		/*!	DataPoints these events are filled into a block at a time, owned by this object	*/
 	IPDF* fittingPDF;			/*!	Pointer to the PDF instance to be used by this thread	*/
 	bool useWeights;			/*!	Are we performing a weighted fit?			*/
 	vector<double> dataPoint_Result;	/*!	Result for evaluating each datapoint			*/
 	PhaseSpaceBoundary* FitBoundary;	/*!	PhaseSpaceBoundary containing all data			*/
 	double stored_integral;			/*!	Stored Integral for Numerical Integral fits		*/
 	bool weightsSquared;			/*!	Are we using Weight Squared?				*/
+	const vector<string>* gradientNames;	/*!	Parameters to differentiate with respect to		*/
+	vector<double> gradient_Result;		/*!	Gradient summed over dataSubSet, empty on failure	*/
 
 	ComponentRef* thisComponent;
 
@@ -49,6 +59,9 @@ class Threading
 		//	Split the data into subset(s) with a safe default
 		static vector<vector<DataPoint*> > divideData( IDataSet*, int=1 );
 
+		//	Number of events in each of the subsets divideData would make, without asking the DataSet for any DataPoints
+		static vector<unsigned int> divideEvents( const unsigned int numberEvents, int subsets=1 );
+
 		static vector<IDataSet*> divideDataSet( IDataSet* input, unsigned int subsets=1 );
 
 		//	Function to divide the data values used in the threaded GSL Norm function
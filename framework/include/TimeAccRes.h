@@ -57,6 +57,16 @@ class TimeAccRes : public IResolutionModel
 		pair<double, double> ExpCosSin( double time, double gamma, double dms );
 		pair<double, double> ExpCosSinInt( double tlow, double thigh, double gamma, double dms );
 
+		void ExpBatch( const EventBlock& Input, const double* time, double gamma, double* output );
+		void ExpCosSinBatch( const EventBlock& Input, const double* time, double gamma, double dms, double* expCos, double* expSin );
+
+#ifndef __CINT__
+		ResolutionDual ExpDual( double time, const ResolutionDual& gamma );
+		ResolutionDual ExpIntDual( double tlow, double thigh, const ResolutionDual& gamma );
+		ResolutionDual ExpCosDual( double time, const ResolutionDual& gamma, const ResolutionDual& dms );
+		ResolutionDual ExpSinDual( double time, const ResolutionDual& gamma, const ResolutionDual& dms );
+#endif
+
 		bool isPerEvent();
 
 		bool CacheValid() const;
@@ -0,0 +1,114 @@
+/*!
+ * @class ToyPipeline
+ *
+ * @brief Runs the toys of a study in forked worker processes, see ProcessPool, so generating one toy never waits for the fit to another
+ *
+ * Every worker generates and fits one toy at a time and is given the next toy as soon as it is done, so with K workers there are
+ * always K toys being generated or fitted and the next toys are queued in the parent.
+ *
+ * Each toy is generated from its own seed, made from the seed of the study and the number of the toy, so the result of a toy
+ * doesn't depend on how many workers there are or which of them ran it. The results are handed back in toy order.
+ *
+ * Each toy is written to the StudyJournal of the study as soon as it finishes, and toys already in the journal are not run again.
+ */
+
+#pragma once
+#ifndef RAPIDFIT_TOY_PIPELINE_H
+#define RAPIDFIT_TOY_PIPELINE_H
+
+//	RapidFit Headers
+#include "FitResult.h"
+#include "FitFunctionConfiguration.h"
+#include "StudyJournal.h"
+//	System Headers
+#include <vector>
+
+using namespace::std;
+
+class ToyPipeline
+{
+	public:
+		/*!
+		 * @brief Signature of the function which generates and fits one toy, this is given the study data and the number of the toy
+		 *
+		 * RapidFitRandom has already been seeded for this toy when it is called
+		 *
+		 * @return the FitResults of this toy, these are owned by the caller of Run
+		 */
+		typedef vector<FitResult*> (*ToyTask)( void* input, const unsigned int toyNumber );
+
+		/*!
+		 * @brief Run the toys of any following studies in worker processes
+		 *
+		 * @param numberWorkers     Number of worker processes, 1 runs every toy in this process
+		 *
+		 * @param threadsPerWorker  Number of threads each worker fits with, 0 to keep the number from the XML
+		 */
+		static void SetWorkers( const unsigned int numberWorkers, const int threadsPerWorker=0 );
+
+		/*!
+		 * @brief Seed the toys of a study are seeded from
+		 *
+		 * This is drawn from RapidFitRandom, so it follows the seed from the XML or the command line
+		 */
+		static unsigned int StudySeed();
+
+		/*!
+		 * @brief Seed of one toy of a study, this is never 0 which would seed TRandom3 from the clock
+		 */
+		static unsigned int ToySeed( const unsigned int studySeed, const unsigned int toyNumber );
+
+		/*!
+		 * @brief Generate and fit the toys firstToy to firstToy+numberToys-1
+		 *
+		 * @param thisTask    Function which generates and fits one toy
+		 * @param input       Data passed to thisTask, the workers each have their own copy of everything this points to
+		 * @param function    FitFunctionConfiguration of the fits, the number of threads is changed for the workers
+		 * @param studySeed   Seed of the study from StudySeed
+		 * @param firstToy    Number of the first toy to run
+		 * @param numberToys  Number of toys to run
+		 * @param realTimes   Filled with the real time each toy took
+		 * @param cpuTimes    Filled with the CPU time each toy took
+		 * @param journal     Journal of the study, NULL to not keep one
+		 * @param block       Block of the journal the toys are stored in
+		 *
+		 * @return the FitResults of each toy in toy order, these are empty if the worker running the toy died
+		 */
+		static vector<vector<FitResult*> > Run( ToyTask thisTask, void* input, FitFunctionConfiguration* function, const unsigned int studySeed,
+				const unsigned int firstToy, const unsigned int numberToys, vector<double>& realTimes, vector<double>& cpuTimes,
+				StudyJournal* journal=NULL, const unsigned int block=0 );
+
+	private:
+		/*!
+		 * @brief Everything needed to run and collect one call to Run
+		 */
+		struct ToyBatch
+		{
+			ToyTask task;
+			void* input;
+			unsigned int studySeed;
+			unsigned int firstToy;
+			vector<unsigned int> toysToRun;		/*!	Toys which aren't in the journal, relative to firstToy	*/
+			StudyJournal* journal;
+			unsigned int block;
+			vector<vector<FitResult*> >* results;
+			vector<double>* realTimes;
+			vector<double>* cpuTimes;
+		};
+
+		/*!
+		 * @brief Seed RapidFitRandom and run toy toysToRun[index] of a ToyBatch, this is run in the worker processes
+		 */
+		static vector<FitResult*> Toy_task( void* input, const unsigned int index, const FitResult* seed );
+
+		/*!
+		 * @brief Store and journal the results of toy toysToRun[index] of a ToyBatch, this is run in the parent
+		 */
+		static void Toy_result( void* input, const unsigned int index, vector<FitResult*> theseResults, const double realTime, const double cpuTime );
+
+		static unsigned int toyWorkers;		/*!	Number of worker processes to run the toys in		*/
+		static int toyWorkerThreads;		/*!	Number of threads each worker fits with, 0 for the XML	*/
+};
+
+#endif
+
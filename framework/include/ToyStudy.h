@@ -91,10 +91,18 @@ class ToyStudy	:	public IStudy
 		ToyStudy ( const ToyStudy& );
 		ToyStudy& operator = ( const ToyStudy& );
 
-		FitResult * GenerateAndMinimise();
+		/*!
+		 * @brief Generate and fit one toy, this is run by the ToyPipeline
+		 *
+		 * @param input  The ToyStudy
+		 *
+		 * @param toyNumber  Number of the toy, used to name the files when all toys are saved
+		 */
+		static vector<FitResult*> GenerateAndMinimise( void* input, const unsigned int toyNumber );
 
 		bool fixedNumToys;
 		bool saveAllToys;
+		int studyOutputLevel;
 };
 
 #endif
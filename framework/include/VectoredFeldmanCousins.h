@@ -100,6 +100,13 @@ class VectoredFeldmanCousins : public IStudy
 
 		ParameterSet* getParameterSet( ParameterSet* inputSet, ResultParameterSet* inputResult );
 
+		/*!
+		 * @brief Generate one toy at the current grid point and fit it with the control parameter(s) fixed and then free, this is run by the ToyPipeline
+		 *
+		 * @return the fit with the control parameter(s) fixed, followed by the fit with them free unless the first fit failed
+		 */
+		static vector<FitResult*> GenerateAndFitToy( void* input, const unsigned int toyNumber );
+
 		/*!
 		 * Internal Objects specific to the FC study
 		 */
@@ -119,6 +126,8 @@ class VectoredFeldmanCousins : public IStudy
 		vector<double> generate_n_events;
 		ParameterSet* ParameterSetWithFreeParameters;
 		ParameterSet* ParameterSetWithFixedParameters;;
+		FitResult* currentGridPoint;
+		int studyOutputLevel;
 };
 
 #endif
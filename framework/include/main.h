@@ -99,6 +99,8 @@ int saveOneDataSet( RapidFitConfiguration* config );
 
 int testIntegrator( RapidFitConfiguration* config );
 
+int testBatchFunctions();
+
 int testComponentPlot( RapidFitConfiguration* config );
 
 int calculateFitFractions( RapidFitConfiguration* config );
@@ -12,8 +12,13 @@
 #include "AcceptReject.h"
 #include "PhaseSpaceBoundary.h"
 #include "RapidFitRandom.h"
+#include "ClassLookUp.h"
+#include "Threading.h"
+#include "EventBlock.h"
+#include "MakeFoam.h"
 //	System Headers
 #include <iostream>
+#include <algorithm>
 #include <math.h>
 #include <float.h>
 
@@ -22,8 +27,12 @@
 
 //Constructor with correct argument
 AcceptReject::AcceptReject( PhaseSpaceBoundary * NewBoundary, IPDF * NewPDF ) : generationFunction(NewPDF),
-	generationBoundary(NewBoundary), dataNumber(0), newDataSet(), rootRandom(), moreThanMaximum(0.01), numberAttempts(0)
+	generationBoundary(NewBoundary), dataNumber(0), newDataSet(), rootRandom(), moreThanMaximum(0.01), numberAttempts(0),
+	numberThreads(1), numberStreams(0), blockSize(RAPIDFIT_GENERATION_BLOCK_SIZE), allNames(), allUnits(), discreteValues(),
+	useEnvelope(true), envelopeBuilt(false), cellMinima(), cellRanges(), cellVolumes(), cellBounds(), cellIntegrals(), cellIntegralErrors()
 {
+	const int cores = Threading::numCores();
+	if( cores > 1 ) numberThreads = (unsigned) cores;
 	newDataSet = new MemoryDataSet(generationBoundary);
 	rootRandom = RapidFitRandom::GetRandomFunction();
 }
@@ -40,78 +49,568 @@ AcceptReject::~AcceptReject()
 //Use accept/reject method to create data
 int AcceptReject::GenerateData( int DataAmount )
 {
-	int numberAccepted = 0;
-	vector<string> allNames = generationBoundary->GetAllNames();
-	vector<string>::iterator nameIterator;
+	if( DataAmount <= 0 ) return dataNumber;
+
+	allNames = generationBoundary->GetAllNames();
+	allUnits.clear();
+	discreteValues.clear();
+	for( unsigned int j=0; j< allNames.size(); ++j )
+	{
+		IConstraint* thisConstraint = generationBoundary->GetConstraint( allNames[j] );
+		allUnits.push_back( thisConstraint->GetUnit() );
+		discreteValues.push_back( thisConstraint->IsDiscrete() ? thisConstraint->GetValues() : vector<double>() );
+	}
+	const unsigned int nObs = (unsigned) allNames.size();
+
+	this->SetupCells( DataAmount );
+
+	//	The number of streams mustn't depend on the machine, or neither would the events
+	unsigned int nStreams = numberStreams;
+	if( nStreams == 0 )
+	{
+		nStreams = (unsigned) DataAmount / RAPIDFIT_GENERATION_EVENTS_PER_STREAM;
+		if( nStreams > RAPIDFIT_GENERATION_MAXIMUM_STREAMS ) nStreams = RAPIDFIT_GENERATION_MAXIMUM_STREAMS;
+		if( nStreams == 0 ) nStreams = 1;
+	}
+	const unsigned int nThreads = numberThreads < nStreams ? numberThreads : nStreams;
+
+	AcceptReject_Thread* streams = new AcceptReject_Thread[ nStreams ];
+	for( unsigned int i=0; i< nStreams; ++i )
+	{
+		streams[i].generator = this;
+		streams[i].nextStream = i+nThreads < nStreams ? &(streams[i+nThreads]) : NULL;
+		if( nStreams == 1 )
+		{
+			streams[i].generationPDF = generationFunction;
+			streams[i].random = rootRandom;
+		}
+		else
+		{
+			//	A seed of 0 would make TRandom3 seed itself from the clock
+			streams[i].generationPDF = ClassLookUp::CopyPDF( generationFunction );
+			streams[i].random = new TRandom3( 1 + (unsigned) rootRandom->Integer( 2147483646 ) );
+		}
+		const unsigned int numberTrials = blockSize > 1 ? blockSize : 1;
+		for( unsigned int t=0; t< numberTrials; ++t )
+		{
+			DataPoint* trialPoint = new DataPoint( allNames );
+			for( unsigned int j=0; j< nObs; ++j ) trialPoint->SetObservable( allNames[j], 0., allUnits[j] );
+			streams[i].trialPoints.push_back( trialPoint );
+		}
+		streams[i].trialValues.resize( numberTrials * nObs );
+		streams[i].trialRandoms.resize( numberTrials );
+		streams[i].trialCells.resize( numberTrials );
+		streams[i].selectedPoints.resize( numberTrials );
+		streams[i].selectedTrials.resize( numberTrials );
+		streams[i].selectedResults.resize( numberTrials );
+		streams[i].numberWanted = (unsigned) DataAmount / nStreams + ( i < (unsigned) DataAmount % nStreams ? 1 : 0 );
+		streams[i].accepted.reserve( streams[i].numberWanted * nObs );
+		this->SetStreamBounds( &(streams[i]), cellBounds );
+	}
+
+	unsigned int numberAccepted = 0;
+	bool zeroValue = false;
+	while( true )
+	{
+		if( nThreads == 1 )
+		{
+			GenerateStream_pthread( (void*) &(streams[0]) );
+		}
+		else
+		{
+			//	Thread i runs streams i, i+nThreads, ...
+			vector<pthread_t> threads( nThreads );
+			vector<bool> started( nThreads, false );
+			for( unsigned int i=0; i< nThreads; ++i )
+			{
+				started[i] = ( pthread_create( &(threads[i]), NULL, GenerateStream_pthread, (void*) &(streams[i]) ) == 0 );
+				//	Can't start a thread, so generate these streams now
+				if( !started[i] ) GenerateStream_pthread( (void*) &(streams[i]) );
+			}
+			for( unsigned int i=0; i< nThreads; ++i )
+			{
+				if( started[i] ) pthread_join( threads[i], NULL );
+			}
+		}
+
+		//	Bring all of the streams to the same envelope
+		for( unsigned int i=0; i< nStreams; ++i )
+		{
+			for( unsigned int c=0; c< cellBounds.size(); ++c )
+			{
+				if( streams[i].bounds[c] > cellBounds[c] ) cellBounds[c] = streams[i].bounds[c];
+			}
+		}
+		numberAccepted = 0;
+		for( unsigned int i=0; i< nStreams; ++i )
+		{
+			if( streams[i].bounds != cellBounds )
+			{
+				cout << "AcceptReject: Stream " << i << " was generated below the envelope of the other streams, starting it again" << endl;
+				this->SetStreamBounds( &(streams[i]), cellBounds );
+				this->RestartStream( &(streams[i]) );
+			}
+			numberAccepted += (unsigned) ( streams[i].accepted.size() / nObs );
+			if( streams[i].zeroValue ) zeroValue = true;
+		}
+		if( !envelopeBuilt ) moreThanMaximum = cellBounds[0];
+
+		if( zeroValue || numberAccepted >= (unsigned) DataAmount ) break;
+
+		//	Generate the events of any streams which started again
+		const unsigned int missing = (unsigned) DataAmount - numberAccepted;
+		for( unsigned int i=0; i< nStreams; ++i )
+		{
+			streams[i].numberWanted = (unsigned) ( streams[i].accepted.size() / nObs ) + missing / nStreams + ( i < missing % nStreams ? 1 : 0 );
+		}
+	}
+
+	//	Merge the streams in order
+	DataPoint* newDataPoint = new DataPoint( allNames );
+	for( unsigned int j=0; j< nObs; ++j )
+	{
+		newDataPoint->SetObservable( allNames[j], 0., allUnits[j] );
+	}
+	numberAccepted = 0;
+	vector<unsigned int> cellCounts( cellBounds.size(), 0 );
+	for( unsigned int i=0; i< nStreams; ++i )
+	{
+		const unsigned int streamEvents = (unsigned) ( streams[i].accepted.size() / nObs );
+		for( unsigned int k=0; k< streamEvents && numberAccepted < (unsigned) DataAmount; ++k, ++numberAccepted )
+		{
+			const double* values = &(streams[i].accepted[ k*nObs ]);
+			for( unsigned int j=0; j< nObs; ++j ) newDataPoint->GetObservable( j )->ExternallySetValue( values[j] );
+			newDataSet->SafeAddDataPoint( newDataPoint );
+			++cellCounts[ streams[i].acceptedCells[k] ];
+		}
+		numberAttempts += streams[i].numberAttempts;
+	}
+	delete newDataPoint;
+
+	if( envelopeBuilt && !zeroValue ) this->CheckEnvelope( cellCounts );
+
+	for( unsigned int i=0; i< nStreams; ++i )
+	{
+		for( unsigned int t=0; t< streams[i].trialPoints.size(); ++t ) delete streams[i].trialPoints[t];
+		if( nStreams > 1 )
+		{
+			delete streams[i].generationPDF;
+			delete streams[i].random;
+		}
+	}
+	delete[] streams;
+
+	//Return data generation statistics
+	dataNumber += (int) numberAccepted;
+	cout << "Data generation: " << numberAccepted << " accepted from " << numberAttempts;
+	if( nStreams > 1 ) cout << " in " << nStreams << " streams on " << nThreads << " threads";
+	cout << endl;
+	numberAttempts = 0;
+	return dataNumber;
+}
+
+void AcceptReject::GenerateStream( AcceptReject_Thread* stream )
+{
+	if( stream->trialPoints.size() > 1 ) this->GenerateStreamBlocks( stream );
+	else this->GenerateStreamScalar( stream );
+}
+
+void AcceptReject::GenerateStreamScalar( AcceptReject_Thread* stream )
+{
+	const unsigned int nObs = (unsigned) allNames.size();
+	DataPoint* testDataPoint = stream->trialPoints[0];
+	double* values = &(stream->trialValues[0]);
 
 	//Keep trying until required amount of data is generated
-	while (numberAccepted < DataAmount)
+	while( stream->accepted.size() < (size_t) stream->numberWanted * nObs )
+	{
+		++stream->numberAttempts;
+
+		//Move the trial point to a new point in N-space
+		const unsigned int cell = this->DrawCell( stream );
+		this->DrawTrial( stream->random, cell, values );
+		this->SetTrialPoint( testDataPoint, values );
+
+		//Apply preselection of test values
+		double testValue = stream->bounds[cell] * stream->random->Rndm();
+		if( !this->Preselection( testDataPoint, testValue ) ) continue;
+
+		//Accept/reject
+		const double functionValue = stream->generationPDF->Evaluate( testDataPoint );
+		if( fabs(functionValue - 0.0) < DOUBLE_TOLERANCE )
+		{
+			//Will get stuck in infinite loop
+			cerr << "Function value zero" << endl;
+			stream->zeroValue = true;
+			return;
+		}
+
+		//	This trial was drawn from the old envelope, so it goes with the events thrown away
+		if( functionValue > stream->bounds[cell] )
+		{
+			this->RaiseBound( stream, cell, functionValue );
+			continue;
+		}
+
+		if( testValue < functionValue )
+		{
+			stream->accepted.insert( stream->accepted.end(), values, values+nObs );
+			stream->acceptedCells.push_back( cell );
+			++stream->numberAccepted;
+		}
+	}
+}
+
+void AcceptReject::GenerateStreamBlocks( AcceptReject_Thread* stream )
+{
+	const unsigned int nObs = (unsigned) allNames.size();
+	const unsigned int largestBlock = (unsigned) stream->trialPoints.size();
+
+	while( stream->accepted.size() < (size_t) stream->numberWanted * nObs )
 	{
-		++numberAttempts;
+		//	Once the acceptance is known only make about as many trials as are needed for the events still missing
+		const unsigned int missing = stream->numberWanted - (unsigned) ( stream->accepted.size() / nObs );
+		unsigned int numberTrials = largestBlock;
+		if( stream->numberAccepted > 0 )
+		{
+			const double expected = 1.2 * double(missing) * double(stream->numberAttempts) / double(stream->numberAccepted) + 16.;
+			if( expected < double(largestBlock) ) numberTrials = (unsigned) expected;
+		}
 
-		//Create a new point in N-space
-		DataPoint * testDataPoint = new DataPoint(allNames);
-		for ( nameIterator = allNames.begin(); nameIterator != allNames.end(); ++nameIterator )
+		//	Draw every random number for the block first
+		double* values = &(stream->trialValues[0]);
+		double* randoms = &(stream->trialRandoms[0]);
+		unsigned int* cells = &(stream->trialCells[0]);
+		for( unsigned int t=0; t< numberTrials; ++t )
 		{
-			//Create a new observable value
-			Observable * newObservable = generationBoundary->GetConstraint(*nameIterator)->CreateObservable(rootRandom);
-			testDataPoint->SetObservable( *nameIterator, newObservable );
-			delete newObservable;
+			cells[t] = this->DrawCell( stream );
+			this->DrawTrial( stream->random, cells[t], values + t*nObs );
+			randoms[t] = stream->random->Rndm();
 		}
 
 		//Apply preselection of test values
-		double testValue = moreThanMaximum * rootRandom->Rndm();
-		if ( Preselection( testDataPoint, testValue ) )
+		unsigned int numberSelected = 0;
+		for( unsigned int t=0; t< numberTrials; ++t )
+		{
+			DataPoint* testDataPoint = stream->trialPoints[t];
+			this->SetTrialPoint( testDataPoint, values + t*nObs );
+			if( this->Preselection( testDataPoint, stream->bounds[ cells[t] ] * randoms[t] ) )
+			{
+				stream->selectedPoints[numberSelected] = testDataPoint;
+				stream->selectedTrials[numberSelected] = t;
+				++numberSelected;
+			}
+		}
+
+		double* results = &(stream->selectedResults[0]);
+		if( numberSelected > 0 )
+		{
+			EventBlock thisBlock( &(stream->selectedPoints[0]), numberSelected );
+			try
+			{
+				stream->generationPDF->EvaluateForNumericGenerationBatch( thisBlock, results );
+			}
+			catch(...)
+			{
+				//	Find the trial which can't be evaluated, EvaluateForNumericGeneration reports it and gives 0
+				for( unsigned int s=0; s< numberSelected; ++s ) results[s] = stream->generationPDF->EvaluateForNumericGeneration( stream->selectedPoints[s] );
+			}
+		}
+
+		//	The usual case, the whole block is below the bounds of its cells, needs nothing but comparisons
+		bool simple = true;
+		for( unsigned int s=0; s< numberSelected; ++s )
 		{
-			//Accept/reject
-			double functionValue = generationFunction->Evaluate(testDataPoint);
-			if ( fabs(functionValue - 0.0) < DOUBLE_TOLERANCE )
+			const unsigned int t = stream->selectedTrials[s];
+			if( results[s] > stream->bounds[ cells[t] ] || fabs(results[s] - 0.0) < DOUBLE_TOLERANCE ) simple = false;
+		}
+		if( simple )
+		{
+			for( unsigned int s=0; s< numberSelected; ++s )
 			{
-				//Will get stuck in infinite loop
-				cerr << "Function value zero" << endl;
-				delete testDataPoint;
-				return dataNumber;
+				const unsigned int t = stream->selectedTrials[s];
+				results[s] = ( randoms[t] * stream->bounds[ cells[t] ] < results[s] ) ? 1. : 0.;
 			}
+		}
 
-			if (functionValue > moreThanMaximum)
+		//	Take the accepted trials in order until the stream has all of its events, the rest of the block is unused
+		unsigned int numberUsed = numberTrials;
+		for( unsigned int s=0; s< numberSelected; ++s )
+		{
+			const unsigned int t = stream->selectedTrials[s];
+			bool accept = false;
+			if( simple )
 			{
-				//Restart accept/reject
-				cout << "Function value " << functionValue << " is more than expected maximum " << moreThanMaximum << ": restarting data generation" << endl;
-				dataNumber = 0;
-				numberAccepted = 0;
-				newDataSet->Clear();
-				moreThanMaximum *= 2.0;
-				delete testDataPoint;
-				return GenerateData(DataAmount);
+				accept = results[s] > 0.5;
 			}
 			else
 			{
-				if (testValue < functionValue)
+				const double functionValue = results[s];
+				if( fabs(functionValue - 0.0) < DOUBLE_TOLERANCE )
 				{
-					//Accept
-					newDataSet->AddDataPoint(testDataPoint);
-					++numberAccepted;
-					delete testDataPoint;
+					//Will get stuck in infinite loop
+					cerr << "Function value zero" << endl;
+					stream->zeroValue = true;
+					stream->numberAttempts += (int) t+1;
+					return;
 				}
-				else
+				//	The rest of the block was drawn from the old envelope, so it goes with the events thrown away
+				if( functionValue > stream->bounds[ cells[t] ] )
+				{
+					this->RaiseBound( stream, cells[t], functionValue );
+					numberUsed = t+1;
+					break;
+				}
+				accept = randoms[t] * stream->bounds[ cells[t] ] < functionValue;
+			}
+
+			if( accept )
+			{
+				stream->accepted.insert( stream->accepted.end(), values + t*nObs, values + (t+1)*nObs );
+				stream->acceptedCells.push_back( cells[t] );
+				++stream->numberAccepted;
+				if( stream->accepted.size() >= (size_t) stream->numberWanted * nObs )
 				{
-					//Reject
-					delete testDataPoint;
+					numberUsed = t+1;
+					break;
 				}
 			}
 		}
+		stream->numberAttempts += (int) numberUsed;
+	}
+}
+
+void AcceptReject::SetupCells( const int DataAmount )
+{
+	if( envelopeBuilt ) return;
+
+	bool anyContinuous = false;
+	for( unsigned int j=0; j< discreteValues.size(); ++j )
+	{
+		if( discreteValues[j].empty() ) anyContinuous = true;
+	}
+
+	if( useEnvelope && anyContinuous && DataAmount >= RAPIDFIT_ENVELOPE_MIN_EVENTS )
+	{
+		this->BuildEnvelope();
+		return;
+	}
+
+	//	A single cell covering all of the phase space with the bound moreThanMaximum, which is the plain accept/reject method
+	const unsigned int nObs = (unsigned) allNames.size();
+	cellMinima.assign( nObs, 0. );
+	cellRanges.assign( nObs, 0. );
+	for( unsigned int j=0; j< nObs; ++j )
+	{
+		if( !discreteValues[j].empty() ) continue;
+		IConstraint* thisConstraint = generationBoundary->GetConstraint( allNames[j] );
+		cellMinima[j] = thisConstraint->GetMinimum();
+		cellRanges[j] = thisConstraint->GetMaximum() - thisConstraint->GetMinimum();
+	}
+	cellVolumes.assign( 1, 1. );
+	cellBounds.assign( 1, moreThanMaximum );
+}
+
+void AcceptReject::BuildEnvelope()
+{
+	const unsigned int nObs = (unsigned) allNames.size();
+
+	//	The cells are only split in the continuous Observables, the discrete ones are held at their first value while they are made
+	vector<string> continuousNames, discreteNames;
+	DataPoint* samplePoint = new DataPoint( allNames );
+	for( unsigned int j=0; j< nObs; ++j )
+	{
+		if( discreteValues[j].empty() )
+		{
+			continuousNames.push_back( allNames[j] );
+			samplePoint->SetObservable( allNames[j], 0., allUnits[j] );
+		}
 		else
 		{
-			//Reject
-			delete testDataPoint;
+			discreteNames.push_back( allNames[j] );
+			samplePoint->SetObservable( allNames[j], discreteValues[j][0], allUnits[j] );
 		}
 	}
 
-	//Return data generation statistics
-	dataNumber += numberAccepted;
-	cout << "Data generation: " << numberAccepted << " accepted from " << numberAttempts << endl;
-	numberAttempts = 0;
-	return dataNumber;
+	vector<PhaseSpaceBoundary*> cells = MakeFoam::MakeCells( generationFunction, generationBoundary, samplePoint, continuousNames, discreteNames,
+			RAPIDFIT_ENVELOPE_CELL_SAMPLES, RAPIDFIT_ENVELOPE_MAXIMUM_CELLS, rootRandom );
+
+	const unsigned int nCells = (unsigned) cells.size();
+	cellMinima.assign( nCells*nObs, 0. );
+	cellRanges.assign( nCells*nObs, 0. );
+	cellVolumes.assign( nCells, 1. );
+	cellBounds.assign( nCells, 0. );
+	for( unsigned int c=0; c< nCells; ++c )
+	{
+		for( unsigned int j=0; j< nObs; ++j )
+		{
+			if( !discreteValues[j].empty() ) continue;
+			IConstraint* thisConstraint = cells[c]->GetConstraint( allNames[j] );
+			cellMinima[ c*nObs + j ] = thisConstraint->GetMinimum();
+			cellRanges[ c*nObs + j ] = thisConstraint->GetMaximum() - thisConstraint->GetMinimum();
+			cellVolumes[c] *= cellRanges[ c*nObs + j ];
+		}
+		delete cells[c];
+	}
+
+	//	Sample each cell, with all of the discrete values, for its largest value
+	vector<double> values( nObs, 0. );
+	cellIntegrals.assign( nCells, 0. );
+	cellIntegralErrors.assign( nCells, 0. );
+	double sumMeans = 0., largestBound = 0.;
+	for( unsigned int c=0; c< nCells; ++c )
+	{
+		double largest = 0., sum = 0., sum2 = 0.;
+		for( unsigned int k=0; k< RAPIDFIT_ENVELOPE_BOUND_SAMPLES; ++k )
+		{
+			this->DrawTrial( rootRandom, c, &(values[0]) );
+			this->SetTrialPoint( samplePoint, &(values[0]) );
+			const double functionValue = generationFunction->EvaluateForNumericGeneration( samplePoint );
+			if( functionValue > largest ) largest = functionValue;
+			sum += functionValue;
+			sum2 += functionValue*functionValue;
+		}
+		cellBounds[c] = RAPIDFIT_ENVELOPE_SAFETY * largest;
+		if( cellBounds[c] > largestBound ) largestBound = cellBounds[c];
+		const double mean = sum / RAPIDFIT_ENVELOPE_BOUND_SAMPLES;
+		const double variance = sum2 / RAPIDFIT_ENVELOPE_BOUND_SAMPLES - mean*mean;
+		cellIntegrals[c] = cellVolumes[c] * mean;
+		cellIntegralErrors[c] = cellVolumes[c] * sqrt( ( variance > 0. ? variance : 0. ) / RAPIDFIT_ENVELOPE_BOUND_SAMPLES );
+		sumMeans += cellIntegrals[c];
+	}
+	delete samplePoint;
+
+	//	A cell where nothing was seen can't be left out, as the PDF might not be zero everywhere in it
+	double sumBounds = 0.;
+	for( unsigned int c=0; c< nCells; ++c )
+	{
+		if( cellBounds[c] < 1E-3 * largestBound ) cellBounds[c] = 1E-3 * largestBound;
+		sumBounds += cellVolumes[c] * cellBounds[c];
+	}
+
+	cout << "AcceptReject: envelope of " << nCells << " cells, expected efficiency " << sumMeans / sumBounds << endl;
+	envelopeBuilt = true;
+}
+
+unsigned int AcceptReject::DrawCell( AcceptReject_Thread* stream ) const
+{
+	//	No random number is used for a single cell, so the plain method draws exactly the same numbers as it always has
+	if( stream->cumulative.size() == 1 ) return 0;
+	const double position = stream->cumulative.back() * stream->random->Rndm();
+	const unsigned int cell = (unsigned) ( upper_bound( stream->cumulative.begin(), stream->cumulative.end(), position ) - stream->cumulative.begin() );
+	return cell < stream->cumulative.size() ? cell : (unsigned) stream->cumulative.size() - 1;
+}
+
+void AcceptReject::DrawTrial( TRandom3* random, const unsigned int cell, double* values ) const
+{
+	const unsigned int nObs = (unsigned) allNames.size();
+	const double* minima = &(cellMinima[ cell*nObs ]);
+	const double* ranges = &(cellRanges[ cell*nObs ]);
+	for( unsigned int j=0; j< nObs; ++j )
+	{
+		if( discreteValues[j].empty() )
+		{
+			values[j] = minima[j] + ranges[j] * random->Rndm();
+		}
+		else
+		{
+			values[j] = discreteValues[j][ (unsigned) floor( double(discreteValues[j].size()) * random->Rndm() ) ];
+		}
+	}
+}
+
+void AcceptReject::SetStreamBounds( AcceptReject_Thread* stream, const vector<double>& bounds ) const
+{
+	stream->bounds = bounds;
+	stream->cumulative.resize( bounds.size() );
+	double total = 0.;
+	for( unsigned int c=0; c< bounds.size(); ++c )
+	{
+		total += bounds[c] * cellVolumes[c];
+		stream->cumulative[c] = total;
+	}
+}
+
+void AcceptReject::SetTrialPoint( DataPoint* thisPoint, const double* values ) const
+{
+	const unsigned int nObs = (unsigned) allNames.size();
+	for( unsigned int j=0; j< nObs; ++j )
+	{
+		Observable* thisObservable = thisPoint->GetObservable( j );
+		thisObservable->ExternallySetValue( values[j] );
+		thisObservable->SetBinNumber( -1 );
+		thisObservable->SetBkgBinNumber( -1 );
+	}
+	thisPoint->ClearPerEventData();
+}
+
+void AcceptReject::RaiseBound( AcceptReject_Thread* stream, const unsigned int cell, const double functionValue ) const
+{
+	const double oldBound = stream->bounds[cell];
+	double newBound = oldBound;
+	while( newBound < functionValue ) newBound *= 2.0;
+
+	if( stream->bounds.size() == 1 )
+	{
+		cout << "Function value " << functionValue << " is more than expected maximum " << oldBound << ": starting again with " << newBound << endl;
+	}
+	else
+	{
+		cout << "Function value " << functionValue << " is more than the bound " << oldBound << " of envelope cell " << cell << ": starting again with " << newBound << endl;
+	}
+
+	vector<double> newBounds( stream->bounds );
+	newBounds[cell] = newBound;
+	this->SetStreamBounds( stream, newBounds );
+	this->RestartStream( stream );
+}
+
+void AcceptReject::RestartStream( AcceptReject_Thread* stream ) const
+{
+	stream->accepted.clear();
+	stream->acceptedCells.clear();
+}
+
+bool AcceptReject::CheckEnvelope( const vector<unsigned int>& cellCounts ) const
+{
+	const unsigned int nCells = (unsigned) cellCounts.size();
+	if( nCells < 2 || cellIntegrals.size() != nCells ) return true;
+
+	double total = 0., sumIntegrals = 0.;
+	for( unsigned int c=0; c< nCells; ++c )
+	{
+		total += cellCounts[c];
+		sumIntegrals += cellIntegrals[c];
+	}
+	if( !( total > 0. ) || !( sumIntegrals > 0. ) ) return true;
+
+	//	Poisson error of the count and the error of the expected count from the sampled integral
+	double chi2 = 0.;
+	for( unsigned int c=0; c< nCells; ++c )
+	{
+		const double expected = total * cellIntegrals[c] / sumIntegrals;
+		const double expectedError = total * cellIntegralErrors[c] / sumIntegrals;
+		const double variance = expected + expectedError*expectedError;
+		if( !( variance > 0. ) ) continue;
+		chi2 += ( cellCounts[c] - expected ) * ( cellCounts[c] - expected ) / variance;
+	}
+
+	const double ndf = nCells - 1.;
+	if( chi2 > ndf + 5.*sqrt( 2.*ndf ) )
+	{
+		cerr << "AcceptReject: WARNING the generated events don't follow the PDF over the envelope cells, chi2/ndf = " << chi2 << "/" << ndf << endl;
+		return false;
+	}
+	return true;
+}
+
+void* AcceptReject::GenerateStream_pthread( void* input_data )
+{
+	for( AcceptReject_Thread* stream = (AcceptReject_Thread*) input_data; stream != NULL; stream = stream->nextStream )
+	{
+		stream->generator->GenerateStream( stream );
+	}
+	return NULL;
 }
 
 //Return data set
@@ -120,6 +619,26 @@ IDataSet * AcceptReject::GetDataSet() const
 	return newDataSet;
 }
 
+void AcceptReject::SetNumberThreads( const unsigned int Input )
+{
+	numberThreads = Input > 0 ? Input : 1;
+}
+
+void AcceptReject::SetNumberStreams( const unsigned int Input )
+{
+	numberStreams = Input;
+}
+
+void AcceptReject::SetBlockSize( const unsigned int Input )
+{
+	blockSize = Input > 0 ? Input : 1;
+}
+
+void AcceptReject::SetUseEnvelope( const bool Input )
+{
+	useEnvelope = Input;
+}
+
 //Overload in child functions to speed data generation for complex functions
 bool AcceptReject::Preselection( DataPoint * TestDataPoint, double TestValue )
 {
@@ -27,7 +27,9 @@ using namespace::std;
 BasePDF::BasePDF() : BasePDF_Framework( this ), BasePDF_MCCaching(),
 	numericalNormalisation(false), allParameters( vector<string>() ), allObservables(), doNotIntegrateList(), observableDistNames(), observableDistributions(),
 	component_list(), requiresBoundary(false), cachingEnabled( true ), haveTestedIntegral( false ), discrete_Normalisation( false ), DiscreteCaches(new vector<double>()),
-	debug_mutex(NULL), can_remove_mutex(true), fixed_checked(false), isFixed(false), fixedID(0), _basePDFComponentStatus(false), stored_boundary(NULL), stored_point(NULL), stored_index(0)
+	debug_mutex(NULL), can_remove_mutex(true), fixed_checked(false), isFixed(false), fixedID(0), _basePDFComponentStatus(false), stored_boundary(NULL), stored_point(NULL), stored_index(0),
+	parameterRefs(), inputRefs(), changedParameters(), cacheDependencies(), parametersApplied(false), parameterVersion(0),
+	gradientNames(NULL), gradientNamesSize(0), gradientSlots()
 {
 	component_list.push_back( "0" );
 }
@@ -39,7 +41,9 @@ BasePDF::BasePDF( const BasePDF& input ) : BasePDF_Framework( input ), BasePDF_M
 	cachingEnabled( input.cachingEnabled ), haveTestedIntegral( input.haveTestedIntegral ),
 	discrete_Normalisation( input.discrete_Normalisation ), DiscreteCaches(NULL),
 	debug_mutex(input.debug_mutex), can_remove_mutex(false), fixed_checked(input.fixed_checked), isFixed(input.isFixed), fixedID(input.fixedID),
-	_basePDFComponentStatus(input._basePDFComponentStatus), stored_boundary(input.stored_boundary), stored_index(input.stored_index), stored_point(input.stored_point)
+	_basePDFComponentStatus(input._basePDFComponentStatus), stored_boundary(input.stored_boundary), stored_index(input.stored_index), stored_point(input.stored_point),
+	parameterRefs(), inputRefs(), changedParameters(), cacheDependencies( input.cacheDependencies ), parametersApplied(false), parameterVersion(0),
+	gradientNames(NULL), gradientNamesSize(0), gradientSlots()
 {
 	allParameters.SetPhysicsParameters( &(input.allParameters) );
 	DiscreteCaches = new vector<double>( input.DiscreteCaches->size() );
@@ -69,6 +73,7 @@ void BasePDF::SetComponentStatus( const bool input )
 
 void BasePDF::ReallySetComponentStatus( const bool input )
 {
+	if( _basePDFComponentStatus != input ) ++parameterVersion;
 	_basePDFComponentStatus = input;
 }
 
@@ -185,19 +190,89 @@ void BasePDF::UpdatePhysicsParameters( ParameterSet* Input )
 {
 	if( allParameters.GetAllNames().size() != 0 )
 	{
+		bool anyChanged = this->FindChangedParameters( Input );
+
+		//	Always pass the first set of parameters through, copies may not have set up their internal state yet
+		if( !parametersApplied )
+		{
+			changedParameters.assign( changedParameters.size(), true );
+			anyChanged = true;
+		}
+
+		//	Nothing this PDF depends on has moved, leave everything as it is
+		if( !anyChanged ) return;
+
 		//  Invalidate the cache
-		if( !(allParameters == (*Input)) ) this->UnsetCache();
+		bool cacheChanged = cacheDependencies.empty();
+		for( unsigned int i=0; i< cacheDependencies.size() && !cacheChanged; ++i )
+		{
+			cacheChanged = this->ParameterChanged( cacheDependencies[i] );
+		}
+		if( cacheChanged ) this->UnsetCache();
+
 		allParameters.SetPhysicsParameters( Input );
 	}
 	else
 	{
 		allParameters.AddPhysicsParameters( Input );
 		this->UnsetCache();
+		this->FindChangedParameters( Input );
+		changedParameters.assign( changedParameters.size(), true );
 	}
 
+	parametersApplied = true;
+	++parameterVersion;
 	this->SetPhysicsParameters( Input );
 }
 
+unsigned int BasePDF::GetParameterVersion() const
+{
+	return parameterVersion;
+}
+
+bool BasePDF::FindChangedParameters( ParameterSet* Input )
+{
+	const vector<string> ourNames = allParameters.GetAllNames();
+	if( parameterRefs.size() != ourNames.size() )
+	{
+		parameterRefs.clear(); inputRefs.clear();
+		for( unsigned int i=0; i< ourNames.size(); ++i )
+		{
+			parameterRefs.push_back( ObservableRef( ourNames[i] ) );
+			inputRefs.push_back( ObservableRef( ourNames[i] ) );
+		}
+	}
+	changedParameters.assign( ourNames.size(), false );
+
+	bool anyChanged = false;
+	for( unsigned int i=0; i< parameterRefs.size(); ++i )
+	{
+		const PhysicsParameter* ours = allParameters.GetPhysicsParameter( parameterRefs[i] );
+		const PhysicsParameter* theirs = Input->GetPhysicsParameter( inputRefs[i] );
+		if( ours->GetValue() != theirs->GetValue() || ours->GetType() != theirs->GetType() )
+		{
+			changedParameters[i] = true;
+			anyChanged = true;
+		}
+	}
+	return anyChanged;
+}
+
+bool BasePDF::ParameterChanged( const string& Name ) const
+{
+	if( !parametersApplied ) return true;
+	for( unsigned int i=0; i< parameterRefs.size(); ++i )
+	{
+		if( parameterRefs[i].Name() == Name ) return changedParameters[i];
+	}
+	return false;
+}
+
+void BasePDF::SetCacheDependencies( const vector<string>& Names )
+{
+	cacheDependencies = Names;
+}
+
 //Set the function parameters
 bool BasePDF::SetPhysicsParameters( ParameterSet * NewParameterSet )
 {
@@ -549,6 +624,79 @@ double BasePDF::Evaluate(DataPoint * NewDataPoint)
 	return  -1.0;
 }
 
+//	Default is to simply Evaluate each event in turn
+void BasePDF::EvaluateBatch( const EventBlock& Input, double* out )
+{
+	const unsigned int number = Input.GetNumberEvents();
+	for( unsigned int i=0; i< number; ++i )
+	{
+		out[i] = this->Evaluate( Input.GetDataPoint( i ) );
+	}
+}
+
+bool BasePDF::GetAnalyticGradient() const
+{
+	return false;
+}
+
+void BasePDF::EvaluateGradient( DataPoint* Input, PhaseSpaceBoundary* Boundary, const vector<string>& Names, double* gradient )
+{
+	(void) Input; (void) Boundary; (void) Names; (void) gradient;
+	PDF_THREAD_LOCK
+	cerr << "BasePDF: " << this->GetLabel() << " does not provide an analytic gradient" << endl;
+	PDF_THREAD_UNLOCK
+	throw(-21);
+}
+
+unsigned int BasePDF::GetNumberAmplitudeTerms() const
+{
+	return 0;
+}
+
+void BasePDF::EvaluateAmplitudeTerms( DataPoint* Input, complex<double>* terms, double& weight )
+{
+	(void) Input; (void) terms; (void) weight;
+	PDF_THREAD_LOCK
+	cerr << "BasePDF: " << this->GetLabel() << " does not provide amplitude terms" << endl;
+	PDF_THREAD_UNLOCK
+	throw(-22);
+}
+
+vector<string> BasePDF::GetAmplitudeCouplingNames() const
+{
+	return vector<string>();
+}
+
+double BasePDF::ContractAmplitudeIntegrals( const vector<complex<double> >& integrals )
+{
+	(void) integrals;
+	PDF_THREAD_LOCK
+	cerr << "BasePDF: " << this->GetLabel() << " does not provide amplitude terms" << endl;
+	PDF_THREAD_UNLOCK
+	throw(-22);
+}
+
+int BasePDF::GetGradientSlot( const vector<string>& Names, const ObservableRef& Param )
+{
+	//	This caches the position of Param within allParameters
+	allParameters.GetPhysicsParameter( Param );
+	const unsigned int thisIndex = (unsigned) Param.GetIndex();
+
+	if( &Names != gradientNames || Names.size() != gradientNamesSize || thisIndex >= gradientSlots.size() )
+	{
+		const vector<string> ourNames = allParameters.GetAllNames();
+		gradientSlots.assign( ourNames.size(), -1 );
+		for( unsigned int i=0; i< ourNames.size(); ++i )
+		{
+			gradientSlots[i] = StringProcessing::VectorContains( &Names, &(ourNames[i]) );
+		}
+		gradientNames = &Names;
+		gradientNamesSize = Names.size();
+	}
+
+	return gradientSlots[ thisIndex ];
+}
+
 //Return the function value at the given point for generation
 double BasePDF::EvaluateForNumericGeneration( DataPoint* NewDataPoint )
 {
@@ -569,6 +717,11 @@ double BasePDF::EvaluateForNumericGeneration( DataPoint* NewDataPoint )
 	return returnable;
 }
 
+void BasePDF::EvaluateForNumericGenerationBatch( const EventBlock& Input, double* out )
+{
+	this->EvaluateBatch( Input, out );
+}
+
 //Calculate the function value for numerical integration
 double BasePDF::EvaluateForNumericIntegral( DataPoint * NewDataPoint )
 {
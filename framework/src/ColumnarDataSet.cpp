@@ -0,0 +1,1181 @@
+
+//	RapidFit Headers
+#include "ColumnarDataSet.h"
+#include "IConstraint.h"
+#include "StringProcessing.h"
+#include "Threading.h"
+//	System Headers
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <limits>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdio.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define DOUBLE_TOLERANCE_DATA 1E-8
+
+using namespace::std;
+
+ColumnarDataSet::ColumnarDataSet( PhaseSpaceBoundary* NewBoundary ) :
+	dataBoundary( new PhaseSpaceBoundary(*NewBoundary) ), templatePoint(NULL), allNames(), allColumns(), binNumColumns(), acceptanceColumns(),
+	initialNLLColumn(NULL), weightColumn(NULL), numberEvents(0), capacity(0), mappedRegion(NULL), mappedBytes(0), allViews(), view_lock(),
+	useWeights(false), WeightName(""), alpha(1.), alphaName("uninitialized"), valuesID( ColumnarDataSet::NewValuesID() )
+{
+	pthread_mutex_init( &view_lock, NULL );
+
+	allNames = dataBoundary->GetAllNames();
+
+	templatePoint = new DataPoint( allNames );
+	for( unsigned int i=0; i< allNames.size(); ++i )
+	{
+		string unit = dataBoundary->GetConstraint( allNames[i] )->GetUnit();
+		templatePoint->SetObservable( allNames[i], 0., unit, true, (int)i );
+	}
+	templatePoint->SetPhaseSpaceBoundary( dataBoundary );
+
+	allColumns.resize( allNames.size(), NULL );
+	binNumColumns.resize( allNames.size(), NULL );
+	acceptanceColumns.resize( allNames.size(), NULL );
+}
+
+ColumnarDataSet::~ColumnarDataSet()
+{
+	this->Clear();
+	if( templatePoint != NULL ) delete templatePoint;
+	if( dataBoundary != NULL ) delete dataBoundary;
+	pthread_mutex_destroy( &view_lock );
+}
+
+void* ColumnarDataSet::AllocateColumn( const size_t bytes )
+{
+	void* output = NULL;
+	size_t wanted = bytes > 0 ? bytes : RAPIDFIT_COLUMN_ALIGNMENT;
+#ifdef _WIN32
+	output = _aligned_malloc( wanted, RAPIDFIT_COLUMN_ALIGNMENT );
+#else
+	if( posix_memalign( &output, RAPIDFIT_COLUMN_ALIGNMENT, wanted ) != 0 ) output = NULL;
+#endif
+	if( output == NULL )
+	{
+		cerr << "ColumnarDataSet: Cannot allocate " << wanted << " bytes for DataSet. Exiting" << endl;
+		exit(-8321);
+	}
+	return output;
+}
+
+void ColumnarDataSet::FreeColumn( void* column )
+{
+	if( column == NULL ) return;
+#ifdef _WIN32
+	_aligned_free( column );
+#else
+	free( column );
+#endif
+}
+
+void ColumnarDataSet::Grow( const unsigned int wantedCapacity )
+{
+	if( wantedCapacity <= capacity ) return;
+
+	unsigned int newCapacity = capacity > 0 ? capacity : 1024;
+	while( newCapacity < wantedCapacity ) newCapacity *= 2;
+
+	for( unsigned int i=0; i< allNames.size(); ++i )
+	{
+		double* newColumn = (double*) AllocateColumn( sizeof(double)*newCapacity );
+		int* newBinNum = (int*) AllocateColumn( sizeof(int)*newCapacity );
+		double* newAcceptance = (double*) AllocateColumn( sizeof(double)*newCapacity );
+		if( numberEvents > 0 )
+		{
+			memcpy( newColumn, allColumns[i], sizeof(double)*numberEvents );
+			memcpy( newBinNum, binNumColumns[i], sizeof(int)*numberEvents );
+			memcpy( newAcceptance, acceptanceColumns[i], sizeof(double)*numberEvents );
+		}
+		if( mappedRegion == NULL ) FreeColumn( allColumns[i] );
+		FreeColumn( binNumColumns[i] );
+		FreeColumn( acceptanceColumns[i] );
+		allColumns[i] = newColumn;
+		binNumColumns[i] = newBinNum;
+		acceptanceColumns[i] = newAcceptance;
+	}
+
+	double* newNLL = (double*) AllocateColumn( sizeof(double)*newCapacity );
+	double* newWeight = (double*) AllocateColumn( sizeof(double)*newCapacity );
+	if( numberEvents > 0 )
+	{
+		memcpy( newNLL, initialNLLColumn, sizeof(double)*numberEvents );
+		memcpy( newWeight, weightColumn, sizeof(double)*numberEvents );
+	}
+	FreeColumn( initialNLLColumn );
+	FreeColumn( weightColumn );
+	initialNLLColumn = newNLL;
+	weightColumn = newWeight;
+
+	//	The values have all been copied out of any cache file
+	this->Unmap();
+
+	capacity = newCapacity;
+}
+
+void ColumnarDataSet::Reserve( const unsigned int wantedEvents )
+{
+	this->Grow( wantedEvents );
+}
+
+void ColumnarDataSet::AddEvent( const double* values )
+{
+	if( numberEvents == capacity ) this->Grow( numberEvents+1 );
+
+	for( unsigned int i=0; i< allNames.size(); ++i )
+	{
+		allColumns[i][numberEvents] = values[i];
+		binNumColumns[i][numberEvents] = -1;
+		acceptanceColumns[i][numberEvents] = -1.;
+	}
+	initialNLLColumn[numberEvents] = numeric_limits<double>::quiet_NaN();
+	weightColumn[numberEvents] = 1.;
+
+	allViews.push_back( NULL );
+	++numberEvents;
+}
+
+void ColumnarDataSet::SafeAddDataPoint( DataPoint* NewDataPoint )
+{
+	if( numberEvents == capacity ) this->Grow( numberEvents+1 );
+
+	for( unsigned int i=0; i< allNames.size(); ++i )
+	{
+		ObservableRef thisRef( allNames[i] );
+		Observable* thisObs = NewDataPoint->GetObservable( thisRef );
+		allColumns[i][numberEvents] = thisObs->GetValue();
+		binNumColumns[i][numberEvents] = thisObs->GetBinNumber();
+		acceptanceColumns[i][numberEvents] = thisObs->GetAcceptance();
+	}
+	initialNLLColumn[numberEvents] = NewDataPoint->GetInitialNLL();
+	weightColumn[numberEvents] = NewDataPoint->GetEventWeight();
+
+	allViews.push_back( NULL );
+	++numberEvents;
+}
+
+bool ColumnarDataSet::AddDataPoint( DataPoint* NewDataPoint )
+{
+	bool added = false;
+	if( dataBoundary->IsPointInBoundary( NewDataPoint ) )
+	{
+		this->SafeAddDataPoint( NewDataPoint );
+		added = true;
+	}
+	delete NewDataPoint;
+	return added;
+}
+
+void ColumnarDataSet::CopyEvent( const ColumnarDataSet* source, const unsigned int index )
+{
+	if( numberEvents == capacity ) this->Grow( numberEvents+1 );
+
+	for( unsigned int i=0; i< allNames.size(); ++i )
+	{
+		allColumns[i][numberEvents] = source->allColumns[i][index];
+		binNumColumns[i][numberEvents] = source->binNumColumns[i][index];
+		acceptanceColumns[i][numberEvents] = source->acceptanceColumns[i][index];
+	}
+	initialNLLColumn[numberEvents] = source->initialNLLColumn[index];
+	weightColumn[numberEvents] = source->weightColumn[index];
+
+	allViews.push_back( NULL );
+	++numberEvents;
+}
+
+DataPoint* ColumnarDataSet::MakeDataPoint( const unsigned int index ) const
+{
+	DataPoint* output = new DataPoint( *templatePoint );
+	this->FillDataPoint( index, output );
+	output->SetPhaseSpaceBoundary( dataBoundary );
+	return output;
+}
+
+void ColumnarDataSet::FillDataPoint( const unsigned int index, DataPoint* output ) const
+{
+	for( unsigned int i=0; i< allNames.size(); ++i )
+	{
+		Observable* thisObs = output->GetObservable( i );
+		thisObs->ExternallySetValue( allColumns[i][index] );
+		thisObs->SetBinNumber( binNumColumns[i][index] );
+		thisObs->SetAcceptance( acceptanceColumns[i][index] );
+	}
+	output->SetInitialNLL( initialNLLColumn[index] );
+	output->SetEventWeight( weightColumn[index] );
+}
+
+void ColumnarDataSet::RefreshView( const unsigned int index ) const
+{
+	DataPoint* thisView = allViews[index];
+	if( thisView == NULL ) return;
+	this->FillDataPoint( index, thisView );
+	thisView->NewDataGeneration();
+}
+
+void ColumnarDataSet::FillBlock( const unsigned int first, const unsigned int number, vector<DataPoint*>& points ) const
+{
+	while( points.size() < number ) points.push_back( new DataPoint( *templatePoint ) );
+	for( unsigned int k=0; k< number; ++k )
+	{
+		this->FillDataPoint( first+k, points[k] );
+		points[k]->SetPhaseSpaceBoundary( dataBoundary );
+		points[k]->ClearPerEventData();
+	}
+}
+
+void ColumnarDataSet::StoreBlock( const unsigned int first, const unsigned int number, DataPoint* const* points ) const
+{
+	for( unsigned int k=0; k< number; ++k )
+	{
+		for( unsigned int i=0; i< allNames.size(); ++i )
+		{
+			Observable* thisObs = points[k]->GetObservable( i );
+			binNumColumns[i][first+k] = thisObs->GetBinNumber();
+			acceptanceColumns[i][first+k] = thisObs->GetAcceptance();
+		}
+		initialNLLColumn[first+k] = points[k]->GetInitialNLL();
+	}
+}
+
+void ColumnarDataSet::RefreshAllViews() const
+{
+	for( unsigned int i=0; i< numberEvents; ++i ) this->RefreshView( i );
+}
+
+//Retrieve the data point with the given index
+DataPoint* ColumnarDataSet::GetDataPoint( int Index )
+{
+	if( Index < 0 || Index >= (int)numberEvents )
+	{
+		cerr << "Index (" << Index << ") out of range in DataSet" << endl;
+		return NULL;
+	}
+
+	DataPoint* thisView = allViews[(unsigned)Index];
+	if( thisView == NULL )
+	{
+		pthread_mutex_lock( &view_lock );
+		thisView = allViews[(unsigned)Index];
+		if( thisView == NULL )
+		{
+			thisView = this->MakeDataPoint( (unsigned)Index );
+			allViews[(unsigned)Index] = thisView;
+		}
+		pthread_mutex_unlock( &view_lock );
+	}
+
+	thisView->SetPhaseSpaceBoundary( dataBoundary );
+	return thisView;
+}
+
+vector<unsigned int> ColumnarDataSet::GetDiscreteIndices( const vector<ObservableRef> discreteParam, const vector<double> discreteVal ) const
+{
+	vector<unsigned int> output;
+
+	vector<const double*> wantedColumns;
+	for( unsigned int j=0; j< discreteParam.size(); ++j )
+	{
+		int thisColumn = this->GetColumnIndex( discreteParam[j] );
+		if( thisColumn < 0 )
+		{
+			cerr << "Observable name " << discreteParam[j].Name() << " not found in DataSet" << endl;
+			throw(-20);
+		}
+		wantedColumns.push_back( allColumns[(unsigned)thisColumn] );
+	}
+
+	for( unsigned int i=0; i< numberEvents; ++i )
+	{
+		bool decision = true;
+		for( unsigned int j=0; j< wantedColumns.size(); ++j )
+		{
+			if( !( fabs( wantedColumns[j][i] - discreteVal[j] ) < DOUBLE_TOLERANCE_DATA ) )
+			{
+				decision = false;
+				break;
+			}
+		}
+		if( decision ) output.push_back( i );
+	}
+
+	return output;
+}
+
+//Get the number of data points in the set
+int ColumnarDataSet::GetDataNumber( DataPoint* templateDataPoint ) const
+{
+	if( templateDataPoint == NULL ) return (int)numberEvents;
+
+	pair< vector<ObservableRef>, vector<double > > thisPointInfo = this->GetBoundary()->GetDiscreteInfo( templateDataPoint );
+	if( thisPointInfo.first.empty() || thisPointInfo.second.empty() ) return (int)numberEvents;
+	if( thisPointInfo.first.size() != thisPointInfo.second.size() ) return 0;
+	return (int) this->GetDiscreteIndices( thisPointInfo.first, thisPointInfo.second ).size();
+}
+
+vector<DataPoint> ColumnarDataSet::GetDiscreteSubSet( DataPoint* templateDataPoint ) const
+{
+	if( templateDataPoint == NULL )
+	{
+		vector<DataPoint> returnable_subset;
+		returnable_subset.reserve( numberEvents );
+		for( unsigned int i=0; i< numberEvents; ++i )
+		{
+			DataPoint* thisPoint = this->MakeDataPoint( i );
+			returnable_subset.push_back( *thisPoint );
+			delete thisPoint;
+		}
+		return returnable_subset;
+	}
+
+	pair< vector<ObservableRef>, vector<double > > thisPointInfo = this->GetBoundary()->GetDiscreteInfo( templateDataPoint );
+	return this->GetDiscreteSubSet( thisPointInfo.first, thisPointInfo.second );
+}
+
+vector<DataPoint> ColumnarDataSet::GetDiscreteSubSet( const vector<ObservableRef> discreteParam, const vector<double> discreteVal ) const
+{
+	if( discreteParam.empty() || discreteVal.empty() )
+	{
+		return this->GetDiscreteSubSet( (DataPoint*)NULL );
+	}
+
+	vector<DataPoint> returnable_subset;
+	if( discreteParam.size() != discreteVal.size() )
+	{
+		cerr << "\n\n\t\tBadly Defined definition of a subset, returning 0 events!\n\n" << endl;
+		return returnable_subset;
+	}
+
+	vector<unsigned int> wanted = this->GetDiscreteIndices( discreteParam, discreteVal );
+	returnable_subset.reserve( wanted.size() );
+	for( unsigned int i=0; i< wanted.size(); ++i )
+	{
+		DataPoint* thisPoint = this->MakeDataPoint( wanted[i] );
+		returnable_subset.push_back( *thisPoint );
+		delete thisPoint;
+	}
+
+	return returnable_subset;
+}
+
+vector<DataPoint> ColumnarDataSet::GetDiscreteSubSet( const vector<string> discreteParam, const vector<double> discreteVal ) const
+{
+	vector<ObservableRef> temp_ref;
+	for( unsigned int j=0; j< discreteParam.size(); ++j )
+	{
+		temp_ref.push_back( ObservableRef( discreteParam[j] ) );
+	}
+	return this->GetDiscreteSubSet( temp_ref, discreteVal );
+}
+
+IDataSet* ColumnarDataSet::GetDiscreteDataSet( const vector<ObservableRef> discreteParam, const vector<double> discreteVal ) const
+{
+	ColumnarDataSet* output = new ColumnarDataSet( dataBoundary );
+
+	if( discreteParam.empty() || discreteVal.empty() )
+	{
+		output->Reserve( numberEvents );
+		for( unsigned int i=0; i< numberEvents; ++i ) output->CopyEvent( this, i );
+	}
+	else if( discreteParam.size() == discreteVal.size() )
+	{
+		vector<unsigned int> wanted = this->GetDiscreteIndices( discreteParam, discreteVal );
+		output->Reserve( (unsigned)wanted.size() );
+		for( unsigned int i=0; i< wanted.size(); ++i ) output->CopyEvent( this, wanted[i] );
+	}
+	else
+	{
+		cerr << "\n\n\t\tBadly Defined definition of a subset, returning 0 events!\n\n" << endl;
+	}
+
+	if( useWeights )
+	{
+		output->useWeights = useWeights;
+		output->WeightName = WeightName;
+		output->alpha = alpha;
+		output->alphaName = alphaName;
+	}
+
+	return (IDataSet*) output;
+}
+
+//Get the data bound
+PhaseSpaceBoundary * ColumnarDataSet::GetBoundary() const
+{
+	return dataBoundary;
+}
+
+void ColumnarDataSet::SetBoundary( const PhaseSpaceBoundary* Input )
+{
+	delete dataBoundary;
+	dataBoundary = new PhaseSpaceBoundary( *Input );
+	templatePoint->SetPhaseSpaceBoundary( dataBoundary );
+	for( unsigned int i=0; i< numberEvents; ++i )
+	{
+		if( allViews[i] != NULL ) allViews[i]->SetPhaseSpaceBoundary( dataBoundary );
+	}
+}
+
+//Empty the data set
+void ColumnarDataSet::Clear()
+{
+	for( unsigned int i=0; i< allViews.size(); ++i )
+	{
+		if( allViews[i] != NULL ) delete allViews[i];
+	}
+	vector<DataPoint*> empty;
+	allViews.swap( empty );
+
+	for( unsigned int i=0; i< allNames.size(); ++i )
+	{
+		if( mappedRegion == NULL ) FreeColumn( allColumns[i] );
+		allColumns[i] = NULL;
+		FreeColumn( binNumColumns[i] );		binNumColumns[i] = NULL;
+		FreeColumn( acceptanceColumns[i] );	acceptanceColumns[i] = NULL;
+	}
+	FreeColumn( initialNLLColumn );	initialNLLColumn = NULL;
+	FreeColumn( weightColumn );	weightColumn = NULL;
+
+	this->Unmap();
+
+	numberEvents = 0;
+	capacity = 0;
+	valuesID = ColumnarDataSet::NewValuesID();
+}
+
+//	Sort all of the columns in the same order, any views which exist are updated so that view i still refers to event i
+void ColumnarDataSet::SortBy( string parameter )
+{
+	cout << "Sorting" << endl;
+	if( numberEvents > 0 )
+	{
+		int sortColumn = this->GetColumnIndex( ObservableRef( parameter ) );
+		if( sortColumn < 0 )
+		{
+			cerr << "Observable name " << parameter << " not found in DataSet" << endl;
+			throw(-20);
+		}
+
+		vector<pair<double,unsigned int> > order;
+		order.reserve( numberEvents );
+		for( unsigned int i=0; i< numberEvents; ++i ) order.push_back( make_pair( allColumns[(unsigned)sortColumn][i], i ) );
+		stable_sort( order.begin(), order.end() );
+
+		double* tempDouble = (double*) AllocateColumn( sizeof(double)*numberEvents );
+		int* tempInt = (int*) AllocateColumn( sizeof(int)*numberEvents );
+
+		for( unsigned int col=0; col< allNames.size(); ++col )
+		{
+			for( unsigned int i=0; i< numberEvents; ++i ) tempDouble[i] = allColumns[col][order[i].second];
+			memcpy( allColumns[col], tempDouble, sizeof(double)*numberEvents );
+			for( unsigned int i=0; i< numberEvents; ++i ) tempDouble[i] = acceptanceColumns[col][order[i].second];
+			memcpy( acceptanceColumns[col], tempDouble, sizeof(double)*numberEvents );
+			for( unsigned int i=0; i< numberEvents; ++i ) tempInt[i] = binNumColumns[col][order[i].second];
+			memcpy( binNumColumns[col], tempInt, sizeof(int)*numberEvents );
+		}
+		for( unsigned int i=0; i< numberEvents; ++i ) tempDouble[i] = initialNLLColumn[order[i].second];
+		memcpy( initialNLLColumn, tempDouble, sizeof(double)*numberEvents );
+		for( unsigned int i=0; i< numberEvents; ++i ) tempDouble[i] = weightColumn[order[i].second];
+		memcpy( weightColumn, tempDouble, sizeof(double)*numberEvents );
+
+		FreeColumn( tempDouble );
+		FreeColumn( tempInt );
+
+		valuesID = ColumnarDataSet::NewValuesID();
+		this->RefreshAllViews();
+
+		cout << numberEvents << endl;
+	}
+	cout << "Sorted" << endl;
+}
+
+unsigned int ColumnarDataSet::GetNumberObservables() const
+{
+	return (unsigned int) allNames.size();
+}
+
+vector<string> ColumnarDataSet::GetObservableNames() const
+{
+	return allNames;
+}
+
+int ColumnarDataSet::GetColumnIndex( const ObservableRef& Name ) const
+{
+	int thisIndex = Name.GetIndex();
+	if( thisIndex >= 0 && thisIndex < (int)allNames.size() )
+	{
+		if( allNames[(unsigned)thisIndex] == *(Name.NameRef()) ) return thisIndex;
+	}
+	thisIndex = StringProcessing::VectorContains( &allNames, Name.NameRef() );
+	if( thisIndex >= 0 ) Name.SetIndex( thisIndex );
+	return thisIndex;
+}
+
+const double* ColumnarDataSet::GetColumn( const unsigned int column ) const
+{
+	return allColumns[column];
+}
+
+int* ColumnarDataSet::GetBinNumberColumn( const unsigned int column ) const
+{
+	return binNumColumns[column];
+}
+
+double* ColumnarDataSet::GetAcceptanceColumn( const unsigned int column ) const
+{
+	return acceptanceColumns[column];
+}
+
+double* ColumnarDataSet::GetInitialNLLColumn() const
+{
+	return initialNLLColumn;
+}
+
+const double* ColumnarDataSet::GetEventWeightColumn() const
+{
+	return weightColumn;
+}
+
+size_t ColumnarDataSet::GetValuesID() const
+{
+	return valuesID;
+}
+
+size_t ColumnarDataSet::NewValuesID()
+{
+	static size_t lastID = 0;
+	return __sync_add_and_fetch( &lastID, (size_t) 1 );
+}
+
+double ColumnarDataSet::Yield()
+{
+	if( useWeights )	return this->GetSumWeights();
+	else			return this->GetDataNumber();
+}
+
+double ColumnarDataSet::YieldError()
+{
+	if( useWeights )	return sqrt( this->GetSumWeightsSq() );
+	else			return sqrt( this->GetDataNumber() );
+}
+
+string ColumnarDataSet::GetWeightName() const
+{
+	return WeightName;
+}
+
+bool ColumnarDataSet::GetWeightsWereUsed() const
+{
+	return useWeights;
+}
+
+void ColumnarDataSet::UseEventWeights( const string Name )
+{
+	int weightColumnIndex = this->GetColumnIndex( ObservableRef( Name ) );
+	if( weightColumnIndex < 0 )
+	{
+		cerr << "Observable name " << Name << " not found in DataSet" << endl;
+		throw(-20);
+	}
+	WeightName = Name;
+	useWeights = true;
+	memcpy( weightColumn, allColumns[(unsigned)weightColumnIndex], sizeof(double)*numberEvents );
+	this->RefreshAllViews();
+}
+
+void ColumnarDataSet::NormaliseWeights()
+{
+	if( useWeights )
+	{
+		double sum_Val=0.;
+		double sum_Val2=0.;
+		for( unsigned int i=0; i< numberEvents; ++i )
+		{
+			double thisVal=weightColumn[i];
+			sum_Val += thisVal;
+			sum_Val2 += thisVal*thisVal;
+		}
+
+		this->ApplyAlpha( sum_Val, sum_Val2 );
+	}
+}
+
+double ColumnarDataSet::GetSumWeights()
+{
+	if( this->GetWeightsWereUsed() )
+	{
+		const double* weights = allColumns[(unsigned)this->GetColumnIndex( ObservableRef( WeightName ) )];
+		double total=0.;
+		for( unsigned int i=0; i< numberEvents; ++i ) total+=weights[i];
+		return total;
+	}
+	else
+	{
+		return (double)this->GetDataNumber();
+	}
+}
+
+double ColumnarDataSet::GetSumWeightsSq()
+{
+	if( this->GetWeightsWereUsed() )
+	{
+		const double* weights = allColumns[(unsigned)this->GetColumnIndex( ObservableRef( WeightName ) )];
+		double total=0.;
+		for( unsigned int i=0; i< numberEvents; ++i ) total+=weights[i]*weights[i];
+		return total;
+	}
+	else
+	{
+		return (double)this->GetDataNumber();
+	}
+}
+
+void ColumnarDataSet::ApplyAlpha( const double total_sum, const double total_sum_sq )
+{
+	alpha= fabs(total_sum / total_sum_sq);
+	const double* weights = allColumns[(unsigned)this->GetColumnIndex( ObservableRef( WeightName ) )];
+	for( unsigned int i=0; i< numberEvents; ++i ) weightColumn[i] = weights[i] * alpha;
+	this->RefreshAllViews();
+	cout << "alpha = " << setprecision(10) << total_sum << "  /  " << total_sum_sq << endl;
+	cout << "Correction Factor: " << setprecision(5) << fabs(alpha) << " applied to DataSet containing " << numberEvents << " events." << endl << endl;
+}
+
+double ColumnarDataSet::GetAlpha()
+{
+	if( alphaName != "uninitialized" )
+	{
+		const double* alphas = allColumns[(unsigned)this->GetColumnIndex( ObservableRef( alphaName ) )];
+		double alphaSum=0.;
+		for( unsigned int i=0; i< numberEvents; ++i ) alphaSum+=alphas[i];
+		alphaSum/=(double)numberEvents;
+		return fabs(alphaSum);
+	}
+	else
+	{
+		return alpha;
+	}
+}
+
+void ColumnarDataSet::ApplyExternalAlpha( const string AlphaName )
+{
+	int alphaColumnIndex = this->GetColumnIndex( ObservableRef( AlphaName ) );
+	if( alphaColumnIndex < 0 )
+	{
+		cerr << "Observable name " << AlphaName << " not found in DataSet" << endl;
+		throw(-20);
+	}
+	alphaName = AlphaName;
+	const double* alphas = allColumns[(unsigned)alphaColumnIndex];
+	const double* weights = allColumns[(unsigned)this->GetColumnIndex( ObservableRef( WeightName ) )];
+	double avr=0.;
+	for( unsigned int i=0; i< numberEvents; ++i )
+	{
+		weightColumn[i] = weights[i] * alphas[i];
+		avr+=alphas[i];
+	}
+	avr/=(double)numberEvents;
+	this->RefreshAllViews();
+	cout << "Using Observable: " << alphaName << " to apply a per-event alpha correction to the per-event weights used. Average Weight: " << avr << endl << endl;
+}
+
+void ColumnarDataSet::PrintYield()
+{
+	cout << "Total Yield = " << this->Yield() << " ± " << this->YieldError() << endl;
+	this->Print();
+}
+
+void ColumnarDataSet::Print()
+{
+	const double* weights = NULL;
+	if( this->GetWeightsWereUsed() && numberEvents > 0 )
+	{
+		weights = allColumns[(unsigned)this->GetColumnIndex( ObservableRef( WeightName ) )];
+		double total=0.;
+		double err=0.;
+		for( unsigned int i=0; i< numberEvents; ++i )
+		{
+			total+=weights[i];
+			err+=weights[i]*weights[i];
+		}
+		err = sqrt(err);
+		cout << "DataSet contains a total of:     " << total << " ± " << err << "     SIGNAL events.(" << numberEvents << " total). In " << this->GetBoundary()->GetNumberCombinations() << " Discrete DataSets." << endl;
+	}
+	else
+	{
+		cout << "DataSet contains a total of:     " << numberEvents << "     events. In " << this->GetBoundary()->GetNumberCombinations() << " Discrete DataSets." << endl;
+	}
+
+	if( this->GetBoundary()->GetNumberCombinations() > 1 && this->GetBoundary()->GetNumberCombinations() < 20 )
+	{
+		vector<DataPoint*> combinations = this->GetBoundary()->GetDiscreteCombinations();
+		for( unsigned int i=0; i< combinations.size(); ++i )
+		{
+			string description = this->GetBoundary()->DiscreteDescription( combinations[i] );
+			for( unsigned int j=0; j< description.size(); ++j )
+			{
+				if( description[j] == '\n' ) description[j] = ' ';
+				if( description[j] == '\t' ) description[j] = ' ';
+			}
+			pair< vector<ObservableRef>, vector<double > > thisPointInfo = this->GetBoundary()->GetDiscreteInfo( combinations[i] );
+			vector<unsigned int> thisData = this->GetDiscreteIndices( thisPointInfo.first, thisPointInfo.second );
+			double this_yield=0.;
+			if( weights != NULL )
+			{
+				for( unsigned int k=0; k< thisData.size(); ++k ) this_yield += weights[thisData[k]];
+			}
+			if( !thisData.empty() )
+			{
+				cout << "Combination: " << description << " has: " << thisData.size() << " events";
+				if( weights != NULL ) cout << " and " << this_yield << " yield." << endl;
+				else cout << "." << endl;
+			}
+		}
+	}
+}
+
+uint64_t ColumnarDataSet::Checksum( const void* data, const size_t bytes, const uint64_t initial )
+{
+	const unsigned char* input = (const unsigned char*) data;
+	uint64_t output = initial;
+	for( size_t i=0; i< bytes; ++i )
+	{
+		output ^= (uint64_t) input[i];
+		output *= 1099511628211ULL;
+	}
+	return output;
+}
+
+uint64_t ColumnarDataSet::NumberCacheBlocks( const CacheLayout& layout )
+{
+	if( layout.events == 0 || layout.blockEvents == 0 ) return 0;
+	return ( layout.events + layout.blockEvents - 1 ) / layout.blockEvents;
+}
+
+//	Layout of the fixed part of the cache header
+//
+//	char[8]		magic
+//	uint32_t	version
+//	uint32_t	number of Observables
+//	uint64_t	number of events
+//	uint64_t	bytes from the start of one column to the next
+//	uint64_t	offset of the first column from the start of the file
+//	uint64_t	length of the key
+//	uint64_t	number of events in each checksummed block
+//
+//	followed by the key, the names as uint32_t length + characters, the checksum of each block of each column,
+//	and the checksum of everything before it
+static const char RAPIDFIT_EVENT_CACHE_MAGIC[8] = { 'R', 'F', 'E', 'V', 'C', 'A', 'C', 'H' };
+
+static uint64_t RoundToAlignment( const uint64_t bytes )
+{
+	return ( ( bytes + RAPIDFIT_COLUMN_ALIGNMENT - 1 ) / RAPIDFIT_COLUMN_ALIGNMENT ) * RAPIDFIT_COLUMN_ALIGNMENT;
+}
+
+template<class T> static void AppendBytes( string& output, const T& input )
+{
+	output.append( (const char*) &input, sizeof(T) );
+}
+
+template<class T> static bool ReadBytes( const char* input, const size_t bytes, size_t& position, T& output )
+{
+	if( position + sizeof(T) > bytes ) return false;
+	memcpy( &output, input + position, sizeof(T) );
+	position += sizeof(T);
+	return true;
+}
+
+bool ColumnarDataSet::WriteCache( const string path, const string key ) const
+{
+	const uint32_t version = RAPIDFIT_EVENT_CACHE_VERSION;
+	const uint32_t numberColumns = (uint32_t) allNames.size();
+	const uint64_t events = numberEvents;
+	const uint64_t stride = RoundToAlignment( sizeof(double)*events );
+
+	CacheLayout layout;
+	layout.events = events;
+	layout.blockEvents = RAPIDFIT_CACHE_CHECKSUM_EVENTS;
+	const uint64_t numberBlocks = NumberCacheBlocks( layout );
+
+	uint64_t headerBytes = sizeof(RAPIDFIT_EVENT_CACHE_MAGIC) + 2*sizeof(uint32_t) + 5*sizeof(uint64_t) + key.size() + sizeof(uint64_t);
+	for( unsigned int i=0; i< allNames.size(); ++i ) headerBytes += sizeof(uint32_t) + allNames[i].size();
+	headerBytes += allNames.size()*numberBlocks*sizeof(uint64_t);
+	const uint64_t dataOffset = RoundToAlignment( headerBytes );
+
+	string header;
+	header.append( RAPIDFIT_EVENT_CACHE_MAGIC, sizeof(RAPIDFIT_EVENT_CACHE_MAGIC) );
+	AppendBytes( header, version );
+	AppendBytes( header, numberColumns );
+	AppendBytes( header, events );
+	AppendBytes( header, stride );
+	AppendBytes( header, dataOffset );
+	AppendBytes( header, (uint64_t) key.size() );
+	AppendBytes( header, layout.blockEvents );
+	header.append( key );
+	for( unsigned int i=0; i< allNames.size(); ++i )
+	{
+		AppendBytes( header, (uint32_t) allNames[i].size() );
+		header.append( allNames[i] );
+	}
+	for( unsigned int i=0; i< allNames.size(); ++i )
+	{
+		for( uint64_t block=0; block< numberBlocks; ++block )
+		{
+			const uint64_t blockStart = block*layout.blockEvents;
+			const uint64_t blockSize = min( layout.blockEvents, events - blockStart );
+			AppendBytes( header, Checksum( allColumns[i] + blockStart, sizeof(double)*blockSize ) );
+		}
+	}
+	AppendBytes( header, Checksum( header.data(), header.size() ) );
+	header.append( (size_t)( dataOffset - header.size() ), '\0' );
+
+	stringstream tempName;
+	tempName << path << ".tmp";
+#ifndef _WIN32
+	tempName << "." << getpid();
+#endif
+
+	FILE* output = fopen( tempName.str().c_str(), "wb" );
+	if( output == NULL )
+	{
+		cerr << "ColumnarDataSet: Cannot write event cache " << tempName.str() << endl;
+		return false;
+	}
+
+	const string padding( (size_t)( stride - sizeof(double)*events ), '\0' );
+	bool written = fwrite( header.data(), 1, header.size(), output ) == header.size();
+	for( unsigned int i=0; written && i< allNames.size(); ++i )
+	{
+		if( numberEvents > 0 ) written = fwrite( allColumns[i], sizeof(double), numberEvents, output ) == numberEvents;
+		if( written && !padding.empty() ) written = fwrite( padding.data(), 1, padding.size(), output ) == padding.size();
+	}
+	written = ( fclose( output ) == 0 ) && written;
+
+	if( !written || rename( tempName.str().c_str(), path.c_str() ) != 0 )
+	{
+		cerr << "ColumnarDataSet: Failed to write event cache " << path << endl;
+		remove( tempName.str().c_str() );
+		return false;
+	}
+	return true;
+}
+
+string ColumnarDataSet::ReadCacheHeader( const char* input, const size_t bytes, const string key, const vector<string>& wantedNames, CacheLayout& layout )
+{
+	size_t position = 0;
+
+	char magic[sizeof(RAPIDFIT_EVENT_CACHE_MAGIC)];
+	uint32_t version=0, numberColumns=0;
+	uint64_t keyBytes=0, headerChecksum=0;
+
+	if( !ReadBytes( input, bytes, position, magic ) || memcmp( magic, RAPIDFIT_EVENT_CACHE_MAGIC, sizeof(magic) ) != 0 ) return "not an event cache";
+	if( !ReadBytes( input, bytes, position, version ) || version != RAPIDFIT_EVENT_CACHE_VERSION ) return "written by a different version";
+	if( !ReadBytes( input, bytes, position, numberColumns ) || !ReadBytes( input, bytes, position, layout.events ) || !ReadBytes( input, bytes, position, layout.stride )
+		|| !ReadBytes( input, bytes, position, layout.dataOffset ) || !ReadBytes( input, bytes, position, keyBytes ) || !ReadBytes( input, bytes, position, layout.blockEvents ) )
+	{
+		return "truncated";
+	}
+	if( keyBytes != key.size() || position + keyBytes > bytes || memcmp( input + position, key.data(), key.size() ) != 0 ) return "stale";
+	if( numberColumns != wantedNames.size() ) return "stale";
+
+	position += (size_t) keyBytes;
+	for( unsigned int i=0; i< numberColumns; ++i )
+	{
+		uint32_t nameBytes=0;
+		if( !ReadBytes( input, bytes, position, nameBytes ) || position + nameBytes > bytes ) return "truncated";
+		if( string( input + position, nameBytes ) != wantedNames[i] ) return "stale";
+		position += nameBytes;
+	}
+
+	if( layout.blockEvents == 0 ) return "corrupt header";
+	const uint64_t numberBlocks = NumberCacheBlocks( layout );
+	if( numberColumns > 0 && numberBlocks > ( bytes - position ) / ( sizeof(uint64_t)*numberColumns ) ) return "truncated";
+	layout.blockChecksums.resize( (size_t)( numberColumns*numberBlocks ) );
+	for( size_t i=0; i< layout.blockChecksums.size(); ++i )
+	{
+		if( !ReadBytes( input, bytes, position, layout.blockChecksums[i] ) ) return "truncated";
+	}
+
+	const uint64_t expectedChecksum = Checksum( input, position );
+	if( !ReadBytes( input, bytes, position, headerChecksum ) || headerChecksum != expectedChecksum ) return "corrupt header";
+	if( layout.events >= (uint64_t) numeric_limits<unsigned int>::max() || layout.stride < sizeof(double)*layout.events || layout.stride % RAPIDFIT_COLUMN_ALIGNMENT != 0
+		|| layout.dataOffset % RAPIDFIT_COLUMN_ALIGNMENT != 0 || layout.dataOffset < position || layout.dataOffset + numberColumns*layout.stride > bytes )
+	{
+		return "corrupt header";
+	}
+
+	return "";
+}
+
+ColumnarDataSet* ColumnarDataSet::ReadCache( const string path, const string key, PhaseSpaceBoundary* NewBoundary )
+{
+#ifdef _WIN32
+	(void) path; (void) key; (void) NewBoundary;
+	return NULL;
+#else
+	int fileDescriptor = open( path.c_str(), O_RDONLY );
+	if( fileDescriptor < 0 ) return NULL;
+
+	struct stat fileInfo;
+	if( fstat( fileDescriptor, &fileInfo ) != 0 || fileInfo.st_size <= 0 )
+	{
+		close( fileDescriptor );
+		return NULL;
+	}
+	const size_t bytes = (size_t) fileInfo.st_size;
+
+	//	Private so that changes to the values, e.g. from SortBy, stay in this process
+	void* region = mmap( NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileDescriptor, 0 );
+	close( fileDescriptor );
+	if( region == MAP_FAILED ) return NULL;
+
+	const char* input = (const char*) region;
+	vector<string> wantedNames = NewBoundary->GetAllNames();
+	CacheLayout layout;
+	string problem = ReadCacheHeader( input, bytes, key, wantedNames, layout );
+
+	if( problem.empty() && !CheckMappedBlocks( input, layout, (unsigned) wantedNames.size() ) ) problem = "corrupt data";
+
+	if( !problem.empty() )
+	{
+		cout << "Ignoring event cache " << path << ": " << problem << endl;
+		munmap( region, bytes );
+		return NULL;
+	}
+
+	ColumnarDataSet* output = new ColumnarDataSet( NewBoundary );
+	output->AdoptMapping( region, bytes, layout.dataOffset, layout.stride, (unsigned int) layout.events );
+	return output;
+#endif
+}
+
+bool ColumnarDataSet::CheckMappedBlocks( const char* input, const CacheLayout& layout, const unsigned int numberColumns )
+{
+	const uint64_t totalBlocks = numberColumns*NumberCacheBlocks( layout );
+	if( totalBlocks == 0 ) return true;
+
+	int cores = Threading::numCores();
+	const unsigned int numberThreads = (unsigned) min( (uint64_t)( cores > 0 ? cores : 1 ), totalBlocks );
+
+	vector<BlockCheck_Thread> threadData( numberThreads );
+	vector<pthread_t> threads( numberThreads );
+	vector<bool> started( numberThreads, false );
+	for( unsigned int t=0; t< numberThreads; ++t )
+	{
+		threadData[t].input = input;
+		threadData[t].layout = &layout;
+		threadData[t].firstBlock = ( t*totalBlocks ) / numberThreads;
+		threadData[t].numberBlocks = ( (t+1)*totalBlocks ) / numberThreads - threadData[t].firstBlock;
+		threadData[t].isOK = false;
+		//	The first share is checked here once the others are running
+		if( t > 0 ) started[t] = pthread_create( &(threads[t]), NULL, CheckMappedBlocks_pthread, (void*) &(threadData[t]) ) == 0;
+	}
+
+	bool isOK = true;
+	for( unsigned int t=0; t< numberThreads; ++t )
+	{
+		if( started[t] ) pthread_join( threads[t], NULL );
+		else CheckMappedBlocks_pthread( (void*) &(threadData[t]) );
+		isOK = isOK && threadData[t].isOK;
+	}
+	return isOK;
+}
+
+void* ColumnarDataSet::CheckMappedBlocks_pthread( void* input )
+{
+	BlockCheck_Thread* thisData = (BlockCheck_Thread*) input;
+	const CacheLayout* layout = thisData->layout;
+	const uint64_t numberBlocks = NumberCacheBlocks( *layout );
+
+	thisData->isOK = true;
+	for( uint64_t i=thisData->firstBlock; i< thisData->firstBlock + thisData->numberBlocks && thisData->isOK; ++i )
+	{
+		const uint64_t column = i / numberBlocks;
+		const uint64_t blockStart = ( i % numberBlocks )*layout->blockEvents;
+		const uint64_t blockSize = min( layout->blockEvents, layout->events - blockStart );
+		const char* values = thisData->input + layout->dataOffset + column*layout->stride + sizeof(double)*blockStart;
+		thisData->isOK = Checksum( values, sizeof(double)*blockSize ) == layout->blockChecksums[(size_t)i];
+	}
+	return NULL;
+}
+
+bool ColumnarDataSet::ReadCacheRange( const int fileDescriptor, const CacheLayout& layout, const unsigned int first, const unsigned int number )
+{
+#ifdef _WIN32
+	(void) fileDescriptor; (void) layout; (void) first; (void) number;
+	return false;
+#else
+	for( unsigned int i=0; i< allViews.size(); ++i )
+	{
+		if( allViews[i] != NULL ) delete allViews[i];
+	}
+	allViews.assign( number, NULL );
+
+	//	Values mapped from a whole cache file can't be reused, let Grow replace all of the columns
+	if( mappedRegion != NULL )
+	{
+		for( unsigned int i=0; i< allNames.size(); ++i ) allColumns[i] = NULL;
+		capacity = 0;
+		this->Unmap();
+	}
+
+	//	Keep the columns which are already big enough
+	numberEvents = 0;
+	this->Grow( number );
+
+	bool isOK = true;
+	for( unsigned int i=0; i< allNames.size(); ++i )
+	{
+		char* output = (char*) allColumns[i];
+		size_t wanted = sizeof(double)*number;
+		off_t offset = (off_t)( layout.dataOffset + i*layout.stride + sizeof(double)*first );
+		while( isOK && wanted > 0 )
+		{
+			ssize_t found = pread( fileDescriptor, output, wanted, offset );
+			if( found <= 0 ) isOK = false;
+			else
+			{
+				output += found;
+				offset += found;
+				wanted -= (size_t) found;
+			}
+		}
+		if( isOK && !CheckCacheRange( fileDescriptor, layout, i, allColumns[i], first, number ) )
+		{
+			cerr << "ColumnarDataSet: Events " << first << " to " << first+number << " of " << allNames[i] << " in the event cache fail their checksum" << endl;
+			isOK = false;
+		}
+		for( unsigned int j=0; j< number; ++j )
+		{
+			binNumColumns[i][j] = -1;
+			acceptanceColumns[i][j] = -1.;
+		}
+	}
+	for( unsigned int j=0; j< number; ++j )
+	{
+		initialNLLColumn[j] = numeric_limits<double>::quiet_NaN();
+		weightColumn[j] = 1.;
+	}
+	useWeights = false;
+	numberEvents = number;
+
+	return isOK;
+#endif
+}
+
+bool ColumnarDataSet::CheckCacheRange( const int fileDescriptor, const CacheLayout& layout, const unsigned int column, const double* values, const unsigned int first, const unsigned int number )
+{
+#ifdef _WIN32
+	(void) fileDescriptor; (void) layout; (void) column; (void) values; (void) first; (void) number;
+	return false;
+#else
+	if( number == 0 ) return true;
+
+	const uint64_t numberBlocks = NumberCacheBlocks( layout );
+	const uint64_t last = (uint64_t) first + number;
+	vector<char> edge;
+	for( uint64_t block = first / layout.blockEvents; block <= ( last-1 ) / layout.blockEvents; ++block )
+	{
+		const uint64_t blockStart = block*layout.blockEvents;
+		const uint64_t blockEnd = min( blockStart + layout.blockEvents, layout.events );
+
+		//	Whatever part of the block lies outside the events in memory is read from the file, before and after them
+		uint64_t thisChecksum = Checksum( NULL, 0 );
+		for( unsigned int side=0; side< 3; ++side )
+		{
+			uint64_t start = side == 0 ? blockStart : ( side == 1 ? max( blockStart, (uint64_t) first ) : last );
+			const uint64_t end = side == 0 ? min( blockEnd, (uint64_t) first ) : ( side == 1 ? min( blockEnd, last ) : blockEnd );
+			if( start >= end ) continue;
+
+			if( side == 1 )
+			{
+				thisChecksum = Checksum( values + ( start - first ), sizeof(double)*( end - start ), thisChecksum );
+				continue;
+			}
+
+			edge.resize( (size_t)( sizeof(double)*( end - start ) ) );
+			size_t done = 0;
+			while( done < edge.size() )
+			{
+				ssize_t found = pread( fileDescriptor, &(edge[done]), edge.size() - done, (off_t)( layout.dataOffset + column*layout.stride + sizeof(double)*start + done ) );
+				if( found <= 0 ) return false;
+				done += (size_t) found;
+			}
+			thisChecksum = Checksum( &(edge[0]), edge.size(), thisChecksum );
+		}
+
+		if( thisChecksum != layout.blockChecksums[(size_t)( column*numberBlocks + block )] ) return false;
+	}
+	return true;
+#endif
+}
+
+void ColumnarDataSet::SetEventWeights( const string weightName, const double scale, const string scaleName )
+{
+	const double* weights = allColumns[(unsigned)this->GetColumnIndex( ObservableRef( weightName ) )];
+	const double* scales = scaleName.empty() ? NULL : allColumns[(unsigned)this->GetColumnIndex( ObservableRef( scaleName ) )];
+	for( unsigned int i=0; i< numberEvents; ++i )
+	{
+		weightColumn[i] = weights[i] * scale;
+		if( scales != NULL ) weightColumn[i] *= scales[i];
+	}
+	WeightName = weightName;
+	useWeights = true;
+	alpha = scale;
+	alphaName = scaleName.empty() ? "uninitialized" : scaleName;
+	this->RefreshAllViews();
+}
+
+void ColumnarDataSet::AdoptMapping( void* region, const size_t bytes, const uint64_t dataOffset, const uint64_t stride, const unsigned int events )
+{
+	this->Clear();
+
+	mappedRegion = region;
+	mappedBytes = bytes;
+
+	for( unsigned int i=0; i< allNames.size(); ++i )
+	{
+		allColumns[i] = (double*)( (char*) region + dataOffset + i*stride );
+		binNumColumns[i] = (int*) AllocateColumn( sizeof(int)*events );
+		acceptanceColumns[i] = (double*) AllocateColumn( sizeof(double)*events );
+		for( unsigned int j=0; j< events; ++j )
+		{
+			binNumColumns[i][j] = -1;
+			acceptanceColumns[i][j] = -1.;
+		}
+	}
+	initialNLLColumn = (double*) AllocateColumn( sizeof(double)*events );
+	weightColumn = (double*) AllocateColumn( sizeof(double)*events );
+	for( unsigned int j=0; j< events; ++j )
+	{
+		initialNLLColumn[j] = numeric_limits<double>::quiet_NaN();
+		weightColumn[j] = 1.;
+	}
+
+	allViews.assign( events, NULL );
+	numberEvents = events;
+	capacity = events;
+}
+
+void ColumnarDataSet::Unmap()
+{
+	if( mappedRegion == NULL ) return;
+#ifndef _WIN32
+	munmap( mappedRegion, mappedBytes );
+#endif
+	mappedRegion = NULL;
+	mappedBytes = 0;
+}
@@ -2138,6 +2138,7 @@ string ComponentPlotter::XML( int projectionType )
 	xml << "\t" << "<UseSpline>" << "True/False" << "</UseSpline> # Use a Spline to interpolate between PDF points" << endl;
 	xml << "\t" << "<Threads>" << "NumberOfThreads" << "</Threads> # Number of Threads that GSL will use when multi-threading" << endl;
 	xml << "\t" << "<FixedIntegrationPoints>" << "numberOfPointsPerGSLIntegral" << "</FixedIntegrationPoints> # Set the Number of points for GSL to use to be non default" << endl;
+	xml << "\t" << "<IntegrationPrecision>" << "relativePrecision" << "</IntegrationPrecision> # Add GSL points until this precision is reached, FixedIntegrationPoints is then the maximum" << endl;
 	xml << "\t" << "<UseGSLNumericalIntegration>" << "True/False" << "</UseGSLNumericalIntegration> # Use the GSL Integrator for projections, this is multi-threaded so better" << endl;
 	xml << "\t" << "<StyleKey>" << "LineStyle1:LineStyle2:LineStyle3:..." << "</StyleKey> # Styles to use for different lines" << endl;
 	xml << "\t" << "<ColorKey>" << "LineColor1:LineColor2:LineColor3:..." << "</ColorKey> # Colors to use for different lines" << endl;
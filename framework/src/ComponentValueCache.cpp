@@ -0,0 +1,142 @@
+
+//	RapidFit Headers
+#include "ComponentValueCache.h"
+#include "ColumnarDataSet.h"
+//	System Headers
+#include <vector>
+#include <map>
+
+using namespace::std;
+
+//	About 100MB of cache, beyond this the events are probably being streamed through rather than fitted repeatedly
+const unsigned int ComponentValueCache::maxCachedEvents = 4000000;
+
+ComponentValueCache::ComponentValueCache() : blockLookup(), columnLookup(), allBlocks(), cachedEvents(), cachedValues()
+{
+}
+
+ComponentValueCache::ComponentValueCache( const ComponentValueCache& input ) : blockLookup(), columnLookup(), allBlocks(), cachedEvents(), cachedValues()
+{
+	(void) input;
+}
+
+ComponentValueCache::~ComponentValueCache()
+{
+}
+
+void ComponentValueCache::Clear()
+{
+	blockLookup.clear();
+	columnLookup.clear();
+	vector<CachedBlock>().swap( allBlocks );
+	vector<CachedEvent>().swap( cachedEvents );
+	vector<double>().swap( cachedValues );
+}
+
+unsigned int ComponentValueCache::GetNumberEvents() const
+{
+	return (unsigned int) cachedValues.size();
+}
+
+int ComponentValueCache::FindBlock( const EventBlock& Input ) const
+{
+	if( Input.HasColumns() )
+	{
+		map<pair<size_t, unsigned int>, unsigned int>::const_iterator found =
+			columnLookup.find( make_pair( Input.GetColumnData()->GetValuesID(), Input.GetFirstEvent() ) );
+		if( found == columnLookup.end() || allBlocks[ found->second ].nEvents != Input.GetNumberEvents() ) return -1;
+		return (int) found->second;
+	}
+
+	map<DataPoint*, unsigned int>::const_iterator found = blockLookup.find( Input.GetDataPoint( 0 ) );
+	if( found == blockLookup.end() ) return -1;
+
+	const CachedBlock& thisBlock = allBlocks[ found->second ];
+	if( thisBlock.columnar || thisBlock.nEvents != Input.GetNumberEvents() ) return -1;
+
+	DataPoint** points = Input.GetDataPoints();
+	const CachedEvent* stored = &(cachedEvents[ thisBlock.offset ]);
+	for( unsigned int i=0; i< thisBlock.nEvents; ++i )
+	{
+		if( points[i] != stored[i].point ) return -1;
+	}
+
+	return (int) found->second;
+}
+
+bool ComponentValueCache::IsCurrent( const CachedBlock& thisBlock, const EventBlock& Input ) const
+{
+	//	The values ID of the columns changes whenever the stored events do
+	if( thisBlock.columnar ) return true;
+
+	DataPoint** points = Input.GetDataPoints();
+	const CachedEvent* stored = &(cachedEvents[ thisBlock.offset ]);
+	for( unsigned int i=0; i< thisBlock.nEvents; ++i )
+	{
+		if( points[i]->GetDataID() != stored[i].dataID || points[i]->GetDataGeneration() != stored[i].dataGeneration ) return false;
+	}
+	return true;
+}
+
+void ComponentValueCache::StoreEvents( const CachedBlock& thisBlock, const EventBlock& Input )
+{
+	if( thisBlock.columnar ) return;
+
+	DataPoint** points = Input.GetDataPoints();
+	CachedEvent* stored = &(cachedEvents[ thisBlock.offset ]);
+	for( unsigned int i=0; i< thisBlock.nEvents; ++i )
+	{
+		stored[i].point = points[i];
+		stored[i].dataID = points[i]->GetDataID();
+		stored[i].dataGeneration = points[i]->GetDataGeneration();
+	}
+}
+
+void ComponentValueCache::EvaluateBatch( IPDF* thisPDF, const EventBlock& Input, double* out )
+{
+	const unsigned int number = Input.GetNumberEvents();
+	if( number == 0 ) return;
+
+	const unsigned int version = thisPDF->GetParameterVersion();
+
+	int blockIndex = this->FindBlock( Input );
+
+	if( blockIndex >= 0 && allBlocks[(unsigned)blockIndex].version == version && this->IsCurrent( allBlocks[(unsigned)blockIndex], Input ) )
+	{
+		const double* stored = &(cachedValues[ allBlocks[(unsigned)blockIndex].offset ]);
+		for( unsigned int i=0; i< number; ++i ) out[i] = stored[i];
+		return;
+	}
+
+	thisPDF->EvaluateBatch( Input, out );
+
+	if( blockIndex < 0 )
+	{
+		const bool columnar = Input.HasColumns();
+		pair<size_t, unsigned int> columnKey( 0, 0 );
+		if( columnar ) columnKey = make_pair( Input.GetColumnData()->GetValuesID(), Input.GetFirstEvent() );
+
+		//	The blocks are split differently to before, start again rather than keep overlapping copies of the same events
+		if( columnar && columnLookup.find( columnKey ) != columnLookup.end() ) this->Clear();
+		if( !columnar && blockLookup.find( Input.GetDataPoint( 0 ) ) != blockLookup.end() ) this->Clear();
+		if( cachedValues.size() + number > maxCachedEvents ) this->Clear();
+
+		CachedBlock newBlock;
+		newBlock.offset = (unsigned int) cachedValues.size();
+		newBlock.nEvents = number;
+		newBlock.columnar = columnar;
+		cachedEvents.resize( cachedEvents.size() + number );
+		cachedValues.resize( cachedValues.size() + number );
+		if( columnar ) columnLookup[ columnKey ] = (unsigned int) allBlocks.size();
+		else blockLookup[ Input.GetDataPoint( 0 ) ] = (unsigned int) allBlocks.size();
+		allBlocks.push_back( newBlock );
+		blockIndex = (int) allBlocks.size() - 1;
+	}
+
+	CachedBlock& thisBlock = allBlocks[(unsigned)blockIndex];
+	thisBlock.version = version;
+	this->StoreEvents( thisBlock, Input );
+	double* stored = &(cachedValues[ thisBlock.offset ]);
+	for( unsigned int i=0; i< number; ++i ) stored[i] = out[i];
+}
+
@@ -19,19 +19,22 @@
 #include <stdlib.h>
 #include <iomanip>
 #include <limits>
+#include <pthread.h>
+#include <stdint.h>
 
 using namespace::std;
 
 //	Required for Sorting
 DataPoint::DataPoint() : allObservables(), allNames(), myPhaseSpaceBoundary(NULL), thisDiscreteIndex(-1),
-	WeightValue(1.), storedID(0), initialNLL( numeric_limits<double>::quiet_NaN() ), PerEventData(), nameIndex(), DiscreteIndexMap()
+	WeightValue(1.), storedID(0), initialNLL( numeric_limits<double>::quiet_NaN() ), PerEventData(), nameIndex(), DiscreteIndexMap(), layoutID(0), dataID( DataPoint::NewDataID() ), dataGeneration(0)
 {
+	this->UpdateLayoutID();
 }
 
 //Constructor with correct arguments
 DataPoint::DataPoint( vector<string> NewNames ) : allObservables(), allNames(), myPhaseSpaceBoundary(NULL),
 	thisDiscreteIndex(-1), WeightValue(1.), storedID(0), initialNLL( numeric_limits<double>::quiet_NaN() ),
-	PerEventData(), nameIndex(), DiscreteIndexMap()
+	PerEventData(), nameIndex(), DiscreteIndexMap(), layoutID(0), dataID( DataPoint::NewDataID() ), dataGeneration(0)
 {
 	allObservables.reserve( NewNames.size() );
 	//Populate the map
@@ -50,6 +53,7 @@ DataPoint::DataPoint( vector<string> NewNames ) : allObservables(), allNames(),
 		}
 		cerr << "This is harmless, but you will now have some merged Observable(s)" << endl;
 	}
+	this->UpdateLayoutID();
 }
 
 //Assignment operator
@@ -70,6 +74,8 @@ DataPoint& DataPoint::operator=( const DataPoint& NewPoint )
 			this->allObservables.push_back( Observable( (NewPoint.allObservables[i]) ) );
 		}
 		this->DiscreteIndexMap = NewPoint.DiscreteIndexMap;
+		this->layoutID = NewPoint.layoutID;
+		++dataGeneration;
 	}
 	return *(this);
 }
@@ -77,7 +83,8 @@ DataPoint& DataPoint::operator=( const DataPoint& NewPoint )
 DataPoint::DataPoint( const DataPoint& input ) :
 	allObservables(), allNames(input.allNames), myPhaseSpaceBoundary(input.myPhaseSpaceBoundary),
 	thisDiscreteIndex(input.thisDiscreteIndex), WeightValue(input.WeightValue), storedID(input.storedID),
-	initialNLL( input.initialNLL ), PerEventData(input.PerEventData), nameIndex(), DiscreteIndexMap(input.DiscreteIndexMap)
+	initialNLL( input.initialNLL ), PerEventData(input.PerEventData), nameIndex(), DiscreteIndexMap(input.DiscreteIndexMap), layoutID(input.layoutID),
+	dataID( DataPoint::NewDataID() ), dataGeneration(0)
 {
 	for( unsigned int i=0; i< input.allObservables.size(); ++i )
 	{
@@ -116,6 +123,73 @@ void DataPoint::RemoveObservable( const string input )
 
 	allNames.erase( name_to_remove );
 	allObservables.erase( observable_to_remove );
+	this->UpdateLayoutID();
+	++dataGeneration;
+}
+
+void DataPoint::UpdateLayoutID()
+{
+	//	Nearly every DataPoint made on a thread has the same names as the one before, so check those first without taking the lock
+	static __thread const vector<string>* lastNames = NULL;
+	static __thread size_t lastNamesID = 0;
+	if( lastNames != NULL && *lastNames == allNames )
+	{
+		layoutID = lastNamesID;
+		return;
+	}
+
+	//	Every list of names seen so far with its identifier, found through a 64 bit FNV-1a hash over all of the names, each followed by a separator
+	//	The lists are never removed, so the pointers stay valid for the lifetime of the program
+	static pthread_mutex_t layout_lock = PTHREAD_MUTEX_INITIALIZER;
+	static map<uint64_t, vector<pair<const vector<string>*, size_t> > > knownLayouts;
+	static size_t lastLayout = 0;
+
+	uint64_t thisHash = 14695981039346656037ULL;
+	for( vector<string>::const_iterator name_i = allNames.begin(); name_i != allNames.end(); ++name_i )
+	{
+		for( string::const_iterator char_i = name_i->begin(); char_i != name_i->end(); ++char_i )
+		{
+			thisHash = ( thisHash ^ (uint64_t)(unsigned char)(*char_i) ) * 1099511628211ULL;
+		}
+		thisHash = ( thisHash ^ (uint64_t) 0xFF ) * 1099511628211ULL;
+	}
+
+	//	Two lists with the same hash still get their own identifier, slots are only shared between identical lists
+	pthread_mutex_lock( &layout_lock );
+	vector<pair<const vector<string>*, size_t> >& sameHash = knownLayouts[ thisHash ];
+	const vector<string>* thisNames = NULL;
+	layoutID = 0;
+	for( unsigned int i=0; i< sameHash.size(); ++i )
+	{
+		if( *(sameHash[i].first) == allNames )
+		{
+			thisNames = sameHash[i].first;
+			layoutID = sameHash[i].second;
+			break;
+		}
+	}
+	//	0 is reserved to mean 'no layout'
+	if( layoutID == 0 )
+	{
+		thisNames = new vector<string>( allNames );
+		layoutID = ++lastLayout;
+		sameHash.push_back( make_pair( thisNames, layoutID ) );
+	}
+	pthread_mutex_unlock( &layout_lock );
+
+	lastNames = thisNames;
+	lastNamesID = layoutID;
+}
+
+void DataPoint::SlotOutOfRange( const unsigned int slot ) const
+{
+	cerr << "DataPoint: Slot " << slot << " requested from a DataPoint with only " << allObservables.size() << " Observables" << endl;
+	throw(-1544);
+}
+
+int DataPoint::GetSlot( const ObservableRef& object ) const
+{
+	return StringProcessing::VectorContains( &allNames, object.NameRef() );
 }
 
 Observable* DataPoint::GetObservable( unsigned int wanted )
@@ -173,6 +247,7 @@ bool DataPoint::SetObservable( string Name, Observable * NewObservable )
 	else
 	{
 		allObservables[(unsigned)nameIndex].SetObservable(NewObservable);
+		++dataGeneration;
 		return true;
 	}
 }
@@ -193,6 +268,7 @@ bool DataPoint::SetObservable( ObservableRef& Name, Observable * NewObservable )
 		{
 			Name.SetIndex( nameIndex );
 			allObservables[(unsigned)nameIndex].SetObservable(NewObservable);
+			++dataGeneration;
 			return true;
 		}
 		//return false;
@@ -200,6 +276,7 @@ bool DataPoint::SetObservable( ObservableRef& Name, Observable * NewObservable )
 	else
 	{
 		allObservables[(unsigned)Name.GetIndex()].SetObservable(NewObservable);
+		++dataGeneration;
 		return true;
 	}
 }
@@ -210,6 +287,8 @@ void DataPoint::AddObservable( string Name, Observable* NewObservable )
 	{
 		allNames.push_back( Name );
 		allObservables.push_back( Observable(*NewObservable) );
+		this->UpdateLayoutID();
+		++dataGeneration;
 	}
 	else
 	{
@@ -223,6 +302,7 @@ void DataPoint::AddObservable( string Name, double Value, string Unit, bool trus
 	if( trusted )
 	{
 		allObservables[(unsigned)thisnameIndex].SetObservable( tempObservable );
+		++dataGeneration;
 	}
 	else
 	{
@@ -240,6 +320,7 @@ bool DataPoint::SetObservable( string Name, double Value, string Unit, bool trus
 	{
 		returnValue=true;
 		allObservables[(unsigned)thisnameIndex].SetObservable( temporaryObservable );
+		++dataGeneration;
 	}
 	else
 	{
@@ -332,6 +413,19 @@ void DataPoint::SetPerEventData( const vector<double> input )
 void DataPoint::ClearPerEventData()
 {
 	PerEventData.clear();
+	++dataGeneration;
+}
+
+void DataPoint::NewDataGeneration()
+{
+	++dataGeneration;
+}
+
+size_t DataPoint::NewDataID()
+{
+	//	DataPoints are made on several threads at once when generating
+	static size_t lastID = 0;
+	return __sync_add_and_fetch( &lastID, (size_t) 1 );
 }
 
 void DataPoint::SetDiscreteIndexIDMap( size_t thisID, int index )
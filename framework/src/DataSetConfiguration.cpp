@@ -12,8 +12,7 @@
 #include "TFile.h"
 #include "TBranch.h"
 #include "TLeaf.h"
-#include "TEventList.h"
-#include "TCanvas.h"
+#include "TStopwatch.h"
 #include "TString.h"
 #include "TTree.h"
 #include "TDirectory.h"
@@ -22,6 +21,8 @@
 ///	RapidFit Headers
 #include "StringProcessing.h"
 #include "MemoryDataSet.h"
+#include "ColumnarDataSet.h"
+#include "StreamingDataSet.h"
 #include "DataSetConfiguration.h"
 #include "ClassLookUp.h"
 #include "ResultFormatter.h"
@@ -32,6 +33,8 @@
 #include <map>
 #include <stdlib.h>
 #include <sstream>
+#include <iomanip>
+#include <sys/stat.h>
 
 using namespace::std;
 
@@ -347,6 +350,17 @@ IDataSet * DataSetConfiguration::LoadDataFile( vector<string> Arguments, vector<
 	{
 		//Make a RootFileDataSet from a root file
 		//data = new RootFileDataSet( fileName, dataBoundary );
+		searchName = "EventCache";
+		int eventCacheIndex = StringProcessing::VectorContains( &ArgumentNames, &searchName );
+		if( eventCacheIndex >= 0 )
+		{
+			//	With a chunk size the events are left on disk and streamed through the fit
+			searchName = "StreamChunkSize";
+			int chunkSizeIndex = StringProcessing::VectorContains( &ArgumentNames, &searchName );
+			unsigned int chunkSize = 0;
+			if( chunkSizeIndex >= 0 ) chunkSize = (unsigned) atoi( Arguments[unsigned(chunkSizeIndex)].c_str() );
+			return LoadCachedRootFile( fileName, nTuplePath, NumberEventsToRead, DataBoundary, Arguments[unsigned(eventCacheIndex)], chunkSize );
+		}
 		return LoadRootFileIntoMemory( fileName, nTuplePath, NumberEventsToRead, DataBoundary );
 	}
 	else if ( fileNameExtension == "csv" )
@@ -369,7 +383,10 @@ IDataSet * DataSetConfiguration::LoadDataFile( vector<string> Arguments, vector<
 
 IDataSet * DataSetConfiguration::LoadRootFileIntoMemory( string this_fileName, string ntuplePath, long numberEventsToRead, PhaseSpaceBoundary * DataBoundary )
 {
-	MemoryDataSet * data = new MemoryDataSet(DataBoundary);
+	TStopwatch loadTime;
+	loadTime.Start();
+
+	ColumnarDataSet * data = new ColumnarDataSet(DataBoundary);
 	vector<string> observableNames = DataBoundary->GetAllNames();
 	int numberOfObservables = int(observableNames.size());
 
@@ -381,71 +398,37 @@ IDataSet * DataSetConfiguration::LoadRootFileIntoMemory( string this_fileName, s
 		exit(2374);
 	}
 	if( Start_Entry != 0 ) cout << "Starting From Entry: " << Start_Entry<< " in the ntuple." << endl;
-	int totalNumberOfEvents = int(ntuple->GetEntries());
+	Long64_t totalNumberOfEvents = ntuple->GetEntries();
 	if( totalNumberOfEvents <= 0 )
 	{
 		cerr << "\t\tInvalid number of Events! exiting" << endl << endl;
 		exit(-2374);
 	}
-	ntuple->SetEstimate(ntuple->GetEntries());  // Fix the size of the array of doubles to be created (There will never be more than this many)
-	int numberOfEventsAfterCut = int(ntuple->Draw(">>evtList", cutString.c_str(),"goff",ntuple->GetEntries(),Start_Entry)); // apply the cut which automatically creates the evtList object
-	if ( numberOfEventsAfterCut == -1 )
-	{
-		cerr << "Please check the cut string you are using!" << endl;
-		exit(97823);
-	}
-	//	TEventList * evtList = (TEventList*)gDirectory->Get("evtList"); // ROOT is weird
-
-	cout << "Total number of events in file: " << totalNumberOfEvents << endl;
-	cout << "You have applied this cut to the data: '" << cutString << "'" << endl;
-	cout << "Total number of events after cut: " << numberOfEventsAfterCut << endl;
-
-	//  Container for all of the data read in from a root file
-	vector<vector<Double_t> > real_data_array;
-	//real_data_array.reserve( unsigned(numberOfObservables) );
-
 
-	//time_t timeNow1;
-	//time(&timeNow1);
-	//cout << "Time Before Draw Read: " << ctime( &timeNow1 ) << endl;
-
-	//  Instead of Reading in in Row form as with events in NTuples
-	//  (Convenient for many columns and few Rows)
-	//  Read in the data in Column form
-	//
-
-	//	This has been rewritten at the behest of ROOT BEING CRAP
+	//	The file is read once, entry by entry, and only the branches used by the cut and by the Observable formulas are read at all.
+	//	TTreeFormula loads the branches it needs itself for the current entry, the TTreeCache makes this one large read per cluster.
 	//
-	//	However...
-	//
-	//	This does allow the oportunity to 'check the data as it is read into RapidFit :D
+	//	The formulas all share the tree so the file is read from a single thread, the PhaseSpace check and the copy into the columns
+	//	are much cheaper than the decompression anyway.
 
-	//  Hold the Data in a temp object
-	vector<Double_t > temp_vector;
-	TString PlotString("");
-	TString Name("");
-	TString Plot_Options = "";
-	if( DEBUG_DATA )
+	TTreeFormula* cutFormula = NULL;
+	if( !cutString.empty() )
 	{
-		Plot_Options = "";
-	} else {
-		Plot_Options = "goff";
+		cutFormula = new TTreeFormula( "RapidFit_Cut", cutString.c_str(), ntuple );
+		if( (cutFormula->GetTree() == NULL) || (cutFormula->GetNdim() == 0) )
+		{
+			cerr << "Please check the cut string you are using!" << endl;
+			exit(97823);
+		}
 	}
 
-	//DataBoundary->Print();
-
-	TCanvas* bob = new TCanvas( Name, Name, 1680, 1050 );
-
+	vector<TTreeFormula*> observableFormulas;
 	TString FormulaName="Fomula_";
 	for( int obsIndex = 0; obsIndex < numberOfObservables; ++obsIndex )
 	{
-		//	If we want to debug the selection construct a canvas
-		Name="Canvas_Name_"; Name+=obsIndex;
-
-		//  Construct a Plot String to use the TTree->Draw Method
-
 		ObservableRef refName = ObservableRef( observableNames[unsigned(obsIndex)] );
 
+		TString PlotString("");
 		IConstraint* this_const = DataBoundary->GetConstraint( refName );
 		if( this_const != NULL )
 		{
@@ -473,72 +456,178 @@ IDataSet * DataSetConfiguration::LoadRootFileIntoMemory( string this_fileName, s
 			exit(-765);
 		}
 
-		//  Draw upto 3 observables at a time in some large plot
-		//  use the 'goff' option to turn graphical output (and annoying text output from default co/de-structors) off
-		//  (it doesn't matter what this looks like and we can throw it away from here)
-
-		ntuple->Draw( PlotString , cutString.c_str(), Plot_Options, Long64_t(ntuple->GetEntries()), Long64_t(Start_Entry) );
-
-		//  Save the actual data to somewhere protected in our memory
-		Double_t* values = ntuple->GetV1();
-
-		//	Use object recasting to make a copy of the data
-		for(int j=0; j < numberOfEventsAfterCut; ++j )	temp_vector.push_back( (double)(values[j]) );
-
+		observableFormulas.push_back( tempFormula );
+	}
 
-		if( DEBUG_DATA )
+	//	Only cache the branches which are actually used
+	vector<TTreeFormula*> allFormulas( observableFormulas );
+	if( cutFormula != NULL ) allFormulas.push_back( cutFormula );
+	ntuple->SetCacheSize( 30*1024*1024 );
+	for( unsigned int formulaIndex=0; formulaIndex< allFormulas.size(); ++formulaIndex )
+	{
+		for( int codeIndex=0; codeIndex< allFormulas[formulaIndex]->GetNcodes(); ++codeIndex )
 		{
-			bob->Update();
-			bob->Print(TString("Observable_"+observableNames[(unsigned)obsIndex]+"_selected.png"));
+			TLeaf* thisLeaf = allFormulas[formulaIndex]->GetLeaf( codeIndex );
+			if( thisLeaf != NULL ) ntuple->AddBranchToCache( thisLeaf->GetBranch(), kTRUE );
 		}
-
-		//	Store the data
-		real_data_array.push_back( vector<double>(temp_vector) );
-
-		//	Cleanup
-		vector<Double_t> empty;
-		temp_vector.swap(empty);
-
-		delete tempFormula;
 	}
-	delete bob;
-	//time_t timeNow2;
-	//time(&timeNow2);
-	//cout << "Time After Draw Read: " << ctime( &timeNow2 ) << endl;
-
+	ntuple->StopCacheLearningPhase();
 
 	// Now populate the dataset
 	int numberOfDataPointsAdded = 0;
-	int numberOfDataPointsRead = 0;
+	int numberOfEventsAfterCut = 0;
 
-	//  Now we have all of the data stored in memory in real_data_array which has a 1<->1 with observableName
-	//  Create and store data points for each event as before and throw away events outside of the PhaseSpace
-	for( ; (numberOfDataPointsRead < numberOfEventsAfterCut) && (numberOfDataPointsAdded < numberEventsToRead) ; ++numberOfDataPointsRead )
+	//  Check each event against the PhaseSpace using a single DataPoint and copy the (possibly snapped) values straight into the columns
+	DataPoint* point = new DataPoint( observableNames );
+	for(int obsIndex = 0; obsIndex < numberOfObservables; ++obsIndex )
 	{
-		DataPoint* point = new DataPoint( observableNames );
+		string name = observableNames[unsigned(obsIndex)];
+		string unit = data->GetBoundary()->GetConstraint( name )->GetUnit();
+		point->SetObservable( name, 0., unit, true, obsIndex );
+	}
+	Long64_t firstEntry = Start_Entry > 0 ? Long64_t(Start_Entry) : 0;
+	Long64_t expectedEvents = totalNumberOfEvents - firstEntry;
+	if( expectedEvents > Long64_t(numberEventsToRead) ) expectedEvents = Long64_t(numberEventsToRead);
+	if( expectedEvents > 0 ) data->Reserve( (unsigned int)expectedEvents );
+	vector<double> thisEvent( (unsigned)numberOfObservables, 0. );
+
+	for( Long64_t entry = firstEntry; (entry < totalNumberOfEvents) && (numberOfDataPointsAdded < numberEventsToRead); ++entry )
+	{
+		if( ntuple->LoadTree( entry ) < 0 ) break;
+
+		//	Same selection as TTree::Draw, an entry passes if the cut is non-zero
+		if( cutFormula != NULL )
+		{
+			if( cutFormula->GetNdata() <= 0 ) continue;
+			if( cutFormula->EvalInstance( 0 ) == 0. ) continue;
+		}
+		++numberOfEventsAfterCut;
+
 		for(int obsIndex = 0; obsIndex < numberOfObservables; ++obsIndex )
 		{
-			string name = observableNames[unsigned(obsIndex)];
-			string unit = data->GetBoundary()->GetConstraint( name )->GetUnit();
-			point->SetObservable( name, real_data_array[unsigned(obsIndex)][unsigned(numberOfDataPointsRead)], unit, true, obsIndex);
-			//cout << real_data_array[unsigned(obsIndex)][unsigned(numberOfDataPointsRead)] << endl;
+			observableFormulas[(unsigned)obsIndex]->GetNdata();
+			point->GetObservable( (unsigned)obsIndex )->ExternallySetValue( observableFormulas[(unsigned)obsIndex]->EvalInstance( 0 ) );
+		}
+		if( data->GetBoundary()->IsPointInBoundary( point ) )
+		{
+			for(int obsIndex = 0; obsIndex < numberOfObservables; ++obsIndex )
+			{
+				thisEvent[(unsigned)obsIndex] = point->GetObservable( (unsigned)obsIndex )->GetValue();
+			}
+			data->AddEvent( &(thisEvent[0]) );
+			++numberOfDataPointsAdded;
 		}
-		bool dataPointAdded = data->AddDataPoint( point );
-		if (dataPointAdded) ++numberOfDataPointsAdded;
 	}
+	delete point;
+
+	for( unsigned int formulaIndex=0; formulaIndex< allFormulas.size(); ++formulaIndex ) delete allFormulas[formulaIndex];
 
 	if( DEBUG_DATA )
 	{
 		data->Print();
 	}
 
+	cout << "Total number of events in file: " << totalNumberOfEvents << endl;
+	cout << "You have applied this cut to the data: '" << cutString << "'" << endl;
+	cout << "Number of events passing the cut which were read: " << numberOfEventsAfterCut << endl;
+
 	inputFile->Close();
 	delete inputFile;
+	loadTime.Stop();
 	cout << "Added " << numberOfDataPointsAdded << " events from ROOT file: " << this_fileName << " which are consistent with the PhaseSpaceBoundary" << endl;
+	cout << "Loading took " << loadTime.RealTime() << " s (CPU " << loadTime.CpuTime() << " s)" << endl;
 	time_t timeNow;
 	time(&timeNow);
 	cout << "Time: " << ctime( &timeNow );
-	while( !real_data_array.empty() ){ while( !real_data_array.back().empty() ){real_data_array.back().pop_back(); }; real_data_array.pop_back(); }
+	return data;
+}
+
+string DataSetConfiguration::EventCacheKey( string this_fileName, string ntuplePath, long numberEventsToRead, PhaseSpaceBoundary * DataBoundary ) const
+{
+	stringstream key;
+	key << setprecision(17);
+	key << "File: " << this_fileName << endl;
+
+	struct stat fileInfo;
+	if( stat( this_fileName.c_str(), &fileInfo ) == 0 )
+	{
+		key << "Size: " << (long long) fileInfo.st_size << endl;
+		key << "Modified: " << (long long) fileInfo.st_mtime << endl;
+	}
+
+	key << "NTuple: " << ntuplePath << endl;
+	key << "Cut: " << cutString << endl;
+	key << "Start: " << Start_Entry << endl;
+	key << "Events: " << numberEventsToRead << endl;
+
+	vector<string> observableNames = DataBoundary->GetAllNames();
+	for( unsigned int i=0; i< observableNames.size(); ++i )
+	{
+		IConstraint* thisConstraint = DataBoundary->GetConstraint( observableNames[i] );
+		key << "Observable: " << observableNames[i] << " " << thisConstraint->GetUnit() << " " << thisConstraint->GetTF1();
+		if( thisConstraint->IsDiscrete() )
+		{
+			vector<double> values = thisConstraint->GetValues();
+			for( unsigned int j=0; j< values.size(); ++j ) key << " " << values[j];
+		}
+		else
+		{
+			key << " " << thisConstraint->GetMinimum() << " " << thisConstraint->GetMaximum();
+		}
+		key << endl;
+	}
+
+	return key.str();
+}
+
+IDataSet * DataSetConfiguration::LoadCachedRootFile( string this_fileName, string ntuplePath, long numberEventsToRead, PhaseSpaceBoundary * DataBoundary, string cacheDirectory, unsigned int streamChunkSize )
+{
+	string key = this->EventCacheKey( this_fileName, ntuplePath, numberEventsToRead, DataBoundary );
+
+	//	One file per key so that different cuts or ranges on the same ntuple don't overwrite each other
+	vector<string> splitPath = StringProcessing::SplitString( this_fileName, '/' );
+	stringstream cacheName;
+	cacheName << cacheDirectory << "/" << splitPath.back() << "_" << hex << setw(16) << setfill('0') << ColumnarDataSet::Checksum( key.data(), key.size() ) << ".rfcache";
+
+	if( streamChunkSize > 0 )
+	{
+		StreamingDataSet* streamed = StreamingDataSet::Open( cacheName.str(), key, DataBoundary, streamChunkSize );
+		if( streamed != NULL ) return streamed;
+
+		//	The cache has to be made from the ntuple once, after that the events are never all in memory
+		IDataSet* data = LoadRootFileIntoMemory( this_fileName, ntuplePath, numberEventsToRead, DataBoundary );
+		ColumnarDataSet* columnarData = dynamic_cast<ColumnarDataSet*>( data );
+		if( columnarData != NULL && columnarData->WriteCache( cacheName.str(), key ) )
+		{
+			cout << "Wrote event cache: " << cacheName.str() << endl;
+			streamed = StreamingDataSet::Open( cacheName.str(), key, DataBoundary, streamChunkSize );
+			if( streamed != NULL )
+			{
+				delete data;
+				return streamed;
+			}
+		}
+		cerr << "Cannot stream from event cache: " << cacheName.str() << ", keeping the events in memory" << endl;
+		return data;
+	}
+
+	TStopwatch loadTime;
+	loadTime.Start();
+	ColumnarDataSet* cached = ColumnarDataSet::ReadCache( cacheName.str(), key, DataBoundary );
+	if( cached != NULL )
+	{
+		loadTime.Stop();
+		cout << "Added " << cached->GetDataNumber() << " events for ROOT file: " << this_fileName << " from event cache: " << cacheName.str() << endl;
+		cout << "Loading took " << loadTime.RealTime() << " s (CPU " << loadTime.CpuTime() << " s)" << endl;
+		return cached;
+	}
+
+	IDataSet* data = LoadRootFileIntoMemory( this_fileName, ntuplePath, numberEventsToRead, DataBoundary );
+	ColumnarDataSet* columnarData = dynamic_cast<ColumnarDataSet*>( data );
+	if( columnarData != NULL && columnarData->WriteCache( cacheName.str(), key ) )
+	{
+		cout << "Wrote event cache: " << cacheName.str() << endl;
+	}
 	return data;
 }
 
@@ -0,0 +1,86 @@
+
+//	RapidFit Headers
+#include "EventBlock.h"
+#include "ColumnarDataSet.h"
+//	System Headers
+#include <iostream>
+
+using namespace::std;
+
+EventBlock::EventBlock( DataPoint** Points, const unsigned int numberEvents ) :
+	allPoints( Points ), nEvents( numberEvents ), columnData( NULL ), firstEvent( 0 )
+{
+}
+
+EventBlock::EventBlock( DataPoint** Points, const unsigned int numberEvents, const ColumnarDataSet* Columns, const unsigned int FirstEvent ) :
+	allPoints( Points ), nEvents( numberEvents ), columnData( Columns ), firstEvent( FirstEvent )
+{
+}
+
+EventBlock::EventBlock( const EventBlock& input ) :
+	allPoints( input.allPoints ), nEvents( input.nEvents ), columnData( input.columnData ), firstEvent( input.firstEvent )
+{
+}
+
+EventBlock& EventBlock::operator= ( const EventBlock& input )
+{
+	if( this != &input )
+	{
+		allPoints = input.allPoints;
+		nEvents = input.nEvents;
+		columnData = input.columnData;
+		firstEvent = input.firstEvent;
+	}
+	return *this;
+}
+
+EventBlock::~EventBlock()
+{
+}
+
+unsigned int EventBlock::GetNumberEvents() const
+{
+	return nEvents;
+}
+
+DataPoint* EventBlock::GetDataPoint( const unsigned int index ) const
+{
+	return allPoints[index];
+}
+
+DataPoint** EventBlock::GetDataPoints() const
+{
+	return allPoints;
+}
+
+bool EventBlock::HasColumns() const
+{
+	return columnData != NULL;
+}
+
+const double* EventBlock::GetColumn( const ObservableRef& Name ) const
+{
+	if( columnData == NULL ) return NULL;
+	int thisColumn = columnData->GetColumnIndex( Name );
+	if( thisColumn < 0 ) return NULL;
+	return columnData->GetColumn( (unsigned)thisColumn ) + firstEvent;
+}
+
+const ColumnarDataSet* EventBlock::GetColumnData() const
+{
+	return columnData;
+}
+
+unsigned int EventBlock::GetFirstEvent() const
+{
+	return firstEvent;
+}
+
+EventBlock EventBlock::SubBlock( const unsigned int first, const unsigned int numberEvents ) const
+{
+	unsigned int start = first < nEvents ? first : nEvents;
+	unsigned int size = numberEvents;
+	if( start + size > nEvents ) size = nEvents - start;
+	return EventBlock( allPoints + start, size, columnData, firstEvent + start );
+}
+
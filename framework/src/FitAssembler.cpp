@@ -18,6 +18,7 @@
 #include "ResultFormatter.h"
 #include "StringProcessing.h"
 #include "PhysicsBottle.h"
+#include "RapidFitIntegrator.h"
 ///	System Headers
 #include <iostream>
 #include <iomanip>
@@ -84,6 +85,8 @@ FitResult * FitAssembler::DoFit( IMinimiser * Minimiser, IFitFunction * TheFunct
 
 	cout << "\nMinimised!\n" << endl;
 
+	RapidFitIntegrator::PrintIntegrationPrecision();
+
 	FitResult* final_result = Minimiser->GetFitResult();
 
 	if( DebugClass::DebugThisClass( "FitAssembler" ) )
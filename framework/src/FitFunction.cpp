@@ -19,10 +19,14 @@
 //	RapidFit Headers
 #include "FitFunction.h"
 #include "Threading.h"
+#include "ThreadPool.h"
+#include "MultiThreadedFunctions.h"
 #include "ClassLookUp.h"
 #include "RapidFitIntegrator.h"
 #include "StringProcessing.h"
 #include "MemoryDataSet.h"
+#include "StreamingDataSet.h"
+#include "ColumnarDataSet.h"
 #include "ProdPDF.h"
 //	System Headers
 #include <iostream>
@@ -37,8 +41,8 @@ using namespace::std;
 //Default constructor
 FitFunction::FitFunction() :
 	Name("Unknown"), allData(), testDouble(), useWeights(false), weightObservableName(), Fit_File(NULL), Fit_Tree(NULL), branch_objects(), branch_names(), fit_calls(0),
-	Threads(-1), stored_pdfs(), StoredBoundary(), StoredDataSubSet(), StoredIntegrals(), finalised(false), fit_thread_data(NULL), testIntegrator( true ), weightsSquared( false ),
-	traceNum(0), step_time(-1), callNum(0), integrationConfig(new RapidFitIntegratorConfig()), initialConstraint( numeric_limits<double>::quiet_NaN() )
+	Threads(-1), stored_pdfs(), StoredBoundary(), StoredDataSubSet(), StoredIntegrals(), finalised(false), fit_thread_data(NULL), thread_pool(NULL), testIntegrator( true ), weightsSquared( false ),
+	traceNum(0), step_time(-1), callNum(0), integrationConfig(new RapidFitIntegratorConfig()), initialConstraint( numeric_limits<double>::quiet_NaN() ), gradientNames()
 {
 }
 
@@ -54,6 +58,11 @@ FitFunction::~FitFunction()
 		Fit_Tree->Write();
 		Fit_File->Close();
 	}
+	if( thread_pool != NULL )
+	{
+		MultiThreadedFunctions::UnsetThreadPool( thread_pool );
+		delete thread_pool;
+	}
 	if( fit_thread_data != NULL ) delete [] fit_thread_data;
 	//if( allData != NULL ) delete allData;
 	/*while( !StoredBoundary.empty() )
@@ -189,13 +198,17 @@ void FitFunction::SetPhysicsBottle( const PhysicsBottle * NewBottle )
 			{
 				cout << "FitFunction: Splitting DataSet" << endl;
 			}
-			StoredDataSubSet.push_back( Threading::divideData( NewBottle->GetResultDataSet(resultIndex), Threads ) );
-			vector<IDataSet*> sets;
-			for( unsigned int i=0; i<  StoredDataSubSet.back().size(); ++i )
+			//	A StreamingDataSet is split one chunk at a time as it is read, holding all of its events here would defeat the point
+			//	The events of a ColumnarDataSet are put into DataPoints one block at a time by the threads, see ColumnarDataSet::FillBlock
+			IDataSet* thisDataSet = NewBottle->GetResultDataSet(resultIndex);
+			if( dynamic_cast<StreamingDataSet*>( thisDataSet ) != NULL || dynamic_cast<ColumnarDataSet*>( thisDataSet ) != NULL )
+			{
+				StoredDataSubSet.push_back( vector<vector<DataPoint*> >( (unsigned) Threads ) );
+			}
+			else
 			{
-				sets.push_back( new MemoryDataSet( NewBottle->GetResultDataSet(resultIndex)->GetBoundary(), StoredDataSubSet.back()[i] ) );
+				StoredDataSubSet.push_back( Threading::divideData( thisDataSet, Threads ) );
 			}
-			stored_datasets.push_back( sets );
 			for( int i=0; i< Threads; ++i )
 			{
 				/*if( DebugClass::DebugThisClass( "FitFunction" ) )
@@ -216,6 +229,15 @@ void FitFunction::SetPhysicsBottle( const PhysicsBottle * NewBottle )
 	if( Threads > 0 )
 	{
 		fit_thread_data = new Fitting_Thread[ (unsigned) Threads ];
+
+		//	Start the worker threads once here rather than once per call from the minimiser
+		if( thread_pool != NULL )
+		{
+			MultiThreadedFunctions::UnsetThreadPool( thread_pool );
+			delete thread_pool;
+		}
+		thread_pool = new ThreadPool( (unsigned) Threads );
+		MultiThreadedFunctions::SetThreadPool( thread_pool );
 	}
 
 	if( DebugClass::DebugThisClass( "FitFunction" ) )
@@ -366,8 +388,8 @@ double FitFunction::Evaluate()
 			//cout << (Double_t) branch_objects[i] << "\t" ;
 			Fit_Tree->SetBranchAddress( string(branch_names[i]).c_str(), &(branch_objects[i]) );
 		}
-		branch_objects[branch_objects.size()] = (Double_t) minimiseValue;
-		Fit_Tree->SetBranchAddress( "NLL", &(branch_objects[branch_objects.size()]) );
+		branch_objects.back() = (Double_t) minimiseValue;
+		Fit_Tree->SetBranchAddress( "NLL", &(branch_objects.back()) );
 		Fit_Tree->SetBranchAddress( "Call", &(fit_calls) );
 
 		Fit_Tree->SetBranchAddress( "time", &(step_time) );
@@ -396,6 +418,97 @@ double FitFunction::Evaluate()
 	return minimiseValue;
 }
 
+bool FitFunction::GetAnalyticGradient()
+{
+	if( !this->ProvidesDataSetGradient() ) return false;
+
+	for( int resultIndex = 0; resultIndex < allData->NumberResults(); ++resultIndex )
+	{
+		if( !allData->GetResultPDF( resultIndex )->GetAnalyticGradient() ) return false;
+	}
+
+	return true;
+}
+
+bool FitFunction::EvaluateGradient( vector<double>& Gradient )
+{
+	ParameterSet* thisParameterSet = allData->GetParameterSet();
+	vector<string> allNames = thisParameterSet->GetAllNames();
+	vector<string> floatNames = thisParameterSet->GetAllFloatNames();
+	if( gradientNames != floatNames ) gradientNames = floatNames;
+
+	Gradient.assign( allNames.size(), 0. );
+	if( gradientNames.empty() ) return true;
+
+	vector<double> floatGradient( gradientNames.size(), 0. );
+	vector<double> thisGradient( gradientNames.size(), 0. );
+
+	//Sum the gradient of each PDF-DataSet pair
+	for( int resultIndex = 0; resultIndex < allData->NumberResults(); ++resultIndex )
+	{
+		if( allData->GetResultDataSet( resultIndex )->GetDataNumber() < 1 ) continue;
+
+		bool isOK = this->EvaluateDataSetGradient( allData->GetResultPDF( resultIndex ), allData->GetResultDataSet( resultIndex ), resultIndex, &(thisGradient[0]) );
+
+		ClearPhaseSpaceCaches( allData->GetResultDataSet( resultIndex ) );
+
+		if( !isOK ) return false;
+
+		for( unsigned int i=0; i< gradientNames.size(); ++i ) floatGradient[i] += thisGradient[i];
+	}
+
+	//The constraints are cheap, differentiate them numerically
+	vector< ConstraintFunction* > constraints = allData->GetConstraints();
+	if( !constraints.empty() )
+	{
+		ParameterSet shiftedParameters( *thisParameterSet );
+		for( unsigned int i=0; i< gradientNames.size(); ++i )
+		{
+			PhysicsParameter* thisParameter = shiftedParameters.GetPhysicsParameter( gradientNames[i] );
+			double centralValue = thisParameter->GetBlindedValue();
+			double step = 1E-6 * ( fabs( centralValue ) > 1. ? fabs( centralValue ) : 1. );
+
+			double upper=0., lower=0.;
+			thisParameter->SetBlindedValue( centralValue + step );
+			for( unsigned int constraintIndex = 0; constraintIndex < constraints.size(); ++constraintIndex )
+			{
+				upper += constraints[constraintIndex]->Evaluate( &shiftedParameters );
+			}
+			thisParameter->SetBlindedValue( centralValue - step );
+			for( unsigned int constraintIndex = 0; constraintIndex < constraints.size(); ++constraintIndex )
+			{
+				lower += constraints[constraintIndex]->Evaluate( &shiftedParameters );
+			}
+			thisParameter->SetBlindedValue( centralValue );
+
+			floatGradient[i] += ( upper - lower ) / ( 2. * step );
+		}
+	}
+
+	for( unsigned int i=0; i< gradientNames.size(); ++i )
+	{
+		if( std::isnan( floatGradient[i] ) ) return false;
+		int index = StringProcessing::VectorContains( &allNames, &(gradientNames[i]) );
+		Gradient[(unsigned)index] = floatGradient[i];
+	}
+
+	return true;
+}
+
+bool FitFunction::ProvidesDataSetGradient() const
+{
+	return false;
+}
+
+bool FitFunction::EvaluateDataSetGradient( IPDF* TestPDF, IDataSet* TestDataSet, int number, double* gradient )
+{
+	(void)TestPDF;
+	(void)TestDataSet;
+	(void)number;
+	(void)gradient;
+	return false;
+}
+
 //Return the value to minimise for a given PDF/DataSet pair
 double FitFunction::EvaluateDataSet( IPDF * TestPDF, IDataSet * TestDataSet, int number )
 {
@@ -483,6 +596,22 @@ bool FitFunction::GetOffSetNLL() const
 	return OffSetNLL;
 }
 
+IFitFunction* FitFunction::Clone( const int nThreads ) const
+{
+	IFitFunction* thisClone = ClassLookUp::LookUpFitFunctionName( Name );
+
+	if( useWeights ) thisClone->UseEventWeights( weightObservableName );
+	thisClone->SetUseWeightsSquared( weightsSquared );
+	thisClone->SetIntegratorConfig( integrationConfig );
+	thisClone->SetThreads( nThreads );
+	thisClone->SetIntegratorTest( false );
+	thisClone->SetOffSetNLL( OffSetNLL );
+
+	thisClone->SetPhysicsBottle( allData );
+
+	return thisClone;
+}
+
 void FitFunction::ClearPhaseSpaceCaches( IDataSet* thisDataSet )
 {
 	for( unsigned int i=0; i< stored_pdfs.size(); ++i )
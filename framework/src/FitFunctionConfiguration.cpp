@@ -123,6 +123,11 @@ void FitFunctionConfiguration::SetThreads( int input )
 	Threads = input;
 }
 
+int FitFunctionConfiguration::GetThreads() const
+{
+	return Threads;
+}
+
 void FitFunctionConfiguration::SetIntegratorTest( bool input )
 {
 	testIntegrator = input;
@@ -13,6 +13,9 @@
 #include "RapidFitMatrix.h"
 ///	System Headers
 #include <vector>
+#include <string>
+#include <cstring>
+#include <stdint.h>
 
 using namespace::std;
 
@@ -97,3 +100,166 @@ void FitResult::Print() const
 	fittedParameters->Print();
 }
 
+//	Layout of a packed FitResult
+//
+//	char[8]		magic
+//	double		minimum value
+//	int32_t		fit status
+//	uint32_t	number of parameters
+//	for each parameter: name, type and unit as uint32_t length + characters, then
+//	double		value, original value, error, minimum, maximum, step size, upper error, lower error
+//	uint8_t		asymmetric errors, scanned
+//	uint32_t	number of covariance matrix parameters, then their names
+//	uint32_t	size of the covariance matrix, then its elements row by row
+static const char RAPIDFIT_PACKED_RESULT_MAGIC[8] = { 'R', 'F', 'R', 'E', 'S', 'U', 'L', 'T' };
+
+template<class T> static void AppendBytes( string& output, const T& input )
+{
+	output.append( (const char*) &input, sizeof(T) );
+}
+
+template<class T> static bool ReadBytes( const string& input, size_t& position, T& output )
+{
+	if( position + sizeof(T) > input.size() ) return false;
+	memcpy( &output, input.data() + position, sizeof(T) );
+	position += sizeof(T);
+	return true;
+}
+
+static void AppendString( string& output, const string& input )
+{
+	AppendBytes( output, (uint32_t) input.size() );
+	output.append( input );
+}
+
+static bool ReadString( const string& input, size_t& position, string& output )
+{
+	uint32_t length=0;
+	if( !ReadBytes( input, position, length ) || position + length > input.size() ) return false;
+	output = input.substr( position, length );
+	position += length;
+	return true;
+}
+
+string FitResult::Pack() const
+{
+	string output( RAPIDFIT_PACKED_RESULT_MAGIC, sizeof(RAPIDFIT_PACKED_RESULT_MAGIC) );
+
+	AppendBytes( output, minimumValue );
+	AppendBytes( output, (int32_t) fitStatus );
+
+	vector<string> allNames = fittedParameters->GetAllNames();
+	AppendBytes( output, (uint32_t) allNames.size() );
+	for( unsigned int i=0; i< allNames.size(); ++i )
+	{
+		ResultParameter* thisParam = fittedParameters->GetResultParameter( allNames[i] );
+		AppendString( output, allNames[i] );
+		AppendString( output, thisParam->GetType() );
+		AppendString( output, thisParam->GetUnit() );
+		AppendBytes( output, thisParam->GetValue() );
+		AppendBytes( output, thisParam->GetOriginalValue() );
+		AppendBytes( output, thisParam->GetError() );
+		AppendBytes( output, thisParam->GetMinimum() );
+		AppendBytes( output, thisParam->GetMaximum() );
+		AppendBytes( output, thisParam->GetStepSize() );
+		AppendBytes( output, thisParam->GetErrHi() );
+		AppendBytes( output, thisParam->GetErrLow() );
+		AppendBytes( output, (uint8_t) thisParam->GetAssym() );
+		AppendBytes( output, (uint8_t) thisParam->GetScanStatus() );
+	}
+
+	vector<string> matrixNames;
+	int matrixSize = 0;
+	if( covarianceMatrix != NULL )
+	{
+		matrixNames = covarianceMatrix->theseParameters;
+		if( covarianceMatrix->thisMatrix != NULL ) matrixSize = covarianceMatrix->thisMatrix->GetNcols();
+	}
+	AppendBytes( output, (uint32_t) matrixNames.size() );
+	for( unsigned int i=0; i< matrixNames.size(); ++i ) AppendString( output, matrixNames[i] );
+	AppendBytes( output, (uint32_t) matrixSize );
+	for( int i=0; i< matrixSize; ++i )
+	{
+		for( int j=0; j< matrixSize; ++j )
+		{
+			AppendBytes( output, (double) (*(covarianceMatrix->thisMatrix))(i,j) );
+		}
+	}
+
+	return output;
+}
+
+FitResult* FitResult::Unpack( const string& input )
+{
+	size_t position = sizeof(RAPIDFIT_PACKED_RESULT_MAGIC);
+	if( input.size() < position || memcmp( input.data(), RAPIDFIT_PACKED_RESULT_MAGIC, position ) != 0 ) return NULL;
+
+	double minimum=0.;
+	int32_t status=0;
+	uint32_t numberParameters=0;
+	if( !ReadBytes( input, position, minimum ) || !ReadBytes( input, position, status ) || !ReadBytes( input, position, numberParameters ) ) return NULL;
+
+	vector<ResultParameter*> allParameters;
+	vector<string> allNames;
+	bool good = true;
+	for( unsigned int i=0; good && i< numberParameters; ++i )
+	{
+		string name, type, unit;
+		double value=0., originalValue=0., error=0., min=0., max=0., stepSize=0., errHi=0., errLow=0.;
+		uint8_t assym=0, scanned=0;
+		good = ReadString( input, position, name ) && ReadString( input, position, type ) && ReadString( input, position, unit )
+			&& ReadBytes( input, position, value ) && ReadBytes( input, position, originalValue ) && ReadBytes( input, position, error )
+			&& ReadBytes( input, position, min ) && ReadBytes( input, position, max ) && ReadBytes( input, position, stepSize )
+			&& ReadBytes( input, position, errHi ) && ReadBytes( input, position, errLow ) && ReadBytes( input, position, assym ) && ReadBytes( input, position, scanned );
+		if( !good ) break;
+
+		ResultParameter* thisParam = new ResultParameter( name, value, originalValue, error, min, max, type, unit );
+		if( assym != 0 ) thisParam->SetAssymErrors( errHi, errLow, error );
+		thisParam->SetStepSize( stepSize );
+		thisParam->SetScanStatus( scanned != 0 );
+		allParameters.push_back( thisParam );
+		allNames.push_back( name );
+	}
+
+	RapidFitMatrix* matrix = new RapidFitMatrix();
+	uint32_t numberMatrixNames=0, matrixSize=0;
+	good = good && ReadBytes( input, position, numberMatrixNames );
+	for( unsigned int i=0; good && i< numberMatrixNames; ++i )
+	{
+		string name;
+		good = ReadString( input, position, name );
+		matrix->theseParameters.push_back( name );
+	}
+	good = good && ReadBytes( input, position, matrixSize ) && position + sizeof(double)*matrixSize*matrixSize == input.size();
+	if( good && matrixSize > 0 )
+	{
+		matrix->thisMatrix = new TMatrixDSym( (int) matrixSize );
+		for( int i=0; i< (int) matrixSize; ++i )
+		{
+			for( int j=0; j< (int) matrixSize; ++j )
+			{
+				double element=0.;
+				ReadBytes( input, position, element );
+				(*(matrix->thisMatrix))(i,j) = element;
+			}
+		}
+	}
+
+	FitResult* output = NULL;
+	if( good )
+	{
+		ResultParameterSet* fittedSet = new ResultParameterSet( allNames );
+		for( unsigned int i=0; i< allParameters.size(); ++i ) fittedSet->SetResultParameter( allNames[i], allParameters[i] );
+		ParameterSet* fittedParameterSet = fittedSet->GetDummyParameterSet();
+		PhysicsBottle* fittedBottle = new PhysicsBottle( fittedParameterSet );
+		output = new FitResult( minimum, fittedSet, (int) status, fittedBottle, matrix );
+		delete fittedBottle;
+		delete fittedParameterSet;
+		delete fittedSet;
+	}
+
+	for( unsigned int i=0; i< allParameters.size(); ++i ) delete allParameters[i];
+	delete matrix;
+
+	return output;
+}
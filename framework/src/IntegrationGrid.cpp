@@ -0,0 +1,712 @@
+
+//	RapidFit Headers
+#include "IntegrationGrid.h"
+#include "RapidFitIntegratorConfig.h"
+#include "ClassLookUp.h"
+#include "EventBlock.h"
+#include "MultiThreadedFunctions.h"
+#include "ThreadPool.h"
+#include "StringProcessing.h"
+//	System Headers
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <float.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#ifdef __RAPIDFIT_USE_GSL
+#include <gsl/gsl_qrng.h>
+#endif
+
+using namespace::std;
+
+bool IntegrationGrid::freezePoints = false;
+
+IntegrationGrid::IntegrationGrid( const string Label, const DataPoint* templateDataPoint, const vector<string> doIntegrate ) :
+	templatePoint( new DataPoint( *templateDataPoint ) ), integrateNames( doIntegrate ), integrateIndex(), otherIndex(), otherValues(),
+	unitPoints(), currentMinima(), currentMaxima(), allPoints(), pointValues(), sliceData(NULL), numberSlices(0), sliceFirst(0), sliceLast(0),
+	proxyValues(), proxyPoints(0), proxySliceData(NULL), proxyLabel(), amplitudeShapeNames(), amplitudeCaches(), gridLabel( Label ), warmStart(), numberIntegrals(0), numberNotConverged(0), mostPoints(0), worstPrecision(0.), sumPrecision(0.), grid_lock()
+{
+	pthread_mutex_init( &grid_lock, NULL );
+
+	templatePoint->ClearPerEventData();
+	IntegrationGrid::ClearCaches( templatePoint );
+
+	for( unsigned int i=0; i< integrateNames.size(); ++i )
+	{
+		int thisSlot = templatePoint->GetSlot( ObservableRef( integrateNames[i] ) );
+		if( thisSlot < 0 )
+		{
+			cerr << "IntegrationGrid: Observable " << integrateNames[i] << " to be integrated is not in the DataPoint" << endl;
+			exit(-8738);
+		}
+		integrateIndex.push_back( (unsigned) thisSlot );
+	}
+
+	const unsigned int nObs = (unsigned) templatePoint->GetAllNames().size();
+	for( unsigned int j=0; j< nObs; ++j )
+	{
+		bool integrated = false;
+		for( unsigned int i=0; i< integrateIndex.size(); ++i ) if( integrateIndex[i] == j ) integrated = true;
+		if( !integrated )
+		{
+			otherIndex.push_back( j );
+			otherValues.push_back( templatePoint->value( j ) );
+		}
+	}
+}
+
+IntegrationGrid::~IntegrationGrid()
+{
+	if( sliceData != NULL )
+	{
+		for( unsigned int i=0; i< numberSlices; ++i )
+		{
+			if( sliceData[i].fittingPDF != NULL ) delete sliceData[i].fittingPDF;
+			if( sliceData[i].thisComponent != NULL ) delete sliceData[i].thisComponent;
+		}
+		delete[] sliceData;
+	}
+
+	this->RemoveProxy();
+
+	while( !allPoints.empty() )
+	{
+		if( allPoints.back() != NULL ) delete allPoints.back();
+		allPoints.pop_back();
+	}
+
+	delete templatePoint;
+
+	pthread_mutex_destroy( &grid_lock );
+}
+
+bool IntegrationGrid::Matches( const string& Label, const DataPoint* templateDataPoint, const vector<string>& doIntegrate ) const
+{
+	return ( Label == gridLabel ) && ( templateDataPoint->GetLayoutID() == templatePoint->GetLayoutID() ) && ( doIntegrate == integrateNames );
+}
+
+void IntegrationGrid::ClearCaches( DataPoint* thisPoint )
+{
+	thisPoint->ClearPerEventData();
+	const unsigned int nObs = (unsigned) thisPoint->GetAllNames().size();
+	for( unsigned int j=0; j< nObs; ++j )
+	{
+		Observable* thisObs = thisPoint->GetObservable( j );
+		thisObs->SetBinNumber( -1 );
+		thisObs->SetBkgBinNumber( -1 );
+	}
+}
+
+void IntegrationGrid::Generate( const unsigned int numberPoints )
+{
+	const unsigned int numberExisting = (unsigned) allPoints.size();
+	if( numberPoints <= numberExisting ) return;
+
+	const unsigned int nDim = (unsigned) integrateNames.size();
+	unitPoints = vector<vector<double> >( nDim, vector<double>( numberPoints, 0. ) );
+
+#ifdef __RAPIDFIT_USE_GSL
+	//	The sequence is deterministic, so the first numberExisting points come out the same as before
+	gsl_qrng* q = gsl_qrng_alloc( gsl_qrng_niederreiter_2, nDim );
+	if( q == NULL )
+	{
+		cerr << "IntegrationGrid: Can't Allocate Integration Tool for GSL Integral." << endl;
+		cerr << " Dim: " << nDim << endl;
+		exit(-741);
+	}
+
+	vector<double> v( nDim, 0. );
+	for( unsigned int i=0; i< numberPoints; ++i )
+	{
+		gsl_qrng_get( q, &(v[0]) );
+		for( unsigned int j=0; j< nDim; ++j ) unitPoints[j][i] = v[j];
+	}
+	gsl_qrng_free( q );
+#endif
+
+	//	New points start from the template, which always holds the current non-integrated values
+	allPoints.reserve( numberPoints );
+	for( unsigned int i=numberExisting; i< numberPoints; ++i )
+	{
+		allPoints.push_back( new DataPoint( *templatePoint ) );
+		if( !currentMinima.empty() ) this->SetIntegrated( i );
+	}
+	pointValues.resize( numberPoints, 0. );
+	proxyValues.resize( numberPoints, 0. );
+}
+
+void IntegrationGrid::SetIntegrated( const unsigned int index )
+{
+	DataPoint* thisPoint = allPoints[index];
+	for( unsigned int j=0; j< integrateIndex.size(); ++j )
+	{
+		thisPoint->GetObservable( integrateIndex[j] )->ExternallySetValue( unitPoints[j][index]*(currentMaxima[j]-currentMinima[j])+currentMinima[j] );
+	}
+	IntegrationGrid::ClearCaches( thisPoint );
+}
+
+void IntegrationGrid::Rescale( const vector<double>& minima, const vector<double>& maxima )
+{
+	currentMinima = minima;
+	currentMaxima = maxima;
+
+	for( unsigned int i=0; i< allPoints.size(); ++i ) this->SetIntegrated( i );
+
+	proxyPoints = 0;
+}
+
+void IntegrationGrid::SyncTemplate( const DataPoint* templateDataPoint )
+{
+	vector<unsigned int> changed;
+	for( unsigned int k=0; k< otherIndex.size(); ++k )
+	{
+		const double wanted = templateDataPoint->value( otherIndex[k] );
+		if( wanted != otherValues[k] )
+		{
+			otherValues[k] = wanted;
+			changed.push_back( k );
+		}
+	}
+
+	if( changed.empty() ) return;
+
+	//	Keep the template in step so that regenerated points start with the same values
+	for( unsigned int k=0; k< changed.size(); ++k )
+	{
+		templatePoint->GetObservable( otherIndex[changed[k]] )->ExternallySetValue( otherValues[changed[k]] );
+	}
+
+	for( unsigned int i=0; i< allPoints.size(); ++i )
+	{
+		DataPoint* thisPoint = allPoints[i];
+		for( unsigned int k=0; k< changed.size(); ++k )
+		{
+			thisPoint->GetObservable( otherIndex[changed[k]] )->ExternallySetValue( otherValues[changed[k]] );
+		}
+		IntegrationGrid::ClearCaches( thisPoint );
+	}
+
+	proxyPoints = 0;
+}
+
+void IntegrationGrid::SetupSlices( IPDF* functionToWrap, ComponentRef* componentIndex, const unsigned int numberThreads )
+{
+	const unsigned int wantedSlices = numberThreads > 0 ? numberThreads : 1;
+
+	if( sliceData == NULL || numberSlices != wantedSlices )
+	{
+		if( sliceData != NULL )
+		{
+			for( unsigned int i=0; i< numberSlices; ++i )
+			{
+				if( sliceData[i].fittingPDF != NULL ) delete sliceData[i].fittingPDF;
+				if( sliceData[i].thisComponent != NULL ) delete sliceData[i].thisComponent;
+			}
+			delete[] sliceData;
+		}
+
+		//	The proxy copies are made per slice too
+		this->RemoveProxy();
+
+		numberSlices = wantedSlices;
+		sliceData = new Fitting_Thread[ numberSlices ];
+		for( unsigned int i=0; i< numberSlices; ++i )
+		{
+			sliceData[i].fittingPDF = ClassLookUp::CopyPDF( functionToWrap );
+		}
+	}
+
+	for( unsigned int i=0; i< numberSlices; ++i )
+	{
+		sliceData[i].fittingPDF->UpdatePhysicsParameters( functionToWrap->GetPhysicsParameters() );
+
+		if( componentIndex == NULL )
+		{
+			if( sliceData[i].thisComponent != NULL ) delete sliceData[i].thisComponent;
+			sliceData[i].thisComponent = NULL;
+		}
+		else if( sliceData[i].thisComponent == NULL || sliceData[i].thisComponent->getComponentName() != componentIndex->getComponentName() )
+		{
+			if( sliceData[i].thisComponent != NULL ) delete sliceData[i].thisComponent;
+			sliceData[i].thisComponent = new ComponentRef( *componentIndex );
+		}
+	}
+}
+
+void IntegrationGrid::EvaluateRange( Fitting_Thread* slices, const unsigned int first, const unsigned int last, vector<double>& values )
+{
+	//	Contiguous slices of the points, see Threading::divideData, the main slices are only split again when the range changes
+	if( slices != sliceData || first != sliceFirst || last != sliceLast )
+	{
+		const unsigned int perSlice = ( last - first ) / numberSlices;
+		unsigned int start = first;
+		for( unsigned int i=0; i< numberSlices; ++i )
+		{
+			const unsigned int end = ( i == numberSlices-1 ) ? last : start + perSlice;
+			slices[i].dataSubSet.assign( allPoints.begin()+start, allPoints.begin()+end );
+			slices[i].firstEvent = start;
+			start = end;
+		}
+		if( slices == sliceData )
+		{
+			sliceFirst = first;
+			sliceLast = last;
+		}
+	}
+
+	ThreadPool::Execute( MultiThreadedFunctions::GetThreadPool(), IntegrationGrid::Evaluate_pthread, slices, numberSlices );
+
+	for( unsigned int i=0; i< numberSlices; ++i )
+	{
+		const vector<double>& thisSet = slices[i].dataPoint_Result;
+		for( unsigned int j=0; j< thisSet.size(); ++j ) values[ slices[i].firstEvent + j ] = thisSet[j];
+	}
+}
+
+void IntegrationGrid::SetupProxy( IPDF* proxyPDF )
+{
+	if( proxySliceData != NULL && proxyLabel == proxyPDF->GetLabel() ) return;
+
+	this->RemoveProxy();
+
+	proxySliceData = new Fitting_Thread[ numberSlices ];
+	for( unsigned int i=0; i< numberSlices; ++i )
+	{
+		proxySliceData[i].fittingPDF = ClassLookUp::CopyPDF( proxyPDF );
+		proxySliceData[i].fittingPDF->UpdatePhysicsParameters( proxyPDF->GetPhysicsParameters() );
+	}
+	proxyLabel = proxyPDF->GetLabel();
+	proxyPoints = 0;
+}
+
+void IntegrationGrid::RemoveProxy()
+{
+	if( proxySliceData == NULL ) return;
+
+	for( unsigned int i=0; i< numberSlices; ++i )
+	{
+		if( proxySliceData[i].fittingPDF != NULL ) delete proxySliceData[i].fittingPDF;
+	}
+	delete[] proxySliceData;
+	proxySliceData = NULL;
+	proxyLabel = "";
+	proxyPoints = 0;
+}
+
+void IntegrationGrid::EvaluateProxy( const unsigned int number )
+{
+	if( number <= proxyPoints ) return;
+
+	//	The proxy may be a different PDF, so it mustn't see or leave behind any per-event data of the PDF being integrated
+	for( unsigned int i=proxyPoints; i< number; ++i ) IntegrationGrid::ClearCaches( allPoints[i] );
+	this->EvaluateRange( proxySliceData, proxyPoints, number, proxyValues );
+	for( unsigned int i=proxyPoints; i< number; ++i ) IntegrationGrid::ClearCaches( allPoints[i] );
+
+	proxyPoints = number;
+}
+
+double IntegrationGrid::ControlVariateEstimate( const unsigned int number, const double volume, const double proxyIntegral ) const
+{
+	//	Means first, then the covariances, over the points where both functions are finite
+	double sum_f=0., sum_g=0., number_good=0.;
+	for( unsigned int i=0; i< number; ++i )
+	{
+		const double f = pointValues[i];
+		const double g = proxyValues[i];
+		if( std::isnan(f) || std::isinf(f) || fabs(f) >= DBL_MAX || std::isnan(g) || std::isinf(g) || fabs(g) >= DBL_MAX ) continue;
+		sum_f += f; sum_g += g; ++number_good;
+	}
+	if( number_good <= 0. ) return 0.;
+
+	const double mean_f = sum_f / number_good;
+	const double mean_g = sum_g / number_good;
+
+	double cov_fg=0., var_g=0.;
+	for( unsigned int i=0; i< number; ++i )
+	{
+		const double f = pointValues[i];
+		const double g = proxyValues[i];
+		if( std::isnan(f) || std::isinf(f) || fabs(f) >= DBL_MAX || std::isnan(g) || std::isinf(g) || fabs(g) >= DBL_MAX ) continue;
+		cov_fg += ( f - mean_f ) * ( g - mean_g );
+		var_g += ( g - mean_g ) * ( g - mean_g );
+	}
+
+	//	beta=1 is the plain difference, the fitted beta can only do better
+	const double beta = var_g > 0. ? cov_fg / var_g : 1.;
+
+	return volume * ( mean_f - beta * mean_g ) + beta * proxyIntegral;
+}
+
+double IntegrationGrid::SumPoints( const unsigned int number, double& number_good ) const
+{
+	//	Sum in the order of the points so that the result doesn't depend on the number of slices
+	double result=0., compensation=0.;
+	number_good = (double) number;
+	for( unsigned int i=0; i< number; ++i )
+	{
+		const double thisNum = pointValues[i];
+		if( !std::isnan(thisNum) && !std::isinf(thisNum) && fabs(thisNum) < DBL_MAX )
+		{
+			const double y = thisNum - compensation;
+			const double t = result + y;
+			compensation = ( t - result ) - y;
+			result = t;
+		}
+		else
+		{
+			--number_good;
+		}
+	}
+	return result;
+}
+
+double IntegrationGrid::Integrate( IPDF* functionToWrap, const DataPoint* templateDataPoint, ComponentRef* componentIndex,
+		const vector<double>& minima, const vector<double>& maxima, const unsigned int numberPoints, const unsigned int numberThreads,
+		const double targetPrecision, const string& combination, IPDF* proxyPDF, const double proxyIntegral )
+{
+#ifdef __RAPIDFIT_USE_GSL
+	double factor=1.;
+	for( unsigned int i=0; i< minima.size(); ++i )
+	{
+		double diff = maxima[i]-minima[i];
+		if( fabs( diff ) > 1E-99 ) factor *= diff;
+	}
+
+	bool adaptive = targetPrecision > 0. && numberPoints > __DEFAULT_RAPIDFIT_MININTEGRATIONPOINTS;
+
+	pthread_mutex_lock( &grid_lock );
+
+	//	Bilinear PDFs only need the integrals of their amplitude terms, these only change with the shape parameters
+	if( componentIndex == NULL && proxyPDF == NULL && functionToWrap->GetNumberAmplitudeTerms() > 0 )
+	{
+		const double amplitudeResult = this->IntegrateAmplitudes( functionToWrap, templateDataPoint, minima, maxima, numberPoints, numberThreads, factor );
+		pthread_mutex_unlock( &grid_lock );
+		return amplitudeResult;
+	}
+
+	unsigned int wantedPoints = numberPoints;
+	if( adaptive )
+	{
+		map<string,unsigned int>::iterator lastTime = warmStart.find( combination );
+		wantedPoints = ( lastTime != warmStart.end() ) ? lastTime->second : __DEFAULT_RAPIDFIT_MININTEGRATIONPOINTS;
+		if( wantedPoints > numberPoints ) wantedPoints = numberPoints;
+		if( freezePoints && lastTime != warmStart.end() ) adaptive = false;
+	}
+
+	this->Generate( wantedPoints );
+	if( currentMinima != minima || currentMaxima != maxima ) this->Rescale( minima, maxima );
+	this->SyncTemplate( templateDataPoint );
+	this->SetupSlices( functionToWrap, componentIndex, numberThreads );
+	if( proxyPDF != NULL ) this->SetupProxy( proxyPDF );
+
+	unsigned int evaluatedPoints = 0;
+	double result=0., precision=0.;
+	while( true )
+	{
+		this->Generate( wantedPoints );
+		if( proxyPDF != NULL ) this->EvaluateProxy( wantedPoints );
+		this->EvaluateRange( sliceData, evaluatedPoints, wantedPoints, pointValues );
+		evaluatedPoints = wantedPoints;
+
+		//	The first half of the sequence gives an estimate of the error
+		double half_result=0.;
+		if( proxyPDF != NULL )
+		{
+			result = this->ControlVariateEstimate( wantedPoints, factor, proxyIntegral );
+			half_result = this->ControlVariateEstimate( wantedPoints/2, factor, proxyIntegral );
+		}
+		else
+		{
+			double number_good=0., half_good=0.;
+			const double sum = this->SumPoints( wantedPoints, number_good );
+			const double half_sum = this->SumPoints( wantedPoints/2, half_good );
+
+			result = number_good > 0. ? sum / ( number_good / factor ) : 0.;
+			half_result = half_good > 0. ? half_sum / ( half_good / factor ) : 0.;
+		}
+		precision = fabs( result ) > 0. ? fabs( result - half_result ) / fabs( result ) : fabs( result - half_result );
+
+		if( !adaptive || precision <= targetPrecision || wantedPoints >= numberPoints ) break;
+
+		wantedPoints = ( 2*wantedPoints < numberPoints ) ? 2*wantedPoints : numberPoints;
+	}
+
+	if( adaptive )
+	{
+		//	Never start lower next time, the normalisation must not jump back to a worse precision between Minuit steps
+		warmStart[ combination ] = wantedPoints;
+		if( precision > targetPrecision ) ++numberNotConverged;
+	}
+
+	++numberIntegrals;
+	if( wantedPoints > mostPoints ) mostPoints = wantedPoints;
+	if( precision > worstPrecision ) worstPrecision = precision;
+	sumPrecision += precision;
+
+	pthread_mutex_unlock( &grid_lock );
+
+	return result;
+#else
+	(void) functionToWrap; (void) templateDataPoint; (void) componentIndex; (void) minima; (void) maxima; (void) numberPoints; (void) numberThreads;
+	(void) targetPrecision; (void) combination; (void) proxyPDF; (void) proxyIntegral;
+	return -99999.;
+#endif
+}
+
+double IntegrationGrid::IntegrateAmplitudes( IPDF* functionToWrap, const DataPoint* templateDataPoint, const vector<double>& minima, const vector<double>& maxima,
+		const unsigned int numberPoints, const unsigned int numberThreads, const double volume )
+{
+	const unsigned int nTerms = functionToWrap->GetNumberAmplitudeTerms();
+
+	//	Which parameters change the amplitude terms, only worked out once
+	if( amplitudeShapeNames.empty() )
+	{
+		const vector<string> couplingNames = functionToWrap->GetAmplitudeCouplingNames();
+		const vector<string> allNames = functionToWrap->GetPhysicsParameters()->GetAllNames();
+		for( unsigned int i=0; i< allNames.size(); ++i )
+		{
+			if( StringProcessing::VectorContains( &couplingNames, &(allNames[i]) ) == -1 ) amplitudeShapeNames.push_back( allNames[i] );
+		}
+		//	Avoid working this out again for a PDF with only couplings
+		if( amplitudeShapeNames.empty() ) amplitudeShapeNames.push_back( "" );
+	}
+
+	vector<double> shapeKey;
+	ParameterSet* theseParameters = functionToWrap->GetPhysicsParameters();
+	for( unsigned int i=0; i< amplitudeShapeNames.size(); ++i )
+	{
+		if( amplitudeShapeNames[i].empty() ) continue;
+		shapeKey.push_back( theseParameters->GetPhysicsParameter( amplitudeShapeNames[i] )->GetValue() );
+	}
+
+	vector<double> pointKey;
+	for( unsigned int k=0; k< otherIndex.size(); ++k ) pointKey.push_back( templateDataPoint->value( otherIndex[k] ) );
+	pointKey.insert( pointKey.end(), minima.begin(), minima.end() );
+	pointKey.insert( pointKey.end(), maxima.begin(), maxima.end() );
+	pointKey.push_back( (double) numberPoints );
+
+	AmplitudeIntegrals* thisCache = NULL;
+	for( unsigned int i=0; i< amplitudeCaches.size(); ++i )
+	{
+		if( amplitudeCaches[i].pointKey == pointKey && amplitudeCaches[i].shapeKey == shapeKey && amplitudeCaches[i].all.size() == nTerms*nTerms )
+		{
+			thisCache = &(amplitudeCaches[i]);
+			break;
+		}
+	}
+
+	if( thisCache == NULL )
+	{
+		this->Generate( numberPoints );
+		if( currentMinima != minima || currentMaxima != maxima ) this->Rescale( minima, maxima );
+		this->SyncTemplate( templateDataPoint );
+		this->SetupSlices( functionToWrap, NULL, numberThreads );
+
+		//	Keep only the most recent shapes and combinations
+		if( amplitudeCaches.size() >= RAPIDFIT_AMPLITUDE_CACHE_SIZE ) amplitudeCaches.erase( amplitudeCaches.begin() );
+		amplitudeCaches.push_back( AmplitudeIntegrals() );
+		thisCache = &(amplitudeCaches.back());
+		thisCache->pointKey = pointKey;
+		thisCache->shapeKey = shapeKey;
+
+		//	The two halves of the points are summed separately for the error estimate
+		vector<complex<double> > sum_half( nTerms*nTerms, complex<double>(0.,0.) );
+		vector<complex<double> > sum_rest( nTerms*nTerms, complex<double>(0.,0.) );
+		double number_half = this->SumAmplitudeTerms( 0, numberPoints/2, nTerms, sum_half );
+		double number_rest = this->SumAmplitudeTerms( numberPoints/2, numberPoints, nTerms, sum_rest );
+
+		thisCache->half = vector<complex<double> >( nTerms*nTerms, complex<double>(0.,0.) );
+		thisCache->all = vector<complex<double> >( nTerms*nTerms, complex<double>(0.,0.) );
+		for( unsigned int i=0; i< nTerms*nTerms; ++i )
+		{
+			if( number_half > 0. ) thisCache->half[i] = sum_half[i] * ( volume / number_half );
+			if( number_half + number_rest > 0. ) thisCache->all[i] = ( sum_half[i] + sum_rest[i] ) * ( volume / ( number_half + number_rest ) );
+		}
+	}
+
+	const double result = functionToWrap->ContractAmplitudeIntegrals( thisCache->all );
+	const double half_result = functionToWrap->ContractAmplitudeIntegrals( thisCache->half );
+	const double precision = fabs( result ) > 0. ? fabs( result - half_result ) / fabs( result ) : fabs( result - half_result );
+
+	++numberIntegrals;
+	if( numberPoints > mostPoints ) mostPoints = numberPoints;
+	if( precision > worstPrecision ) worstPrecision = precision;
+	sumPrecision += precision;
+
+	return result;
+}
+
+double IntegrationGrid::SumAmplitudeTerms( const unsigned int first, const unsigned int last, const unsigned int nTerms, vector<complex<double> >& sum )
+{
+	if( last <= first ) return 0.;
+
+	const unsigned int perSlice = ( last - first ) / numberSlices;
+	unsigned int start = first;
+	for( unsigned int i=0; i< numberSlices; ++i )
+	{
+		const unsigned int end = ( i == numberSlices-1 ) ? last : start + perSlice;
+		sliceData[i].dataSubSet.assign( allPoints.begin()+start, allPoints.begin()+end );
+		sliceData[i].firstEvent = start;
+		start = end;
+	}
+	//	The main slices no longer cover the range EvaluateRange last split them for
+	sliceFirst = 0;
+	sliceLast = 0;
+
+	ThreadPool::Execute( MultiThreadedFunctions::GetThreadPool(), IntegrationGrid::AmplitudeTerms_pthread, sliceData, numberSlices );
+
+	//	Each slice leaves the real and imaginary parts of its sums followed by the number of points used
+	double number_good=0.;
+	for( unsigned int i=0; i< numberSlices; ++i )
+	{
+		const vector<double>& thisSet = sliceData[i].dataPoint_Result;
+		if( thisSet.size() != 2*nTerms*nTerms+1 ) continue;
+		for( unsigned int j=0; j< nTerms*nTerms; ++j ) sum[j] += complex<double>( thisSet[2*j], thisSet[2*j+1] );
+		number_good += thisSet.back();
+	}
+	return number_good;
+}
+
+void* IntegrationGrid::AmplitudeTerms_pthread( void* input_data )
+{
+	struct Fitting_Thread *thread_input = (struct Fitting_Thread*) input_data;
+
+	IPDF* thisPDF = thread_input->fittingPDF;
+	const unsigned int nTerms = thisPDF->GetNumberAmplitudeTerms();
+	const unsigned int number = (unsigned) thread_input->dataSubSet.size();
+
+	vector<double>& output = thread_input->dataPoint_Result;
+	output.assign( 2*nTerms*nTerms+1, 0. );
+
+	vector<complex<double> > terms( nTerms );
+	double number_good=0.;
+	for( unsigned int i=0; i< number; ++i )
+	{
+		double weight=0.;
+		try
+		{
+			thisPDF->EvaluateAmplitudeTerms( thread_input->dataSubSet[i], &(terms[0]), weight );
+		}
+		catch( ... )
+		{
+			continue;
+		}
+
+		bool good = !std::isnan(weight) && !std::isinf(weight);
+		for( unsigned int j=0; j< nTerms; ++j )
+		{
+			good = good && !std::isnan(terms[j].real()) && !std::isnan(terms[j].imag()) && !std::isinf(terms[j].real()) && !std::isinf(terms[j].imag());
+		}
+		if( !good ) continue;
+
+		//	Only the upper triangle, the matrix is Hermitian
+		for( unsigned int j=0; j< nTerms; ++j )
+		{
+			const complex<double> weighted = weight * terms[j];
+			for( unsigned int k=j; k< nTerms; ++k )
+			{
+				const complex<double> thisTerm = weighted * conj( terms[k] );
+				output[2*(j*nTerms+k)] += thisTerm.real();
+				output[2*(j*nTerms+k)+1] += thisTerm.imag();
+			}
+		}
+		++number_good;
+	}
+
+	for( unsigned int j=0; j< nTerms; ++j )
+	{
+		for( unsigned int k=0; k< j; ++k )
+		{
+			output[2*(j*nTerms+k)] = output[2*(k*nTerms+j)];
+			output[2*(j*nTerms+k)+1] = -output[2*(k*nTerms+j)+1];
+		}
+	}
+	output.back() = number_good;
+
+	return NULL;
+}
+
+void IntegrationGrid::SetFreezePoints( const bool freeze )
+{
+	freezePoints = freeze;
+}
+
+void IntegrationGrid::PrintPrecision()
+{
+	pthread_mutex_lock( &grid_lock );
+
+	if( numberIntegrals > 0 )
+	{
+		cout << setw(30) << left << gridLabel << setw(12) << numberIntegrals << setw(12) << mostPoints
+			<< setw(14) << sumPrecision/(double)numberIntegrals << setw(14) << worstPrecision;
+		if( numberNotConverged > 0 ) cout << numberNotConverged << " at the maximum number of points";
+		cout << endl;
+	}
+
+	numberIntegrals = 0;
+	numberNotConverged = 0;
+	mostPoints = 0;
+	worstPrecision = 0.;
+	sumPrecision = 0.;
+
+	pthread_mutex_unlock( &grid_lock );
+}
+
+void* IntegrationGrid::Evaluate_pthread( void* input_data )
+{
+	struct Fitting_Thread *thread_input = (struct Fitting_Thread*) input_data;
+
+	IPDF* thisPDF = thread_input->fittingPDF;
+	const unsigned int number = (unsigned) thread_input->dataSubSet.size();
+
+	//	The capacity is kept between calls
+	thread_input->dataPoint_Result.resize( number );
+	double* output = number > 0 ? &(thread_input->dataPoint_Result[0]) : NULL;
+
+	if( thread_input->thisComponent != NULL )
+	{
+		for( unsigned int i=0; i< number; ++i )
+		{
+			try
+			{
+				output[i] = thisPDF->EvaluateComponent( thread_input->dataSubSet[i], thread_input->thisComponent );
+			}
+			catch( ... )
+			{
+				output[i] = DBL_MAX;
+			}
+		}
+		return NULL;
+	}
+
+	for( unsigned int blockStart=0; blockStart< number; blockStart+=RAPIDFIT_EVENT_BLOCK_SIZE )
+	{
+		const unsigned int blockSize = ( number-blockStart < RAPIDFIT_EVENT_BLOCK_SIZE ) ? number-blockStart : RAPIDFIT_EVENT_BLOCK_SIZE;
+		EventBlock thisBlock( &(thread_input->dataSubSet[blockStart]), blockSize );
+
+		try
+		{
+			thisPDF->EvaluateBatch( thisBlock, output+blockStart );
+		}
+		catch( ... )
+		{
+			//	Find out which point(s) the PDF objected to
+			for( unsigned int i=0; i< blockSize; ++i )
+			{
+				try
+				{
+					output[blockStart+i] = thisPDF->Evaluate( thisBlock.GetDataPoint( i ) );
+				}
+				catch( ... )
+				{
+					output[blockStart+i] = DBL_MAX;
+				}
+			}
+		}
+	}
+
+	return NULL;
+}
+
@@ -49,7 +49,7 @@ namespace JackKnife
 		PhaseSpaceBoundary * phase = xmlFile->GetPhaseSpaceBoundaries()[0];
 		pdfAndData->SetPhysicsParameters( parSet );
 			
-		MemoryDataSet * dataset = (MemoryDataSet*) pdfAndData->GetDataSet();
+		IDataSet * dataset = pdfAndData->GetDataSet();
 		vector<IDataSet*> data;
 		data.push_back(dataset);
 	
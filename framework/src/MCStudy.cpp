@@ -6,9 +6,11 @@
 #include "FitResultVector.h"
 #include "FitAssembler.h"
 #include "PDFWithData.h"
+#include "StudyJournal.h"
 //	System Headers
 #include <string>
 #include <vector>
+#include <sstream>
 
 using namespace::std;
 
@@ -93,8 +95,32 @@ void MCStudy::DoWholeStudy( int OutputLevel )
 		cerr << "Sorry don't quite know how this happened!" << endl; return;
 	}
 
+	//	The steps are fits to fixed subsets of the data so there is no seed to check the journal against
+	stringstream studyDefinition;
+	studyDefinition << "MCStudy " << numberStudies;
+	for( unsigned int i=0; i< events_to_step_over.size(); ++i ) studyDefinition << " " << events_to_step_over[i];
+	for( unsigned int i=0; i< StartingEntries.size(); ++i ) studyDefinition << " " << StartingEntries[i];
+	StudyJournal thisJournal( "MCStudy.journal", 0, studyDefinition.str() );
+
 	for( int i=0; i < numberStudies; ++i )
 	{
+		if( thisJournal.IsFinished( 0, (unsigned) i ) )
+		{
+			double realTime=0., cpuTime=0.;
+			vector<FitResult*> oldResults = thisJournal.GetResults( 0, (unsigned) i, realTime, cpuTime );
+			if( !oldResults.empty() )
+			{
+				cout << "MCStudy: Step " << i+1 << " was read back from the journal" << endl;
+				if( allResults->AddFitResult( oldResults[0], false ) )
+				{
+					allResults->AddRealTime( realTime );
+					allResults->AddCPUTime( cpuTime );
+				}
+				for( unsigned int r=1; r< oldResults.size(); ++r ) delete oldResults[r];
+				continue;
+			}
+		}
+
 		vector<int> local_Start_entries;
 		vector<int>::iterator start_i=StartingEntries.begin();
 		vector<int>::iterator entries_i=events_to_step_over.begin();
@@ -124,7 +150,11 @@ void MCStudy::DoWholeStudy( int OutputLevel )
 
 		FitResult * newResult = FitAssembler::DoSafeFit( theMinimiser, theFunction, studyParameters, local_PDF_w_Data, allConstraints, OutputLevel );
 
-		allResults->AddFitResult( newResult );
+		if( allResults->AddFitResult( newResult ) )
+		{
+			const int last = allResults->NumberResults()-1;
+			thisJournal.Record( 0, (unsigned) i, 0, vector<FitResult*>( 1, newResult ), allResults->GetRealTime( last ), allResults->GetCPUTime( last ) );
+		}
 
 	}
 
@@ -28,16 +28,69 @@ MakeFoam::MakeFoam( const MakeFoam& input ) :
 //Constructor with correct argument
 MakeFoam::MakeFoam( IPDF * InputPDF, PhaseSpaceBoundary * InputBoundary, DataPoint * InputPoint ) : finishedCells(), centerPoints(), centerValues(), cellIntegrals(), integratePDF(InputPDF)
 {
-	//Make the container to hold the possible cells
-	queue<PhaseSpaceBoundary*> possibleCells;
-	PhaseSpaceBoundary* firstCell = InputBoundary;
-	possibleCells.push(firstCell);
-
 	//Make a list of observables to integrate over
 	vector<string> doIntegrate, dontIntegrate;
 	vector<string> pdfDontIntegrate = InputPDF->GetDoNotIntegrateList();
 	StatisticsFunctions::DoDontIntegrateLists( InputPDF, InputBoundary, &(pdfDontIntegrate), doIntegrate, dontIntegrate );
 
+	finishedCells = MakeFoam::MakeCells( InputPDF, InputBoundary, InputPoint, doIntegrate, dontIntegrate, MAXIMUM_SAMPLES, MAXIMUM_CELLS );
+
+	for (unsigned int cellIndex = 0; cellIndex < finishedCells.size(); ++cellIndex )
+	{
+		//Create a data point at the center of the cell
+		DataPoint* cellCenter = new DataPoint( InputPoint->GetAllNames() );
+		for (unsigned int observableIndex = 0; observableIndex < doIntegrate.size(); ++observableIndex )
+		{
+			//Calculate the cell mid point
+			IConstraint * temporaryConstraint = finishedCells[cellIndex]->GetConstraint( doIntegrate[observableIndex] );
+			double midPoint = temporaryConstraint->GetMinimum() + ( ( temporaryConstraint->GetMaximum() - temporaryConstraint->GetMinimum() ) / 2.0 );
+
+			//Use the mid points for the integrable values
+			Observable * temporaryObservable = cellCenter->GetObservable( doIntegrate[observableIndex] );
+			Observable* temporaryObservable2 = new Observable( temporaryObservable->GetName(), midPoint, temporaryObservable->GetUnit() );
+			cellCenter->SetObservable( doIntegrate[observableIndex], temporaryObservable2 );
+			delete temporaryObservable2;
+		}
+		for (unsigned int observableIndex = 0; observableIndex < dontIntegrate.size(); ++observableIndex )
+		{
+			//Use given values for unintegrable observables
+			Observable * temporaryObservable = new Observable( *(InputPoint->GetObservable( dontIntegrate[observableIndex] )) );
+			cellCenter->SetObservable( dontIntegrate[observableIndex], temporaryObservable );
+			delete temporaryObservable;
+		}
+
+		//Store the center point
+		centerPoints.push_back(cellCenter);
+	}
+
+	//Now all the cells have been made!
+	//Make a numerical integrator for the function
+	RapidFitIntegrator cellIntegrator( InputPDF, true );
+
+	//Find the function value at the center of each cell, and the integral of the function over the cell
+	for (unsigned int cellIndex = 0; cellIndex < finishedCells.size(); ++cellIndex )
+	{
+		//Integrate the cell
+		double integral = cellIntegrator.Integral( InputPoint, finishedCells[cellIndex] );
+		cellIntegrals.push_back(integral);
+
+		//Evaluate the function at the center of the cell
+		double value = InputPDF->Evaluate( centerPoints[cellIndex] );
+		centerValues.push_back(value);
+	}
+}
+
+//Split the phase space into cells over which the PDF projections are roughly flat
+vector<PhaseSpaceBoundary*> MakeFoam::MakeCells( IPDF * InputPDF, PhaseSpaceBoundary * InputBoundary, DataPoint * InputPoint, const vector<string>& doIntegrate,
+		const vector<string>& dontIntegrate, const int samples, const int maximumCells, TRandom3 * random )
+{
+	vector<PhaseSpaceBoundary*> finishedCells;
+
+	//Make the container to hold the possible cells
+	queue<PhaseSpaceBoundary*> possibleCells;
+	PhaseSpaceBoundary* firstCell = new PhaseSpaceBoundary( *InputBoundary );
+	possibleCells.push(firstCell);
+
 	//Continue until all possible cells have been examined
 	while ( !possibleCells.empty() )
 	{
@@ -69,7 +122,7 @@ MakeFoam::MakeFoam( IPDF * InputPDF, PhaseSpaceBoundary * InputBoundary, DataPoi
 		}
 
 		//MC sample the cell, make projections, sort of
-		for (int sampleIndex = 0; sampleIndex < MAXIMUM_SAMPLES; ++sampleIndex )
+		for (int sampleIndex = 0; sampleIndex < samples; ++sampleIndex )
 		{
 			//Create a data point within the current cell
 			DataPoint samplePoint( InputPoint->GetAllNames() );
@@ -77,7 +130,9 @@ MakeFoam::MakeFoam( IPDF * InputPDF, PhaseSpaceBoundary * InputBoundary, DataPoi
 			{
 				//Generate random values to explore integrable observables
 				IConstraint * temporaryConstraint = currentCell->GetConstraint( doIntegrate[observableIndex] );
-				samplePoint.SetObservable( doIntegrate[observableIndex], temporaryConstraint->CreateObservable() );
+				Observable * temporaryObservable = ( random != NULL ) ? temporaryConstraint->CreateObservable( random ) : temporaryConstraint->CreateObservable();
+				samplePoint.SetObservable( doIntegrate[observableIndex], temporaryObservable );
+				delete temporaryObservable;
 			}
 			for (unsigned int observableIndex = 0; observableIndex < dontIntegrate.size(); ++observableIndex )
 			{
@@ -117,7 +172,6 @@ MakeFoam::MakeFoam( IPDF * InputPDF, PhaseSpaceBoundary * InputBoundary, DataPoi
 		}
 
 		//Find the maximum gradient
-		vector<double> midPoints;
 		string maximumGradientObservable, unit;
 		double maximumGradient=0.;
 		double lowPoint=0.;
@@ -130,10 +184,6 @@ MakeFoam::MakeFoam( IPDF * InputPDF, PhaseSpaceBoundary * InputBoundary, DataPoi
 			double cellMaximum = temporaryConstraint->GetMaximum();
 			double cellMinimum = temporaryConstraint->GetMinimum();
 
-			//Store the mid point
-			double observableMiddle = cellMinimum + ( ( cellMaximum - cellMinimum ) / 2.0 );
-			midPoints.push_back(observableMiddle);
-
 			for ( int binIndex = 1; binIndex < HISTOGRAM_BINS; ++binIndex )
 			{
 				double gradient = abs( histogramBinHeights[observableIndex][ unsigned(binIndex - 1) ] - histogramBinHeights[observableIndex][unsigned(binIndex)] );
@@ -156,27 +206,6 @@ MakeFoam::MakeFoam( IPDF * InputPDF, PhaseSpaceBoundary * InputBoundary, DataPoi
 		{
 			//Store the finished cell
 			finishedCells.push_back(currentCell);
-
-			//Create a data point at the center of the current cell
-			DataPoint* cellCenter = new DataPoint( InputPoint->GetAllNames() );
-			for (unsigned int observableIndex = 0; observableIndex < doIntegrate.size(); ++observableIndex )
-			{
-				//Use the mid points for the integrable values
-				Observable * temporaryObservable = cellCenter->GetObservable( doIntegrate[observableIndex] );
-				Observable* temporaryObservable2 = new Observable( temporaryObservable->GetName(), midPoints[observableIndex], temporaryObservable->GetUnit() );
-				cellCenter->SetObservable( doIntegrate[observableIndex], temporaryObservable2 );
-				delete temporaryObservable2;
-			}
-			for (unsigned int observableIndex = 0; observableIndex < dontIntegrate.size(); ++observableIndex )
-			{
-				//Use given values for unintegrable observables
-				Observable * temporaryObservable = new Observable( *(InputPoint->GetObservable( dontIntegrate[observableIndex] )) );
-				cellCenter->SetObservable( dontIntegrate[observableIndex], temporaryObservable );
-				delete temporaryObservable;
-			}
-
-			//Store the center point
-			centerPoints.push_back(cellCenter);
 		}
 		else
 		{
@@ -220,10 +249,11 @@ MakeFoam::MakeFoam( IPDF * InputPDF, PhaseSpaceBoundary * InputBoundary, DataPoi
 			//Add the two new cells to the possibles
 			possibleCells.push(daughterCell1);
 			possibleCells.push(daughterCell2);
+			delete currentCell;
 		}
 
 		//Make sure you don't exceed the maximum number of cells
-		if ( int(finishedCells.size() + possibleCells.size()) >= MAXIMUM_CELLS )
+		if ( int(finishedCells.size() + possibleCells.size()) >= maximumCells )
 		{
 			cout << "MakeFoam warning: maximum cells reached with " << possibleCells.size() << " unexplored" << endl;
 
@@ -234,31 +264,6 @@ MakeFoam::MakeFoam( IPDF * InputPDF, PhaseSpaceBoundary * InputBoundary, DataPoi
 				PhaseSpaceBoundary* temporaryCell = possibleCells.front();
 				possibleCells.pop();
 				finishedCells.push_back(temporaryCell);
-
-				//Create a data point at the center of the current cell
-				DataPoint* cellCenter = new DataPoint( InputPoint->GetAllNames() );
-				for (unsigned int observableIndex = 0; observableIndex < doIntegrate.size(); ++observableIndex )
-				{
-					//Calculate the cell mid point
-					IConstraint * temporaryConstraint = temporaryCell->GetConstraint( doIntegrate[observableIndex] );
-					double midPoint = temporaryConstraint->GetMinimum() + ( ( temporaryConstraint->GetMaximum() - temporaryConstraint->GetMinimum() ) / 2  );
-
-					//Use the mid points for the integrable values
-					Observable * temporaryObservable = cellCenter->GetObservable( doIntegrate[observableIndex] );
-					Observable* temporaryObservable2 = new Observable( temporaryObservable->GetName(), midPoint, temporaryObservable->GetUnit() );
-					cellCenter->SetObservable( doIntegrate[observableIndex], temporaryObservable2 );
-					delete temporaryObservable2;
-				}
-				for (unsigned int observableIndex = 0; observableIndex < dontIntegrate.size(); ++observableIndex )
-				{
-					//Use given values for unintegrable observables
-					Observable * temporaryObservable = new Observable( *(InputPoint->GetObservable( dontIntegrate[observableIndex] )) );
-					cellCenter->SetObservable( dontIntegrate[observableIndex], temporaryObservable );
-					delete temporaryObservable;
-				}
-
-				//Store the center point
-				centerPoints.push_back(cellCenter);
 			}
 
 			//Exit the foam loop
@@ -266,21 +271,7 @@ MakeFoam::MakeFoam( IPDF * InputPDF, PhaseSpaceBoundary * InputBoundary, DataPoi
 		}
 	}
 
-	//Now all the cells have been made!
-	//Make a numerical integrator for the function
-	RapidFitIntegrator cellIntegrator( InputPDF, true );
-
-	//Find the function value at the center of each cell, and the integral of the function over the cell
-	for (unsigned int cellIndex = 0; cellIndex < finishedCells.size(); ++cellIndex )
-	{
-		//Integrate the cell
-		double integral = cellIntegrator.Integral( InputPoint, finishedCells[cellIndex] );
-		cellIntegrals.push_back(integral);
-
-		//Evaluate the function at the center of the cell
-		double value = InputPDF->Evaluate( centerPoints[cellIndex] );
-		centerValues.push_back(value);
-	}
+	return finishedCells;
 }
 
 //Destructor
@@ -34,6 +34,10 @@
 #include <pthread.h>
 #include <iomanip>
 #include <complex>
+#include <algorithm>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
 pthread_mutex_t ROOT_Lock = pthread_mutex_t();
 
@@ -297,6 +301,271 @@ namespace Mathematics
 	}
 
 
+	//	Weideman's rational approximation to the Faddeeva function, J.A.C. Weideman, SIAM J. Numer. Anal. 31 (1994) 1497
+	//	w(z) ~= 2 p(Z) / (L-iz)^2 + 1/(sqrt(pi) (L-iz)),   Z = (L+iz)/(L-iz),   p a polynomial of degree cerfBatchTerms-1
+	//	This is valid in the upper half plane and only needs +,-,*,/ so it vectorises well
+	static const unsigned int cerfBatchTerms = 32;
+
+	//	Events processed per chunk in the batch functions, the scratch space for a chunk is held on the stack
+	static const unsigned int cerfBatchChunk = 64;
+
+	struct WeidemanCoefficients
+	{
+		WeidemanCoefficients() : L( sqrt( cerfBatchTerms / sqrt(2.) ) )
+		{
+			//	The coefficients are the Fourier coefficients of exp(-t^2)(L^2+t^2) with t = L tan(theta/2)
+			const int M = 2*(int)cerfBatchTerms;
+			vector<double> f( 2*M, 0. );
+			for( int k=-M+1; k< M; ++k )
+			{
+				const double t = L * tan( 0.5 * k * _pi / M );
+				f[k+M] = exp( -t*t ) * ( L*L + t*t );
+			}
+			for( unsigned int j=1; j<= cerfBatchTerms; ++j )
+			{
+				double sum=0.;
+				for( int k=-M+1; k< M; ++k ) sum += f[k+M] * cos( _pi * j * k / M );
+				a[j-1] = sum / ( 2.*M );
+			}
+		}
+
+		double L;
+		double a[cerfBatchTerms];	//	a[n] is the coefficient of Z^n
+	};
+
+	static const WeidemanCoefficients weideman;
+
+	//	w(x+iy) for y >= 0
+	static inline void faddeevaUpperOne( const double x, const double y, double& w_re, double& w_im )
+	{
+		const double L = weideman.L;
+		const double d_re = L + y;
+		const double d_im = -x;
+		const double inv_denom = 1. / ( d_re*d_re + d_im*d_im );
+		const double n_re = L - y;
+		const double n_im = x;
+		const double Z_re = ( n_re*d_re + n_im*d_im ) * inv_denom;
+		const double Z_im = ( n_im*d_re - n_re*d_im ) * inv_denom;
+
+		double p_re = weideman.a[cerfBatchTerms-1];
+		double p_im = 0.;
+		for( int n=(int)cerfBatchTerms-2; n>= 0; --n )
+		{
+			const double next_re = p_re*Z_re - p_im*Z_im + weideman.a[n];
+			p_im = p_re*Z_im + p_im*Z_re;
+			p_re = next_re;
+		}
+
+		const double inv_re = d_re * inv_denom;
+		const double inv_im = -d_im * inv_denom;
+		const double inv2_re = inv_re*inv_re - inv_im*inv_im;
+		const double inv2_im = 2. * inv_re*inv_im;
+
+		w_re = 2. * ( p_re*inv2_re - p_im*inv2_im ) + inv_re / rootpi;
+		w_im = 2. * ( p_re*inv2_im + p_im*inv2_re ) + inv_im / rootpi;
+	}
+
+#ifdef __AVX2__
+	//	As faddeevaUpperOne for the 4 points starting at x_in, y_in
+	static inline void faddeevaUpperFour( const double* x_in, const double* y_in, double* w_re, double* w_im )
+	{
+		const __m256d L = _mm256_set1_pd( weideman.L );
+		const __m256d one = _mm256_set1_pd( 1. );
+		const __m256d two = _mm256_set1_pd( 2. );
+
+		const __m256d x = _mm256_loadu_pd( x_in );
+		const __m256d y = _mm256_loadu_pd( y_in );
+
+		const __m256d d_re = _mm256_add_pd( L, y );
+		const __m256d d_im = _mm256_sub_pd( _mm256_setzero_pd(), x );
+		const __m256d inv_denom = _mm256_div_pd( one, _mm256_add_pd( _mm256_mul_pd( d_re, d_re ), _mm256_mul_pd( d_im, d_im ) ) );
+		const __m256d n_re = _mm256_sub_pd( L, y );
+		const __m256d n_im = x;
+		const __m256d Z_re = _mm256_mul_pd( _mm256_add_pd( _mm256_mul_pd( n_re, d_re ), _mm256_mul_pd( n_im, d_im ) ), inv_denom );
+		const __m256d Z_im = _mm256_mul_pd( _mm256_sub_pd( _mm256_mul_pd( n_im, d_re ), _mm256_mul_pd( n_re, d_im ) ), inv_denom );
+
+		__m256d p_re = _mm256_set1_pd( weideman.a[cerfBatchTerms-1] );
+		__m256d p_im = _mm256_setzero_pd();
+		for( int n=(int)cerfBatchTerms-2; n>= 0; --n )
+		{
+			const __m256d next_re = _mm256_add_pd( _mm256_sub_pd( _mm256_mul_pd( p_re, Z_re ), _mm256_mul_pd( p_im, Z_im ) ), _mm256_set1_pd( weideman.a[n] ) );
+			p_im = _mm256_add_pd( _mm256_mul_pd( p_re, Z_im ), _mm256_mul_pd( p_im, Z_re ) );
+			p_re = next_re;
+		}
+
+		const __m256d inv_re = _mm256_mul_pd( d_re, inv_denom );
+		const __m256d inv_im = _mm256_mul_pd( _mm256_sub_pd( _mm256_setzero_pd(), d_im ), inv_denom );
+		const __m256d inv2_re = _mm256_sub_pd( _mm256_mul_pd( inv_re, inv_re ), _mm256_mul_pd( inv_im, inv_im ) );
+		const __m256d inv2_im = _mm256_mul_pd( two, _mm256_mul_pd( inv_re, inv_im ) );
+		const __m256d over_rootpi = _mm256_set1_pd( 1. / rootpi );
+
+		const __m256d result_re = _mm256_add_pd( _mm256_mul_pd( two, _mm256_sub_pd( _mm256_mul_pd( p_re, inv2_re ), _mm256_mul_pd( p_im, inv2_im ) ) ), _mm256_mul_pd( inv_re, over_rootpi ) );
+		const __m256d result_im = _mm256_add_pd( _mm256_mul_pd( two, _mm256_add_pd( _mm256_mul_pd( p_re, inv2_im ), _mm256_mul_pd( p_im, inv2_re ) ) ), _mm256_mul_pd( inv_im, over_rootpi ) );
+
+		_mm256_storeu_pd( w_re, result_re );
+		_mm256_storeu_pd( w_im, result_im );
+	}
+#endif
+
+	//	w(x+iy) for numberPoints points with y >= 0, 4 at a time with AVX2 and the rest one at a time
+	static void faddeevaUpperBatch( const double* x, const double* y, const unsigned int numberPoints, double* w_re, double* w_im )
+	{
+		unsigned int i=0;
+#ifdef __AVX2__
+		for( ; i+4 <= numberPoints; i+=4 )
+		{
+			faddeevaUpperFour( x+i, y+i, w_re+i, w_im+i );
+		}
+#endif
+		for( ; i< numberPoints; ++i )
+		{
+			faddeevaUpperOne( x[i], y[i], w_re[i], w_im[i] );
+		}
+	}
+
+	//	The same construction with 160 terms in long double, only used by TestCerfBatch
+	struct WeidemanReference
+	{
+		WeidemanReference() : L( sqrtl( numberTerms / sqrtl( 2.L ) ) )
+		{
+			const long double pi = 3.14159265358979323846264338327950288L;
+			const int M = 2*numberTerms;
+			vector<long double> f( 2*M, 0.L );
+			for( int k=-M+1; k< M; ++k )
+			{
+				const long double t = L * tanl( 0.5L * k * pi / M );
+				f[k+M] = expl( -t*t ) * ( L*L + t*t );
+			}
+			for( int j=1; j<= numberTerms; ++j )
+			{
+				long double sum=0.L;
+				for( int k=-M+1; k< M; ++k ) sum += f[k+M] * cosl( pi * j * k / M );
+				a[j-1] = sum / ( 2.L*M );
+			}
+		}
+
+		complex<long double> w( const long double x, const long double y ) const
+		{
+			const long double rootpi_l = 1.77245385090551602729816748334114518L;
+			const complex<long double> iz( -y, x );
+			const complex<long double> Z = ( L + iz ) / ( L - iz );
+			complex<long double> p = a[numberTerms-1];
+			for( int n=numberTerms-2; n>= 0; --n ) p = p*Z + a[n];
+			return 2.L * p / ( ( L - iz ) * ( L - iz ) ) + 1.L / ( rootpi_l * ( L - iz ) );
+		}
+
+		static const int numberTerms = 160;
+		long double L;
+		long double a[numberTerms];
+	};
+
+	bool TestCerfBatch()
+	{
+		const double tolerance = 5E-13;
+		const WeidemanReference reference;
+
+		//	One row of the grid at a time, 4001 points so there is a tail after the blocks of 4
+		const unsigned int numberRe = 4001;
+		vector<double> x( numberRe ), y( numberRe ), w_re( numberRe ), w_im( numberRe );
+
+		double worstGrid=0., worstX=0., worstY=0.;
+		for( unsigned int j=0; j<= 2000; ++j )
+		{
+			for( unsigned int i=0; i< numberRe; ++i )
+			{
+				x[i] = -200. + 0.1*i;
+				y[i] = 0.1*j;
+			}
+			faddeevaUpperBatch( &(x[0]), &(y[0]), numberRe, &(w_re[0]), &(w_im[0]) );
+			for( unsigned int i=0; i< numberRe; ++i )
+			{
+				const complex<long double> exact = reference.w( x[i], y[i] );
+				const double difference = (double)( sqrtl( ( w_re[i] - exact.real() )*( w_re[i] - exact.real() ) + ( w_im[i] - exact.imag() )*( w_im[i] - exact.imag() ) ) / abs( exact ) );
+				if( difference > worstGrid ) { worstGrid = difference; worstX = x[i]; worstY = y[i]; }
+			}
+		}
+
+		//	On the imaginary axis w(iy) = exp(y^2)erfc(y), beyond y=100 erfc underflows even in long double
+		const unsigned int numberIm = 10001;
+		vector<double> axis_x( numberIm, 0. ), axis_y( numberIm ), axis_re( numberIm ), axis_im( numberIm );
+		for( unsigned int j=0; j< numberIm; ++j ) axis_y[j] = 0.01*j;
+		faddeevaUpperBatch( &(axis_x[0]), &(axis_y[0]), numberIm, &(axis_re[0]), &(axis_im[0]) );
+		double worstAxis=0.;
+		for( unsigned int j=0; j< numberIm; ++j )
+		{
+			const long double exact = expl( (long double)axis_y[j]*axis_y[j] ) * erfcl( axis_y[j] );
+			const double difference = (double)( sqrtl( ( axis_re[j] - exact )*( axis_re[j] - exact ) + (long double)axis_im[j]*axis_im[j] ) / exact );
+			if( difference > worstAxis ) worstAxis = difference;
+		}
+
+#ifdef __AVX2__
+		cout << "Mathematics::evalCerfBatch (AVX2 build, 4 points at a time):" << endl;
+#else
+		cout << "Mathematics::evalCerfBatch (scalar build):" << endl;
+#endif
+		cout << "	Largest |w - w_exact| / |w_exact| against the " << WeidemanReference::numberTerms << " term long double evaluation for |Re z|<=200, 0<=Im z<=200 in steps of 0.1: "
+			<< worstGrid << " at z = " << worstX << " + " << worstY << "i" << endl;
+		cout << "	Largest |w - w_exact| / |w_exact| against exp(y^2)erfc(y) for 0<=y<=100: " << worstAxis << endl;
+
+		const bool passed = worstGrid < tolerance && worstAxis < tolerance;
+		cout << "	" << ( passed ? "PASSED" : "FAILED" ) << ", tolerance " << tolerance << endl;
+		return passed;
+	}
+
+	void evalCerfBatch( const double* swt, const double* u, const double* c, const unsigned int numberEvents, double* re, double* im )
+	{
+		double x[cerfBatchChunk], y[cerfBatchChunk];
+		double w_re[cerfBatchChunk], w_im[cerfBatchChunk];
+
+		for( unsigned int chunkStart=0; chunkStart< numberEvents; chunkStart+=cerfBatchChunk )
+		{
+			const unsigned int chunkSize = min( cerfBatchChunk, numberEvents-chunkStart );
+
+			//	Map every point into the upper half plane, points handled by evalCerfApprox are given a harmless dummy value
+			for( unsigned int i=0; i< chunkSize; ++i )
+			{
+				const unsigned int j = chunkStart+i;
+				const double this_x = swt[j]*c[j];
+				const double this_y = u[j]+c[j];
+				if( this_y <= -4.0 ) { x[i] = 0.; y[i] = 1.; }
+				else if( this_y < 0. ) { x[i] = -this_x; y[i] = -this_y; }
+				else { x[i] = this_x; y[i] = this_y; }
+			}
+
+			faddeevaUpperBatch( x, y, chunkSize, w_re, w_im );
+
+			for( unsigned int i=0; i< chunkSize; ++i )
+			{
+				const unsigned int j = chunkStart+i;
+				const double this_x = swt[j]*c[j];
+				const double this_y = u[j]+c[j];
+				const double u_sq = u[j]*u[j];
+				if( this_y <= -4.0 )
+				{
+					const complex<double> approx = evalCerfApprox( swt[j], u[j], c[j] );
+					re[j] = approx.real();
+					im[j] = approx.imag();
+				}
+				else if( this_y < 0. )
+				{
+					//	exp(-u^2) w(z) = 2 exp(-z^2-u^2) - exp(-u^2) w(-z)
+					const double v_mag = 2. * exp( this_y*this_y - this_x*this_x - u_sq );
+					const double v_arg = -2. * this_x * this_y;
+					const double exp_u = exp( -u_sq );
+					re[j] = v_mag * cos( v_arg ) - exp_u * w_re[i];
+					im[j] = v_mag * sin( v_arg ) - exp_u * w_im[i];
+				}
+				else
+				{
+					const double exp_u = exp( -u_sq );
+					re[j] = exp_u * w_re[i];
+					im[j] = exp_u * w_im[i];
+				}
+			}
+		}
+	}
+
+
 	//----------------------------------------------------------------------------------------------
 	//........................................
 	//evaluate a simple exponential with single gaussian time resolution
@@ -584,6 +853,56 @@ namespace Mathematics
 		}
 	}
 
+	void ExpBatch( const double* t, const double gamma, const double* resolution, const unsigned int numberEvents, double* output )
+	{
+		for( unsigned int i=0; i< numberEvents; ++i )
+		{
+			output[i] = Exp( t[i], gamma, resolution[i] );
+		}
+	}
+
+	void ExpCosSinBatch( const double* t, const double gamma, const double deltaM, const double* resolution, const unsigned int numberEvents, double* expCos, double* expSin )
+	{
+		//	The first half of each is for +wt, the second for -wt
+		double swt[2*cerfBatchChunk], u[2*cerfBatchChunk], c[2*cerfBatchChunk];
+		double cerf_re[2*cerfBatchChunk], cerf_im[2*cerfBatchChunk];
+
+		const double wt = deltaM / gamma ;
+
+		for( unsigned int chunkStart=0; chunkStart< numberEvents; chunkStart+=cerfBatchChunk )
+		{
+			const unsigned int chunkSize = min( cerfBatchChunk, numberEvents-chunkStart );
+
+			for( unsigned int i=0; i< chunkSize; ++i )
+			{
+				const double thisRes = resolution[chunkStart+i];
+				const double this_c = ( thisRes > 0. ) ? gamma * thisRes*_over_sqrt_2 : 0.;
+				const double this_u = ( thisRes > 0. ) ? ( t[chunkStart+i] / thisRes ) *_over_sqrt_2 : 0.;
+				swt[i] = wt; u[i] = -this_u; c[i] = this_c;
+				swt[chunkSize+i] = -wt; u[chunkSize+i] = -this_u; c[chunkSize+i] = this_c;
+			}
+
+			evalCerfBatch( swt, u, c, 2*chunkSize, cerf_re, cerf_im );
+
+			for( unsigned int i=0; i< chunkSize; ++i )
+			{
+				const unsigned int j = chunkStart+i;
+				if( resolution[j] > 0. )
+				{
+					expCos[j] = ( cerf_re[i] + cerf_re[chunkSize+i] ) * 0.25;
+					expSin[j] = ( cerf_im[i] - cerf_im[chunkSize+i] ) * 0.25;
+				}
+				else
+				{
+					const double deltaM_t = deltaM * t[j];
+					const double exp_val = exp( -gamma *t[j] );
+					expCos[j] = exp_val * cos( deltaM_t );
+					expSin[j] = exp_val * sin( deltaM_t );
+				}
+			}
+		}
+	}
+
 	//.................................................................
 	// Evaluate integral of exponential X cosine with single time resolution
 	double ExpCosInt( double tlow, double thigh, double gamma, double deltaM, double resolution  )
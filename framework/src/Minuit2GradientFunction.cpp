@@ -0,0 +1,99 @@
+/**
+        @class Minuit2GradientFunction
+
+        A wrapper making IFitFunctions which provide an analytic gradient work with the Minuit2 API
+*/
+
+//	RapidFit Headers
+#include "Minuit2GradientFunction.h"
+//	System Headers
+#include <iostream>
+#include <cmath>
+
+using namespace::std;
+
+//Constructor with correct argument
+Minuit2GradientFunction::Minuit2GradientFunction( IFitFunction * NewFitFunction, Minuit2Function * NewFunction ) : function(NewFitFunction), valueFunction(NewFunction)
+{
+}
+
+//Destructor
+Minuit2GradientFunction::~Minuit2GradientFunction()
+{
+}
+
+//Return the value to minimise, given the parameters passed
+double Minuit2GradientFunction::operator()( const vector<double>& NewParameterValues ) const
+{
+	return (*valueFunction)( NewParameterValues );
+}
+
+//Return the derivative of the value to minimise with respect to each parameter
+vector<double> Minuit2GradientFunction::Gradient( const vector<double>& NewParameterValues ) const
+{
+	//Make parameter set and pass to wrapped function
+	ParameterSet * temporaryParameters = function->GetParameterSet();
+
+	try
+	{
+		temporaryParameters->SetPhysicsParameters(NewParameterValues);
+		function->SetParameterSet(temporaryParameters);
+	}
+	catch(...)
+	{
+		cerr << "Minuit2 does not provide the correct parameters" << endl;
+		throw(-9999);
+	}
+
+	vector<double> gradient;
+	if( function->EvaluateGradient( gradient ) ) return gradient;
+
+	cerr << "Minuit2GradientFunction: Analytic gradient failed, using central differences for this step" << endl;
+	return this->NumericalGradient( NewParameterValues );
+}
+
+vector<double> Minuit2GradientFunction::NumericalGradient( const vector<double>& NewParameterValues ) const
+{
+	vector<double> gradient( NewParameterValues.size(), 0. );
+	vector<double> shifted( NewParameterValues );
+
+	ParameterSet * parameterSet = function->GetParameterSet();
+	vector<string> allNames = parameterSet->GetAllNames();
+
+	for( unsigned int i=0; i< NewParameterValues.size() && i< allNames.size(); ++i )
+	{
+		if( parameterSet->GetPhysicsParameter( allNames[i] )->GetType() == "Fixed" ) continue;
+
+		double step = 1E-5 * ( fabs( NewParameterValues[i] ) > 1. ? fabs( NewParameterValues[i] ) : 1. );
+
+		shifted[i] = NewParameterValues[i] + step;
+		double upper = (*valueFunction)( shifted );
+		shifted[i] = NewParameterValues[i] - step;
+		double lower = (*valueFunction)( shifted );
+		shifted[i] = NewParameterValues[i];
+
+		gradient[i] = ( upper - lower ) / ( 2. * step );
+	}
+
+	//	Leave the FitFunction at the requested point
+	(*valueFunction)( NewParameterValues );
+
+	return gradient;
+}
+
+//Set the up value for error calculation
+void Minuit2GradientFunction::SetErrorDef( double thisUp )
+{
+	valueFunction->SetErrorDef( thisUp );
+}
+
+//Return the up value for error calculation
+double Minuit2GradientFunction::Up() const
+{
+	return valueFunction->Up();
+}
+double Minuit2GradientFunction::ErrorDef() const
+{
+	return valueFunction->ErrorDef();
+}
+
@@ -16,12 +16,14 @@
 #include "TMatrixDSym.h"
 //	RapidFit Headers
 #include "Minuit2Wrapper.h"
+#include "ParallelHessian.h"
 #include "ResultParameterSet.h"
 #include "StringProcessing.h"
 //	System Headers
 #include <iostream>
 #include <limits>
 #include <ctime>
+#include <cmath>
 
 //const double MAXIMUM_MINIMISATION_STEPS = 100000.0;//800.0;
 //const double FINAL_GRADIENT_TOLERANCE = 0.01;//;0.001;
@@ -30,7 +32,8 @@ const double STEP_SIZE = 0.01;
 
 //Default constructor
 Minuit2Wrapper::Minuit2Wrapper() :
-	function(NULL), RapidFunction(NULL), fitResult(NULL), contours(), maxSteps(), bestTolerance(), Options(), Quality(), nSigma(1), minimum(NULL)
+	function(NULL), gradientFunction(NULL), RapidFunction(NULL), fitResult(NULL), contours(), maxSteps(), bestTolerance(), Options(), Quality(), nSigma(1), minimum(NULL),
+	parallelCovariance(NULL)
 {
 }
 
@@ -38,6 +41,8 @@ Minuit2Wrapper::Minuit2Wrapper() :
 Minuit2Wrapper::~Minuit2Wrapper()
 {
 	if( minimum != NULL ) delete minimum;
+	if( gradientFunction != NULL ) delete gradientFunction;
+	if( parallelCovariance != NULL ) delete parallelCovariance;
 }
 
 void Minuit2Wrapper::SetSteps( int newSteps )
@@ -65,6 +70,10 @@ void Minuit2Wrapper::SetupFit( IFitFunction* NewFunction )
 	//Make a wrapper for the function
 	function = new Minuit2Function( NewFunction, nSigma );
 	RapidFunction = NewFunction;
+
+	//Any gradient left from a previous fit is bound to the old function, Minimise makes a new one if it can
+	if( gradientFunction != NULL ) delete gradientFunction;
+	gradientFunction = NULL;
 }
 
 IFitFunction* Minuit2Wrapper::GetFitFunction()
@@ -85,11 +94,31 @@ void Minuit2Wrapper::Minimise()
 
 	cout << "Minuit2 Starting Fit" << endl;
 
-	//Minimise the wrapped function
-	MnMigrad mig( *function, *( function->GetMnUserParameters() ), (unsigned)Quality );//MINUIT_QUALITY );
+	//Use the analytic gradient if every PDF provides one, unless told not to
+	string NoGradient("NoAnalyticGradient");
+	if( gradientFunction == NULL && StringProcessing::VectorContains( &Options, &NoGradient ) == -1 && RapidFunction->GetAnalyticGradient() )
+	{
+		gradientFunction = new Minuit2GradientFunction( RapidFunction, function );
+	}
+
+	if( gradientFunction != NULL )
+	{
+		cout << "Minuit2 using the analytic gradient of the FitFunction" << endl;
+
+		//Minimise the wrapped function
+		MnMigrad mig( *gradientFunction, *( function->GetMnUserParameters() ), (unsigned)Quality );
+
+		//Retrieve the result of the fit
+		minimum = new FunctionMinimum( mig( (unsigned)maxSteps, bestTolerance ) );
+	}
+	else
+	{
+		//Minimise the wrapped function
+		MnMigrad mig( *function, *( function->GetMnUserParameters() ), (unsigned)Quality );//MINUIT_QUALITY );
 
-	//Retrieve the result of the fit
-	minimum = new FunctionMinimum( mig( (unsigned)maxSteps, bestTolerance ) );//(int)MAXIMUM_MINIMISATION_STEPS, FINAL_GRADIENT_TOLERANCE );
+		//Retrieve the result of the fit
+		minimum = new FunctionMinimum( mig( (unsigned)maxSteps, bestTolerance ) );//(int)MAXIMUM_MINIMISATION_STEPS, FINAL_GRADIENT_TOLERANCE );
+	}
 
 	//Work out the fit status - possibly dodgy
 	int fitStatus=0;
@@ -116,10 +145,59 @@ void Minuit2Wrapper::Minimise()
 
 	cout << endl << "Minuit2 MnMigrad finished:\tStatus: " << fitStatus << "\t\t" << ctime( &timeNow ) << endl;
 
+	string MinosOption("MinosErrors");
+	bool wantMinos = StringProcessing::VectorContains( &Options, &MinosOption ) != -1;
+
+	//	Evaluate the Hessian points concurrently in worker processes when asked to
+	//	MINOS and the contours start from the error matrix of the FunctionMinimum which only MnHesse updates,
+	//	and CorrectedCovariance pairs the error matrix with one from MnHesse when the events are weighted
+	if( parallelCovariance != NULL ) delete parallelCovariance;
+	parallelCovariance = NULL;
+	string NoHesse("NoHesse");
+	string ParallelHesse("ParallelHesse");
+	if( StringProcessing::VectorContains( &Options, &NoHesse ) == -1 && StringProcessing::VectorContains( &Options, &ParallelHesse ) != -1
+		&& !wantMinos && contours.empty() && !RapidFunction->GetWeightsWereUsed() )
+	{
+		cout << "Minuit2 Starting ParallelHessian!" << endl;
+
+		const MnUserParameters * minimisedParameters = &(minimum->UserParameters());
+		vector<string> allNames = RapidFunction->GetParameterSet()->GetAllNames();
+		vector<double> centre, errors;
+		for( unsigned int i=0; i< allNames.size(); ++i )
+		{
+			centre.push_back( minimisedParameters->Value( allNames[i].c_str() ) );
+			errors.push_back( minimisedParameters->Error( allNames[i].c_str() ) );
+		}
+
+		const unsigned int nWorkers = RapidFunction->GetThreads() > 1 ? (unsigned) RapidFunction->GetThreads() : 1;
+		double hessianEDM = 0.;
+		parallelCovariance = ParallelHessian::GetCovarianceMatrix( RapidFunction, centre, errors, function->Up(), nWorkers, hessianEDM );
+
+		if( parallelCovariance == NULL )
+		{
+			cerr << "Minuit2 ParallelHessian failed, running MnHesse instead" << endl;
+		}
+		else
+		{
+			for( unsigned int i=0; i< parallelCovariance->theseParameters.size(); ++i )
+			{
+				cout << parallelCovariance->theseParameters[i] << "\t±\t" << sqrt( (*(parallelCovariance->thisMatrix))((int)i,(int)i) ) << endl;
+			}
+
+			//	Same limit on the EDM as MIGRAD, the Hessian is only trusted if it was taken at the minimum
+			const double edmLimit = 0.002 * bestTolerance * function->Up();
+			cout << "Minuit2 ParallelHessian EDM: " << hessianEDM << "\tlimit: " << edmLimit << endl;
+			if( hessianEDM < edmLimit && minimum->IsValid() ) fitStatus = 3;
+			else fitStatus = 1;
+
+			time(&timeNow);
+			cout << endl << "Minuit2 ParallelHessian finished:\tStatus: " << fitStatus << "\t\t" << ctime( &timeNow ) << endl;
+		}
+	}
+
 	// May also want to run Hesse before the minimisation to get better estimate
 	// of the error matrix.
-	string NoHesse("NoHesse");
-	if( StringProcessing::VectorContains( &Options, &NoHesse ) == -1 )
+	if( StringProcessing::VectorContains( &Options, &NoHesse ) == -1 && parallelCovariance == NULL )
 	{
 		cout << "Minuit2 Starting MnHesse!" << endl;
 		//      Finally Now call HESSE to properly calculate the error matrix
@@ -157,8 +235,7 @@ void Minuit2Wrapper::Minimise()
 
 	vector<double> allMin, allMax;
 
-	string MinosOption("MinosErrors");
-	if( StringProcessing::VectorContains( &Options, &MinosOption ) != -1 )
+	if( wantMinos )
 	{	
 		cout << "Minuit2 Starting MnMinos!" << endl;
 		MnMinos minos( *function, *minimum, 100000 );
@@ -199,21 +276,25 @@ void Minuit2Wrapper::Minimise()
 	//Output time information
 	time(&timeNow);
 
-	if ( !minimum->HasCovariance() )
-	{
-		fitStatus = 0;
-	}
-	else if ( !minimum->HasAccurateCovar() )
-	{
-		fitStatus = 1;
-	}
-	else if ( minimum->HasMadePosDefCovar() )
+	//	The FunctionMinimum doesn't know about the parallel Hessian
+	if( parallelCovariance == NULL )
 	{
-		fitStatus = 2;
-	}
-	else
-	{
-		fitStatus = 3;
+		if ( !minimum->HasCovariance() )
+		{
+			fitStatus = 0;
+		}
+		else if ( !minimum->HasAccurateCovar() )
+		{
+			fitStatus = 1;
+		}
+		else if ( minimum->HasMadePosDefCovar() )
+		{
+			fitStatus = 2;
+		}
+		else
+		{
+			fitStatus = 3;
+		}
 	}
 
 	cout << endl << "Minuit2 finished:\tStatus: " << fitStatus << "\t\t" << ctime( &timeNow ) << endl;
@@ -293,6 +374,9 @@ void Minuit2Wrapper::Minimise()
 	PhysicsBottle* newBottle = RapidFunction->GetPhysicsBottle();
 	fitResult = new FitResult( minimum->Fval(), fittedParameters, fitStatus, newBottle, NULL, allContours );
 
+	//	This replaces the errors from MIGRAD and stores the covariance matrix for the output
+	if( parallelCovariance != NULL ) this->ApplyCovarianceMatrix( parallelCovariance );
+
 	vector<string> floated = RapidFunction->GetParameterSet()->GetAllFloatNames();
 	for( unsigned int i=0; i<allMax.size(); ++i )
 	{
@@ -315,22 +399,48 @@ void Minuit2Wrapper::ContourPlots( vector< pair< string, string > > ContourParam
 }
 
 
-//	The following 3 functions are simply coded up to still have the class compile correctly, but these should be implemented in the future
 void Minuit2Wrapper::CallHesse()
 {
+	//	The FunctionMinimum now holds a newer error matrix than the parallel Hessian
+	if( parallelCovariance != NULL ) delete parallelCovariance;
+	parallelCovariance = NULL;
+
 	MnHesse hesse(1);
 	hesse( *function, *minimum, 100000);
 }
 
 RapidFitMatrix* Minuit2Wrapper::GetCovarianceMatrix()
 {
-	return NULL;
+	//	The errors came from the parallel Hessian rather than the FunctionMinimum
+	if( parallelCovariance != NULL ) return new RapidFitMatrix( *parallelCovariance );
+
+	if( minimum == NULL || !minimum->HasCovariance() ) return NULL;
+
+	//	Minuit2 only holds the covariance of the floated parameters, in the order they were added
+	const MnUserCovariance * covMatrix = &(minimum->UserCovariance());
+	unsigned int numParams = (unsigned)RapidFunction->GetParameterSet()->GetAllFloatNames().size();
+	if( covMatrix->Nrow() != numParams ) return NULL;
+
+	TMatrixDSym* thisMatrix = new TMatrixDSym( (int)numParams );
+	for( unsigned int i=0; i< numParams; ++i )
+	{
+		for( unsigned int j=0; j< numParams; ++j )
+		{
+			(*thisMatrix)((int)i,(int)j) = (*covMatrix)(i,j);
+		}
+	}
+
+	RapidFitMatrix* thisCovMatrix = new RapidFitMatrix();
+	thisCovMatrix->thisMatrix = thisMatrix;
+	thisCovMatrix->theseParameters = RapidFunction->GetParameterSet()->GetAllFloatNames();
+
+	return thisCovMatrix;
 }
 
 void Minuit2Wrapper::ApplyCovarianceMatrix( RapidFitMatrix* Input )
 {
-	(void)Input;
-	return;
+	if( fitResult == NULL ) return;
+	fitResult->ApplyCovarianceMatrix( Input );
 }
 
 void Minuit2Wrapper::SetNSigma( int input )
@@ -6,6 +6,7 @@
 #include "MultiThreadedFunctions.h"
 #include "ClassLookUp.h"
 #include "MemoryDataSet.h"
+#include "ThreadPool.h"
 
 #include <string>
 #include <float.h>
@@ -135,16 +136,6 @@ vector<double>* MultiThreadedFunctions::ParallelEvaluate_pthreads( vector<IPDF*>
 		exit(87356);
 	}
 
-	//      1 thread per core
-	pthread_t* Thread = MultiThreadedFunctions::GetFittingThreads( nThreads );//new pthread_t[ nThreads ];
-	pthread_attr_t attrib;
-
-	//      Threads HAVE to be joinable
-	//      We CANNOT _AND_SHOULD_NOT_ ***EVER*** return information to Minuit without the results from ALL threads successfully returned
-	//      Not all pthread implementations are required to obey this as default when constructing the thread _SO_BE_EXPLICIT_
-	pthread_attr_init(&attrib);
-	pthread_attr_setdetachstate(&attrib, PTHREAD_CREATE_JOINABLE);
-
 	Fitting_Thread* fit_thread_data = MultiThreadedFunctions::GetFittingThreadData( nThreads );//new Fitting_Thread[ (unsigned) nThreads ];
 
 	for( unsigned int i=0; i < nThreads; ++i )
@@ -168,37 +159,10 @@ vector<double>* MultiThreadedFunctions::ParallelEvaluate_pthreads( vector<IPDF*>
 		else fit_thread_data[i].thisComponent = NULL;
 	}
 
-	//cout << "Creating Threads" << endl;
-
-	//      Create the Threads and set them to be joinable
-	for( unsigned int threadnum=0; threadnum< nThreads ; ++threadnum )
-	{
-		int status=0;
-		if( thisComponent == NULL ) status = pthread_create( &Thread[threadnum], &attrib, MultiThreadedFunctions::Evaluate_pthread, (void *) &(fit_thread_data[threadnum]) );
-		else status = pthread_create( &Thread[threadnum], &attrib, MultiThreadedFunctions::EvaluateComponent_pthread, (void *) &(fit_thread_data[threadnum]) );
-
-		//cout << "status: " << status << endl;
-		if( status )
-		{
-			cerr << "ERROR:\tfrom pthread_create()\t" << status << "\t...Exiting\n" << endl;
-			exit(-1);
-		}
-	}
-
-	//cout << "Joining Threads!!" << endl;
-
-	//      Join the Threads
-	for( unsigned int threadnum=0; threadnum< nThreads ; ++threadnum )
-	{
-		int status = pthread_join( Thread[threadnum], NULL);
-		if( status )
-		{
-			cerr << "Error Joining a Thread:\t" << threadnum << "\t:\t" << status << "\t...Exiting\n" << endl;
-		}
-	}
-
-	//      Do some cleaning Up
-	pthread_attr_destroy(&attrib);
+	//      Run on the persistent workers if we have them, otherwise on threads created for this call
+	//      Either way this doesn't return until ALL of the threads have finished
+	if( thisComponent == NULL ) ThreadPool::Execute( stored_pool, MultiThreadedFunctions::Evaluate_pthread, fit_thread_data, nThreads );
+	else ThreadPool::Execute( stored_pool, MultiThreadedFunctions::EvaluateComponent_pthread, fit_thread_data, nThreads );
 
 	unsigned int size=0;
 	for( unsigned int i=0; i< thesePoints.size(); ++i ) size+=thesePoints[i]->GetDataNumber();
@@ -251,7 +215,7 @@ void* MultiThreadedFunctions::Evaluate_pthread( void *input_data )
 	}
 
 	//      Finished evaluating this thread
-	pthread_exit( NULL );
+	return NULL;
 }
 
 void* MultiThreadedFunctions::EvaluateComponent_pthread( void *input_data )
@@ -277,7 +241,7 @@ void* MultiThreadedFunctions::EvaluateComponent_pthread( void *input_data )
 	}
 
 	//      Finished evaluating this thread
-	pthread_exit( NULL );
+	return NULL;
 }
 
 vector<double>* MultiThreadedFunctions::ParallelIntegrate_pthreads( IPDF* thisFunction, IDataSet* thesePoints, PhaseSpaceBoundary* thisBoundary, unsigned int nThreads )
@@ -330,7 +294,7 @@ void* MultiThreadedFunctions::Integrate_pthread( void *input_data )
 	}
 
 	//      Finished evaluating this thread
-	pthread_exit( NULL );
+	return NULL;
 }
 
 vector<double>* MultiThreadedFunctions::ParallelIntegrate_pthreads( vector<IPDF*> thisFunction, vector<IDataSet*> thesePoints, vector<PhaseSpaceBoundary*> theseBoundarys, unsigned int nThreads )
@@ -353,16 +317,6 @@ vector<double>* MultiThreadedFunctions::ParallelIntegrate_pthreads( vector<IPDF*
 		(void) tempVal;
 	}
 
-	//      1 thread per core
-	pthread_t* Thread = MultiThreadedFunctions::GetFittingThreads( nThreads );//new pthread_t[ nThreads ];
-	pthread_attr_t attrib;
-
-	//      Threads HAVE to be joinable
-	//      We CANNOT _AND_SHOULD_NOT_ ***EVER*** return information to Minuit without the results from ALL threads successfully returned
-	//      Not all pthread implementations are required to obey this as default when constructing the thread _SO_BE_EXPLICIT_
-	pthread_attr_init(&attrib);
-	pthread_attr_setdetachstate(&attrib, PTHREAD_CREATE_JOINABLE);
-
 	Fitting_Thread* fit_thread_data = MultiThreadedFunctions::GetFittingThreadData( nThreads );//new Fitting_Thread[ nThreads ];
 
 	for( unsigned int i=0; i< nThreads; ++i )
@@ -374,33 +328,8 @@ vector<double>* MultiThreadedFunctions::ParallelIntegrate_pthreads( vector<IPDF*
 	}
 
 
-	//cout << "Creating Threads" << endl;
-
-	//      Create the Threads and set them to be joinable
-	for( unsigned int threadnum=0; threadnum< nThreads ; ++threadnum )
-	{
-		int status = pthread_create( &Thread[threadnum], &attrib, MultiThreadedFunctions::Integrate_pthread, (void *) &(fit_thread_data[threadnum]) );
-		if( status )
-		{
-			cerr << "ERROR:\tfrom pthread_create()\t" << status << "\t...Exiting\n" << endl;
-			exit(-1);
-		}
-	}
-
-	//cout << "Joining Threads!!" << endl;
-
-	//      Join the Threads
-	for( unsigned int threadnum=0; threadnum< nThreads ; ++threadnum )
-	{
-		int status = pthread_join( Thread[threadnum], NULL);
-		if( status )
-		{
-			cerr << "Error Joining a Thread:\t" << threadnum << "\t:\t" << status << "\t...Exiting\n" << endl;
-		}
-	}
-
-	//      Do some cleaning Up
-	pthread_attr_destroy(&attrib);
+	//      Run on the persistent workers if we have them, otherwise on threads created for this call
+	ThreadPool::Execute( stored_pool, MultiThreadedFunctions::Integrate_pthread, fit_thread_data, nThreads );
 
 	unsigned int size=0;
 	for( unsigned int i=0; i< thesePoints.size(); ++i ) size+=thesePoints[i]->GetDataNumber();
@@ -452,33 +381,20 @@ Fitting_Thread* MultiThreadedFunctions::stored_tread_data = NULL;
 
 unsigned int MultiThreadedFunctions::stored_thread_data_n = 0;
 
-pthread_t* MultiThreadedFunctions::GetFittingThreads( unsigned int nThreads )
+void MultiThreadedFunctions::SetThreadPool( ThreadPool* thisPool )
 {
-	if( Thread == NULL )
-	{
-		Threads_n = 0;
+	stored_pool = thisPool;
+}
 
-		Thread = new pthread_t[ nThreads ];
-		Threads_n = nThreads;
-		return Thread;
-	}
-	else
-	{
-		if( Threads_n == nThreads )
-		{
-			return Thread;
-		}
-		else
-		{
-			delete[] Thread;
-			Thread = new pthread_t[ nThreads ];
-			Threads_n = nThreads;
-			return Thread;
-		}
-	}
+void MultiThreadedFunctions::UnsetThreadPool( ThreadPool* thisPool )
+{
+	if( stored_pool == thisPool ) stored_pool = NULL;
 }
 
-pthread_t* MultiThreadedFunctions::Thread = NULL;
+ThreadPool* MultiThreadedFunctions::GetThreadPool()
+{
+	return stored_pool;
+}
 
-unsigned int MultiThreadedFunctions::Threads_n = 0;
+ThreadPool* MultiThreadedFunctions::stored_pool = NULL;
 
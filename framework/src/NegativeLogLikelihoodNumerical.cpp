@@ -23,6 +23,10 @@
 //	RapidFit Headers
 #include "NegativeLogLikelihoodNumerical.h"
 #include "ClassLookUp.h"
+#include "ThreadPool.h"
+#include "StreamingDataSet.h"
+#include "ColumnarDataSet.h"
+#include "Threading.h"
 //	System Headers
 #include <stdlib.h>
 #include <cmath>
@@ -65,19 +69,21 @@ double NegativeLogLikelihoodNumerical::EvaluateDataSet( IPDF * FittingPDF, IData
 		exit(-125);
 	}
 
-	//	1 thread per core
-	pthread_t* Thread = new pthread_t[ (unsigned)Threads ];
-	pthread_attr_t attrib;
-
-	//	Threads HAVE to be joinable
-	//	We CANNOT _AND_SHOULD_NOT_ ***EVER*** return information to Minuit without the results from ALL threads successfully returned
-	//	Not all pthread implementations are required to obey this as default when constructing the thread _SO_BE_EXPLICIT_
-	pthread_attr_init(&attrib);
-	pthread_attr_setdetachstate(&attrib, PTHREAD_CREATE_JOINABLE);
+	//	The events of a StreamingDataSet aren't split up front, only NegativeLogLikelihoodThreaded reads them a chunk at a time
+	if( dynamic_cast<StreamingDataSet*>( TotalDataSet ) != NULL )
+	{
+		cerr << "A DataSet streamed from an event cache can only be fitted with NegativeLogLikelihoodThreaded" << endl << endl;
+		exit(-126);
+	}
 
 	//cout << "Setup Threads: " << Threads << endl;
 	ObservableRef weightObservableRef( weightObservableName );
 
+	//	The events of a ColumnarDataSet aren't split up front, this needs a DataPoint for each of them, see ColumnarDataSet::GetDataPoint
+	if( dynamic_cast<ColumnarDataSet*>( TotalDataSet ) != NULL && StoredDataSubSet[(unsigned)number].back().empty() )
+	{
+		StoredDataSubSet[(unsigned)number] = Threading::divideData( TotalDataSet, Threads );
+	}
 
 	//	Initialize the Fitting_Thread objects which contain the objects to be passed to each thread
 	for( unsigned int threadnum=0; threadnum< (unsigned)Threads; ++threadnum )
@@ -94,31 +100,9 @@ double NegativeLogLikelihoodNumerical::EvaluateDataSet( IPDF * FittingPDF, IData
 
 	//cout << "Create Threads" << endl;
 
-	//	Create the Threads and set them to be joinable
-	for( unsigned int threadnum=0; threadnum< (unsigned)Threads ; ++threadnum )
-	{
-		int status = pthread_create(&Thread[threadnum], &attrib, this->ThreadWork, (void *) &fit_thread_data[threadnum] );
-		if( status )
-		{
-			cerr << "ERROR:\tfrom pthread_create()\t" << status << "\t...Exiting\n" << endl;
-			exit(-1);
-		}
-	}
-
-	//cout << "Joining Threads!!" << endl;
-
-	//	Join the Threads
-	for( unsigned int threadnum=0; threadnum< (unsigned)Threads ; ++threadnum )
-	{
-		int status = pthread_join( Thread[threadnum], NULL);
-		if( status )
-		{
-			cerr << "Error Joining a Thread:\t" << threadnum << "\t:\t" << status << "\t...Exiting\n" << endl;
-		}
-	}
-
-	//      Do some cleaning Up
-	pthread_attr_destroy(&attrib);
+	//	Wake up the persistent worker threads, this doesn't return until ALL of them have finished
+	//	We CANNOT _AND_SHOULD_NOT_ ***EVER*** return information to Minuit without the results from ALL threads successfully returned
+	ThreadPool::Execute( thread_pool, this->ThreadWork, fit_thread_data, (unsigned)Threads );
 
 	//cout << "Leaving Threads" << endl;
 
@@ -139,7 +123,6 @@ double NegativeLogLikelihoodNumerical::EvaluateDataSet( IPDF * FittingPDF, IData
 	//cout << -total << endl;
 	//exit(100);
 	//delete [] fit_thread_data;
-	delete [] Thread;
 
 	//cout << total << endl;
 	return -total;
@@ -235,7 +218,7 @@ void* NegativeLogLikelihoodNumerical::ThreadWork( void *input_data )
 	//file->Write();
 	//file->Close();
 	//	Finished evaluating this thread
-	pthread_exit( NULL );
+	return NULL;
 }
 
 //Return the up value for error calculations
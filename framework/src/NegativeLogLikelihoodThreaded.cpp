@@ -23,6 +23,10 @@
 //	RapidFit Headers
 #include "NegativeLogLikelihoodThreaded.h"
 #include "ClassLookUp.h"
+#include "ThreadPool.h"
+#include "EventBlock.h"
+#include "ColumnarDataSet.h"
+#include "StreamingDataSet.h"
 #include "IPDF.h"
 //	System Headers
 #include <stdlib.h>
@@ -53,6 +57,31 @@ NegativeLogLikelihoodThreaded::~NegativeLogLikelihoodThreaded()
 {
 }
 
+//Point each Fitting_Thread at its own PDF, boundary and subset of this DataSet
+void NegativeLogLikelihoodThreaded::SetupThreadData( IDataSet * TotalDataSet, const vector<vector<DataPoint*> >& DataSubSets, int number )
+{
+	//	Without any DataPoints the threads fill their own from a ColumnarDataSet a block at a time, split in the same way
+	const vector<unsigned int> numberEvents = Threading::divideEvents( (unsigned) TotalDataSet->GetDataNumber(), Threads );
+
+	//	Initialize the Fitting_Thread objects which contain the objects to be passed to each thread
+	unsigned int firstEvent=0;
+	for( unsigned int threadnum=0; threadnum< (unsigned)Threads; ++threadnum )
+	{
+		fit_thread_data[threadnum].dataSubSet = DataSubSets[threadnum];
+		fit_thread_data[threadnum].fittingPDF = stored_pdfs[((unsigned)number)*(unsigned)Threads + threadnum];
+		fit_thread_data[threadnum].fittingPDF->SetDebugMutex( &eval_lock, false );
+		fit_thread_data[threadnum].useWeights = useWeights;					//	Defined in the fitfunction baseclass
+		fit_thread_data[threadnum].FitBoundary = StoredBoundary[(unsigned)Threads*((unsigned)number)+threadnum];
+		fit_thread_data[threadnum].dataPoint_Result = vector<double>();
+		fit_thread_data[threadnum].weightsSquared = weightsSquared;
+		//	The subsets are contiguous ranges of the whole DataSet, see Threading::divideData
+		fit_thread_data[threadnum].dataSet = TotalDataSet;
+		fit_thread_data[threadnum].firstEvent = firstEvent;
+		fit_thread_data[threadnum].numberEvents = DataSubSets[threadnum].empty() ? numberEvents[threadnum] : (unsigned) DataSubSets[threadnum].size();
+		firstEvent += fit_thread_data[threadnum].numberEvents;
+	}
+}
+
 //Return the negative log likelihood for a PDF/DataSet result
 double NegativeLogLikelihoodThreaded::EvaluateDataSet( IPDF * FittingPDF, IDataSet * TotalDataSet, int number )
 {
@@ -60,22 +89,15 @@ double NegativeLogLikelihoodThreaded::EvaluateDataSet( IPDF * FittingPDF, IDataS
 
 	if( TotalDataSet->GetDataNumber() == 0 ) return 0.;
 
+	StreamingDataSet* streamedData = dynamic_cast<StreamingDataSet*>( TotalDataSet );
+	if( streamedData != NULL ) return this->EvaluateStreamedDataSet( streamedData, number );
+
 	if( Threads <= 0 )
 	{
 		cerr<< "Bad Number of Threads: " << Threads << " check your XML!!!" << endl << endl;
 		exit(-125);
 	}
 
-	//	1 thread per core
-	pthread_t* Thread = new pthread_t[ (unsigned)Threads ];
-	pthread_attr_t attrib;
-
-	//	Threads HAVE to be joinable
-	//	We CANNOT _AND_SHOULD_NOT_ ***EVER*** return information to Minuit without the results from ALL threads successfully returned
-	//	Not all pthread implementations are required to obey this as default when constructing the thread _SO_BE_EXPLICIT_
-	pthread_attr_init(&attrib);
-	pthread_attr_setdetachstate(&attrib, PTHREAD_CREATE_JOINABLE);
-
 	//cout << "Setup Threads: " << Threads << endl;
 	ObservableRef weightObservableRef( weightObservableName );
 
@@ -95,45 +117,16 @@ double NegativeLogLikelihoodThreaded::EvaluateDataSet( IPDF * FittingPDF, IDataS
 	   }
 	   */
 
-	//	Initialize the Fitting_Thread objects which contain the objects to be passed to each thread
-	for( unsigned int threadnum=0; threadnum< (unsigned)Threads; ++threadnum )
-	{
-		fit_thread_data[threadnum].dataSubSet = StoredDataSubSet[(unsigned)number][threadnum];
-		fit_thread_data[threadnum].fittingPDF = stored_pdfs[((unsigned)number)*(unsigned)Threads + threadnum];
-		fit_thread_data[threadnum].fittingPDF->SetDebugMutex( &eval_lock, false );
-		fit_thread_data[threadnum].useWeights = useWeights;					//	Defined in the fitfunction baseclass
-		fit_thread_data[threadnum].FitBoundary = StoredBoundary[(unsigned)Threads*((unsigned)number)+threadnum];
-		fit_thread_data[threadnum].dataPoint_Result = vector<double>();
-		fit_thread_data[threadnum].weightsSquared = weightsSquared;
-	}
-
-	//cout << "Creating Threads" << endl;
-
-	//	Create the Threads and set them to be joinable
-	for( unsigned int threadnum=0; threadnum< (unsigned)Threads ; ++threadnum )
-	{
-		int status = pthread_create(&Thread[threadnum], &attrib, this->ThreadWork, (void *) &fit_thread_data[threadnum] );
-		if( status )
-		{
-			cerr << "ERROR:\tfrom pthread_create()\t" << status << "\t...Exiting\n" << endl;
-			exit(-1);
-		}
-	}
+	this->SetupThreadData( TotalDataSet, StoredDataSubSet[(unsigned)number], number );
 
-	//cout << "Joining Threads!!" << endl;
+	//	Events of a ColumnarDataSet have their initial NLL in a column rather than in a DataPoint
+	ColumnarDataSet* columns = dynamic_cast<ColumnarDataSet*>( TotalDataSet );
 
-	//	Join the Threads
-	for( unsigned int threadnum=0; threadnum< (unsigned)Threads ; ++threadnum )
-	{
-		int status = pthread_join( Thread[threadnum], NULL);
-		if( status )
-		{
-			cerr << "Error Joining a Thread:\t" << threadnum << "\t:\t" << status << "\t...Exiting\n" << endl;
-		}
-	}
+	//cout << "Creating Threads" << endl;
 
-	//      Do some cleaning Up
-	pthread_attr_destroy(&attrib);
+	//	Wake up the persistent worker threads, this doesn't return until ALL of them have finished
+	//	We CANNOT _AND_SHOULD_NOT_ ***EVER*** return information to Minuit without the results from ALL threads successfully returned
+	ThreadPool::Execute( thread_pool, this->ThreadWork, fit_thread_data, (unsigned)Threads );
 
 	//cout << "Leaving Threads" << endl;
 
@@ -150,18 +143,23 @@ double NegativeLogLikelihoodThreaded::EvaluateDataSet( IPDF * FittingPDF, IDataS
 				return DBL_MAX;
 			}
 
-			DataPoint* thisPoint = fit_thread_data[threadnum].dataSubSet[ point_num ];
+			DataPoint* thisPoint = NULL;
+			double* initialNLL = NULL;
+			if( fit_thread_data[threadnum].dataSubSet.empty() ) initialNLL = columns->GetInitialNLLColumn() + fit_thread_data[threadnum].firstEvent + point_num;
+			else thisPoint = fit_thread_data[threadnum].dataSubSet[ point_num ];
 
-			if( this->GetOffSetNLL() && !std::isnan(thisPoint->GetInitialNLL()) )
+			const double thisInitialNLL = initialNLL != NULL ? *initialNLL : thisPoint->GetInitialNLL();
+			if( this->GetOffSetNLL() && !std::isnan(thisInitialNLL) )
 			{
-				NLLValues.push_back(fit_thread_data[threadnum].dataPoint_Result[ point_num ] - thisPoint->GetInitialNLL() );
+				NLLValues.push_back(fit_thread_data[threadnum].dataPoint_Result[ point_num ] - thisInitialNLL );
 			}
 			else
 			{
 				if( this->GetOffSetNLL() )
 				{
 					NLLValues.push_back( 0. );
-					thisPoint->SetInitialNLL( fit_thread_data[threadnum].dataPoint_Result[ point_num ] );
+					if( initialNLL != NULL ) *initialNLL = fit_thread_data[threadnum].dataPoint_Result[ point_num ];
+					else thisPoint->SetInitialNLL( fit_thread_data[threadnum].dataPoint_Result[ point_num ] );
 				}
 				else
 				{
@@ -181,128 +179,367 @@ double NegativeLogLikelihoodThreaded::EvaluateDataSet( IPDF * FittingPDF, IDataS
 		total+=*this_i;
 	}
 
-	delete [] Thread;
-
 	//cout << total << endl;
 	//exit(0);
 
 	return -total;
 }
 
+//Return the negative log likelihood of a DataSet which is read from disk a chunk at a time
+double NegativeLogLikelihoodThreaded::EvaluateStreamedDataSet( StreamingDataSet * TotalDataSet, int number )
+{
+	if( Threads <= 0 )
+	{
+		cerr<< "Bad Number of Threads: " << Threads << " check your XML!!!" << endl << endl;
+		exit(-125);
+	}
+
+	vector<double> chunkValues;
+	const unsigned int numberChunks = TotalDataSet->GetNumberChunks();
+
+	//	Read chunk k+1 in the background while chunk k is evaluated, only these two are ever in memory
+	TotalDataSet->Prefetch( 0 );
+	for( unsigned int chunk=0; chunk< numberChunks; ++chunk )
+	{
+		ColumnarDataSet* thisChunk = TotalDataSet->GetChunk( chunk );
+		TotalDataSet->Prefetch( chunk+1 );
+
+		this->SetupThreadData( thisChunk, vector<vector<DataPoint*> >( (unsigned) Threads ), number );
+
+		ThreadPool::Execute( thread_pool, this->ThreadWork, fit_thread_data, (unsigned)Threads );
+
+		vector<double> NLLValues;
+		bool badValue = false;
+		for( unsigned int threadnum=0; threadnum< (unsigned)Threads; ++threadnum )
+		{
+			for( unsigned int point_num=0; point_num< fit_thread_data[threadnum].dataPoint_Result.size(); ++point_num )
+			{
+				if( fabs(fit_thread_data[threadnum].dataPoint_Result[ point_num ]) >= DBL_MAX ) badValue = true;
+				NLLValues.push_back( fit_thread_data[threadnum].dataPoint_Result[ point_num ] );
+			}
+			vector<double> empty;
+			fit_thread_data[threadnum].dataPoint_Result.swap( empty );
+		}
+		if( badValue ) return DBL_MAX;
+
+		sort( NLLValues.begin(), NLLValues.end(), NLLSort );
+		double chunkTotal=0.;
+		for( vector<double>::iterator this_i = NLLValues.begin(); this_i != NLLValues.end(); ++this_i )
+		{
+			chunkTotal+=*this_i;
+		}
+
+		//	The per-event initial NLL doesn't survive the chunk being read again, so offset each chunk as a whole
+		if( this->GetOffSetNLL() )
+		{
+			if( std::isnan( TotalDataSet->GetChunkOffset( chunk ) ) )
+			{
+				TotalDataSet->SetChunkOffset( chunk, chunkTotal );
+			}
+			chunkTotal -= TotalDataSet->GetChunkOffset( chunk );
+		}
+
+		chunkValues.push_back( chunkTotal );
+	}
+
+	sort( chunkValues.begin(), chunkValues.end(), NLLSort );
+
+	double total=0;
+	for( vector<double>::iterator this_i = chunkValues.begin(); this_i != chunkValues.end(); ++this_i )
+	{
+		total+=*this_i;
+	}
+
+	return -total;
+}
+
 void* NegativeLogLikelihoodThreaded::ThreadWork( void *input_data )
 {
 	struct Fitting_Thread *thread_input = (struct Fitting_Thread*) input_data;
 
 	double value=0, weight=0, integral=0, result=0;
-	int num=0;
-	//bool isnorm = thread_input->fittingPDF->GetName()=="NormalisedSum";
-	for( vector<DataPoint*>::iterator data_i=thread_input->dataSubSet.begin(); data_i != thread_input->dataSubSet.end(); ++data_i, ++num )
+
+	//	If the data is held in columns let the PDFs see them
+	const ColumnarDataSet* columns = dynamic_cast<const ColumnarDataSet*>( thread_input->dataSet );
+
+	//	Without DataPoints for the events each block is filled into the same few DataPoints
+	const bool fillBlocks = columns != NULL && thread_input->dataSubSet.empty();
+
+	const unsigned int totalEvents = fillBlocks ? thread_input->numberEvents : (unsigned) thread_input->dataSubSet.size();
+	vector<double> blockValues( RAPIDFIT_EVENT_BLOCK_SIZE, 0. );
+
+	pthread_mutex_t* debug_lock = thread_input->fittingPDF->DebugMutex();
+
+	bool badValue = false;
+	for( unsigned int blockStart=0; blockStart < totalEvents && !badValue; blockStart+=RAPIDFIT_EVENT_BLOCK_SIZE )
 	{
+		unsigned int blockSize = totalEvents - blockStart;
+		if( blockSize > RAPIDFIT_EVENT_BLOCK_SIZE ) blockSize = RAPIDFIT_EVENT_BLOCK_SIZE;
 
-		pthread_mutex_t* debug_lock = thread_input->fittingPDF->DebugMutex();
-		try
+		DataPoint** blockPoints = NULL;
+		if( fillBlocks )
 		{
-			value = thread_input->fittingPDF->Evaluate( *data_i );
+			columns->FillBlock( thread_input->firstEvent + blockStart, blockSize, thread_input->blockPoints );
+			blockPoints = &(thread_input->blockPoints[0]);
 		}
-		catch( ... )
+		else
 		{
-			value = DBL_MAX;
+			blockPoints = &(thread_input->dataSubSet[blockStart]);
 		}
 
+		EventBlock thisBlock( blockPoints, blockSize, columns, thread_input->firstEvent + blockStart );
+
 		try
 		{
-			integral = thread_input->fittingPDF->Integral( *data_i, thread_input->FitBoundary );
+			thread_input->fittingPDF->EvaluateBatch( thisBlock, &(blockValues[0]) );
 		}
 		catch( ... )
 		{
-			integral = DBL_MAX;
+			//	Find out which event(s) the PDF objected to
+			for( unsigned int i=0; i< blockSize; ++i )
+			{
+				try
+				{
+					blockValues[i] = thread_input->fittingPDF->Evaluate( thisBlock.GetDataPoint( i ) );
+				}
+				catch( ... )
+				{
+					blockValues[i] = DBL_MAX;
+				}
+			}
+		}
+
+		for( unsigned int i=0; i< blockSize; ++i )
+		{
+			DataPoint* data_i = thisBlock.GetDataPoint( i );
+			value = blockValues[i];
+
+			try
+			{
+				integral = thread_input->fittingPDF->Integral( data_i, thread_input->FitBoundary );
+			}
+			catch( ... )
+			{
+				integral = DBL_MAX;
+			}
+
+			if( std::isnan(value) == true )
+			{
+				pthread_mutex_lock( debug_lock );
+				thread_input->dataPoint_Result.push_back( DBL_MAX );
+				cout << endl << "PDF is nan" << endl;
+				data_i->Print();
+				pthread_mutex_unlock( debug_lock );
+				badValue = true;
+				break;
+			}
+			if( std::isnan(integral) == true )
+			{
+				pthread_mutex_lock( debug_lock );
+				thread_input->dataPoint_Result.push_back( DBL_MAX );
+				cout << endl << "Integral is nan" << endl;
+				data_i->Print();
+				pthread_mutex_unlock( debug_lock );
+				badValue = true;
+				break;
+			}
+			if( value <= 0 )
+			{
+				pthread_mutex_lock( debug_lock );
+				thread_input->dataPoint_Result.push_back( DBL_MAX );
+				cout << endl << "Value is <=0 " << value << endl;
+				data_i->Print();
+				pthread_mutex_unlock( debug_lock );
+				badValue = true;
+				break;
+			}
+			if( integral <= 0 )
+			{
+				pthread_mutex_lock( debug_lock );
+				thread_input->dataPoint_Result.push_back( DBL_MAX );
+				cout << endl << "Integral is <= 0 " << integral << endl;
+				data_i->Print();
+				pthread_mutex_unlock( debug_lock );
+				badValue = true;
+				break;
+			}
+
+			if( value >= DBL_MAX || integral >= DBL_MAX )
+			{
+				pthread_mutex_lock( debug_lock );
+				thread_input->dataPoint_Result.push_back( DBL_MAX );
+				cerr << endl << "Caught invalid value from PDF: " << endl;
+				cerr << "Val: " << value << "\tNorm: " << integral << endl;
+				data_i->Print();
+				pthread_mutex_unlock( debug_lock );
+				badValue = true;
+				break;
+			}
+
+			//	Result of evaluating the DataPoint
+			result = log( value / integral );
+
+			//	If we have a weighted dataset then weight the result (if not don't perform a *1.)
+			if( thread_input->useWeights == true )
+			{
+				weight = data_i->GetEventWeight();
+				result *= weight;
+				if( thread_input->weightsSquared )
+				{
+					result *= weight;
+					if( weight < 0 ) result *= -1.;
+				}
+			}
+
+			//	Push back the result from evaluating this datapoint
+			thread_input->dataPoint_Result.push_back( result );
 		}
 
-		/*
-		   if(num==5) exit(0);
-		   pthread_mutex_lock( debug_lock );
-		   cout << "hello" << endl;
-		   pthread_mutex_unlock( debug_lock );
-		   */
+		//	Keep anything the PDF cached for these events
+		if( fillBlocks ) columns->StoreBlock( thread_input->firstEvent + blockStart, blockSize, blockPoints );
+	}
+
+	//	Finished evaluating this thread
+	return NULL;
+}
 
-		//cout << value << "\t" << integral << endl;
+bool NegativeLogLikelihoodThreaded::ProvidesDataSetGradient() const
+{
+	return true;
+}
 
-		if( std::isnan(value) == true )
+bool NegativeLogLikelihoodThreaded::EvaluateDataSetGradient( IPDF * FittingPDF, IDataSet * TotalDataSet, int number, double* gradient )
+{
+	(void) FittingPDF;
+
+	const unsigned int nParams = (unsigned) gradientNames.size();
+	for( unsigned int i=0; i< nParams; ++i ) gradient[i] = 0.;
+
+	if( TotalDataSet->GetDataNumber() == 0 ) return true;
+
+	StreamingDataSet* streamedData = dynamic_cast<StreamingDataSet*>( TotalDataSet );
+	if( streamedData == NULL )
+	{
+		return this->AddDataSetGradient( TotalDataSet, StoredDataSubSet[(unsigned)number], number, gradient );
+	}
+
+	//	One chunk at a time, reading the next chunk while this one is evaluated
+	bool isOK = true;
+	const unsigned int numberChunks = streamedData->GetNumberChunks();
+	streamedData->Prefetch( 0 );
+	for( unsigned int chunk=0; chunk< numberChunks && isOK; ++chunk )
+	{
+		ColumnarDataSet* thisChunk = streamedData->GetChunk( chunk );
+		streamedData->Prefetch( chunk+1 );
+		isOK = this->AddDataSetGradient( thisChunk, vector<vector<DataPoint*> >( (unsigned) Threads ), number, gradient );
+	}
+	return isOK;
+}
+
+//Subtract the gradient of the log-likelihood of these events from gradient
+bool NegativeLogLikelihoodThreaded::AddDataSetGradient( IDataSet * TotalDataSet, const vector<vector<DataPoint*> >& DataSubSets, int number, double* gradient )
+{
+	const unsigned int nParams = (unsigned) gradientNames.size();
+
+	this->SetupThreadData( TotalDataSet, DataSubSets, number );
+	for( unsigned int threadnum=0; threadnum< (unsigned)Threads; ++threadnum )
+	{
+		fit_thread_data[threadnum].gradientNames = &gradientNames;
+	}
+
+	ThreadPool::Execute( thread_pool, this->GradientThreadWork, fit_thread_data, (unsigned)Threads );
+
+	bool isOK = true;
+	for( unsigned int threadnum=0; threadnum< (unsigned)Threads; ++threadnum )
+	{
+		if( fit_thread_data[threadnum].gradient_Result.size() != nParams )
 		{
-			pthread_mutex_lock( debug_lock );
-			thread_input->dataPoint_Result.push_back( DBL_MAX );
-			cout << endl << "PDF is nan" << endl;
-			(*data_i)->Print();
-			pthread_mutex_unlock( debug_lock );
-			break;
+			isOK = false;
 		}
-		if( std::isnan(integral) == true )
+		else
 		{
-			pthread_mutex_lock( debug_lock );
-			thread_input->dataPoint_Result.push_back( DBL_MAX );
-			cout << endl << "Integral is nan" << endl;
-			(*data_i)->Print();
-			pthread_mutex_unlock( debug_lock );
-			break;
+			//	The NLL is minus the sum of the log-likelihoods
+			for( unsigned int i=0; i< nParams; ++i ) gradient[i] -= fit_thread_data[threadnum].gradient_Result[i];
 		}
-		if( value <= 0 )
+		vector<double> empty;
+		fit_thread_data[threadnum].gradient_Result.swap( empty );
+	}
+
+	return isOK;
+}
+
+void* NegativeLogLikelihoodThreaded::GradientThreadWork( void *input_data )
+{
+	struct Fitting_Thread *thread_input = (struct Fitting_Thread*) input_data;
+
+	const vector<string>& Names = *(thread_input->gradientNames);
+	const unsigned int nParams = (unsigned) Names.size();
+
+	vector<double> total( nParams, 0. );
+	vector<double> thisGradient( nParams, 0. );
+
+	pthread_mutex_t* debug_lock = thread_input->fittingPDF->DebugMutex();
+
+	//	As in ThreadWork the events of a ColumnarDataSet may be filled into DataPoints a block at a time
+	const ColumnarDataSet* columns = dynamic_cast<const ColumnarDataSet*>( thread_input->dataSet );
+	const bool fillBlocks = columns != NULL && thread_input->dataSubSet.empty();
+	const unsigned int totalEvents = fillBlocks ? thread_input->numberEvents : (unsigned) thread_input->dataSubSet.size();
+
+	for( unsigned int point_num=0; point_num< totalEvents; ++point_num )
+	{
+		const unsigned int blockIndex = point_num % RAPIDFIT_EVENT_BLOCK_SIZE;
+		if( fillBlocks && blockIndex == 0 )
 		{
-			pthread_mutex_lock( debug_lock );
-			thread_input->dataPoint_Result.push_back( DBL_MAX );
-			cout << endl << "Value is <=0 " << value << endl;
-			(*data_i)->Print();
-			pthread_mutex_unlock( debug_lock );
-			break;
+			unsigned int blockSize = totalEvents - point_num;
+			if( blockSize > RAPIDFIT_EVENT_BLOCK_SIZE ) blockSize = RAPIDFIT_EVENT_BLOCK_SIZE;
+			columns->FillBlock( thread_input->firstEvent + point_num, blockSize, thread_input->blockPoints );
 		}
-		if( integral <= 0 )
+		DataPoint* data_i = fillBlocks ? thread_input->blockPoints[blockIndex] : thread_input->dataSubSet[point_num];
+
+		try
 		{
-			pthread_mutex_lock( debug_lock );
-			thread_input->dataPoint_Result.push_back( DBL_MAX );
-			cout << endl << "Integral is <= 0 " << integral << endl;
-			(*data_i)->Print();
-			pthread_mutex_unlock( debug_lock );
-			break;
+			thread_input->fittingPDF->EvaluateGradient( data_i, thread_input->FitBoundary, Names, &(thisGradient[0]) );
 		}
-
-		if( value >= DBL_MAX || integral >= DBL_MAX )
+		catch( ... )
 		{
 			pthread_mutex_lock( debug_lock );
-			thread_input->dataPoint_Result.push_back( DBL_MAX );
-			cerr << endl << "Caught invalid value from PDF: " << endl;
-			cerr << "Val: " << value << "\tNorm: " << integral << endl;
-			(*data_i)->Print();
+			cerr << endl << "Caught an error evaluating the gradient of the PDF" << endl;
+			data_i->Print();
 			pthread_mutex_unlock( debug_lock );
-			break;
+			return NULL;
 		}
 
-		//if( value / integral > 1. )
-		//{
-		//	cout << "SERIOUSE: " << value / integral << endl;
-		//}
-
-		//	Result of evaluating the DataPoint
-		result = log( value / integral );
-
-		//	If we have a weighted dataset then weight the result (if not don't perform a *1.)
+		//	Weight each event in the same way as in ThreadWork
+		double weight = 1.;
 		if( thread_input->useWeights == true )
 		{
-			weight = (*data_i)->GetEventWeight();
-			//pthread_mutex_lock( &eval_lock );
-			result *= weight;
-			if( thread_input->weightsSquared )
+			weight = data_i->GetEventWeight();
+			if( thread_input->weightsSquared ) weight *= fabs( weight );
+		}
+
+		for( unsigned int i=0; i< nParams; ++i )
+		{
+			if( std::isnan( thisGradient[i] ) )
 			{
-				result *= weight;
-				if( weight < 0 ) result *= -1.;
+				pthread_mutex_lock( debug_lock );
+				cout << endl << "Gradient is nan wrt " << Names[i] << endl;
+				data_i->Print();
+				pthread_mutex_unlock( debug_lock );
+				return NULL;
 			}
-			//pthread_mutex_unlock( &eval_lock );
+			total[i] += weight * thisGradient[i];
 		}
 
-		//	Push back the result from evaluating this datapoint
-		thread_input->dataPoint_Result.push_back( result );
+		//	Keep anything the PDF cached for the events of this block once it is finished
+		if( fillBlocks && ( blockIndex+1 == RAPIDFIT_EVENT_BLOCK_SIZE || point_num+1 == totalEvents ) )
+		{
+			columns->StoreBlock( thread_input->firstEvent + point_num - blockIndex, blockIndex+1, &(thread_input->blockPoints[0]) );
+		}
 	}
 
-	//	Finished evaluating this thread
-	pthread_exit( NULL );
+	thread_input->gradient_Result.swap( total );
+
+	return NULL;
 }
 
 //Return the up value for error calculations
@@ -26,7 +26,8 @@ NormalisedSumPDF::NormalisedSumPDF( const NormalisedSumPDF& input ) : BasePDF( (
 	prototypeDataPoint( input.prototypeDataPoint ), prototypeParameterSet( input.prototypeParameterSet ), doNotIntegrateList( input.doNotIntegrateList ),
 	firstPDF( ClassLookUp::CopyPDF( input.firstPDF ) ), secondPDF( ClassLookUp::CopyPDF( input.secondPDF ) ),
 	firstFraction( input.firstFraction ), firstIntegralCorrection( input.firstIntegralCorrection ), secondIntegralCorrection( input.secondIntegralCorrection ),
-	fractionName( input.fractionName ), integrationBoundary(NULL), _plotComponents( input._plotComponents )
+	fractionName( input.fractionName ), integrationBoundary(NULL), _plotComponents( input._plotComponents ), batchBuffer(),
+	cacheComponents( input.cacheComponents ), firstCache(), secondCache(), gradientBuffer()
 {
 	firstPDF->SetDebugMutex( this->DebugMutex(), false );
 	secondPDF->SetDebugMutex( this->DebugMutex(), false );
@@ -35,7 +36,8 @@ NormalisedSumPDF::NormalisedSumPDF( const NormalisedSumPDF& input ) : BasePDF( (
 }
 
 NormalisedSumPDF::NormalisedSumPDF( PDFConfigurator* config ) : BasePDF(), prototypeDataPoint(), prototypeParameterSet(), doNotIntegrateList(), firstPDF(NULL), secondPDF(NULL),
-	firstFraction(0.5), firstIntegralCorrection(), secondIntegralCorrection(), fractionName(), integrationBoundary(NULL), _plotComponents( true )
+	firstFraction(0.5), firstIntegralCorrection(), secondIntegralCorrection(), fractionName(), integrationBoundary(NULL), _plotComponents( true ), batchBuffer(),
+	cacheComponents( false ), firstCache(), secondCache(), gradientBuffer()
 {
 
 	vector<string> FractionNames = StringProcessing::CombineUniques( config->GetFractionNames(), vector<string>() );
@@ -68,6 +70,7 @@ NormalisedSumPDF::NormalisedSumPDF( PDFConfigurator* config ) : BasePDF(), proto
 	}
 
 	if( config->isTrue( "DontPlotComponents" ) ) _plotComponents = false;
+	cacheComponents = config->isTrue( "CacheComponentValues" );
 
 	this->SetName("NormalisedSumPDF");
 	this->SetLabel( "NormalisedSumPDF_("+firstPDF->GetLabel()+")+("+secondPDF->GetLabel()+")" );
@@ -95,6 +98,8 @@ void NormalisedSumPDF::SetComponentStatus( const bool input )
 	firstPDF->SetComponentStatus( input );
 	secondPDF->SetComponentStatus( input );
 	this->ReallySetComponentStatus( input );
+	firstCache.Clear();
+	secondCache.Clear();
 }
 
 bool NormalisedSumPDF::GetComponentStatus() const
@@ -192,6 +197,8 @@ void NormalisedSumPDF::ChangePhaseSpace( PhaseSpaceBoundary * InputBoundary )
 	this->MakePrototypes( InputBoundary );
 	firstPDF->ChangePhaseSpace( InputBoundary );
 	secondPDF->ChangePhaseSpace( InputBoundary );
+	firstCache.Clear();
+	secondCache.Clear();
 }
 
 //Assemble the vectors of parameter/observable names needed
@@ -353,6 +360,113 @@ double NormalisedSumPDF::Evaluate( DataPoint* NewDataPoint )
 	return sum;
 }
 
+void NormalisedSumPDF::EvaluateBatch( const EventBlock& Input, double* out )
+{
+	this->EvaluateBlock( Input, out, false );
+}
+
+void NormalisedSumPDF::EvaluateForNumericGenerationBatch( const EventBlock& Input, double* out )
+{
+	this->EvaluateBlock( Input, out, true );
+}
+
+void NormalisedSumPDF::EvaluateBlock( const EventBlock& Input, double* out, const bool forGeneration )
+{
+	const unsigned int number = Input.GetNumberEvents();
+	if( number == 0 ) return;
+	if( firstFraction > 1.0 || firstFraction < 0.0 )
+	{
+		cerr << "Requested impossible fraction: " << firstFraction << endl;
+		for( unsigned int i=0; i< number; ++i ) out[i] = DBL_MAX;
+		return;
+	}
+
+	if( firstFraction >= 1. )
+	{
+		this->EvaluateDaughter( firstPDF, firstCache, Input, out, forGeneration );
+		for( unsigned int i=0; i< number; ++i )
+		{
+			out[i] = out[i] / this->GetFirstIntegral( Input.GetDataPoint( i ) );
+		}
+	}
+	else if( firstFraction <= 0. )
+	{
+		this->EvaluateDaughter( secondPDF, secondCache, Input, out, forGeneration );
+		for( unsigned int i=0; i< number; ++i )
+		{
+			out[i] = out[i] / this->GetSecondIntegral( Input.GetDataPoint( i ) );
+		}
+	}
+	else
+	{
+		if( batchBuffer.size() < number ) batchBuffer.resize( number );
+		double* secondValues = &(batchBuffer[0]);
+
+		this->EvaluateDaughter( firstPDF, firstCache, Input, out, forGeneration );
+		this->EvaluateDaughter( secondPDF, secondCache, Input, secondValues, forGeneration );
+
+		for( unsigned int i=0; i< number; ++i )
+		{
+			DataPoint* thisPoint = Input.GetDataPoint( i );
+			double termOne = ( out[i] * firstFraction ) / this->GetFirstIntegral( thisPoint );
+			double termTwo = ( secondValues[i] * ( 1 - firstFraction ) ) / this->GetSecondIntegral( thisPoint );
+			out[i] = termOne + termTwo;
+		}
+	}
+}
+
+void NormalisedSumPDF::EvaluateDaughter( IPDF* thisPDF, ComponentValueCache& thisCache, const EventBlock& Input, double* out, const bool forGeneration )
+{
+	if( forGeneration ) thisPDF->EvaluateForNumericGenerationBatch( Input, out );
+	else if( cacheComponents ) thisCache.EvaluateBatch( thisPDF, Input, out );
+	else thisPDF->EvaluateBatch( Input, out );
+}
+
+bool NormalisedSumPDF::GetAnalyticGradient() const
+{
+	return firstPDF->GetAnalyticGradient() && secondPDF->GetAnalyticGradient();
+}
+
+//	With p1, p2 the normalised daughters and f the fraction:
+//	d ln( f*p1 + (1-f)*p2 ) = ( f*p1*d ln(p1) + (1-f)*p2*d ln(p2) + ( p1 - p2 )*df ) / ( f*p1 + (1-f)*p2 )
+void NormalisedSumPDF::EvaluateGradient( DataPoint* NewDataPoint, PhaseSpaceBoundary* NewBoundary, const vector<string>& Names, double* gradient )
+{
+	(void)NewBoundary;	//	The daughters are normalised over integrationBoundary, as in Evaluate
+	const unsigned int number = (unsigned) Names.size();
+	if( number == 0 ) return;
+
+	if( firstFraction >= 1. )
+	{
+		firstPDF->EvaluateGradient( NewDataPoint, integrationBoundary, Names, gradient );
+		return;
+	}
+	else if( firstFraction <= 0. )
+	{
+		secondPDF->EvaluateGradient( NewDataPoint, integrationBoundary, Names, gradient );
+		return;
+	}
+
+	if( gradientBuffer.size() < number ) gradientBuffer.resize( number );
+	double* secondGradient = &(gradientBuffer[0]);
+
+	double termOne = firstPDF->Evaluate( NewDataPoint ) / this->GetFirstIntegral( NewDataPoint );
+	double termTwo = secondPDF->Evaluate( NewDataPoint ) / this->GetSecondIntegral( NewDataPoint );
+	double sum = firstFraction*termOne + ( 1. - firstFraction )*termTwo;
+
+	firstPDF->EvaluateGradient( NewDataPoint, integrationBoundary, Names, gradient );
+	secondPDF->EvaluateGradient( NewDataPoint, integrationBoundary, Names, secondGradient );
+
+	double weightOne = firstFraction*termOne / sum;
+	double weightTwo = ( 1. - firstFraction )*termTwo / sum;
+	for( unsigned int i=0; i< number; ++i )
+	{
+		gradient[i] = weightOne*gradient[i] + weightTwo*secondGradient[i];
+	}
+
+	int fractionSlot = this->GetGradientSlot( Names, fractionName );
+	if( fractionSlot >= 0 ) gradient[fractionSlot] += ( termOne - termTwo ) / sum;
+}
+
 double NormalisedSumPDF::GetFirstIntegral( DataPoint* NewDataPoint )
 {
 	return firstPDF->Integral( NewDataPoint, integrationBoundary ) * firstIntegralCorrection;
@@ -42,12 +42,6 @@ Observable::~Observable()
 {
 }
 
-//Get and set the value
-double Observable::GetValue() const
-{
-	return value;
-}
-
 //Get the unit
 string Observable::GetUnit() const
 {
@@ -0,0 +1,266 @@
+//	ROOT Headers
+#include "TMatrixDSym.h"
+//	RapidFit Headers
+#include "ParallelHessian.h"
+#include "IntegrationGrid.h"
+#include "ParameterSet.h"
+#include "PhysicsParameter.h"
+#include "PhysicsBottle.h"
+#include "ProcessPool.h"
+#include "ResultParameterSet.h"
+#include "StringProcessing.h"
+#include "ThreadPool.h"
+#include "MultiThreadedFunctions.h"
+//	System Headers
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <float.h>
+
+using namespace::std;
+
+//	Steps of half an error raise the function by about UP/4, well above the numerical noise while still close to parabolic
+static const double hessianStepFraction = 0.5;
+
+RapidFitMatrix* ParallelHessian::GetCovarianceMatrix( IFitFunction* thisFunction, const vector<double>& centre, const vector<double>& errors,
+		const double up, const unsigned int nWorkers, double& edm )
+{
+	edm = DBL_MAX;
+	ParameterSet* thisSet = thisFunction->GetParameterSet();
+	const vector<string> allNames = thisSet->GetAllNames();
+	const vector<string> floatNames = thisSet->GetAllFloatNames();
+	const unsigned int numberFloat = (unsigned) floatNames.size();
+	if( numberFloat == 0 || centre.size() != allNames.size() || errors.size() != allNames.size() ) return NULL;
+
+	//	Position of each floated parameter in the full set and the step taken in it, kept clear of any limits
+	vector<unsigned int> floatIndex;
+	vector<double> steps;
+	for( unsigned int i=0; i< numberFloat; ++i )
+	{
+		const unsigned int index = (unsigned) StringProcessing::VectorContains( allNames, floatNames[i] );
+		PhysicsParameter* thisParam = thisSet->GetPhysicsParameter( floatNames[i] );
+		double thisStep = hessianStepFraction * fabs( errors[index] );
+		if( thisParam->GetType() != "Unbounded" && thisParam->GetType() != "GaussianConstrained" )
+		{
+			if( 0.5*( centre[index] - thisParam->GetMinimum() ) < thisStep ) thisStep = 0.5*( centre[index] - thisParam->GetMinimum() );
+			if( 0.5*( thisParam->GetMaximum() - centre[index] ) < thisStep ) thisStep = 0.5*( thisParam->GetMaximum() - centre[index] );
+		}
+		if( !( thisStep > 0. ) )
+		{
+			cerr << "ParallelHessian: No room to step " << floatNames[i] << " about the minimum" << endl;
+			return NULL;
+		}
+		floatIndex.push_back( index );
+		steps.push_back( thisStep );
+	}
+
+	//	The centre, then f(+i) and f(-i) for each parameter, then f(+i+j) and f(-i-j) for each pair
+	vector<vector<double> > allPoints( 1, centre );
+	for( unsigned int i=0; i< numberFloat; ++i )
+	{
+		vector<double> thisPoint( centre );
+		thisPoint[ floatIndex[i] ] += steps[i];
+		allPoints.push_back( thisPoint );
+		thisPoint[ floatIndex[i] ] -= 2.*steps[i];
+		allPoints.push_back( thisPoint );
+	}
+	for( unsigned int i=0; i< numberFloat; ++i )
+	{
+		for( unsigned int j=i+1; j< numberFloat; ++j )
+		{
+			vector<double> thisPoint( centre );
+			thisPoint[ floatIndex[i] ] += steps[i];
+			thisPoint[ floatIndex[j] ] += steps[j];
+			allPoints.push_back( thisPoint );
+			thisPoint[ floatIndex[i] ] -= 2.*steps[i];
+			thisPoint[ floatIndex[j] ] -= 2.*steps[j];
+			allPoints.push_back( thisPoint );
+		}
+	}
+
+	HessianPoints thisData;
+	thisData.original = thisFunction;
+	thisData.allPoints = &allPoints;
+	thisData.workerFunction = NULL;
+	thisData.values = vector<double>( allPoints.size(), DBL_MAX );
+	thisData.found = vector<bool>( allPoints.size(), false );
+
+	cout << "ParallelHessian: Evaluating " << allPoints.size() << " points" << endl;
+
+	//	If no worker could be forked the points are evaluated one after another here, on a single clone
+	ThreadPool* originalPool = MultiThreadedFunctions::GetThreadPool();
+	ProcessPool::Run( ParallelHessian::EvaluatePoint, &thisData, (unsigned) allPoints.size(), ParallelHessian::StorePoint, &thisData, nWorkers );
+	if( thisData.workerFunction != NULL )
+	{
+		delete thisData.workerFunction->GetPhysicsBottle();
+		delete thisData.workerFunction;
+		MultiThreadedFunctions::SetThreadPool( originalPool );
+		IntegrationGrid::SetFreezePoints( false );
+	}
+
+	bool allGood = true;
+	for( unsigned int p=0; p< allPoints.size(); ++p )
+	{
+		if( !thisData.found[p] || !( fabs( thisData.values[p] ) < DBL_MAX ) ) allGood = false;
+	}
+
+	if( !allGood )
+	{
+		cerr << "ParallelHessian: The function couldn't be evaluated at every point" << endl;
+		return NULL;
+	}
+
+	const double centreValue = thisData.values[0];
+	const vector<double> values( thisData.values.begin()+1, thisData.values.end() );
+
+	vector<double> hessian( numberFloat*numberFloat, 0. );
+	for( unsigned int i=0; i< numberFloat; ++i )
+	{
+		hessian[i*numberFloat+i] = ( values[2*i] + values[2*i+1] - 2.*centreValue ) / ( steps[i]*steps[i] );
+	}
+	unsigned int pairPoint = 2*numberFloat;
+	for( unsigned int i=0; i< numberFloat; ++i )
+	{
+		for( unsigned int j=i+1; j< numberFloat; ++j, pairPoint+=2 )
+		{
+			const double thisTerm = ( values[pairPoint] + values[pairPoint+1] - values[2*i] - values[2*i+1] - values[2*j] - values[2*j+1] + 2.*centreValue )
+				/ ( 2.*steps[i]*steps[j] );
+			hessian[i*numberFloat+j] = thisTerm;
+			hessian[j*numberFloat+i] = thisTerm;
+		}
+	}
+
+	if( !ParallelHessian::InvertPositiveDefinite( hessian, numberFloat ) )
+	{
+		cerr << "ParallelHessian: The Hessian is not positive definite" << endl;
+		return NULL;
+	}
+
+	//	EDM = g^T H^-1 g / 2 with the gradient from the same points
+	vector<double> gradient( numberFloat, 0. );
+	for( unsigned int i=0; i< numberFloat; ++i ) gradient[i] = ( values[2*i] - values[2*i+1] ) / ( 2.*steps[i] );
+	edm = 0.;
+	for( unsigned int i=0; i< numberFloat; ++i )
+	{
+		for( unsigned int j=0; j< numberFloat; ++j ) edm += 0.5*gradient[i]*hessian[i*numberFloat+j]*gradient[j];
+	}
+
+	TMatrixDSym* covMatrix = new TMatrixDSym( (int)numberFloat );
+	for( unsigned int i=0; i< numberFloat; ++i )
+	{
+		for( unsigned int j=0; j< numberFloat; ++j )
+		{
+			(*covMatrix)((int)i,(int)j) = 2.*up*hessian[i*numberFloat+j];
+		}
+	}
+
+	RapidFitMatrix* thisCovMatrix = new RapidFitMatrix();
+	thisCovMatrix->thisMatrix = covMatrix;
+	thisCovMatrix->theseParameters = floatNames;
+
+	return thisCovMatrix;
+}
+
+vector<FitResult*> ParallelHessian::EvaluatePoint( void* input, const unsigned int index, const FitResult* )
+{
+	HessianPoints* thisData = (HessianPoints*) input;
+
+	if( thisData->workerFunction == NULL )
+	{
+		//	In a worker the threads of the inherited pool don't exist, the clone registers a pool of its own
+		MultiThreadedFunctions::SetThreadPool( NULL );
+
+		//	Every point is normalised with as many integration points as at the minimum
+		IntegrationGrid::SetFreezePoints( true );
+		thisData->workerFunction = thisData->original->Clone( 1 );
+
+		//	Every clone starts at the centre, so each one fixes the offsets of its NLL and constraints at the same point
+		ParallelHessian::EvaluateAt( thisData->workerFunction, (*thisData->allPoints)[0] );
+	}
+
+	const double thisValue = ParallelHessian::EvaluateAt( thisData->workerFunction, (*thisData->allPoints)[index] );
+
+	vector<FitResult*> theseResults;
+	if( fabs( thisValue ) < DBL_MAX )
+	{
+		ResultParameterSet noParameters( (vector<string>()) );
+		theseResults.push_back( new FitResult( thisValue, &noParameters, 3, thisData->workerFunction->GetPhysicsBottle() ) );
+	}
+	return theseResults;
+}
+
+void ParallelHessian::StorePoint( void* input, const unsigned int index, vector<FitResult*> theseResults, const double, const double )
+{
+	HessianPoints* thisData = (HessianPoints*) input;
+	if( !theseResults.empty() )
+	{
+		thisData->values[index] = theseResults[0]->GetMinimumValue();
+		thisData->found[index] = true;
+	}
+	while( !theseResults.empty() ) { delete theseResults.back(); theseResults.pop_back(); }
+}
+
+double ParallelHessian::EvaluateAt( IFitFunction* thisFunction, const vector<double>& thisPoint )
+{
+	double thisValue = DBL_MAX;
+	try
+	{
+		ParameterSet* thisSet = thisFunction->GetParameterSet();
+		thisSet->SetPhysicsParameters( thisPoint );
+		thisFunction->SetParameterSet( thisSet );
+		thisValue = thisFunction->Evaluate();
+	}
+	catch(...)
+	{
+		thisValue = DBL_MAX;
+	}
+	return thisValue;
+}
+
+bool ParallelHessian::InvertPositiveDefinite( vector<double>& matrix, const unsigned int size )
+{
+	//	matrix = L L^T with L lower triangular, this fails unless matrix is positive definite
+	vector<double> lower( size*size, 0. );
+	for( unsigned int j=0; j< size; ++j )
+	{
+		double diagonal = matrix[j*size+j];
+		for( unsigned int k=0; k< j; ++k ) diagonal -= lower[j*size+k]*lower[j*size+k];
+		if( !( diagonal > 0. ) ) return false;
+		lower[j*size+j] = sqrt( diagonal );
+
+		for( unsigned int i=j+1; i< size; ++i )
+		{
+			double thisTerm = matrix[i*size+j];
+			for( unsigned int k=0; k< j; ++k ) thisTerm -= lower[i*size+k]*lower[j*size+k];
+			lower[i*size+j] = thisTerm / lower[j*size+j];
+		}
+	}
+
+	//	L^-1 is also lower triangular
+	vector<double> inverseLower( size*size, 0. );
+	for( unsigned int i=0; i< size; ++i )
+	{
+		inverseLower[i*size+i] = 1. / lower[i*size+i];
+		for( unsigned int j=0; j< i; ++j )
+		{
+			double thisTerm = 0.;
+			for( unsigned int k=j; k< i; ++k ) thisTerm -= lower[i*size+k]*inverseLower[k*size+j];
+			inverseLower[i*size+j] = thisTerm / lower[i*size+i];
+		}
+	}
+
+	//	matrix^-1 = L^-T L^-1
+	for( unsigned int i=0; i< size; ++i )
+	{
+		for( unsigned int j=0; j< size; ++j )
+		{
+			double thisTerm = 0.;
+			for( unsigned int k=( i > j ? i : j ); k< size; ++k ) thisTerm += inverseLower[k*size+i]*inverseLower[k*size+j];
+			matrix[i*size+j] = thisTerm;
+		}
+	}
+
+	return true;
+}
+
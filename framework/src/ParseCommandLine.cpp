@@ -87,6 +87,32 @@ void ParseCommandLine::RapidFitHelp()
 	cout << "	Using this forces RapidFit to ignore everything else in the XML relating to contours" <<endl;
 	cout << "	NB: When scripting be sure to pass strings to these parameters especially coming from python!!!" <<endl;
 
+	cout << endl;
+	cout << "--workers 8" << endl;
+	cout << "	Fit the points of LL scans and contours in 8 worker processes forked from RapidFit, each fitting one point at a time" << endl;
+	cout << "	Toy studies and FC studies also generate and fit 8 toys at a time, each toy has its own seed so the results don't depend on the number of workers" << endl;
+	cout << "	The output is the same as when the points or toys are fitted one after another" << endl;
+
+	cout << endl;
+	cout << "--threadsPerWorker 4" << endl;
+	cout << "	Number of threads each worker process fits with, by default this is the number of threads from the XML" << endl;
+
+	cout << endl;
+	cout << "--DontWarmStartScans" << endl;
+	cout << "	Start every point of LL scans and contours from the XML values in grid order" << endl;
+	cout << "	By default the points are fitted outwards from the starting value and each fit starts from the nearest point in an earlier ring which has converged" << endl;
+	cout << "	With --workers every worker is kept busy, a point starts from the nearest converged point already finished, or the XML values if there isn't one yet" << endl;
+
+	cout << endl;
+	cout << "--WarmStartScanErrors" << endl;
+	cout << "	Also use the errors of the nearest converged scan point as the initial step sizes of the floated parameters" << endl;
+
+	cout << endl;
+	cout << "--resume" << endl;
+	cout << "	Carry on with toy, FC, MC studies and LL scans which were stopped, skipping the toys and points already in their journal" << endl;
+	cout << "	Every finished toy or point is written to ToyStudy.journal, FCStudy_*.journal, MCStudy.journal or LLScan_*.journal as it finishes" << endl;
+	cout << "	Use the same XML, seed and study options as the run being resumed, RapidFit refuses to resume a journal written for a different study" << endl;
+
 	cout << endl;
 	cout << "--MCStudy" << endl;
 	cout << "	Perform an MC style Study which takes an Ntuple and sequentially processes it in sequential steps" << endl;
@@ -145,6 +171,11 @@ void ParseCommandLine::RapidFitHelp()
 	cout << "--testIntegrator" << endl;
 	cout << "       This allows you to test the Numerical vs Analytical Integrals from an XML" << endl;
 
+	cout << endl;
+	cout << "--testBatchFunctions" << endl;
+	cout << "       Check the functions which evaluate a block of events at once against their reference values and exit, no XML is needed" << endl;
+	cout << "       The exit code is 0 if every check passed" << endl;
+
 	cout << endl;
 	cout << "--helpProjections" << endl;
 	cout << "       This will print a lot of options available for the Projections or ComponentProjections of a fit to data" << endl;
@@ -372,6 +403,33 @@ int ParseCommandLine::ParseThisCommandLine( RapidFitConfiguration& config, vecto
 				return BAD_COMMAND_LINE_ARG;
 			}
 		}
+		else if( currentArgument == "--workers" )
+		{
+			if( argumentIndex + 1 < argv.size() )
+			{
+				++argumentIndex;
+				int workers = atoi( argv[argumentIndex].c_str() );
+				config.numberWorkers = workers > 1 ? (unsigned) workers : 1;
+			}
+			else
+			{
+				cerr << "Number of workers not specified" << endl;
+				return BAD_COMMAND_LINE_ARG;
+			}
+		}
+		else if( currentArgument == "--threadsPerWorker" )
+		{
+			if( argumentIndex + 1 < argv.size() )
+			{
+				++argumentIndex;
+				config.threadsPerWorker = atoi( argv[argumentIndex].c_str() );
+			}
+			else
+			{
+				cerr << "Number of threads per worker not specified" << endl;
+				return BAD_COMMAND_LINE_ARG;
+			}
+		}
 		else if( currentArgument == "--OverrideXML" )
 		{
 			if( argumentIndex + 2 < argv.size() )
@@ -650,6 +708,7 @@ int ParseCommandLine::ParseThisCommandLine( RapidFitConfiguration& config, vecto
 
 		//	The Parameters beyond here are for setting boolean flags
 		else if( currentArgument == "--testIntegrator" )			{	config.testIntegratorFlag = true;			}
+		else if( currentArgument == "--testBatchFunctions" )			{	config.testBatchFunctionsFlag = true;			}
 		else if( currentArgument == "--testRapidIntegrator" )			{	config.testRapidIntegratorFlag = true;			}
 		else if( currentArgument == "--calculateFitFractions" )			{	config.calculateFitFractionsFlag = true;		}
 		else if( currentArgument == "--calculateAcceptanceWeights" )		{	config.calculateAcceptanceWeights = true;		}
@@ -664,6 +723,9 @@ int ParseCommandLine::ParseThisCommandLine( RapidFitConfiguration& config, vecto
 		else if( currentArgument == "--MCStudy" )				{	config.MCStudyFlag = true;				}
 		else if( currentArgument == "--ForceContinue" )				{	config.Force_Continue_Flag = true;			}
 		else if( currentArgument == "--DontStartAtCenter" )			{	config.StartAtCenterFlag = false;			}
+		else if( currentArgument == "--DontWarmStartScans" )			{	config.WarmStartScansFlag = false;			}
+		else if( currentArgument == "--WarmStartScanErrors" )			{	config.WarmStartScanErrorsFlag = true;			}
+		else if( currentArgument == "--resume" )				{	config.resumeFlag = true;				}
 		else if( currentArgument == "--WeightDataSet" ) 			{       config.WeightDataSet=true;				}
 		else if( currentArgument == "--saveFitXML" )				{	config.saveFitXML = true;				}
 		else if( currentArgument == "--generateToyXML" )			{	config.generateToyXML = true;				}
@@ -11,6 +11,7 @@
 #include "PerEventResModel.h"
 #include "StringProcessing.h"
 #include "Mathematics.h"
+#include "DualMathematics.h"
 
 #include <stdio.h>
 #include <vector>
@@ -25,7 +26,7 @@ RESMODEL_CREATOR( PerEventResModel );
 PerEventResModel::PerEventResModel( PDFConfigurator* configurator, bool quiet ) :
 	resScaleName		( configurator->getName("timeResolutionScale") ),
 	eventResolutionName	( configurator->getName("eventResolution") ),
-	numberComponents( 1 ), isCacheValid(false)
+	numberComponents( 1 ), isCacheValid(false), slotLayoutID(0), eventResolutionSlot(-1), eventResolutions()
 {
 	if( !quiet) cout << "PerEventResModel:: Instance created " << endl ;
 }
@@ -60,10 +61,27 @@ void PerEventResModel::addObservables( vector<string> & observableNames )
 //To take the current value of an obserable into the instance
 void PerEventResModel::setObservables( DataPoint * measurement )
 {
-	eventResolution = measurement->GetObservable( eventResolutionName )->GetValue();
+	eventResolution = this->GetEventResolution( measurement );
 	return;
 }
 
+//..........................
+//Read the event resolution, the slot is only looked up when the DataPoint layout changes
+inline double PerEventResModel::GetEventResolution( DataPoint* measurement )
+{
+	if( measurement->GetLayoutID() != slotLayoutID )
+	{
+		eventResolutionSlot = measurement->GetSlot( eventResolutionName );
+		if( eventResolutionSlot < 0 )
+		{
+			cerr << "PerEventResModel: Observable " << eventResolutionName.Name() << " not found in DataPoint" << endl;
+			throw(-20);
+		}
+		slotLayoutID = measurement->GetLayoutID();
+	}
+	return measurement->value( (unsigned)eventResolutionSlot );
+}
+
 //..........................
 //To take the current value of an obserable into the instance
 bool PerEventResModel::isPerEvent( ) {  return true ; }
@@ -94,6 +112,23 @@ double PerEventResModel::ExpCosInt( double tlow, double thigh, double gamma, dou
 	return Mathematics::ExpCosInt( tlow, thigh, gamma, dms, eventResolution*resScale) ;
 }
 
+//	Exact derivatives, the resolution is a constant here
+ResolutionDual PerEventResModel::ExpDual( double time, const ResolutionDual& gamma ) {
+	return Mathematics::Exp( ResolutionDual( time ), gamma, ResolutionDual( eventResolution*resScale ) ) ;
+}
+
+ResolutionDual PerEventResModel::ExpIntDual( double tlow, double thigh, const ResolutionDual& gamma ) {
+	return Mathematics::ExpInt( tlow, thigh, gamma, ResolutionDual( eventResolution*resScale ) ) ;
+}
+
+ResolutionDual PerEventResModel::ExpCosDual( double time, const ResolutionDual& gamma, const ResolutionDual& dms ) {
+	return Mathematics::ExpCos( ResolutionDual( time ), gamma, dms, ResolutionDual( eventResolution*resScale ) ) ;
+}
+
+ResolutionDual PerEventResModel::ExpSinDual( double time, const ResolutionDual& gamma, const ResolutionDual& dms ) {
+	return Mathematics::ExpSin( ResolutionDual( time ), gamma, dms, ResolutionDual( eventResolution*resScale ) ) ;
+}
+
 unsigned int PerEventResModel::numComponents()
 {
 	return numberComponents;
@@ -126,3 +161,29 @@ pair<double,double> PerEventResModel::ExpCosSinInt( double tlow, double thigh, d
 	return Mathematics::ExpCosSinInt( tlow, thigh, gamma, dms, eventResolution*resScale);
 }
 
+void PerEventResModel::FillEventResolutions( const EventBlock& Input )
+{
+	const unsigned int numberEvents = Input.GetNumberEvents();
+	eventResolutions.resize( numberEvents );
+
+	const double* resolutionColumn = Input.GetColumn( eventResolutionName );
+	for( unsigned int i=0; i< numberEvents; ++i )
+	{
+		if( resolutionColumn != NULL ) eventResolutions[i] = resolutionColumn[i] * resScale;
+		else eventResolutions[i] = this->GetEventResolution( Input.GetDataPoint( i ) ) * resScale;
+	}
+}
+
+void PerEventResModel::ExpBatch( const EventBlock& Input, const double* time, double gamma, double* output )
+{
+	if( Input.GetNumberEvents() == 0 ) return;
+	this->FillEventResolutions( Input );
+	Mathematics::ExpBatch( time, gamma, &(eventResolutions[0]), Input.GetNumberEvents(), output );
+}
+
+void PerEventResModel::ExpCosSinBatch( const EventBlock& Input, const double* time, double gamma, double dms, double* expCos, double* expSin )
+{
+	if( Input.GetNumberEvents() == 0 ) return;
+	this->FillEventResolutions( Input );
+	Mathematics::ExpCosSinBatch( time, gamma, dms, &(eventResolutions[0]), Input.GetNumberEvents(), expCos, expSin );
+}
@@ -0,0 +1,336 @@
+//	ROOT Headers
+#include "TStopwatch.h"
+//	RapidFit Headers
+#include "ProcessPool.h"
+#include "FitResult.h"
+//	System Headers
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <errno.h>
+#include <signal.h>
+#include <stdint.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+using namespace::std;
+
+//	Each task is sent to a worker as
+//
+//	uint32_t	task number
+//	uint64_t	length of the packed seed FitResult, 0 if there is no seed
+//
+//	followed by the packed seed, and each result is sent back to the parent as
+//
+//	uint32_t	task number
+//	double		real time
+//	double		CPU time
+//	uint32_t	number of FitResults
+//
+//	followed by the length of each packed FitResult as a uint64_t and the packed FitResult
+
+bool ProcessPool::Run( FitTask thisTask, void* taskData, const unsigned int nTasks, ResultHandler handler, void* handlerData, const unsigned int nWorkers,
+		SeedFunction seeds )
+{
+	if( nTasks == 0 ) return true;
+
+	unsigned int numberWorkers = nWorkers;
+	if( numberWorkers > nTasks ) numberWorkers = nTasks;
+	if( numberWorkers < 1 ) numberWorkers = 1;
+
+	cout << "ProcessPool: Running " << nTasks << " fits on " << numberWorkers << " worker processes" << endl;
+
+	//	A worker dying must not take the parent with it when its task pipe is written to
+	void (*oldHandler)(int) = signal( SIGPIPE, SIG_IGN );
+
+	Worker unused;
+	unused.pid = -1; unused.taskPipe = -1; unused.resultPipe = -1; unused.currentTask = -1;
+	vector<Worker> allWorkers( numberWorkers, unused );
+
+	unsigned int nextTask = 0, numberFinished = 0;
+	bool allGood = true;
+
+	for( unsigned int i=0; i< numberWorkers; ++i )
+	{
+		if( StartWorker( allWorkers, i, thisTask, taskData ) && SendTask( allWorkers[i], nextTask, seeds == NULL ? NULL : seeds( handlerData, nextTask ) ) ) ++nextTask;
+	}
+
+	while( numberFinished < nTasks )
+	{
+		vector<struct pollfd> allPolls;
+		vector<unsigned int> pollWorkers;
+		for( unsigned int i=0; i< allWorkers.size(); ++i )
+		{
+			if( allWorkers[i].currentTask < 0 ) continue;
+			struct pollfd thisPoll;
+			thisPoll.fd = allWorkers[i].resultPipe;
+			thisPoll.events = POLLIN;
+			thisPoll.revents = 0;
+			allPolls.push_back( thisPoll );
+			pollWorkers.push_back( i );
+		}
+
+		if( allPolls.empty() )
+		{
+			//	No worker could be started, run what is left here
+			cerr << "ProcessPool: No worker processes are running, running the remaining " << nTasks-nextTask << " fits here" << endl;
+			for( ; nextTask < nTasks; ++nextTask )
+			{
+				const FitResult* thisSeed = seeds == NULL ? NULL : seeds( handlerData, nextTask );
+				TStopwatch clock;
+				clock.Start( true );
+				vector<FitResult*> theseResults = thisTask( taskData, nextTask, thisSeed );
+				clock.Stop();
+				handler( handlerData, nextTask, theseResults, clock.RealTime(), clock.CpuTime() );
+				++numberFinished;
+			}
+		}
+		else
+		{
+			int ready = poll( &(allPolls[0]), (nfds_t) allPolls.size(), -1 );
+			if( ready < 0 && errno != EINTR )
+			{
+				cerr << "ProcessPool: poll failed: " << strerror( errno ) << endl;
+				exit(-4301);
+			}
+
+			for( unsigned int p=0; ready > 0 && p< allPolls.size(); ++p )
+			{
+				if( allPolls[p].revents == 0 ) continue;
+				Worker& thisWorker = allWorkers[ pollWorkers[p] ];
+				const unsigned int thisTaskNumber = (unsigned) thisWorker.currentTask;
+
+				uint32_t index=0, numberResults=0;
+				double realTime=0., cpuTime=0.;
+				bool received = ReadAll( thisWorker.resultPipe, &index, sizeof(index) ) && ReadAll( thisWorker.resultPipe, &realTime, sizeof(realTime) )
+					&& ReadAll( thisWorker.resultPipe, &cpuTime, sizeof(cpuTime) ) && ReadAll( thisWorker.resultPipe, &numberResults, sizeof(numberResults) );
+				received = received && index == thisTaskNumber;
+
+				vector<FitResult*> theseResults;
+				for( uint32_t r=0; received && r< numberResults; ++r )
+				{
+					uint64_t length=0;
+					received = ReadAll( thisWorker.resultPipe, &length, sizeof(length) );
+					string packed( received ? (size_t) length : 0, '\0' );
+					received = received && ( length == 0 || ReadAll( thisWorker.resultPipe, &(packed[0]), (size_t) length ) );
+					if( !received ) break;
+					FitResult* thisResult = FitResult::Unpack( packed );
+					if( thisResult == NULL ) cerr << "ProcessPool: Could not read result " << r << " of fit " << thisTaskNumber << endl;
+					else theseResults.push_back( thisResult );
+				}
+
+				if( !received )
+				{
+					while( !theseResults.empty() ) { delete theseResults.back(); theseResults.pop_back(); }
+				}
+				else
+				{
+					thisWorker.currentTask = -1;
+					handler( handlerData, thisTaskNumber, theseResults, realTime, cpuTime );
+					++numberFinished;
+
+					if( nextTask < nTasks )
+					{
+						if( SendTask( thisWorker, nextTask, seeds == NULL ? NULL : seeds( handlerData, nextTask ) ) ) ++nextTask;
+						else received = false;
+					}
+				}
+
+				if( !received )
+				{
+					if( thisWorker.currentTask >= 0 )
+					{
+						cerr << "ProcessPool: Worker " << thisWorker.pid << " died while running fit " << thisWorker.currentTask << endl;
+						const unsigned int lostTask = (unsigned) thisWorker.currentTask;
+						thisWorker.currentTask = -1;
+						handler( handlerData, lostTask, vector<FitResult*>(), 0., 0. );
+						++numberFinished;
+						allGood = false;
+					}
+					StopWorker( thisWorker );
+					if( nextTask < nTasks && StartWorker( allWorkers, pollWorkers[p], thisTask, taskData )
+						&& SendTask( thisWorker, nextTask, seeds == NULL ? NULL : seeds( handlerData, nextTask ) ) ) ++nextTask;
+				}
+			}
+		}
+	}
+
+	for( unsigned int i=0; i< allWorkers.size(); ++i ) StopWorker( allWorkers[i] );
+
+	signal( SIGPIPE, oldHandler );
+
+	return allGood;
+}
+
+bool ProcessPool::StartWorker( vector<Worker>& allWorkers, const unsigned int slot, FitTask thisTask, void* taskData )
+{
+	int taskPipe[2], resultPipe[2];
+	if( pipe( taskPipe ) != 0 ) return false;
+	if( pipe( resultPipe ) != 0 )
+	{
+		close( taskPipe[0] ); close( taskPipe[1] );
+		return false;
+	}
+
+	//	Anything still buffered would otherwise be printed again by the child
+	cout.flush(); cerr.flush();
+	fflush( NULL );
+
+	pid_t pid = fork();
+	if( pid < 0 )
+	{
+		cerr << "ProcessPool: fork failed: " << strerror( errno ) << endl;
+		close( taskPipe[0] ); close( taskPipe[1] );
+		close( resultPipe[0] ); close( resultPipe[1] );
+		return false;
+	}
+
+	if( pid == 0 )
+	{
+		close( taskPipe[1] );
+		close( resultPipe[0] );
+		for( unsigned int i=0; i< allWorkers.size(); ++i )
+		{
+			if( allWorkers[i].taskPipe >= 0 ) close( allWorkers[i].taskPipe );
+			if( allWorkers[i].resultPipe >= 0 ) close( allWorkers[i].resultPipe );
+		}
+		WorkerLoop( thisTask, taskData, taskPipe[0], resultPipe[1] );
+	}
+
+	close( taskPipe[0] );
+	close( resultPipe[1] );
+
+	allWorkers[slot].pid = pid;
+	allWorkers[slot].taskPipe = taskPipe[1];
+	allWorkers[slot].resultPipe = resultPipe[0];
+	allWorkers[slot].currentTask = -1;
+
+	return true;
+}
+
+bool ProcessPool::SendTask( Worker& thisWorker, const unsigned int index, const FitResult* seed )
+{
+	const uint32_t thisIndex = index;
+	string packed;
+	if( seed != NULL ) packed = seed->Pack();
+	const uint64_t length = packed.size();
+
+	string message;
+	message.append( (const char*) &thisIndex, sizeof(thisIndex) );
+	message.append( (const char*) &length, sizeof(length) );
+	message.append( packed );
+
+	if( !WriteAll( thisWorker.taskPipe, message.data(), message.size() ) ) return false;
+	thisWorker.currentTask = (int) index;
+	return true;
+}
+
+void ProcessPool::StopWorker( Worker& thisWorker )
+{
+	//	Closing the task pipe tells the worker to exit
+	if( thisWorker.taskPipe >= 0 ) close( thisWorker.taskPipe );
+	if( thisWorker.pid > 0 )
+	{
+		int status = 0;
+		while( waitpid( thisWorker.pid, &status, 0 ) < 0 && errno == EINTR ) {}
+	}
+	if( thisWorker.resultPipe >= 0 ) close( thisWorker.resultPipe );
+
+	thisWorker.pid = -1;
+	thisWorker.taskPipe = -1;
+	thisWorker.resultPipe = -1;
+	thisWorker.currentTask = -1;
+}
+
+void ProcessPool::WorkerLoop( FitTask thisTask, void* taskData, const int taskPipe, const int resultPipe )
+{
+	uint32_t index=0;
+	uint64_t seedLength=0;
+	while( ReadAll( taskPipe, &index, sizeof(index) ) && ReadAll( taskPipe, &seedLength, sizeof(seedLength) ) )
+	{
+		FitResult* thisSeed = NULL;
+		if( seedLength > 0 )
+		{
+			string packedSeed( (size_t) seedLength, '\0' );
+			if( !ReadAll( taskPipe, &(packedSeed[0]), (size_t) seedLength ) ) break;
+			thisSeed = FitResult::Unpack( packedSeed );
+		}
+
+		TStopwatch clock;
+		clock.Start( true );
+		vector<FitResult*> theseResults;
+		try
+		{
+			theseResults = thisTask( taskData, index, thisSeed );
+		}
+		catch(...)
+		{
+			cerr << "ProcessPool: Caught Error in fit " << index << endl;
+			theseResults.clear();
+		}
+		clock.Stop();
+		if( thisSeed != NULL ) delete thisSeed;
+
+		const double realTime = clock.RealTime();
+		const double cpuTime = clock.CpuTime();
+		uint32_t numberResults = 0;
+		string packed;
+		for( unsigned int r=0; r< theseResults.size(); ++r )
+		{
+			if( theseResults[r] == NULL ) continue;
+			const string thisPacked = theseResults[r]->Pack();
+			const uint64_t length = thisPacked.size();
+			packed.append( (const char*) &length, sizeof(length) );
+			packed.append( thisPacked );
+			++numberResults;
+			delete theseResults[r];
+		}
+
+		string message;
+		message.append( (const char*) &index, sizeof(index) );
+		message.append( (const char*) &realTime, sizeof(realTime) );
+		message.append( (const char*) &cpuTime, sizeof(cpuTime) );
+		message.append( (const char*) &numberResults, sizeof(numberResults) );
+		message.append( packed );
+
+		cout.flush(); cerr.flush();
+		if( !WriteAll( resultPipe, message.data(), message.size() ) ) break;
+	}
+
+	cout.flush(); cerr.flush();
+	fflush( NULL );
+
+	//	Skip the exit handlers and static destructors, these belong to the parent
+	_exit(0);
+}
+
+bool ProcessPool::ReadAll( const int fileDescriptor, void* output, const size_t bytes )
+{
+	size_t done = 0;
+	while( done < bytes )
+	{
+		ssize_t found = read( fileDescriptor, (char*) output + done, bytes - done );
+		if( found < 0 && errno == EINTR ) continue;
+		if( found <= 0 ) return false;
+		done += (size_t) found;
+	}
+	return true;
+}
+
+bool ProcessPool::WriteAll( const int fileDescriptor, const void* input, const size_t bytes )
+{
+	size_t done = 0;
+	while( done < bytes )
+	{
+		ssize_t written = write( fileDescriptor, (const char*) input + done, bytes - done );
+		if( written < 0 && errno == EINTR ) continue;
+		if( written <= 0 ) return false;
+		done += (size_t) written;
+	}
+	return true;
+}
@@ -15,7 +15,7 @@ PDF_CREATOR( ProdPDF );
 
 //Constructor not specifying fraction parameter name
 //ProdPDF::ProdPDF( IPDF * FirstPDF, IPDF * SecondPDF ) : BasePDF(), prototypeDataPoint(), prototypeParameterSet(), doNotIntegrateList(), firstPDF( ClassLookUp::CopyPDF(FirstPDF) ), secondPDF( ClassLookUp::CopyPDF(SecondPDF) )
-ProdPDF::ProdPDF( PDFConfigurator* config ) : BasePDF(), prototypeDataPoint(), prototypeParameterSet(), doNotIntegrateList(), firstPDF( NULL ), secondPDF( NULL ), _plotComponents( true )
+ProdPDF::ProdPDF( PDFConfigurator* config ) : BasePDF(), prototypeDataPoint(), prototypeParameterSet(), doNotIntegrateList(), firstPDF( NULL ), secondPDF( NULL ), _plotComponents( true ), batchBuffer(), gradientBuffer()
 {
 	if( config->GetDaughterPDFs().size() != 2 )
 	{
@@ -143,7 +143,7 @@ ProdPDF::ProdPDF( const ProdPDF& input ) : BasePDF( (BasePDF) input ),
 	prototypeDataPoint( input.prototypeDataPoint ),
 	prototypeParameterSet( input.prototypeParameterSet ),
 	doNotIntegrateList( input.doNotIntegrateList ),
-	firstPDF( ClassLookUp::CopyPDF( input.firstPDF ) ), secondPDF( ClassLookUp::CopyPDF( input.secondPDF ) ), _plotComponents( input._plotComponents )
+	firstPDF( ClassLookUp::CopyPDF( input.firstPDF ) ), secondPDF( ClassLookUp::CopyPDF( input.secondPDF ) ), _plotComponents( input._plotComponents ), batchBuffer(), gradientBuffer()
 {
 	firstPDF->SetDebugMutex( this->DebugMutex(), false );
 	secondPDF->SetDebugMutex( this->DebugMutex(), false );
@@ -240,6 +240,62 @@ double ProdPDF::Evaluate( DataPoint * NewDataPoint )
 	return prod;
 }
 
+void ProdPDF::EvaluateBatch( const EventBlock& Input, double* out )
+{
+	const unsigned int number = Input.GetNumberEvents();
+	if( number == 0 ) return;
+
+	if( batchBuffer.size() < number ) batchBuffer.resize( number );
+	double* secondValues = &(batchBuffer[0]);
+
+	firstPDF->EvaluateBatch( Input, out );
+	secondPDF->EvaluateBatch( Input, secondValues );
+
+	for( unsigned int i=0; i< number; ++i )
+	{
+		out[i] = out[i] * secondValues[i];
+	}
+}
+
+void ProdPDF::EvaluateForNumericGenerationBatch( const EventBlock& Input, double* out )
+{
+	const unsigned int number = Input.GetNumberEvents();
+	if( number == 0 ) return;
+
+	if( batchBuffer.size() < number ) batchBuffer.resize( number );
+	double* secondValues = &(batchBuffer[0]);
+
+	firstPDF->EvaluateForNumericGenerationBatch( Input, out );
+	secondPDF->EvaluateForNumericGenerationBatch( Input, secondValues );
+
+	for( unsigned int i=0; i< number; ++i )
+	{
+		out[i] = out[i] * secondValues[i];
+	}
+}
+
+bool ProdPDF::GetAnalyticGradient() const
+{
+	return !this->GetNumericalNormalisation() && firstPDF->GetAnalyticGradient() && secondPDF->GetAnalyticGradient();
+}
+
+void ProdPDF::EvaluateGradient( DataPoint* NewDataPoint, PhaseSpaceBoundary* NewBoundary, const vector<string>& Names, double* gradient )
+{
+	const unsigned int number = (unsigned) Names.size();
+	if( number == 0 ) return;
+
+	if( gradientBuffer.size() < number ) gradientBuffer.resize( number );
+	double* secondGradient = &(gradientBuffer[0]);
+
+	firstPDF->EvaluateGradient( NewDataPoint, NewBoundary, Names, gradient );
+	secondPDF->EvaluateGradient( NewDataPoint, NewBoundary, Names, secondGradient );
+
+	for( unsigned int i=0; i< number; ++i )
+	{
+		gradient[i] += secondGradient[i];
+	}
+}
+
 //Return the function value at the given point for numerical integration
 double ProdPDF::EvaluateForNumericIntegral( DataPoint * NewDataPoint )
 {
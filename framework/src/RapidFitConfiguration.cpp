@@ -9,6 +9,8 @@ using namespace::std;
 RapidFitConfiguration::RapidFitConfiguration() :
 numberRepeats(),
 	Nuisencemodel(),
+	numberWorkers(),
+	threadsPerWorker(),
 	jobNum(),
 	nData(),
 	jackStartNum(),
@@ -45,6 +47,7 @@ numberRepeats(),
 	saveOneDataSetFlag(),
 	saveOneFoamDataSetFlag(),
 	testIntegratorFlag(),
+	testBatchFunctionsFlag(),
 	testComponentPlotFlag(),
 	observableNameFlag(),
 	doPlottingFlag(),
@@ -67,6 +70,9 @@ numberRepeats(),
 	FC_LL_PART_Flag(),
 	GOF_Flag(),
 	StartAtCenterFlag(),
+	WarmStartScansFlag(),
+	WarmStartScanErrorsFlag(),
+	resumeFlag(),
 	WeightDataSet(),
 	OutputLevelSet(),
 	saveFitXML(),
@@ -96,6 +102,8 @@ numberRepeats(),
 		//Variables to store command line arguments
 		numberRepeats = 0;
 		Nuisencemodel=2;
+		numberWorkers=1;
+		threadsPerWorker=0;
 		jobNum = 0;
 		nData = 0;
 		configFileName = "";
@@ -135,6 +143,7 @@ numberRepeats(),
 		saveOneDataSetFlag = false;
 		saveOneFoamDataSetFlag = false;
 		testIntegratorFlag = false;
+		testBatchFunctionsFlag = false;
 		testComponentPlotFlag = false;
 		observableNameFlag = false;
 		doPlottingFlag = false;
@@ -157,6 +166,9 @@ numberRepeats(),
 		FC_LL_PART_Flag=false;
 		GOF_Flag=false;
 		StartAtCenterFlag=true;
+		WarmStartScansFlag=true;
+		WarmStartScanErrorsFlag=false;
+		resumeFlag=false;
 		WeightDataSet=false;
 		OutputLevelSet=false;
 		saveFitXML=false;
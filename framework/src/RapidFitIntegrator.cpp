@@ -21,6 +21,7 @@
 #include "Threading.h"
 #include "MultiThreadedFunctions.h"
 #include "MemoryDataSet.h"
+#include "IntegrationGrid.h"
 //	System Headers
 #include <iostream>
 #include <iomanip>
@@ -39,7 +40,6 @@
 #include "Math/GSLMCIntegrator.h"
 #endif
 
-pthread_mutex_t GSL_DATAPOINT_MANAGEMENT_THREADLOCK;
 pthread_mutex_t GSL_DATAPOINT_GET_THREADLOCK;
 
 pthread_mutex_t check_settings_lock;
@@ -62,7 +62,8 @@ RapidFitIntegrator::RapidFitIntegrator( IPDF * InputFunction, bool ForceNumerica
 	ratioOfIntegrals(-1.), fastIntegrator(NULL), functionToWrap(InputFunction), multiDimensionIntegrator(NULL), oneDimensionIntegrator(NULL),
 	functionCanIntegrate(false), haveTestedIntegral(false), num_threads(4),
 	RapidFitIntegratorNumerical( ForceNumerical ), obs_check(false), checked_list(),
-	pseudoRandomIntegration( UsePseudoRandomIntegration ), GSLFixedPoints( __DEFAULT_RAPIDFIT_FIXEDINTEGRATIONPOINTS ), _storedConfig(NULL)
+	pseudoRandomIntegration( UsePseudoRandomIntegration ), GSLFixedPoints( __DEFAULT_RAPIDFIT_FIXEDINTEGRATIONPOINTS ),
+	GSLPrecision( __DEFAULT_RAPIDFIT_INTEGRATIONPRECISION ), normalisationProxy(NULL), _storedConfig(NULL)
 {
 	multiDimensionIntegrator = new AdaptiveIntegratorMultiDim();
 #if ROOT_VERSION_CODE > ROOT_VERSION(5,28,0)
@@ -79,7 +80,8 @@ RapidFitIntegrator::RapidFitIntegrator( const RapidFitIntegrator& input ) : rati
 	fastIntegrator( NULL ), functionToWrap( input.functionToWrap ), multiDimensionIntegrator( NULL ), oneDimensionIntegrator( NULL ),
 	pseudoRandomIntegration(input.pseudoRandomIntegration), functionCanIntegrate( input.functionCanIntegrate ), haveTestedIntegral( true ),
 	RapidFitIntegratorNumerical( input.RapidFitIntegratorNumerical ), obs_check( input.obs_check ), checked_list( input.checked_list ),
-	num_threads(input.num_threads), GSLFixedPoints( input.GSLFixedPoints ),
+	num_threads(input.num_threads), GSLFixedPoints( input.GSLFixedPoints ), GSLPrecision( input.GSLPrecision ),
+	normalisationProxy( input.normalisationProxy==NULL?NULL:ClassLookUp::CopyPDF( input.normalisationProxy ) ),
 	_storedConfig( input._storedConfig==NULL?NULL:new RapidFitIntegratorConfig( *input._storedConfig ) )
 {
 	//	We don't own the PDF so no need to duplicate it as we have to be told which one to use
@@ -116,6 +118,7 @@ void RapidFitIntegrator::SetUpIntegrator( const RapidFitIntegratorConfig* config
 	this->SetNumThreads( config->numThreads );
 	this->SetUseGSLIntegrator( config->useGSLIntegrator );
 	this->SetFixedIntegralPoints( config->FixedIntegrationPoints );
+	this->SetIntegrationPrecision( config->IntegrationPrecision );
 	this->SetMaxIntegrationSteps( config->MaxIntegrationSteps );
 	this->SetIntegrationAbsTolerance( config->IntegrationRelTolerance );
 	this->SetIntegrationRelTolerance( config->IntegrationAbsTolerance );
@@ -180,6 +183,54 @@ void RapidFitIntegrator::SetFixedIntegralPoints( const unsigned int input )
 	}
 }
 
+void RapidFitIntegrator::SetIntegrationPrecision( const double input )
+{
+	GSLPrecision = input;
+}
+
+void RapidFitIntegrator::SetNormalisationProxy( const IPDF* Input )
+{
+	if( normalisationProxy != NULL ) delete normalisationProxy;
+	normalisationProxy = NULL;
+
+	if( Input == NULL ) return;
+
+	if( Input->GetNumericalNormalisation() )
+	{
+		cerr << "RapidFitIntegrator: Proxy PDF " << Input->GetLabel() << " has no analytic integral, NOT using it" << endl;
+		return;
+	}
+
+	normalisationProxy = ClassLookUp::CopyPDF( Input );
+}
+
+IPDF* RapidFitIntegrator::GetNormalisationProxy() const
+{
+	return normalisationProxy;
+}
+
+bool RapidFitIntegrator::ProxyMatches( const PhaseSpaceBoundary* NewBoundary, const vector<string>& DontIntegrateThese, const vector<string>& doIntegrate ) const
+{
+	if( normalisationProxy == NULL ) return false;
+
+	vector<string> proxyDoIntegrate, proxyDontIntegrate;
+	StatisticsFunctions::DoDontIntegrateLists( normalisationProxy, NewBoundary, &DontIntegrateThese, proxyDoIntegrate, proxyDontIntegrate );
+
+	vector<string> discreteNames = NewBoundary->GetDiscreteNames();
+	vector<string> proxyIntegrate;
+	for( unsigned int i=0; i< proxyDoIntegrate.size(); ++i )
+	{
+		if( StringProcessing::VectorContains( &discreteNames, &(proxyDoIntegrate[i]) ) == -1 ) proxyIntegrate.push_back( proxyDoIntegrate[i] );
+	}
+
+	if( proxyIntegrate.size() != doIntegrate.size() ) return false;
+	for( unsigned int i=0; i< doIntegrate.size(); ++i )
+	{
+		if( StringProcessing::VectorContains( &proxyIntegrate, &(doIntegrate[i]) ) == -1 ) return false;
+	}
+	return true;
+}
+
 //	Don't want the projections to be insanely accurate
 void RapidFitIntegrator::ProjectionSettings()
 {
@@ -198,6 +249,7 @@ RapidFitIntegrator::~RapidFitIntegrator()
 	if( fastIntegrator != NULL ) delete fastIntegrator;
 	//this->clearGSLIntegrationPoints();
 	if( this->_storedConfig != NULL ) delete this->_storedConfig;
+	if( normalisationProxy != NULL ) delete normalisationProxy;
 }
 
 //Return the integral over all observables
@@ -601,200 +653,75 @@ double RapidFitIntegrator::PseudoRandomNumberIntegral( IPDF* functionToWrap, con
 #endif
 }
 
-vector<DataPoint*> RapidFitIntegrator::initGSLDataPoints( unsigned int number, vector<double> maxima, vector<double> minima, DataPoint* templateDataPoint, vector<string> doIntegrate )
-{
-	vector<DataPoint*> doEval_points;
-	pthread_mutex_lock( &GSL_DATAPOINT_MANAGEMENT_THREADLOCK );
-
-#ifdef __RAPIDFIT_USE_GSL
-
-	unsigned int nDim = (unsigned) minima.size();
-
-	unsigned int npoint = number;
-	vector<double> * integrationPoints = new vector<double>[ nDim ];
+vector<IntegrationGrid*> RapidFitIntegrator::integrationGrids = vector<IntegrationGrid*>();
 
-	//pthread_mutex_lock( &gsl_mutex );
-	//cout << "Allocating GSL Integration Tool. nDim " << nDim << endl;
-	gsl_qrng * q = NULL;
-	try
-	{
-		//q = gsl_qrng_alloc( gsl_qrng_sobol, (unsigned)nDim );
-		q = gsl_qrng_alloc( gsl_qrng_niederreiter_2, (unsigned)nDim );
-	}
-	catch(...)
-	{
-		cout << "Can't Allocate Integration Tool for GSL Integral." << endl;
-		cout << " Dim: " << nDim << endl;
-		exit(-742);
-	}
+IntegrationGrid* RapidFitIntegrator::GetIntegrationGrid( IPDF* functionToWrap, const DataPoint* templateDataPoint, const vector<string>& doIntegrate )
+{
+	pthread_mutex_lock( &GSL_DATAPOINT_GET_THREADLOCK );
 
-	if( q == NULL )
-	{
-		cout << "Can't Allocate Integration Tool for GSL Integral." << endl;
-		cout << " Dim: " << nDim << endl;
-		exit(-741);
-	}
+	const string thisLabel = functionToWrap->GetLabel();
 
-	double* v = new double[ nDim ];
-	for( unsigned int i = 0; i < npoint; i++)
+	IntegrationGrid* thisGrid = NULL;
+	for( unsigned int i=0; i< integrationGrids.size(); ++i )
 	{
-		gsl_qrng_get( q, v );
-		for( unsigned int j = 0; j < nDim; j++)
+		if( integrationGrids[i]->Matches( thisLabel, templateDataPoint, doIntegrate ) )
 		{
-			integrationPoints[j].push_back( v[j] );
+			thisGrid = integrationGrids[i];
+			break;
 		}
 	}
-	delete v;
-	gsl_qrng_free(q);
-	//cout << "Freed GSL Integration Tool" << endl;
-	//pthread_mutex_unlock( &gsl_mutex );
-
-	/*vector<double> minima_v, maxima_v;
-	  for( unsigned int i=0; i< nDim; ++i )
-	  {
-	  minima_v.push_back( minima[i] );
-	  maxima_v.push_back( maxima[i] );
-	  }*/
-	//cout << "Constructing Functions" << endl;
-	//IntegratorFunction* quickFunction = new IntegratorFunction( functionToWrap, NewDataPoint, doIntegrate, dontIntegrate, NewBoundary, componentIndex, minima_v, maxima_v );
 
-	for (unsigned int i = 0; i < integrationPoints[0].size(); ++i)
+	if( thisGrid == NULL )
 	{
-		double* point = new double[ nDim ];
-		for ( unsigned int j = 0; j < nDim; j++)
-		{
-			//cout << doIntegrate[j] << " " << maxima[j] << " " << minima[j] << " " << integrationPoints[j][i] << endl;
-			point[j] = integrationPoints[j][i]*(maxima[j]-minima[j])+minima[j];
-		}
-
-		DataPoint* thisPoint = new DataPoint( *templateDataPoint );
-
-		thisPoint->ClearPerEventData();
-		vector<string> allObs=thisPoint->GetAllNames();
-		for( unsigned int j=0; j<allObs.size(); ++j )
-		{
-			Observable* thisObs = thisPoint->GetObservable( j );
-			thisObs->SetBinNumber(-1);
-			thisObs->SetBkgBinNumber(-1);
-		}
-
-		for( unsigned int k=0; k< doIntegrate.size(); ++k )
-		{
-			thisPoint->SetObservable( doIntegrate[k], point[k], "noUnitsHere" );
-		}
-
-		doEval_points.push_back( thisPoint );
-		//result += quickFunction->DoEval( point );
-		delete[] point;
+		thisGrid = new IntegrationGrid( thisLabel, templateDataPoint, doIntegrate );
+		integrationGrids.push_back( thisGrid );
 	}
 
-	delete[] integrationPoints;
-#endif
-
-	(void) maxima; (void) minima; (void) number;
-	pthread_mutex_unlock( &GSL_DATAPOINT_MANAGEMENT_THREADLOCK );
-	return doEval_points;
+	pthread_mutex_unlock( &GSL_DATAPOINT_GET_THREADLOCK );
+	return thisGrid;
 }
 
-vector<DataPoint*> RapidFitIntegrator::getGSLIntegrationPoints( unsigned int number, vector<double> maxima, vector<double> minima, DataPoint* templateDataPoint, vector<string> doIntegrate, PhaseSpaceBoundary* thisBound )
+void RapidFitIntegrator::clearGSLIntegrationPoints()
 {
 	pthread_mutex_lock( &GSL_DATAPOINT_GET_THREADLOCK );
-
-	bool pointsGood = true;
-	if( !_global_doEval_points.empty() )
+	while( !integrationGrids.empty() )
 	{
-		if( _global_doEval_points[0] != NULL )
-		{
-			vector<string> allConsts = thisBound->GetDiscreteNames();
-			for( unsigned int i=0; i< allConsts.size(); ++i )
-			{
-				double haveVal = _global_doEval_points[0]->GetObservable( allConsts[i] )->GetValue();
-				double wantVal = templateDataPoint->GetObservable( allConsts[i] )->GetValue();
-
-				if( haveVal != wantVal )
-				{
-					pointsGood = false;
-					break;
-				}
-			}
-		}
-	}
-
-	if( ( number != _global_doEval_points.size() ) || (( ( _global_range_minima != minima ) || ( _global_range_maxima != maxima ) ) || !pointsGood ) )
-	{
-		clearGSLIntegrationPoints();
-		_global_doEval_points = initGSLDataPoints( number, maxima, minima, templateDataPoint, doIntegrate );
-		_global_range_minima = minima;
-		_global_range_maxima = maxima;
-		_global_observable_names = doIntegrate;
+		if( integrationGrids.back() != NULL ) delete integrationGrids.back();
+		integrationGrids.pop_back();
 	}
-
-	vector<string> allObs = _global_doEval_points[0]->GetAllNames();
-	for( unsigned int i=0; i< _global_doEval_points.size(); ++i )
-	{
-		DataPoint* thisPoint = _global_doEval_points[i];
-		for( unsigned int j=0; j< allObs.size(); ++j )
-		{
-			Observable* thisObs = thisPoint->GetObservable( j );
-			thisObs->SetBinNumber( -1 );
-			thisObs->SetBkgBinNumber( -1 );
-		}
-		thisPoint->ClearPerEventData();
-	}
-
 	pthread_mutex_unlock( &GSL_DATAPOINT_GET_THREADLOCK );
-	return _global_doEval_points;
 }
 
-void RapidFitIntegrator::clearGSLIntegrationPoints()
+void RapidFitIntegrator::PrintIntegrationPrecision()
 {
-	pthread_mutex_lock( &GSL_DATAPOINT_MANAGEMENT_THREADLOCK );
-	while( !_global_doEval_points.empty() )
+	pthread_mutex_lock( &GSL_DATAPOINT_GET_THREADLOCK );
+	if( !integrationGrids.empty() )
 	{
-		if( _global_doEval_points.back() != NULL ) delete _global_doEval_points.back();
-		_global_doEval_points.pop_back();
+		cout << "Numerical Integration Precision:" << endl;
+		cout << setw(30) << left << "PDF" << setw(12) << "Integrals" << setw(12) << "Max Points" << setw(14) << "Mean RelErr" << setw(14) << "Max RelErr" << endl;
+		for( unsigned int i=0; i< integrationGrids.size(); ++i ) integrationGrids[i]->PrintPrecision();
+		cout << endl;
 	}
-	_global_range_minima.clear();
-	_global_range_maxima.clear();
-	_global_observable_names.clear();
-	pthread_mutex_unlock( &GSL_DATAPOINT_MANAGEMENT_THREADLOCK );
+	pthread_mutex_unlock( &GSL_DATAPOINT_GET_THREADLOCK );
 }
 
 double RapidFitIntegrator::PseudoRandomNumberIntegralThreaded( IPDF* functionToWrap, const DataPoint * NewDataPoint, const PhaseSpaceBoundary * NewBoundary,
-		ComponentRef* componentIndex, vector<string> doIntegrate, vector<string> dontIntegrate, unsigned int num_threads, unsigned int GSLFixedPoints )
+		ComponentRef* componentIndex, vector<string> doIntegrate, vector<string> dontIntegrate, unsigned int num_threads, unsigned int GSLFixedPoints, double GSLPrecision,
+		IPDF* proxyPDF, double proxyIntegral )
 {
 #ifdef __RAPIDFIT_USE_GSL
 
 	(void) dontIntegrate;
-	/*
-	   cout << endl << "Using: " << num_threads << endl;
-	   cout << "Do:" << endl;
-	   for( unsigned int i=0; i< doIntegrate.size();++i )
-	   {
-	   cout << doIntegrate[i] << endl;
-	   }
-	   cout << "Dont:" << endl;
-	   for( unsigned int i=0; i< dontIntegrate.size();++i )
-	   {
-	   cout << dontIntegrate[i] << endl;
-	   }
-	 */
-
-	//Make arrays of the observable ranges to integrate over
-	double* minima = new double[ doIntegrate.size() ];
-	double* maxima = new double[ doIntegrate.size() ];
 
 	if( DebugClass::DebugThisClass( "RapidFitIntegrator" ) )
 	{
 		cout << "RapidFitIntegrator: Starting to use GSL PseudoRandomNumberThreaded :D" << endl;
-		//for( unsigned int i=0; i< doIntegrate.size(); ++i ) cout << doIntegrate[i] << "\t";
-		//cout << endl;
-		//for( unsigned int i=0; i< dontIntegrate.size(); ++i ) cout << dontIntegrate[i] << "\t";
-		//cout << endl;
 		cout << "Component: " << componentIndex << endl;
 		if( componentIndex != NULL ) cout << componentIndex->getComponentName() << endl;
 	}
 
+	//Make arrays of the observable ranges to integrate over
+	vector<double> minima_v, maxima_v;
 	for( unsigned int observableIndex = 0; observableIndex < doIntegrate.size(); ++observableIndex )
 	{
 		IConstraint * newConstraint = NULL;
@@ -809,131 +736,29 @@ double RapidFitIntegrator::PseudoRandomNumberIntegralThreaded( IPDF* functionToW
 			cerr << endl;
 			exit(-8737);
 		}
-		minima[observableIndex] = (double)newConstraint->GetMinimum();
-		maxima[observableIndex] = (double)newConstraint->GetMaximum();
-	}
-
-	if( DebugClass::DebugThisClass( "RapidFitIntegrator" ) )
-	{
-		cout << "RapidFitIntegrator: Doing GSL stuff..." << endl;
-	}
-
-	vector<double> minima_v, maxima_v;
-	for( unsigned int i=0; i< doIntegrate.size(); ++i )
-	{
-		minima_v.push_back( minima[i] );
-		maxima_v.push_back( maxima[i] );
-	}
-
-	//	the whole new/delete here is because I'm too lazy to lookup how to cast away the const from a pointer...
-
-	DataPoint* templateDataPoint = new DataPoint( *NewDataPoint );
-
-	PhaseSpaceBoundary* thisBound = new PhaseSpaceBoundary( *NewBoundary );
-
-	vector<DataPoint*> doEval_points = RapidFitIntegrator::getGSLIntegrationPoints( GSLFixedPoints, maxima_v, minima_v, templateDataPoint, doIntegrate, thisBound );
-
-	if( DebugClass::DebugThisClass( "RapidFitIntegrator" ) )
-	{
-		cout << "RapidFitIntegrator:: " << doEval_points.size() << " GSL Points" << endl;
+		minima_v.push_back( (double)newConstraint->GetMinimum() );
+		maxima_v.push_back( (double)newConstraint->GetMaximum() );
 	}
 
-	delete templateDataPoint;
-
-	IDataSet* thisDataSet = new MemoryDataSet( thisBound, doEval_points );
-
-	delete thisBound;
-
-	ThreadingConfig* thisConfig = new ThreadingConfig();
-	thisConfig->numThreads = num_threads;
-	thisConfig->MultiThreadingInstance = "pthreads";
+	//	The grid keeps its points and PDF copies between calls, all that happens here is evaluate and sum
+	IntegrationGrid* thisGrid = RapidFitIntegrator::GetIntegrationGrid( functionToWrap, NewDataPoint, doIntegrate );
 
-	if( componentIndex != NULL ) thisConfig->wantedComponent = new ComponentRef( *componentIndex );
-	else thisConfig->wantedComponent = NULL;
+	//	The number of points needed is remembered per discrete combination
+	string combination;
+	if( GSLPrecision > 0. ) combination = NewBoundary->DiscreteDescription( const_cast<DataPoint*>(NewDataPoint) );
 
-	//	thisDataSet->GetDataPoint( 0 )->Print();
-
-	//	cout << functionToWrap->GetName() << "\t0:\t" << functionToWrap->Evaluate( thisDataSet->GetDataPoint( 0 ) ) << endl;
-
-	//	cout << functionToWrap->GetName() << "\t100:\t" << functionToWrap->Evaluate( thisDataSet->GetDataPoint( 100 ) ) << endl;
-
-	//	if( componentIndex != NULL ) cout << functionToWrap->GetName() << "\t" << thisConfig->wantedComponent->getComponentName() << ":\t" << functionToWrap->EvaluateComponent( thisDataSet->GetDataPoint( 0 ), thisConfig->wantedComponent ) << endl;
-
-	if( DebugClass::DebugThisClass( "RapidFitIntegrator" ) )
-	{
-		cout << "RapidFitIntegrator:: " << thisDataSet->GetDataNumber() << "  " << functionToWrap->GetLabel() << "  th: " << num_threads << endl;
-		thisDataSet->GetDataPoint( 0 )->Print();
-	}
-
-	vector<double>* thisSet = MultiThreadedFunctions::ParallelEvaluate( functionToWrap, thisDataSet, thisConfig );
-
-	if( DebugClass::DebugThisClass( "RapidFitIntegrator" ) )
-	{
-		cout << "RapidFitIntegrator:: Finished Eval" << endl;
-	}
-
-	delete thisDataSet;
-
-	//	DebugClass::Dump2TTree( DebugClass::GetUniqueROOTFileName(), *thisSet );
-
-	if( thisConfig->wantedComponent != NULL ) delete thisConfig->wantedComponent;
-	delete thisConfig;
-
-	double number_points = (double)GSLFixedPoints;
-
-	double result=0.;
-	double thisNum=0.;
-	sort( thisSet->begin(), thisSet->end() );
-	for( unsigned int i=0; i< thisSet->size(); ++i )
-	{
-		thisNum=thisSet->at( i );
-		if( ( !std::isnan(thisNum) && fabs(thisNum)<DBL_MAX ) && ( !std::isinf(thisNum) ) )
-		{
-			result+=thisNum;
-		}
-		else// if( std::isnan(thisNum) || std::isinf(thisNum) )
-		{
-			--number_points;
-		}
-	}
-
-	//cout << result << endl;
-
-	double factor=1.;
-	for( unsigned int i=0; i< (unsigned)doIntegrate.size(); ++i )
-	{
-		double diff = maxima[i]-minima[i];
-		//cout << factor << "\t\t" << diff << endl;
-		if( fabs( diff ) > 1E-99 ) factor *= diff;
-	}
-
-	//cout << factor << endl;
-
-	//cout << GSLFixedPoints << endl;
-
-	//cout << doEval_points.size() << endl;
-
-	//cout << thisSet->size() << endl;
-
-	result /= ( number_points / factor );
-
-	//cout << result << endl;
-
-	delete thisSet;
-
-	delete[] minima;
-	delete[] maxima;
-
-	//cout << result << endl;
+	double result = thisGrid->Integrate( functionToWrap, NewDataPoint, componentIndex, minima_v, maxima_v, GSLFixedPoints, num_threads, GSLPrecision, combination, proxyPDF, proxyIntegral );
 
 	if( DebugClass::DebugThisClass( "RapidFitIntegrator" ) )
 	{
+		cout << "RapidFitIntegrator:: " << GSLFixedPoints << " GSL Points  " << functionToWrap->GetLabel() << "  th: " << num_threads << endl;
 		cout << result << endl;
 	}
 
 	return result;
 #else
-	(void) functionToWrap; (void) NewDataPoint; (void) NewBoundary; (void) componentIndex; (void) doIntegrate; (void) dontIntegrate; (void) num_threads;
+	(void) functionToWrap; (void) NewDataPoint; (void) NewBoundary; (void) componentIndex; (void) doIntegrate; (void) dontIntegrate; (void) num_threads; (void) GSLFixedPoints;
+	(void) GSLPrecision; (void) proxyPDF; (void) proxyIntegral;
 	return -99999.;
 #endif
 }
@@ -1092,6 +917,8 @@ double RapidFitIntegrator::DoNumericalIntegral( const DataPoint * NewDataPoint,
 
 	double output_val = 0.;
 
+	const bool useProxy = pseudoRandomIntegration && this->ProxyMatches( NewBoundary, DontIntegrateThese, doIntegrate );
+
 	//If there are no observables left to integrate over, just evaluate the function
 	if( doIntegrate.empty() || doIntegrate.size() == 0 )
 	{
@@ -1143,7 +970,16 @@ double RapidFitIntegrator::DoNumericalIntegral( const DataPoint * NewDataPoint,
 						cout << "RapidFitIntegrator: Using GSL PseudoRandomNumber :D" << endl;
 					}
 					//numericalIntegral += this->PseudoRandomNumberIntegral( functionToWrap, *dataPoint_i, NewBoundary, componentIndex, doIntegrate, dontIntegrate, GSLFixedPoints );
-					numericalIntegral += this->PseudoRandomNumberIntegralThreaded( functionToWrap, *dataPoint_i, NewBoundary, componentIndex, doIntegrate, dontIntegrate, num_threads, GSLFixedPoints );
+					//	The proxy only knows the integral of the whole PDF
+					IPDF* proxyPDF = NULL;
+					double proxyIntegral = 0.;
+					if( componentIndex == NULL && useProxy )
+					{
+						proxyPDF = normalisationProxy;
+						proxyIntegral = normalisationProxy->Integral( *dataPoint_i, NewBoundary );
+					}
+					numericalIntegral += this->PseudoRandomNumberIntegralThreaded( functionToWrap, *dataPoint_i, NewBoundary, componentIndex, doIntegrate, dontIntegrate, num_threads, GSLFixedPoints, GSLPrecision,
+							proxyPDF, proxyIntegral );
 					if( DebugClass::DebugThisClass( "RapidFitIntegrator" ) )
 					{
 						cout << "RapidFitIntegrator: Finished: " << numericalIntegral << endl;
@@ -1198,17 +1034,6 @@ double RapidFitIntegrator::DoNumericalIntegral( const DataPoint * NewDataPoint,
 	return output_val;
 }
 
-void RapidFitIntegrator::ModifiyStoredPoints( DataPoint* NewDataPoint, string ProjectThis )
-{
-	ObservableRef thisObs_Ext( ProjectThis );
-	ObservableRef thisObs_Int( ProjectThis );
-	for( unsigned int i=0; i< _global_doEval_points.size(); ++i )
-	{
-		Observable* InputObs = NewDataPoint->GetObservable( thisObs_Ext );
-		_global_doEval_points[i]->SetObservable( thisObs_Int, InputObs );
-	}
-}
-
 //Return the integral over all observables except one
 double RapidFitIntegrator::ProjectObservable( DataPoint* NewDataPoint, PhaseSpaceBoundary * NewBoundary, string ProjectThis, ComponentRef* Component )
 {
@@ -1218,11 +1043,8 @@ double RapidFitIntegrator::ProjectObservable( DataPoint* NewDataPoint, PhaseSpac
 
 	if( this->GetUseGSLIntegrator() )
 	{
-		if( GSLvalidFor == ProjectThis )
-		{
-			this->ModifiyStoredPoints( NewDataPoint, ProjectThis );
-		}
-		else
+		//	The grids pick up the new value of ProjectThis from NewDataPoint themselves
+		if( GSLvalidFor != ProjectThis )
 		{
 			this->clearGSLIntegrationPoints();
 			GSLvalidFor="";
@@ -207,6 +207,11 @@ double ResultParameter::GetStepSize() const
 	return stepSize;
 }
 
+void ResultParameter::SetStepSize( double input )
+{
+	stepSize = input;
+}
+
 bool ResultParameter::GetScanStatus() const
 {
 	return ScanStatus;
@@ -10,31 +10,67 @@
 #include "PhysicsBottle.h"
 #include "OutputConfiguration.h"
 #include "PDFWithData.h"
+#include "ProcessPool.h"
+#include "ResultParameterSet.h"
+#include "StringProcessing.h"
+//	ROOT Headers
+#include "TStopwatch.h"
 //	System Headers
 #include <vector>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <string>
 #include <iomanip>
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
 
 using namespace::std;
 
+unsigned int ScanStudies::scanWorkers = 1;
+int ScanStudies::scanWorkerThreads = 0;
+bool ScanStudies::scanWarmStart = true;
+bool ScanStudies::scanSeedErrors = false;
 
-//  Interface for internal calls
-void ScanStudies::DoScan( MinimiserConfiguration * MinimiserConfig, FitFunctionConfiguration * FunctionConfig, ParameterSet* BottleParameters,
-	vector< PDFWithData* > BottleData, vector< ConstraintFunction* > BottleConstraints, ScanParam* Wanted_Param, FitResultVector* output_interface,
-	int OutputLevel, bool forceContinue )
+void ScanStudies::SetWorkers( const unsigned int numberWorkers, const int threadsPerWorker )
 {
-	FunctionConfig->SetIntegratorTest( false );
+	scanWorkers = numberWorkers < 1 ? 1 : numberWorkers;
+	scanWorkerThreads = threadsPerWorker;
+}
 
-	double uplim = Wanted_Param->GetMax();
-	double lolim = Wanted_Param->GetMin();
-	double npoints = Wanted_Param->GetPoints();
-	string scanName = Wanted_Param->GetName();
+void ScanStudies::SetWarmStart( const bool warmStart, const bool seedErrors )
+{
+	scanWarmStart = warmStart;
+	scanSeedErrors = seedErrors;
+}
 
-	//	cout << "Performing Scan for the parameter " << scanName << endl ;
+//	Index of the grid value closest to this value
+static unsigned int ClosestGridPoint( const vector<double>& gridValues, const double value )
+{
+	unsigned int closest = 0;
+	for( unsigned int i=1; i< gridValues.size(); ++i )
+	{
+		if( fabs( gridValues[i] - value ) < fabs( gridValues[closest] - value ) ) closest = i;
+	}
+	return closest;
+}
+
+//	Put the floated parameters back to where they started
+static void RestoreScanStart( ParameterSet* BottleParameters, const vector<string>& floatedNames, const vector<double>& startValues, const vector<double>& startSteps )
+{
+	for( unsigned int i=0; i< floatedNames.size(); ++i )
+	{
+		PhysicsParameter* thisParameter = BottleParameters->GetPhysicsParameter( floatedNames[i] );
+		thisParameter->SetBlindedValue( startValues[i] );
+		thisParameter->SetStepSize( startSteps[i] );
+	}
+}
 
-	// Get a pointer to the physics parameter to be scanned and fix it	
+PhysicsParameter* ScanStudies::FixScanParameter( ParameterSet* BottleParameters, const string scanName, const double lolim, const double uplim,
+	double& originalValue, string& originalType )
+{
+	// Get a pointer to the physics parameter to be scanned and fix it
 	// CAREFUL:  this must be reset as it was at the end.
 	PhysicsParameter* scanParameter = NULL;
 	try{
@@ -45,147 +81,221 @@ void ScanStudies::DoScan( MinimiserConfiguration * MinimiserConfig, FitFunctionC
 		cerr << "Couldn't find Parameter: " << scanName << ". Can NOT perform scan!" << endl << endl;
 		exit(3763);
 	}
-	double originalValue = scanParameter->GetBlindedValue();
-	string originalType = scanParameter->GetType();
+	originalValue = scanParameter->GetBlindedValue();
+	originalType = scanParameter->GetType();
 
 	if( originalType == "Fixed" && fabs(uplim-lolim) < 1E-5 )
 	{
-		cerr << "Cannot Run a scan Using Parameter: " << scanName << endl;
+		cerr << "Cannot Run a scan Using Parameter: " << scanName << endl << endl;
 		exit(3764);
 	}
 
 	scanParameter->SetType( "Fixed" ) ;
+	return scanParameter;
+}
+
+//  Interface for internal calls
+void ScanStudies::DoScan( MinimiserConfiguration * MinimiserConfig, FitFunctionConfiguration * FunctionConfig, ParameterSet* BottleParameters,
+	vector< PDFWithData* > BottleData, vector< ConstraintFunction* > BottleConstraints, ScanParam* Wanted_Param, FitResultVector* output_interface,
+	int OutputLevel, bool forceContinue )
+{
+	FunctionConfig->SetIntegratorTest( false );
+
+	double uplim = Wanted_Param->GetMax();
+	double lolim = Wanted_Param->GetMin();
+	double npoints = Wanted_Param->GetPoints();
+	string scanName = Wanted_Param->GetName();
+
+	//	cout << "Performing Scan for the parameter " << scanName << endl ;
+
+	double originalValue = 0.;
+	string originalType;
+	PhysicsParameter* scanParameter = FixScanParameter( BottleParameters, scanName, lolim, uplim, originalValue, originalType );
 	BottleParameters->FloatedFirst();
 	scanParameter = BottleParameters->GetPhysicsParameter(scanName);
 
 	// Need to set up a loop , fixing the scan parameter at each point
 	double deltaScan=0.;
+	if( int(npoints)!=1 ) deltaScan = (uplim-lolim) / (npoints-1.) ;
+	else deltaScan=0;
 
-	for( int si=0; si<int(npoints); ++si)
-	{
-		cout << "\n\nSINGLE SCAN NUMBER\t\t" << si+1 << "\t\tOF\t\t" <<int(npoints)<< endl<<endl;
+	ScanGrid thisGrid;
+	thisGrid.minimiser = MinimiserConfig; thisGrid.function = FunctionConfig; thisGrid.parameters = BottleParameters;
+	thisGrid.data = BottleData; thisGrid.constraints = BottleConstraints;
+	thisGrid.innerName = scanName; thisGrid.innerStep = deltaScan;
+	for( int si=0; si<int(npoints); ++si ) thisGrid.innerValues.push_back( lolim+deltaScan*si );
+	thisGrid.outputLevel = OutputLevel; thisGrid.forceContinue = forceContinue;
+	thisGrid.output1D = output_interface; thisGrid.output2D = NULL;
 
-		// Set scan parameter value
-		if( int(npoints)!=1 ) deltaScan = (uplim-lolim) / (npoints-1.) ;
-		else deltaScan=0;
-		double scanVal = lolim+deltaScan*si;
+	//	The scan doesn't generate anything so there is no seed to check the journal against
+	stringstream scanDefinition;
+	scanDefinition << setprecision(17) << "LLScan " << scanName << " " << lolim << " " << uplim << " " << npoints;
+	StudyJournal thisJournal( "LLScan_" + scanName + ".journal", 0, scanDefinition.str() );
+	thisGrid.journal = &thisJournal;
 
-		//      The FitFunction has the ability to change the content of the input ParameterSet by definition as it isn't defined as const
-		scanParameter = BottleParameters->GetPhysicsParameter(scanName);
-		scanParameter->SetBlindedValue( scanVal ) ;
+	RunScanGrid( &thisGrid, 0., originalValue );
+
+	// Reset the parameter as it was
+	scanParameter = BottleParameters->GetPhysicsParameter(scanName);
+	scanParameter->SetType( originalType ) ;
+	scanParameter->SetBlindedValue( originalValue ) ;
+}
 
-		cout << "Fitting at:\t" << scanName << "=" << setw(6) << scanVal << setw(6) << " " << "StepSize: " << deltaScan << endl;
+FitResult* ScanStudies::FitScanPoint( MinimiserConfiguration * MinimiserConfig, FitFunctionConfiguration * FunctionConfig, ParameterSet* BottleParameters,
+	vector< PDFWithData* > BottleData, vector< ConstraintFunction* > BottleConstraints, string scanName, double scanVal, double deltaScan,
+	const FitResult* seed, int OutputLevel, bool forceContinue )
+{
+	//      The FitFunction has the ability to change the content of the input ParameterSet by definition as it isn't defined as const
+	PhysicsParameter* scanParameter = BottleParameters->GetPhysicsParameter(scanName);
+	scanParameter->SetBlindedValue( scanVal ) ;
 
-		output_interface->StartStopwatch();
+	cout << "Fitting at:\t" << scanName << "=" << setw(6) << scanVal << setw(6) << " " << "StepSize: " << deltaScan << endl;
 
-		FitResult* scanStepResult=NULL;
+	//	Remember where the floated parameters start so a seeded fit can be retried from here
+	vector<string> floatedNames = BottleParameters->GetAllFloatNames();
+	vector<double> startValues, startSteps;
+	for( unsigned int i=0; i< floatedNames.size(); ++i )
+	{
+		startValues.push_back( BottleParameters->GetPhysicsParameter( floatedNames[i] )->GetBlindedValue() );
+		startSteps.push_back( BottleParameters->GetPhysicsParameter( floatedNames[i] )->GetStepSize() );
+	}
+
+	if( seed != NULL )
+	{
+		cout << "Starting from the nearest converged scan point" << endl;
+		SeedScanPoint( BottleParameters, floatedNames, seed );
+	}
 
+	FitResult* scanStepResult=NULL;
+
+	//BottleParameters->Print();
+
+	try{
+		//	Use the SafeFit as this always returns something when a PDF has been written to throw not exit
+		//	Do a scan point fit
 		//BottleParameters->Print();
+		scanStepResult = FitAssembler::DoSafeFit( MinimiserConfig, FunctionConfig, BottleParameters, BottleData, BottleConstraints, forceContinue, OutputLevel );
+	}
+	catch( int e )
+	{
+		cerr << "Caught Scan Error: " << e << endl;
+		exit(-987);
+	}
+	catch( ... )
+	{
+		cerr << "Caught Unknown Scan Error" << endl;
+		exit(-986);
+	}
 
-		try{
-			//	Use the SafeFit as this always returns something when a PDF has been written to throw not exit
-			//	Do a scan point fit
-			//BottleParameters->Print();
-			scanStepResult = FitAssembler::DoSafeFit( MinimiserConfig, FunctionConfig, BottleParameters, BottleData, BottleConstraints, forceContinue, OutputLevel );
-		}
-		catch( int e )
-		{
-			cerr << "Caught Scan Error: " << e << endl;
-			exit(-987);
-		}
-		catch( ... )
-		{
-			cerr << "Caught Unknown Scan Error" << endl;
-			exit(-986);
-		}
+	int retries = 0;
+	int left_right = 1;
+	int wiggle_step_num = 0;
+	double scanVal_orig = scanVal;
+	double wiggle_step_size = deltaScan/20.;
 
-		int retries = 0;
-		int left_right = 1;
-		int wiggle_step_num = 0;
-		double scanVal_orig = scanVal;
-		double wiggle_step_size = deltaScan/20.;
 
+	while( scanStepResult->GetFitStatus() != 3 )
+	{
 
-		while( scanStepResult->GetFitStatus() != 3 )
+		if( retries != 1 )
 		{
-
-			if( retries != 1 )
+			cout << "\n\t\t\tRETRYING FIT" << endl;
+			scanVal = scanVal_orig;
+			if( retries == 0 && seed != NULL )
 			{
-				cout << "\n\t\t\tRETRYING FIT" << endl;
-				scanVal = scanVal_orig;
-				++retries;
+				cout << "\t\t\tFROM THE STARTING VALUES" << endl;
+				RestoreScanStart( BottleParameters, floatedNames, startValues, startSteps );
 			}
-			else
+			++retries;
+		}
+		else
+		{
+			if( int(wiggle_step_num/2)*2 == wiggle_step_num )	// Even
 			{
-				if( int(wiggle_step_num/2)*2 == wiggle_step_num )	// Even
-				{
-					left_right = 1;
-				}
-				else							// Odd
-				{
-					left_right = -1;
-				}
-				//  remember 0/2 and 1/2 are both 0 as an integer
+				left_right = 1;
+			}
+			else							// Odd
+			{
+				left_right = -1;
+			}
+			//  remember 0/2 and 1/2 are both 0 as an integer
 
-				scanVal = scanVal_orig + (double)left_right * wiggle_step_size * (double)int((wiggle_step_num)/2 + 1);
+			scanVal = scanVal_orig + (double)left_right * wiggle_step_size * (double)int((wiggle_step_num)/2 + 1);
 
-				cout << "\tStepping to: " << scanVal << " Retrying!" << endl;
+			cout << "\tStepping to: " << scanVal << " Retrying!" << endl;
 
-				++wiggle_step_num;
-			}
+			++wiggle_step_num;
+		}
 
-			//	Perform 10 steps either side of minima with 20th of the step size
-			//	when more than 10 steps either side have strayed into next point on the scan
-			//	This 'wiggle is only done in 1D here
-			if( wiggle_step_num >= 20 ) break;
+		//	Perform 10 steps either side of minima with 20th of the step size
+		//	when more than 10 steps either side have strayed into next point on the scan
+		//	This 'wiggle is only done in 1D here
+		if( wiggle_step_num >= 20 ) break;
 
-			scanParameter->SetBlindedValue( scanVal ) ;
-			output_interface->StartStopwatch();
-			scanStepResult = FitAssembler::DoSafeFit( MinimiserConfig, FunctionConfig, BottleParameters, BottleData, BottleConstraints, forceContinue, OutputLevel );
-		}
+		scanParameter->SetBlindedValue( scanVal ) ;
+		scanStepResult = FitAssembler::DoSafeFit( MinimiserConfig, FunctionConfig, BottleParameters, BottleData, BottleConstraints, forceContinue, OutputLevel );
+	}
 
 
-		cout << "Fit Finished!\n" <<endl;
+	cout << "Fit Finished!\n" <<endl;
 
-		//  THIS IS ALWAYS TRUE BY DEFINITION OF THE SCAN
-		string name = Wanted_Param->GetName();
-		string type = BottleParameters->GetPhysicsParameter( name )->GetType();
-		string unit = BottleParameters->GetPhysicsParameter( name )->GetUnit();
-		scanStepResult->GetResultParameterSet()->SetResultParameter( name, scanVal, scanVal, 0., scanVal, scanVal, type, unit );
-
-		vector<string> Fixed_List = BottleParameters->GetAllFixedNames();
-		vector<string> Fit_List = scanStepResult->GetResultParameterSet()->GetAllNames();
-		for( unsigned short int i=0; i < Fixed_List.size() ; ++i )
+	RestoreScanStart( BottleParameters, floatedNames, startValues, startSteps );
+
+	//  THIS IS ALWAYS TRUE BY DEFINITION OF THE SCAN
+	string name = scanName;
+	string type = BottleParameters->GetPhysicsParameter( name )->GetType();
+	string unit = BottleParameters->GetPhysicsParameter( name )->GetUnit();
+	scanStepResult->GetResultParameterSet()->SetResultParameter( name, scanVal, scanVal, 0., scanVal, scanVal, type, unit );
+
+	vector<string> Fixed_List = BottleParameters->GetAllFixedNames();
+	vector<string> Fit_List = scanStepResult->GetResultParameterSet()->GetAllNames();
+	for( unsigned short int i=0; i < Fixed_List.size() ; ++i )
+	{
+		bool found=false;
+		for( unsigned short int j=0; j < Fit_List.size(); ++j )
 		{
-			bool found=false;
-			for( unsigned short int j=0; j < Fit_List.size(); ++j )
-			{
-				if( Fit_List[j] == Fixed_List[i] )
-				{
-					found = true;
-				}
-			}
-			if( !found )
+			if( Fit_List[j] == Fixed_List[i] )
 			{
-				string fixed_type = BottleParameters->GetPhysicsParameter( Fixed_List[i] )->GetType();
-				string fixed_unit = BottleParameters->GetPhysicsParameter( Fixed_List[i] )->GetUnit();
-				double fixed_value = BottleParameters->GetPhysicsParameter( Fixed_List[i] )->GetValue();
-				scanStepResult->GetResultParameterSet()->ForceNewResultParameter( Fixed_List[i],
-						fixed_value, fixed_value, 0., fixed_value, fixed_value, fixed_type, fixed_unit );
+				found = true;
 			}
 		}
+		if( !found )
+		{
+			string fixed_type = BottleParameters->GetPhysicsParameter( Fixed_List[i] )->GetType();
+			string fixed_unit = BottleParameters->GetPhysicsParameter( Fixed_List[i] )->GetUnit();
+			double fixed_value = BottleParameters->GetPhysicsParameter( Fixed_List[i] )->GetValue();
+			scanStepResult->GetResultParameterSet()->ForceNewResultParameter( Fixed_List[i],
+					fixed_value, fixed_value, 0., fixed_value, fixed_value, fixed_type, fixed_unit );
+		}
+	}
 
-		scanStepResult->GetResultParameterSet()->GetResultParameter( scanName )->SetScanStatus( true );
+	scanStepResult->GetResultParameterSet()->GetResultParameter( scanName )->SetScanStatus( true );
 
-		ResultFormatter::ReviewOutput( scanStepResult );
+	ResultFormatter::ReviewOutput( scanStepResult );
 
-		output_interface->AddFitResult( scanStepResult );
-	}
+	return scanStepResult;
+}
 
-	// Reset the parameter as it was
-	scanParameter = BottleParameters->GetPhysicsParameter(scanName);
-	scanParameter->SetType( originalType ) ;
-	scanParameter->SetBlindedValue( originalValue ) ;
+void ScanStudies::SeedScanPoint( ParameterSet* BottleParameters, const vector<string>& floatedNames, const FitResult* seed )
+{
+	ResultParameterSet* seedParameters = seed->GetResultParameterSet();
+	vector<string> seedNames = seedParameters->GetAllNames();
+
+	for( unsigned int i=0; i< floatedNames.size(); ++i )
+	{
+		if( StringProcessing::VectorContains( seedNames, floatedNames[i] ) == -1 ) continue;
+
+		ResultParameter* seedParameter = seedParameters->GetResultParameter( floatedNames[i] );
+		PhysicsParameter* thisParameter = BottleParameters->GetPhysicsParameter( floatedNames[i] );
+
+		double seedValue = seedParameter->GetValue();
+		if( !( seedValue == seedValue ) ) continue;
+		if( thisParameter->GetType() != "Unbounded" && ( seedValue < thisParameter->GetMinimum() || seedValue > thisParameter->GetMaximum() ) ) continue;
+		thisParameter->SetBlindedValue( seedValue );
+
+		//	Minuit builds its first error matrix from the step sizes
+		if( scanSeedErrors && seedParameter->GetError() > 0. ) thisParameter->SetStepSize( seedParameter->GetError() );
+	}
 }
 
 //  Interface for internal calls
@@ -205,75 +315,273 @@ void ScanStudies::DoScan2D( MinimiserConfiguration * MinimiserConfig, FitFunctio
 	string scanName2 = Param_Set.second->GetName();
 
 
-	// Get a pointer to the physics parameter to be scanned and fix it
-	// CAREFUL:  this must be reset as it was at the end.
-	PhysicsParameter* scanParameter = NULL;
-	try{
-		scanParameter = BottleParameters->GetPhysicsParameter(scanName);
-	}
-	catch(...)
+	double originalValue = 0.;
+	string originalType;
+	PhysicsParameter* scanParameter = FixScanParameter( BottleParameters, scanName, lolim, uplim, originalValue, originalType );
+
+	// Need to set up a loop , fixing the scan parameter at each point
+
+	double deltaScan=0.;
+	if( int(npoints) !=1 ) deltaScan = (uplim-lolim) / (npoints-1.) ;
+	else deltaScan=0.;
+
+	//	Fix the inner parameter here as well so any point of the grid can be fitted in any order
+	double uplim2 = Param_Set.second->GetMax();
+	double lolim2 = Param_Set.second->GetMin();
+	double npoints2 = Param_Set.second->GetPoints();
+	double deltaScan2 = 0.;
+	if( int(npoints2) !=1 ) deltaScan2 = (uplim2-lolim2) / (npoints2-1.);
+
+	double originalValue2 = 0.;
+	string originalType2;
+	FixScanParameter( BottleParameters, scanName2, lolim2, uplim2, originalValue2, originalType2 );
+	BottleParameters->FloatedFirst();
+
+	ScanGrid thisGrid;
+	thisGrid.minimiser = MinimiserConfig; thisGrid.function = FunctionConfig; thisGrid.parameters = BottleParameters;
+	thisGrid.data = BottleData; thisGrid.constraints = BottleConstraints;
+	thisGrid.outerName = scanName;
+	for( int si=0; si < int(npoints); ++si ) thisGrid.outerValues.push_back( lolim + si*deltaScan );
+	thisGrid.innerName = scanName2; thisGrid.innerStep = deltaScan2;
+	for( int sj=0; sj < int(npoints2); ++sj ) thisGrid.innerValues.push_back( lolim2 + sj*deltaScan2 );
+	thisGrid.outputLevel = OutputLevel; thisGrid.forceContinue = forceContinue;
+	thisGrid.resultNames = result_names;
+	thisGrid.output1D = NULL; thisGrid.output2D = output_interface;
+
+	stringstream scanDefinition;
+	scanDefinition << setprecision(17) << "LLContour " << scanName << " " << lolim << " " << uplim << " " << npoints
+		<< " " << scanName2 << " " << lolim2 << " " << uplim2 << " " << npoints2;
+	StudyJournal thisJournal( "LLContour_" + scanName + "_" + scanName2 + ".journal", 0, scanDefinition.str() );
+	thisGrid.journal = &thisJournal;
+
+	RunScanGrid( &thisGrid, originalValue, originalValue2 );
+
+	PhysicsParameter* scanParameter2 = BottleParameters->GetPhysicsParameter(scanName2);
+	scanParameter2->SetType( originalType2 );
+	scanParameter2->SetBlindedValue( originalValue2 );
+
+	//Reset the parameter as it was
+	scanParameter = BottleParameters->GetPhysicsParameter(scanName);
+	scanParameter->SetType( originalType ) ;
+	scanParameter->SetBlindedValue( originalValue ) ;
+}
+
+void ScanStudies::RunScanGrid( ScanGrid* thisGrid, const double outerCentre, const double innerCentre )
+{
+	const unsigned int numberInner = (unsigned) thisGrid->innerValues.size();
+	const unsigned int numberPoints = ( thisGrid->outerValues.empty() ? 1 : (unsigned) thisGrid->outerValues.size() ) * numberInner;
+
+	thisGrid->gridResults = vector<FitResult*>( numberPoints, (FitResult*) NULL );
+	thisGrid->realTimes = vector<double>( numberPoints, 0. );
+	thisGrid->cpuTimes = vector<double>( numberPoints, 0. );
+
+	//	Take the points finished by an earlier run from the journal, these also seed their neighbours
+	unsigned int numberResumed = 0;
+	for( unsigned int i=0; i< numberPoints; ++i )
 	{
-		cerr << "Couldn't find Parameter: " << scanName << ". Can NOT perform scan!" << endl << endl;
-		exit(3763);
+		if( thisGrid->journal == NULL || !thisGrid->journal->IsFinished( 0, i ) ) continue;
+		vector<FitResult*> theseResults = thisGrid->journal->GetResults( 0, i, thisGrid->realTimes[i], thisGrid->cpuTimes[i] );
+		if( theseResults.empty() ) continue;
+		thisGrid->gridResults[i] = theseResults[0];
+		for( unsigned int r=1; r< theseResults.size(); ++r ) delete theseResults[r];
+		++numberResumed;
 	}
-	double originalValue = scanParameter->GetBlindedValue( );
-	string originalType = scanParameter->GetType( );
+	if( numberResumed > 0 ) cout << "ScanStudies: " << numberResumed << " scan points were read back from the journal" << endl;
 
-	if( originalType == "Fixed" && fabs(uplim-lolim) < 1E-5 )
+	OrderScanGrid( thisGrid, outerCentre, innerCentre );
+	const unsigned int numberTasks = (unsigned) thisGrid->visitOrder.size();
+
+	if( scanWorkers > 1 && numberTasks > 1 )
 	{
-		cerr << "Cannot Run a scan Using Parameter: " << scanName << endl << endl;
-		exit(3764);
+		//	Each worker gets its own thread budget, the parent isn't fitting while they run
+		const int originalThreads = thisGrid->function->GetThreads();
+		if( scanWorkerThreads > 0 ) thisGrid->function->SetThreads( scanWorkerThreads );
+
+		//	Every point is handed out as soon as a worker is free, in ring order, so a point is seeded from whichever earlier ring has converged by then
+		//	The first points out start from the XML values, which are the central fit
+		if( scanWarmStart ) cout << "ScanStudies: Warm start, each point starts from the nearest converged point already finished, " << scanWorkers << " points at a time" << endl;
+		else cout << "ScanStudies: Every point starts from the XML values, " << scanWorkers << " points at a time" << endl;
+
+		ProcessPool::Run( ScanStudies::ScanPoint_task, (void*) thisGrid, numberTasks, ScanStudies::ScanPoint_result, (void*) thisGrid, scanWorkers,
+				scanWarmStart ? ScanStudies::ScanPoint_seed : NULL );
+
+		thisGrid->function->SetThreads( originalThreads );
 	}
-	scanParameter->SetType( "Fixed" );
+	else
+	{
+		if( scanWarmStart ) cout << "ScanStudies: Warm start, each point starts from the nearest converged point in an earlier ring, one point at a time" << endl;
+		else cout << "ScanStudies: Every point starts from the XML values, one point at a time" << endl;
 
-	// Need to set up a loop , fixing the scan parameter at each point
+		for( unsigned int i=0; i< numberTasks; ++i )
+		{
+			TStopwatch clock;
+			clock.Start( true );
+			vector<FitResult*> theseResults = ScanPoint_task( (void*) thisGrid, i, scanWarmStart ? ScanPoint_seed( (void*) thisGrid, i ) : NULL );
+			clock.Stop();
+			ScanPoint_result( (void*) thisGrid, i, theseResults, clock.RealTime(), clock.CpuTime() );
+		}
+	}
 
-	double deltaScan=0.;
-	if( int(npoints) !=1 ) deltaScan = (uplim-lolim) / (npoints-1.) ;
-	else deltaScan=0.;
+	//	The points were fitted out of order, the output is always in grid order
+	for( unsigned int i=0; i< numberPoints; ++i )
+	{
+		FitResultVector* output = thisGrid->output1D;
+		if( thisGrid->output2D != NULL )
+		{
+			//	Start a new row of the 2D scan at its first point
+			if( i % numberInner == 0 ) thisGrid->output2D->push_back( new FitResultVector( thisGrid->resultNames ) );
+			output = thisGrid->output2D->back();
+		}
+
+		output->AddFitResult( thisGrid->gridResults[i], false );
+		output->AddRealTime( thisGrid->realTimes[i] );
+		output->AddCPUTime( thisGrid->cpuTimes[i] );
+	}
+}
 
-	for( int si=0; si < int(npoints); ++si )
+void ScanStudies::OrderScanGrid( ScanGrid* thisGrid, const double outerCentre, const double innerCentre )
+{
+	const unsigned int numberInner = (unsigned) thisGrid->innerValues.size();
+	const unsigned int numberPoints = ( thisGrid->outerValues.empty() ? 1 : (unsigned) thisGrid->outerValues.size() ) * numberInner;
+
+	thisGrid->visitOrder.clear();
+	if( !scanWarmStart )
 	{
+		thisGrid->gridRings = vector<int>( numberPoints, 0 );
+		for( unsigned int i=0; i< numberPoints; ++i )
+		{
+			if( thisGrid->gridResults[i] == NULL ) thisGrid->visitOrder.push_back( i );
+		}
+		return;
+	}
+
+	const int centreOuter = thisGrid->outerValues.empty() ? 0 : (int) ClosestGridPoint( thisGrid->outerValues, outerCentre );
+	const int centreInner = (int) ClosestGridPoint( thisGrid->innerValues, innerCentre );
 
-		cout << "\n\n2DSCAN OUTER NUMBER\t\t" << si+1 << "\t\tOF\t\t" << int(npoints) <<endl<<endl;
-		FitResultVector* Returnable_Result = new FitResultVector( result_names );
+	//	Sort the points by the number of grid steps from the centre, so every point after the first has a neighbour in the ring before it
+	vector<pair<int, unsigned int> > allDistances;
+	thisGrid->gridRings.clear();
+	for( unsigned int i=0; i< numberPoints; ++i )
+	{
+		const int distance = abs( (int)(i / numberInner) - centreOuter ) + abs( (int)(i % numberInner) - centreInner );
+		allDistances.push_back( make_pair( distance, i ) );
+		thisGrid->gridRings.push_back( distance );
+	}
+	sort( allDistances.begin(), allDistances.end() );
 
-		// Set scan parameter value
-		double scanVal = lolim + si*deltaScan;
+	for( unsigned int i=0; i< numberPoints; ++i )
+	{
+		if( thisGrid->gridResults[ allDistances[i].second ] == NULL ) thisGrid->visitOrder.push_back( allDistances[i].second );
+	}
+}
 
-		cout << "Fitting at:\t" << scanName << "=" << setw(6) << scanVal << setw(6) << " " << "StepSize: " << deltaScan << endl;
+vector<FitResult*> ScanStudies::ScanPoint_task( void* input, const unsigned int index, const FitResult* seed )
+{
+	ScanGrid* thisGrid = (ScanGrid*) input;
+	const unsigned int numberInner = (unsigned) thisGrid->innerValues.size();
+	const unsigned int point = thisGrid->visitOrder[index];
 
-		//	The FitFunction has the ability to change the content of the input ParameterSet by definition as it isn't defined as const
-		scanParameter = BottleParameters->GetPhysicsParameter(scanName);
-		scanParameter->SetBlindedValue( scanVal );
+	cout << "\n\nSCAN POINT NUMBER\t\t" << point+1 << "\t\tOF\t\t" << thisGrid->gridResults.size() << "\t\t(FIT " << index+1 << ")" << endl << endl;
 
-		// Do a scan point fit
-		ScanStudies::DoScan( MinimiserConfig, FunctionConfig, BottleParameters, BottleData, BottleConstraints, Param_Set.second, Returnable_Result, OutputLevel, forceContinue );
+	if( !thisGrid->outerName.empty() )
+	{
+		double outerVal = thisGrid->outerValues[ point / numberInner ];
+		thisGrid->parameters->GetPhysicsParameter( thisGrid->outerName )->SetBlindedValue( outerVal );
+	}
 
-		//
-		//
-		//	Would be nice to add an additional wiggle here for the 2D as this would improve things at the usual cost
-		//
-		//
+	FitResult* scanStepResult = FitScanPoint( thisGrid->minimiser, thisGrid->function, thisGrid->parameters, thisGrid->data, thisGrid->constraints,
+			thisGrid->innerName, thisGrid->innerValues[ point % numberInner ], thisGrid->innerStep, seed, thisGrid->outputLevel, thisGrid->forceContinue );
 
+	if( !thisGrid->outerName.empty() )
+	{
 		//  THIS IS ALWAYS TRUE BY DEFINITION OF THE SCAN
-		string name = Param_Set.first->GetName();
-		string type = BottleParameters->GetPhysicsParameter( name )->GetType();
-		string unit = BottleParameters->GetPhysicsParameter( name )->GetUnit();
+		double outerVal = thisGrid->outerValues[ point / numberInner ];
+		string type = thisGrid->parameters->GetPhysicsParameter( thisGrid->outerName )->GetType();
+		string unit = thisGrid->parameters->GetPhysicsParameter( thisGrid->outerName )->GetUnit();
+		scanStepResult->GetResultParameterSet()->SetResultParameter( thisGrid->outerName, outerVal, outerVal, 0., outerVal, outerVal, type, unit );
+		scanStepResult->GetResultParameterSet()->GetResultParameter( thisGrid->outerName )->SetScanStatus( true );
+	}
+
+	return vector<FitResult*>( 1, scanStepResult );
+}
+
+const FitResult* ScanStudies::ScanPoint_seed( void* input, const unsigned int index )
+{
+	ScanGrid* thisGrid = (ScanGrid*) input;
+	const int numberInner = (int) thisGrid->innerValues.size();
+	const int point = (int) thisGrid->visitOrder[index];
+
+	//	Closest in grid steps, the scanned parameters can have very different ranges, ties go to the first point in grid order
+	const FitResult* closest = NULL;
+	int closestDistance = 0;
+	for( int i=0; i< (int) thisGrid->gridResults.size(); ++i )
+	{
+		const FitResult* thisResult = thisGrid->gridResults[i];
+		if( thisResult == NULL || thisResult->GetFitStatus() != 3 ) continue;
+		if( thisGrid->gridRings[i] >= thisGrid->gridRings[point] ) continue;
+		const int outerDistance = i / numberInner - point / numberInner;
+		const int innerDistance = i % numberInner - point % numberInner;
+		const int distance = outerDistance*outerDistance + innerDistance*innerDistance;
+		if( closest == NULL || distance < closestDistance )
+		{
+			closest = thisResult;
+			closestDistance = distance;
+		}
+	}
+
+	return closest;
+}
+
+void ScanStudies::ScanPoint_result( void* input, const unsigned int index, vector<FitResult*> theseResults, const double realTime, const double cpuTime )
+{
+	ScanGrid* thisGrid = (ScanGrid*) input;
+	const unsigned int numberInner = (unsigned) thisGrid->innerValues.size();
+	const unsigned int point = thisGrid->visitOrder[index];
+
+	FitResult* thisResult = theseResults.empty() ? NULL : theseResults[0];
 
-		for( short int i=0; i < Returnable_Result->NumberResults(); ++i )
+	//	A point whose worker died isn't journalled so it is fitted again on resuming
+	if( thisResult != NULL && thisGrid->journal != NULL ) thisGrid->journal->Record( 0, point, 0, theseResults, realTime, cpuTime );
+
+	if( thisResult == NULL )
+	{
+		cerr << "ScanStudies: No result for scan point " << point+1 << ", storing it as a failed fit" << endl;
+		thisResult = FailedScanPoint( thisGrid->parameters, thisGrid->innerName, thisGrid->innerValues[ point % numberInner ] );
+		if( !thisGrid->outerName.empty() )
 		{
-			Returnable_Result->GetFitResult( i )->GetResultParameterSet()->SetResultParameter( name, scanVal, scanVal, 0., scanVal, scanVal, type, unit );
-			Returnable_Result->GetFitResult( i )->GetResultParameterSet()->GetResultParameter( scanName )->SetScanStatus( true );
+			double outerVal = thisGrid->outerValues[ point / numberInner ];
+			ResultParameter* outerParam = thisResult->GetResultParameterSet()->GetResultParameter( thisGrid->outerName );
+			thisResult->GetResultParameterSet()->SetResultParameter( thisGrid->outerName, outerVal, outerVal, 0., outerVal, outerVal, outerParam->GetType(), outerParam->GetUnit() );
+			thisResult->GetResultParameterSet()->GetResultParameter( thisGrid->outerName )->SetScanStatus( true );
 		}
+	}
 
-		output_interface->push_back( Returnable_Result );
+	thisGrid->gridResults[point] = thisResult;
+	thisGrid->realTimes[point] = realTime;
+	thisGrid->cpuTimes[point] = cpuTime;
+}
+
+FitResult* ScanStudies::FailedScanPoint( ParameterSet* BottleParameters, const string scanName, const double scanVal )
+{
+	vector<string> NewNamesList = BottleParameters->GetAllNames();
+	ResultParameterSet* DummyFitResults = new ResultParameterSet( NewNamesList );
+	for( unsigned int j=0; j< NewNamesList.size(); ++j )
+	{
+		string type = BottleParameters->GetPhysicsParameter( NewNamesList[j] )->GetType();
+		string unit = BottleParameters->GetPhysicsParameter( NewNamesList[j] )->GetUnit();
+		DummyFitResults->SetResultParameter( NewNamesList[j], -999., -999., -999., -999., -999., type, unit );
 	}
+	string type = BottleParameters->GetPhysicsParameter( scanName )->GetType();
+	string unit = BottleParameters->GetPhysicsParameter( scanName )->GetUnit();
+	DummyFitResults->SetResultParameter( scanName, scanVal, scanVal, 0., scanVal, scanVal, type, unit );
+	DummyFitResults->GetResultParameter( scanName )->SetScanStatus( true );
 
-	//Reset the parameter as it was
-	scanParameter = BottleParameters->GetPhysicsParameter(scanName);
-	scanParameter->SetType( originalType ) ;
-	scanParameter->SetBlindedValue( originalValue ) ;
+	PhysicsBottle* Bad_Bottle = new PhysicsBottle( BottleParameters );
+	FitResult* ReturnableFitResult = new FitResult( LLSCAN_FIT_FAILURE_VALUE, DummyFitResults, -1, Bad_Bottle );
+	delete Bad_Bottle;
+	delete DummyFitResults;
+
+	return ReturnableFitResult;
 }
 
 // Interface for external calls
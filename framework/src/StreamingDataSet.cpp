@@ -0,0 +1,510 @@
+//	RapidFit Headers
+#include "StreamingDataSet.h"
+#include "ColumnarDataSet.h"
+#include "ObservableRef.h"
+#include "StringProcessing.h"
+//	System Headers
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <limits>
+#include <stdlib.h>
+#include <math.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+using namespace::std;
+
+StreamingDataSet* StreamingDataSet::Open( const string path, const string key, PhaseSpaceBoundary* NewBoundary, const unsigned int ChunkSize )
+{
+#ifdef _WIN32
+	(void) path; (void) key; (void) NewBoundary; (void) ChunkSize;
+	return NULL;
+#else
+	int fileDescriptor = open( path.c_str(), O_RDONLY );
+	if( fileDescriptor < 0 ) return NULL;
+
+	struct stat fileInfo;
+	if( fstat( fileDescriptor, &fileInfo ) != 0 || fileInfo.st_size <= 0 )
+	{
+		close( fileDescriptor );
+		return NULL;
+	}
+	const size_t bytes = (size_t) fileInfo.st_size;
+
+	//	Only the pages holding the header are actually read here
+	void* region = mmap( NULL, bytes, PROT_READ, MAP_SHARED, fileDescriptor, 0 );
+	if( region == MAP_FAILED )
+	{
+		close( fileDescriptor );
+		return NULL;
+	}
+	vector<string> wantedNames = NewBoundary->GetAllNames();
+	ColumnarDataSet::CacheLayout layout;
+	string problem = ColumnarDataSet::ReadCacheHeader( (const char*) region, bytes, key, wantedNames, layout );
+	munmap( region, bytes );
+
+	//	The data is only checked chunk by chunk as it is read, see ColumnarDataSet::ReadCacheRange
+	if( !problem.empty() )
+	{
+		cout << "Ignoring event cache " << path << ": " << problem << endl;
+		close( fileDescriptor );
+		return NULL;
+	}
+
+	return new StreamingDataSet( path, fileDescriptor, layout, NewBoundary, ChunkSize );
+#endif
+}
+
+StreamingDataSet::StreamingDataSet( const string path, const int fileDescriptor, const ColumnarDataSet::CacheLayout& layout, PhaseSpaceBoundary* NewBoundary, const unsigned int ChunkSize ) :
+	filePath( path ), cacheFile( fileDescriptor ), cacheLayout( layout ), dataBoundary( new PhaseSpaceBoundary(*NewBoundary) ),
+	numberEvents( (unsigned int) layout.events ), chunkSize( ChunkSize > 0 ? ChunkSize : RAPIDFIT_STREAMING_CHUNK_SIZE ), currentChunk(-1),
+	accessBuffer(), access_lock(), handedOut(), discreteNumbers(), chunkOffsets(), useWeights(false), WeightName(""), alpha(1.), alphaName("uninitialized")
+{
+	pthread_mutex_init( &access_lock, NULL );
+
+	for( unsigned int i=0; i< 2; ++i )
+	{
+		streamBuffers[i].owner = this;
+		streamBuffers[i].data = new ColumnarDataSet( dataBoundary );
+		streamBuffers[i].chunk = -1;
+		streamBuffers[i].loading = false;
+	}
+	accessBuffer.owner = this;
+	accessBuffer.data = new ColumnarDataSet( dataBoundary );
+	accessBuffer.chunk = -1;
+	accessBuffer.loading = false;
+
+	chunkOffsets.resize( this->GetNumberChunks(), numeric_limits<double>::quiet_NaN() );
+
+	cout << "Streaming " << numberEvents << " events from event cache: " << filePath << " in " << this->GetNumberChunks() << " chunks of " << chunkSize << endl;
+}
+
+StreamingDataSet::~StreamingDataSet()
+{
+	this->FinishPrefetch();
+	for( unsigned int i=0; i< 2; ++i ) delete streamBuffers[i].data;
+	delete accessBuffer.data;
+	for( map<int,DataPoint*>::iterator point_i = handedOut.begin(); point_i != handedOut.end(); ++point_i ) delete point_i->second;
+#ifndef _WIN32
+	close( cacheFile );
+#endif
+	if( dataBoundary != NULL ) delete dataBoundary;
+	pthread_mutex_destroy( &access_lock );
+}
+
+unsigned int StreamingDataSet::GetChunkSize() const
+{
+	return chunkSize;
+}
+
+unsigned int StreamingDataSet::GetNumberChunks() const
+{
+	return ( numberEvents + chunkSize - 1 ) / chunkSize;
+}
+
+unsigned int StreamingDataSet::GetChunkStart( const unsigned int chunk ) const
+{
+	return chunk * chunkSize;
+}
+
+double StreamingDataSet::GetChunkOffset( const unsigned int chunk ) const
+{
+	return chunkOffsets[chunk];
+}
+
+void StreamingDataSet::SetChunkOffset( const unsigned int chunk, const double offset )
+{
+	chunkOffsets[chunk] = offset;
+}
+
+void StreamingDataSet::LoadChunk( ChunkBuffer* buffer, const unsigned int chunk ) const
+{
+	const unsigned int start = this->GetChunkStart( chunk );
+	const unsigned int number = numberEvents - start < chunkSize ? numberEvents - start : chunkSize;
+	if( !buffer->data->ReadCacheRange( cacheFile, cacheLayout, start, number ) )
+	{
+		cerr << "StreamingDataSet: Failed to read events " << start << " to " << start+number << " from " << filePath << ". Exiting" << endl;
+		exit(-8323);
+	}
+	this->ApplyWeights( buffer->data );
+	buffer->chunk = (int) chunk;
+}
+
+void* StreamingDataSet::LoadChunk_pthread( void* input_data )
+{
+	ChunkBuffer* buffer = (ChunkBuffer*) input_data;
+	buffer->owner->LoadChunk( buffer, (unsigned) buffer->chunk );
+	return NULL;
+}
+
+void StreamingDataSet::WaitFor( ChunkBuffer* buffer )
+{
+	if( !buffer->loading ) return;
+	pthread_join( buffer->thread, NULL );
+	buffer->loading = false;
+}
+
+void StreamingDataSet::FinishPrefetch()
+{
+	for( unsigned int i=0; i< 2; ++i ) this->WaitFor( &(streamBuffers[i]) );
+}
+
+void StreamingDataSet::Prefetch( const unsigned int chunk )
+{
+	if( chunk >= this->GetNumberChunks() ) return;
+	for( unsigned int i=0; i< 2; ++i )
+	{
+		if( streamBuffers[i].chunk == (int) chunk ) return;
+	}
+
+	ChunkBuffer* target = ( currentChunk >= 0 && streamBuffers[0].chunk == currentChunk ) ? &(streamBuffers[1]) : &(streamBuffers[0]);
+	this->WaitFor( target );
+
+	target->chunk = (int) chunk;
+	target->loading = true;
+	if( pthread_create( &(target->thread), NULL, LoadChunk_pthread, (void*) target ) != 0 )
+	{
+		//	Can't read in the background, so read it now
+		target->loading = false;
+		this->LoadChunk( target, chunk );
+	}
+}
+
+ColumnarDataSet* StreamingDataSet::GetChunk( const unsigned int chunk )
+{
+	ChunkBuffer* found = NULL;
+	for( unsigned int i=0; i< 2; ++i )
+	{
+		if( streamBuffers[i].chunk == (int) chunk ) found = &(streamBuffers[i]);
+	}
+
+	if( found != NULL )
+	{
+		this->WaitFor( found );
+	}
+	else
+	{
+		found = ( currentChunk >= 0 && streamBuffers[0].chunk == currentChunk ) ? &(streamBuffers[1]) : &(streamBuffers[0]);
+		this->WaitFor( found );
+		this->LoadChunk( found, chunk );
+	}
+
+	currentChunk = (int) chunk;
+	return found->data;
+}
+
+ColumnarDataSet* StreamingDataSet::GetAccessChunk( const unsigned int chunk ) const
+{
+	if( accessBuffer.chunk != (int) chunk ) this->LoadChunk( &accessBuffer, chunk );
+	return accessBuffer.data;
+}
+
+void StreamingDataSet::ApplyWeights( ColumnarDataSet* data ) const
+{
+	if( !useWeights ) return;
+	if( alphaName != "uninitialized" )	data->SetEventWeights( WeightName, 1., alphaName );
+	else					data->SetEventWeights( WeightName, alpha );
+}
+
+void StreamingDataSet::ReweightBuffers()
+{
+	this->FinishPrefetch();
+	for( unsigned int i=0; i< 2; ++i )
+	{
+		if( streamBuffers[i].chunk >= 0 ) this->ApplyWeights( streamBuffers[i].data );
+	}
+	pthread_mutex_lock( &access_lock );
+	if( accessBuffer.chunk >= 0 ) this->ApplyWeights( accessBuffer.data );
+	for( map<int,DataPoint*>::iterator point_i = handedOut.begin(); point_i != handedOut.end(); ++point_i )
+	{
+		DataPoint* thisPoint = point_i->second;
+		double thisWeight = 1.;
+		if( useWeights )
+		{
+			thisWeight = thisPoint->GetObservable( WeightName )->GetValue();
+			if( alphaName != "uninitialized" )	thisWeight *= thisPoint->GetObservable( alphaName )->GetValue();
+			else					thisWeight *= alpha;
+		}
+		thisPoint->SetEventWeight( thisWeight );
+	}
+	pthread_mutex_unlock( &access_lock );
+}
+
+void StreamingDataSet::SumColumn( const string Name, double& sum, double& sumSq ) const
+{
+	sum = 0.;
+	sumSq = 0.;
+	pthread_mutex_lock( &access_lock );
+	for( unsigned int chunk=0; chunk< this->GetNumberChunks(); ++chunk )
+	{
+		ColumnarDataSet* thisChunk = this->GetAccessChunk( chunk );
+		const double* values = thisChunk->GetColumn( (unsigned) thisChunk->GetColumnIndex( ObservableRef( Name ) ) );
+		const unsigned int number = (unsigned) thisChunk->GetDataNumber();
+		for( unsigned int i=0; i< number; ++i )
+		{
+			sum += values[i];
+			sumSq += values[i]*values[i];
+		}
+	}
+	pthread_mutex_unlock( &access_lock );
+}
+
+//Retrieve the data point with the given index
+DataPoint* StreamingDataSet::GetDataPoint( int Index )
+{
+	if( Index < 0 || Index >= (int)numberEvents )
+	{
+		cerr << "Index (" << Index << ") out of range in DataSet" << endl;
+		return NULL;
+	}
+
+	//	Each event is copied out of the chunk the first time it's asked for, so the pointer survives the chunk being replaced
+	pthread_mutex_lock( &access_lock );
+	DataPoint*& thisPoint = handedOut[Index];
+	if( thisPoint == NULL )
+	{
+		const unsigned int chunk = (unsigned) Index / chunkSize;
+		thisPoint = new DataPoint( *(this->GetAccessChunk( chunk )->GetDataPoint( Index - (int)this->GetChunkStart( chunk ) )) );
+		thisPoint->SetPhaseSpaceBoundary( dataBoundary );
+	}
+	DataPoint* output = thisPoint;
+	pthread_mutex_unlock( &access_lock );
+	return output;
+}
+
+bool StreamingDataSet::AddDataPoint( DataPoint* NewDataPoint )
+{
+	cerr << "StreamingDataSet: Events can't be added to a DataSet streamed from " << filePath << endl;
+	delete NewDataPoint;
+	return false;
+}
+
+void StreamingDataSet::SortBy( string parameterName )
+{
+	cerr << "StreamingDataSet: Can't sort a DataSet streamed from " << filePath << " by " << parameterName << ", leaving it unsorted" << endl;
+}
+
+int StreamingDataSet::GetDataNumber( DataPoint* templateDataPoint ) const
+{
+	if( templateDataPoint == NULL ) return (int)numberEvents;
+
+	string description = dataBoundary->DiscreteDescription( templateDataPoint );
+	pthread_mutex_lock( &access_lock );
+	map<string,int>::iterator found = discreteNumbers.find( description );
+	if( found == discreteNumbers.end() )
+	{
+		int total = 0;
+		for( unsigned int chunk=0; chunk< this->GetNumberChunks(); ++chunk )
+		{
+			total += this->GetAccessChunk( chunk )->GetDataNumber( templateDataPoint );
+		}
+		found = discreteNumbers.insert( make_pair( description, total ) ).first;
+	}
+	const int output = found->second;
+	pthread_mutex_unlock( &access_lock );
+	return output;
+}
+
+PhaseSpaceBoundary* StreamingDataSet::GetBoundary() const
+{
+	return dataBoundary;
+}
+
+void StreamingDataSet::SetBoundary( const PhaseSpaceBoundary* Input )
+{
+	this->FinishPrefetch();
+	delete dataBoundary;
+	dataBoundary = new PhaseSpaceBoundary( *Input );
+	for( unsigned int i=0; i< 2; ++i ) streamBuffers[i].data->SetBoundary( Input );
+	pthread_mutex_lock( &access_lock );
+	accessBuffer.data->SetBoundary( Input );
+	for( map<int,DataPoint*>::iterator point_i = handedOut.begin(); point_i != handedOut.end(); ++point_i ) point_i->second->SetPhaseSpaceBoundary( dataBoundary );
+	discreteNumbers.clear();
+	pthread_mutex_unlock( &access_lock );
+}
+
+IDataSet* StreamingDataSet::GetDiscreteDataSet( const vector<ObservableRef> discreteParam, const vector<double> discreteVal ) const
+{
+	ColumnarDataSet* output = new ColumnarDataSet( dataBoundary );
+	pthread_mutex_lock( &access_lock );
+	for( unsigned int chunk=0; chunk< this->GetNumberChunks(); ++chunk )
+	{
+		IDataSet* thisSubSet = this->GetAccessChunk( chunk )->GetDiscreteDataSet( discreteParam, discreteVal );
+		for( int i=0; i< thisSubSet->GetDataNumber(); ++i ) output->SafeAddDataPoint( thisSubSet->GetDataPoint( i ) );
+		delete thisSubSet;
+	}
+	pthread_mutex_unlock( &access_lock );
+	this->ApplyWeights( output );
+	return output;
+}
+
+vector<DataPoint> StreamingDataSet::GetDiscreteSubSet( const vector<ObservableRef> discreteParam, const vector<double> discreteVal ) const
+{
+	vector<DataPoint> output;
+	pthread_mutex_lock( &access_lock );
+	for( unsigned int chunk=0; chunk< this->GetNumberChunks(); ++chunk )
+	{
+		vector<DataPoint> thisSubSet = this->GetAccessChunk( chunk )->GetDiscreteSubSet( discreteParam, discreteVal );
+		output.insert( output.end(), thisSubSet.begin(), thisSubSet.end() );
+	}
+	pthread_mutex_unlock( &access_lock );
+	return output;
+}
+
+vector<DataPoint> StreamingDataSet::GetDiscreteSubSet( const vector<string> discreteParam, const vector<double> discreteVal ) const
+{
+	vector<DataPoint> output;
+	pthread_mutex_lock( &access_lock );
+	for( unsigned int chunk=0; chunk< this->GetNumberChunks(); ++chunk )
+	{
+		vector<DataPoint> thisSubSet = this->GetAccessChunk( chunk )->GetDiscreteSubSet( discreteParam, discreteVal );
+		output.insert( output.end(), thisSubSet.begin(), thisSubSet.end() );
+	}
+	pthread_mutex_unlock( &access_lock );
+	return output;
+}
+
+vector<DataPoint> StreamingDataSet::GetDiscreteSubSet( DataPoint* input ) const
+{
+	vector<DataPoint> output;
+	pthread_mutex_lock( &access_lock );
+	for( unsigned int chunk=0; chunk< this->GetNumberChunks(); ++chunk )
+	{
+		vector<DataPoint> thisSubSet = this->GetAccessChunk( chunk )->GetDiscreteSubSet( input );
+		output.insert( output.end(), thisSubSet.begin(), thisSubSet.end() );
+	}
+	pthread_mutex_unlock( &access_lock );
+	return output;
+}
+
+double StreamingDataSet::Yield()
+{
+	if( useWeights )	return this->GetSumWeights();
+	else			return this->GetDataNumber();
+}
+
+double StreamingDataSet::YieldError()
+{
+	if( useWeights )	return sqrt( this->GetSumWeightsSq() );
+	else			return sqrt( this->GetDataNumber() );
+}
+
+string StreamingDataSet::GetWeightName() const
+{
+	return WeightName;
+}
+
+bool StreamingDataSet::GetWeightsWereUsed() const
+{
+	return useWeights;
+}
+
+void StreamingDataSet::UseEventWeights( const string Name )
+{
+	vector<string> allNames = dataBoundary->GetAllNames();
+	if( StringProcessing::VectorContains( &allNames, &Name ) < 0 )
+	{
+		cerr << "Observable name " << Name << " not found in DataSet" << endl;
+		throw(-20);
+	}
+	this->FinishPrefetch();
+	WeightName = Name;
+	useWeights = true;
+	this->ReweightBuffers();
+}
+
+void StreamingDataSet::NormaliseWeights()
+{
+	if( useWeights )
+	{
+		double sum_Val=0., sum_Val2=0.;
+		this->SumColumn( WeightName, sum_Val, sum_Val2 );
+		this->ApplyAlpha( sum_Val, sum_Val2 );
+	}
+}
+
+double StreamingDataSet::GetSumWeights()
+{
+	if( !useWeights ) return (double)numberEvents;
+	double sum_Val=0., sum_Val2=0.;
+	this->SumColumn( WeightName, sum_Val, sum_Val2 );
+	return sum_Val;
+}
+
+double StreamingDataSet::GetSumWeightsSq()
+{
+	if( !useWeights ) return (double)numberEvents;
+	double sum_Val=0., sum_Val2=0.;
+	this->SumColumn( WeightName, sum_Val, sum_Val2 );
+	return sum_Val2;
+}
+
+void StreamingDataSet::ApplyAlpha( const double total_sum, const double total_sum_sq )
+{
+	this->FinishPrefetch();
+	alpha = fabs(total_sum / total_sum_sq);
+	alphaName = "uninitialized";
+	this->ReweightBuffers();
+	cout << "alpha = " << setprecision(10) << total_sum << "  /  " << total_sum_sq << endl;
+	cout << "Correction Factor: " << setprecision(5) << fabs(alpha) << " applied to DataSet containing " << numberEvents << " events." << endl << endl;
+}
+
+double StreamingDataSet::GetAlpha()
+{
+	if( alphaName != "uninitialized" )
+	{
+		double alphaSum=0., alphaSum2=0.;
+		this->SumColumn( alphaName, alphaSum, alphaSum2 );
+		return fabs( alphaSum / (double)numberEvents );
+	}
+	else
+	{
+		return alpha;
+	}
+}
+
+void StreamingDataSet::ApplyExternalAlpha( const string AlphaName )
+{
+	vector<string> allNames = dataBoundary->GetAllNames();
+	if( StringProcessing::VectorContains( &allNames, &AlphaName ) < 0 )
+	{
+		cerr << "Observable name " << AlphaName << " not found in DataSet" << endl;
+		throw(-20);
+	}
+	this->FinishPrefetch();
+	alphaName = AlphaName;
+	this->ReweightBuffers();
+	double avr=0., avr2=0.;
+	this->SumColumn( alphaName, avr, avr2 );
+	avr/=(double)numberEvents;
+	cout << "Using Observable: " << alphaName << " to apply a per-event alpha correction to the per-event weights used. Average Weight: " << avr << endl << endl;
+}
+
+void StreamingDataSet::PrintYield()
+{
+	cout << "Total Yield = " << this->Yield() << " ± " << this->YieldError() << endl;
+	this->Print();
+}
+
+void StreamingDataSet::Print()
+{
+	if( useWeights && numberEvents > 0 )
+	{
+		double total=0., err=0.;
+		this->SumColumn( WeightName, total, err );
+		err = sqrt(err);
+		cout << "DataSet contains a total of:     " << total << " ± " << err << "     SIGNAL events.(" << numberEvents << " total). In " << this->GetBoundary()->GetNumberCombinations() << " Discrete DataSets." << endl;
+	}
+	else
+	{
+		cout << "DataSet contains a total of:     " << numberEvents << "     events. In " << this->GetBoundary()->GetNumberCombinations() << " Discrete DataSets." << endl;
+	}
+	cout << "Streamed from: " << filePath << " in " << this->GetNumberChunks() << " chunks of " << chunkSize << " events." << endl;
+}
+
@@ -0,0 +1,252 @@
+//	RapidFit Headers
+#include "StudyJournal.h"
+#include "FitResult.h"
+//	System Headers
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <unistd.h>
+
+using namespace::std;
+
+//	The journal starts with
+//
+//	char[8]		"RFJOURN2"
+//	uint32_t	study seed
+//	uint64_t	hash of the study definition
+//
+//	and is followed by one record for each finished step
+//
+//	uint32_t	block
+//	uint32_t	step
+//	uint32_t	seed
+//	double		real time
+//	double		CPU time
+//	uint32_t	number of FitResults
+//
+//	followed by the length of each packed FitResult as a uint64_t and the packed FitResult
+
+static const char journalMagic[8] = { 'R', 'F', 'J', 'O', 'U', 'R', 'N', '2' };
+
+template<class T> static void AppendBytes( string& output, const T& input )
+{
+	output.append( (const char*) &input, sizeof(T) );
+}
+
+template<class T> static bool ReadBytes( const string& input, size_t& position, T& output )
+{
+	if( position + sizeof(T) > input.size() ) return false;
+	memcpy( &output, input.data() + position, sizeof(T) );
+	position += sizeof(T);
+	return true;
+}
+
+bool StudyJournal::resumeStudies = false;
+string StudyJournal::studyConfiguration;
+
+void StudyJournal::SetResume( const bool resume )
+{
+	resumeStudies = resume;
+}
+
+void StudyJournal::SetStudyConfiguration( const vector<string>& xml, const vector<string>& commandLineParams )
+{
+	studyConfiguration.clear();
+	for( unsigned int i=0; i< xml.size(); ++i ) studyConfiguration.append( xml[i] + "\n" );
+	studyConfiguration.append( 1, '\0' );
+	for( unsigned int i=0; i< commandLineParams.size(); ++i ) studyConfiguration.append( commandLineParams[i] + "\n" );
+}
+
+uint64_t StudyJournal::HashDefinition( const string& studyDefinition )
+{
+	const string wholeDefinition = studyConfiguration + '\0' + studyDefinition;
+	uint64_t thisHash = 14695981039346656037ULL;
+	for( string::const_iterator char_i = wholeDefinition.begin(); char_i != wholeDefinition.end(); ++char_i )
+	{
+		thisHash = ( thisHash ^ (uint64_t)(unsigned char)(*char_i) ) * 1099511628211ULL;
+	}
+	return thisHash;
+}
+
+StudyJournal::StudyJournal( const string journalName, const unsigned int studySeed, const string studyDefinition ) :
+	fileName( journalName ), journalFile( NULL ), finishedSteps()
+{
+	const uint64_t definitionHash = StudyJournal::HashDefinition( studyDefinition );
+
+	bool resumed = false;
+	if( resumeStudies ) resumed = this->ReadJournal( studySeed, definitionHash );
+
+	if( resumed )
+	{
+		journalFile = fopen( fileName.c_str(), "ab" );
+		cout << "StudyJournal: Resuming from " << finishedSteps.size() << " finished steps in " << fileName << endl;
+	}
+	else
+	{
+		finishedSteps.clear();
+		journalFile = fopen( fileName.c_str(), "wb" );
+		if( journalFile != NULL )
+		{
+			const uint32_t thisSeed = studySeed;
+			string header( journalMagic, sizeof(journalMagic) );
+			AppendBytes( header, thisSeed );
+			AppendBytes( header, definitionHash );
+			fwrite( header.data(), 1, header.size(), journalFile );
+			fflush( journalFile );
+		}
+	}
+
+	if( journalFile == NULL )
+	{
+		cerr << "StudyJournal: Could not open " << fileName << ": " << strerror( errno ) << ", this study can't be resumed" << endl;
+	}
+}
+
+StudyJournal::~StudyJournal()
+{
+	if( journalFile != NULL ) fclose( journalFile );
+}
+
+bool StudyJournal::ReadJournal( const unsigned int studySeed, const uint64_t definitionHash )
+{
+	FILE* inputFile = fopen( fileName.c_str(), "rb" );
+	if( inputFile == NULL ) return false;
+
+	string input;
+	char buffer[65536];
+	size_t found = 0;
+	while( ( found = fread( buffer, 1, sizeof(buffer), inputFile ) ) > 0 ) input.append( buffer, found );
+	fclose( inputFile );
+
+	size_t position = sizeof(journalMagic);
+	uint32_t thisSeed = 0;
+	uint64_t thisHash = 0;
+	if( input.size() < position || input.compare( 0, sizeof(journalMagic), journalMagic, sizeof(journalMagic) ) != 0
+		|| !ReadBytes( input, position, thisSeed ) || !ReadBytes( input, position, thisHash ) )
+	{
+		cerr << "StudyJournal: " << fileName << " is not a journal, starting again" << endl;
+		return false;
+	}
+
+	//	Starting again would throw away the steps of the other study, leave it to the user to move the journal out of the way
+	if( thisSeed != studySeed )
+	{
+		cerr << "StudyJournal: " << fileName << " was written with seed " << thisSeed << " not " << studySeed << endl;
+		cerr << "StudyJournal: Refusing to resume a different study, remove the journal or run without --resume" << endl;
+		exit(-4401);
+	}
+	if( thisHash != definitionHash )
+	{
+		cerr << "StudyJournal: " << fileName << " was written for a different XML, command line parameters or study definition" << endl;
+		cerr << "StudyJournal: Refusing to resume a different study, remove the journal or run without --resume" << endl;
+		exit(-4402);
+	}
+
+	size_t lastComplete = position;
+	while( position < input.size() )
+	{
+		uint32_t block=0, step=0, seed=0, numberResults=0;
+		JournalEntry thisEntry;
+		bool complete = ReadBytes( input, position, block ) && ReadBytes( input, position, step ) && ReadBytes( input, position, seed )
+			&& ReadBytes( input, position, thisEntry.realTime ) && ReadBytes( input, position, thisEntry.cpuTime ) && ReadBytes( input, position, numberResults );
+		for( uint32_t r=0; complete && r< numberResults; ++r )
+		{
+			uint64_t length=0;
+			complete = ReadBytes( input, position, length ) && position + length <= input.size();
+			if( !complete ) break;
+			thisEntry.packedResults.push_back( input.substr( position, (size_t) length ) );
+			position += (size_t) length;
+		}
+		if( !complete ) break;
+
+		thisEntry.seed = seed;
+		finishedSteps[ make_pair( (unsigned) block, (unsigned) step ) ] = thisEntry;
+		lastComplete = position;
+	}
+
+	//	Drop the record which was being written when the study stopped so the next one follows on from the last complete one
+	if( lastComplete < input.size() )
+	{
+		cerr << "StudyJournal: Dropping an incomplete record at the end of " << fileName << endl;
+		if( truncate( fileName.c_str(), (off_t) lastComplete ) != 0 )
+		{
+			cerr << "StudyJournal: Could not truncate " << fileName << ": " << strerror( errno ) << ", starting again" << endl;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool StudyJournal::IsFinished( const unsigned int block, const unsigned int step ) const
+{
+	return finishedSteps.find( make_pair( block, step ) ) != finishedSteps.end();
+}
+
+vector<FitResult*> StudyJournal::GetResults( const unsigned int block, const unsigned int step, double& realTime, double& cpuTime ) const
+{
+	vector<FitResult*> theseResults;
+	map<pair<unsigned int, unsigned int>, JournalEntry>::const_iterator found = finishedSteps.find( make_pair( block, step ) );
+	if( found == finishedSteps.end() ) return theseResults;
+
+	realTime = found->second.realTime;
+	cpuTime = found->second.cpuTime;
+	for( unsigned int r=0; r< found->second.packedResults.size(); ++r )
+	{
+		FitResult* thisResult = FitResult::Unpack( found->second.packedResults[r] );
+		if( thisResult == NULL ) cerr << "StudyJournal: Could not read result " << r << " of step " << step << " in " << fileName << endl;
+		else theseResults.push_back( thisResult );
+	}
+	return theseResults;
+}
+
+void StudyJournal::Record( const unsigned int block, const unsigned int step, const unsigned int seed, const vector<FitResult*>& theseResults,
+		const double realTime, const double cpuTime )
+{
+	if( journalFile == NULL ) return;
+
+	const uint32_t thisBlock = block, thisStep = step, thisSeed = seed;
+	uint32_t numberResults = 0;
+	string packed;
+	for( unsigned int r=0; r< theseResults.size(); ++r )
+	{
+		if( theseResults[r] == NULL ) continue;
+		const string thisPacked = theseResults[r]->Pack();
+		const uint64_t length = thisPacked.size();
+		AppendBytes( packed, length );
+		packed.append( thisPacked );
+		++numberResults;
+	}
+
+	string record;
+	AppendBytes( record, thisBlock );
+	AppendBytes( record, thisStep );
+	AppendBytes( record, thisSeed );
+	AppendBytes( record, realTime );
+	AppendBytes( record, cpuTime );
+	AppendBytes( record, numberResults );
+	record.append( packed );
+
+	//	Write the whole record at once and make sure it reaches the disk before carrying on
+	if( fwrite( record.data(), 1, record.size(), journalFile ) != record.size() || fflush( journalFile ) != 0 )
+	{
+		//	Anything appended after a broken record couldn't be read back
+		cerr << "StudyJournal: Could not write to " << fileName << ": " << strerror( errno ) << ", no more steps will be journalled" << endl;
+		fclose( journalFile );
+		journalFile = NULL;
+		return;
+	}
+	fsync( fileno( journalFile ) );
+}
+
+unsigned int StudyJournal::NumberFinished() const
+{
+	return (unsigned) finishedSteps.size();
+}
+
@@ -22,7 +22,8 @@ PDF_CREATOR( SumPDF );
 
 SumPDF::SumPDF( const SumPDF& input ) : BasePDF( (BasePDF) input ), prototypeDataPoint(input.prototypeDataPoint), prototypeParameterSet(input.prototypeParameterSet), doNotIntegrateList(input.doNotIntegrateList),
 	firstPDF(ClassLookUp::CopyPDF(input.firstPDF) ), secondPDF( ClassLookUp::CopyPDF(input.secondPDF) ), firstFraction(input.firstFraction), firstIntegralCorrection(input.firstIntegralCorrection),
-	secondIntegralCorrection(input.secondIntegralCorrection), fractionName(input.fractionName), _plotComponents( input._plotComponents )
+	secondIntegralCorrection(input.secondIntegralCorrection), fractionName(input.fractionName), _plotComponents( input._plotComponents ), batchBuffer(),
+	cacheComponents( input.cacheComponents ), firstCache(), secondCache()
 {
 	firstPDF->SetDebugMutex( this->DebugMutex(), false );
 	secondPDF->SetDebugMutex( this->DebugMutex(), false );
@@ -32,7 +33,8 @@ SumPDF::SumPDF( const SumPDF& input ) : BasePDF( (BasePDF) input ), prototypeDat
 //SumPDF::SumPDF( IPDF * FirstPDF, IPDF * SecondPDF, PhaseSpaceBoundary * InputBoundary, string FractionName ) : prototypeDataPoint(), prototypeParameterSet(), doNotIntegrateList(), firstPDF( ClassLookUp::CopyPDF(FirstPDF) ), secondPDF( ClassLookUp::CopyPDF(SecondPDF) ), firstFraction(0.5), firstIntegralCorrection(), secondIntegralCorrection(), fractionName(FractionName)
 
 SumPDF::SumPDF( PDFConfigurator* config ) : BasePDF(), prototypeDataPoint(), prototypeParameterSet(), doNotIntegrateList(), firstPDF(NULL), secondPDF(NULL), firstFraction(0.5),
-	firstIntegralCorrection(), secondIntegralCorrection(), fractionName(), integrationBoundary(NULL), _plotComponents( true )
+	firstIntegralCorrection(), secondIntegralCorrection(), fractionName(), integrationBoundary(NULL), _plotComponents( true ), batchBuffer(),
+	cacheComponents( false ), firstCache(), secondCache()
 {
 	if( config->GetFractionNames().size() != 1 )                                                                                                                                                                                         
 	{         
@@ -56,6 +58,8 @@ SumPDF::SumPDF( PDFConfigurator* config ) : BasePDF(), prototypeDataPoint(), pro
 	cout << endl;
 	cout << "Constructing SumPDF" << endl;
 	cout << endl;
+	cacheComponents = config->isTrue( "CacheComponentValues" );
+
 	this->SetName( "SumPDF" );
 	this->SetLabel( "SumPDF_("+firstPDF->GetLabel()+")+("+firstPDF->GetLabel()+")" );
 	MakePrototypes(integrationBoundary);
@@ -71,6 +75,8 @@ void SumPDF::SetComponentStatus( const bool input )
 	firstPDF->SetComponentStatus( input );
 	secondPDF->SetComponentStatus( input );
 	this->ReallySetComponentStatus( input );
+	firstCache.Clear();
+	secondCache.Clear();
 }
 
 bool SumPDF::GetComponentStatus() const
@@ -267,6 +273,46 @@ double SumPDF::Evaluate( DataPoint * NewDataPoint )
 	return termOne + termTwo;
 }
 
+void SumPDF::EvaluateBatch( const EventBlock& Input, double* out )
+{
+	this->EvaluateBlock( Input, out, false );
+}
+
+void SumPDF::EvaluateForNumericGenerationBatch( const EventBlock& Input, double* out )
+{
+	this->EvaluateBlock( Input, out, true );
+}
+
+void SumPDF::EvaluateBlock( const EventBlock& Input, double* out, const bool forGeneration )
+{
+	const unsigned int number = Input.GetNumberEvents();
+	if( number == 0 ) return;
+	if( firstFraction > 1.0 || firstFraction < 0.0 )
+	{
+		cerr << "Requested impossible fraction: " << firstFraction << endl;
+		for( unsigned int i=0; i< number; ++i ) out[i] = DBL_MAX;
+		return;
+	}
+
+	if( batchBuffer.size() < number ) batchBuffer.resize( number );
+	double* secondValues = &(batchBuffer[0]);
+
+	this->EvaluateDaughter( firstPDF, firstCache, Input, out, forGeneration );
+	this->EvaluateDaughter( secondPDF, secondCache, Input, secondValues, forGeneration );
+
+	for( unsigned int i=0; i< number; ++i )
+	{
+		out[i] = out[i] * firstFraction + secondValues[i] * ( 1 - firstFraction );
+	}
+}
+
+void SumPDF::EvaluateDaughter( IPDF* thisPDF, ComponentValueCache& thisCache, const EventBlock& Input, double* out, const bool forGeneration )
+{
+	if( forGeneration ) thisPDF->EvaluateForNumericGenerationBatch( Input, out );
+	else if( cacheComponents ) thisCache.EvaluateBatch( thisPDF, Input, out );
+	else thisPDF->EvaluateBatch( Input, out );
+}
+
 
 //Return a prototype data point
 vector<string> SumPDF::GetPrototypeDataPoint()
@@ -0,0 +1,177 @@
+
+//	RapidFit Headers
+#include "ThreadPool.h"
+#include "Threading.h"
+//	System Headers
+#include <pthread.h>
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+using namespace::std;
+
+ThreadPool::ThreadPool( const unsigned int nThreads ) :
+	workers(), worker_info(), submit_lock(), pool_lock(), work_ready(), work_done(),
+	current_task(NULL), current_data(NULL), current_n(0), generation(0), pending(0), shutdown(false)
+{
+	pthread_mutex_init( &submit_lock, NULL );
+	pthread_mutex_init( &pool_lock, NULL );
+	pthread_cond_init( &work_ready, NULL );
+	pthread_cond_init( &work_done, NULL );
+
+	workers.resize( nThreads );
+	worker_info.resize( nThreads );
+
+	pthread_attr_t attrib;
+	pthread_attr_init( &attrib );
+	pthread_attr_setdetachstate( &attrib, PTHREAD_CREATE_JOINABLE );
+
+	for( unsigned int threadnum=0; threadnum< nThreads; ++threadnum )
+	{
+		worker_info[threadnum].pool = this;
+		worker_info[threadnum].index = threadnum;
+		int status = pthread_create( &(workers[threadnum]), &attrib, ThreadPool::WorkerLoop, (void *) &(worker_info[threadnum]) );
+		if( status )
+		{
+			cerr << "ThreadPool: ERROR from pthread_create(): " << status << "... Exiting" << endl;
+			exit(-1);
+		}
+	}
+
+	pthread_attr_destroy( &attrib );
+}
+
+ThreadPool::~ThreadPool()
+{
+	pthread_mutex_lock( &pool_lock );
+	shutdown = true;
+	pthread_cond_broadcast( &work_ready );
+	pthread_mutex_unlock( &pool_lock );
+
+	for( unsigned int threadnum=0; threadnum< workers.size(); ++threadnum )
+	{
+		pthread_join( workers[threadnum], NULL );
+	}
+
+	pthread_cond_destroy( &work_done );
+	pthread_cond_destroy( &work_ready );
+	pthread_mutex_destroy( &pool_lock );
+	pthread_mutex_destroy( &submit_lock );
+}
+
+unsigned int ThreadPool::GetNumThreads() const
+{
+	return (unsigned int) workers.size();
+}
+
+void ThreadPool::Execute( ThreadTask thisTask, Fitting_Thread* data, const unsigned int nTasks )
+{
+	if( nTasks == 0 ) return;
+
+	//	Either too much work for this pool, or the pool is in use (most likely we've been called from inside one of its tasks)
+	if( nTasks > workers.size() || pthread_mutex_trylock( &submit_lock ) != 0 )
+	{
+		ThreadPool::ExecuteTransient( thisTask, data, nTasks );
+		return;
+	}
+
+	pthread_mutex_lock( &pool_lock );
+	current_task = thisTask;
+	current_data = data;
+	current_n = nTasks;
+	pending = nTasks;
+	++generation;
+	pthread_cond_broadcast( &work_ready );
+
+	while( pending != 0 )
+	{
+		pthread_cond_wait( &work_done, &pool_lock );
+	}
+
+	current_task = NULL;
+	current_data = NULL;
+	current_n = 0;
+	pthread_mutex_unlock( &pool_lock );
+
+	pthread_mutex_unlock( &submit_lock );
+}
+
+void ThreadPool::Execute( ThreadPool* thisPool, ThreadTask thisTask, Fitting_Thread* data, const unsigned int nTasks )
+{
+	if( thisPool != NULL ) thisPool->Execute( thisTask, data, nTasks );
+	else ThreadPool::ExecuteTransient( thisTask, data, nTasks );
+}
+
+void ThreadPool::ExecuteTransient( ThreadTask thisTask, Fitting_Thread* data, const unsigned int nTasks )
+{
+	if( nTasks == 0 ) return;
+
+	pthread_t* Thread = new pthread_t[ nTasks ];
+	pthread_attr_t attrib;
+	pthread_attr_init( &attrib );
+	pthread_attr_setdetachstate( &attrib, PTHREAD_CREATE_JOINABLE );
+
+	for( unsigned int threadnum=0; threadnum< nTasks; ++threadnum )
+	{
+		int status = pthread_create( &(Thread[threadnum]), &attrib, thisTask, (void *) &(data[threadnum]) );
+		if( status )
+		{
+			cerr << "ThreadPool: ERROR from pthread_create(): " << status << "... Exiting" << endl;
+			exit(-1);
+		}
+	}
+
+	for( unsigned int threadnum=0; threadnum< nTasks; ++threadnum )
+	{
+		int status = pthread_join( Thread[threadnum], NULL );
+		if( status )
+		{
+			cerr << "ThreadPool: ERROR from pthread_join(): " << status << "... Exiting" << endl;
+			exit(-1);
+		}
+	}
+
+	pthread_attr_destroy( &attrib );
+	delete[] Thread;
+}
+
+void* ThreadPool::WorkerLoop( void* input )
+{
+	ThreadPool_Worker* thisWorker = (ThreadPool_Worker*) input;
+	ThreadPool* thisPool = thisWorker->pool;
+	const unsigned int thisIndex = thisWorker->index;
+
+	unsigned long seen_generation = 0;
+
+	pthread_mutex_lock( &(thisPool->pool_lock) );
+	while( true )
+	{
+		while( !thisPool->shutdown && thisPool->generation == seen_generation )
+		{
+			pthread_cond_wait( &(thisPool->work_ready), &(thisPool->pool_lock) );
+		}
+
+		if( thisPool->shutdown ) break;
+
+		seen_generation = thisPool->generation;
+
+		//	Not every worker has work in every batch
+		if( thisIndex >= thisPool->current_n ) continue;
+
+		ThreadTask thisTask = thisPool->current_task;
+		Fitting_Thread* thisData = &(thisPool->current_data[thisIndex]);
+
+		pthread_mutex_unlock( &(thisPool->pool_lock) );
+
+		thisTask( (void*) thisData );
+
+		pthread_mutex_lock( &(thisPool->pool_lock) );
+
+		--(thisPool->pending);
+		if( thisPool->pending == 0 ) pthread_cond_signal( &(thisPool->work_done) );
+	}
+	pthread_mutex_unlock( &(thisPool->pool_lock) );
+
+	return NULL;
+}
+
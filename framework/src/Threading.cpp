@@ -123,6 +123,19 @@ vector<vector<DataPoint*> > Threading::divideData( IDataSet* input, int subsets
 	return output_datasets;
 }
 
+vector<unsigned int> Threading::divideEvents( const unsigned int numberEvents, int subsets )
+{
+	if( subsets <= 0 ) subsets = 1;
+
+	const unsigned int subset_size = numberEvents / (unsigned) subsets;
+	vector<unsigned int> output( (unsigned) subsets, subset_size );
+
+	//	The remainder goes on the last subset, as in divideData
+	output.back() += numberEvents - (unsigned) subsets * subset_size;
+
+	return output;
+}
+
 //      Method to return a vector of data subset(s)
 vector<IDataSet*> Threading::divideDataSet( IDataSet* input, unsigned int subsets )
 {
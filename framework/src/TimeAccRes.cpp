@@ -294,3 +294,55 @@ pair<double,double> TimeAccRes::ExpCosSin( double time, double gamma, double dms
 	return thisPair;
 }
 
+void TimeAccRes::ExpBatch( const EventBlock& Input, const double* time, double gamma, double* output )
+{
+	resolutionModel->ExpBatch( Input, time, gamma, output );
+	for( unsigned int i=0; i< Input.GetNumberEvents(); ++i )
+	{
+		output[i] *= timeAcc->getValue( time[i] );
+	}
+}
+
+void TimeAccRes::ExpCosSinBatch( const EventBlock& Input, const double* time, double gamma, double dms, double* expCos, double* expSin )
+{
+	resolutionModel->ExpCosSinBatch( Input, time, gamma, dms, expCos, expSin );
+	for( unsigned int i=0; i< Input.GetNumberEvents(); ++i )
+	{
+		const double thisAcc = timeAcc->getValue( time[i] );
+		expCos[i] *= thisAcc; expSin[i] *= thisAcc;
+	}
+}
+
+ResolutionDual TimeAccRes::ExpDual( double time, const ResolutionDual& gamma )
+{
+	return resolutionModel->ExpDual( time, gamma ) * timeAcc->getValue( time );
+}
+
+ResolutionDual TimeAccRes::ExpIntDual( double tlow, double thigh, const ResolutionDual& gamma )
+{
+	ResolutionDual returnable_ExpInt( 0. );
+
+	for( unsigned int islice = 0; islice < (unsigned) timeAcc->numberOfSlices(); ++islice )
+	{
+		AcceptanceSlice* thisSlice = timeAcc->getSlice(islice);
+
+		const double tlo = tlow > thisSlice->tlow() ? tlow : thisSlice->tlow();
+		const double thi = thigh < thisSlice->thigh() ? thigh : thisSlice->thigh();
+		if( thi > tlo )
+		{
+			returnable_ExpInt += resolutionModel->ExpIntDual( tlo, thi, gamma ) * thisSlice->height();
+		}
+	}
+
+	return returnable_ExpInt;
+}
+
+ResolutionDual TimeAccRes::ExpCosDual( double time, const ResolutionDual& gamma, const ResolutionDual& dms )
+{
+	return resolutionModel->ExpCosDual( time, gamma, dms ) * timeAcc->getValue( time );
+}
+
+ResolutionDual TimeAccRes::ExpSinDual( double time, const ResolutionDual& gamma, const ResolutionDual& dms )
+{
+	return resolutionModel->ExpSinDual( time, gamma, dms ) * timeAcc->getValue( time );
+}
@@ -0,0 +1,118 @@
+//	ROOT Headers
+#include "TRandom3.h"
+#include "TStopwatch.h"
+//	RapidFit Headers
+#include "ToyPipeline.h"
+#include "ProcessPool.h"
+#include "RapidFitRandom.h"
+//	System Headers
+#include <iostream>
+#include <vector>
+#include <stdint.h>
+
+using namespace::std;
+
+unsigned int ToyPipeline::toyWorkers = 1;
+int ToyPipeline::toyWorkerThreads = 0;
+
+void ToyPipeline::SetWorkers( const unsigned int numberWorkers, const int threadsPerWorker )
+{
+	toyWorkers = numberWorkers < 1 ? 1 : numberWorkers;
+	toyWorkerThreads = threadsPerWorker;
+}
+
+unsigned int ToyPipeline::StudySeed()
+{
+	return (unsigned) RapidFitRandom::GetRandomFunction()->Integer( 2147483647 );
+}
+
+unsigned int ToyPipeline::ToySeed( const unsigned int studySeed, const unsigned int toyNumber )
+{
+	//	SplitMix64 finaliser, neighbouring toys get unrelated seeds
+	uint64_t mixed = ( (uint64_t) studySeed << 32 ) | (uint64_t) toyNumber;
+	mixed += 0x9E3779B97F4A7C15ULL;
+	mixed = ( mixed ^ ( mixed >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+	mixed = ( mixed ^ ( mixed >> 27 ) ) * 0x94D049BB133111EBULL;
+	mixed = mixed ^ ( mixed >> 31 );
+
+	//	RapidFitRandom takes a positive int and 0 would seed from the clock
+	return 1 + (unsigned int)( mixed % 2147483646ULL );
+}
+
+vector<vector<FitResult*> > ToyPipeline::Run( ToyTask thisTask, void* input, FitFunctionConfiguration* function, const unsigned int studySeed,
+		const unsigned int firstToy, const unsigned int numberToys, vector<double>& realTimes, vector<double>& cpuTimes,
+		StudyJournal* journal, const unsigned int block )
+{
+	vector<vector<FitResult*> > allResults( numberToys );
+	realTimes = vector<double>( numberToys, 0. );
+	cpuTimes = vector<double>( numberToys, 0. );
+
+	ToyBatch thisBatch;
+	thisBatch.task = thisTask; thisBatch.input = input;
+	thisBatch.studySeed = studySeed; thisBatch.firstToy = firstToy;
+	thisBatch.journal = journal; thisBatch.block = block;
+	thisBatch.results = &allResults; thisBatch.realTimes = &realTimes; thisBatch.cpuTimes = &cpuTimes;
+
+	//	Take the toys finished by an earlier run from the journal
+	for( unsigned int i=0; i< numberToys; ++i )
+	{
+		if( journal != NULL && journal->IsFinished( block, firstToy+i ) ) allResults[i] = journal->GetResults( block, firstToy+i, realTimes[i], cpuTimes[i] );
+		else thisBatch.toysToRun.push_back( i );
+	}
+	const unsigned int numberToRun = (unsigned) thisBatch.toysToRun.size();
+	if( numberToRun < numberToys ) cout << "ToyPipeline: " << numberToys - numberToRun << " toys were read back from the journal" << endl;
+
+	if( toyWorkers > 1 && numberToRun > 1 )
+	{
+		//	Each worker gets its own thread budget, the parent isn't fitting while they run
+		const int originalThreads = function->GetThreads();
+		if( toyWorkerThreads > 0 ) function->SetThreads( toyWorkerThreads );
+
+		ProcessPool::Run( ToyPipeline::Toy_task, (void*) &thisBatch, numberToRun, ToyPipeline::Toy_result, (void*) &thisBatch, toyWorkers );
+
+		function->SetThreads( originalThreads );
+	}
+	else
+	{
+		for( unsigned int i=0; i< numberToRun; ++i )
+		{
+			TStopwatch clock;
+			clock.Start( true );
+			vector<FitResult*> theseResults = Toy_task( (void*) &thisBatch, i, NULL );
+			clock.Stop();
+			Toy_result( (void*) &thisBatch, i, theseResults, clock.RealTime(), clock.CpuTime() );
+		}
+	}
+
+	return allResults;
+}
+
+vector<FitResult*> ToyPipeline::Toy_task( void* input, const unsigned int index, const FitResult* seed )
+{
+	(void) seed;
+	ToyBatch* thisBatch = (ToyBatch*) input;
+	const unsigned int toyNumber = thisBatch->firstToy + thisBatch->toysToRun[index];
+
+	RapidFitRandom::SetRandomFunction( (int) ToySeed( thisBatch->studySeed, toyNumber ) );
+
+	return thisBatch->task( thisBatch->input, toyNumber );
+}
+
+void ToyPipeline::Toy_result( void* input, const unsigned int index, vector<FitResult*> theseResults, const double realTime, const double cpuTime )
+{
+	ToyBatch* thisBatch = (ToyBatch*) input;
+	const unsigned int toy = thisBatch->toysToRun[index];
+	const unsigned int toyNumber = thisBatch->firstToy + toy;
+
+	//	A toy whose worker died isn't journalled so it is run again on resuming
+	if( theseResults.empty() ) cerr << "ToyPipeline: No result for toy " << toyNumber + 1 << endl;
+	else if( thisBatch->journal != NULL )
+	{
+		thisBatch->journal->Record( thisBatch->block, toyNumber, ToySeed( thisBatch->studySeed, toyNumber ), theseResults, realTime, cpuTime );
+	}
+
+	(*thisBatch->results)[toy] = theseResults;
+	(*thisBatch->realTimes)[toy] = realTime;
+	(*thisBatch->cpuTimes)[toy] = cpuTime;
+}
+
@@ -15,15 +15,18 @@
 #include "I_XMLConfigReader.h"
 #include "StringProcessing.h"
 #include "ResultFormatter.h"
+#include "ToyPipeline.h"
+#include "StudyJournal.h"
 //	System Headers
 #include <iostream>
+#include <sstream>
 
 using namespace::std;
 
 //Constructor with correct arguments
 ToyStudy::ToyStudy( MinimiserConfiguration * TheMinimiser, FitFunctionConfiguration * TheFunction, ParameterSet* StudyParameters,
 		vector< PDFWithData* > PDFsAndData, vector< ConstraintFunction* > InputConstraints, int NumberStudies ) :
-		IStudy(), fixedNumToys(false), saveAllToys(false)
+		IStudy(), fixedNumToys(false), saveAllToys(false), studyOutputLevel(-999)
 {
 	pdfsAndData = PDFsAndData;
 	studyParameters = StudyParameters;
@@ -81,46 +84,75 @@ void ToyStudy::DoWholeStudy( int OutputLevel )
 		pdfsAndData[i]->SetUseCache( false );
 	}
 
-	TString filename="filename_";
+	studyOutputLevel = OutputLevel;
 
-	//Loop over all studies
-	for ( int studyIndex = 0; studyIndex < numberStudies; ++studyIndex )
+	//	Toys are run in batches, any which fail are replaced by extra toys in the next batch
+	const unsigned int studySeed = ToyPipeline::StudySeed();
+	stringstream studyDefinition;
+	studyDefinition << "ToyStudy " << numberStudies << " " << fixedNumToys;
+	StudyJournal thisJournal( "ToyStudy.journal", studySeed, studyDefinition.str() );
+	unsigned int studyIndex = 0;
+	while( (int)studyIndex < numberStudies )
 	{
-		cout << "\n\n\t\tStarting ToyStudy\t\t" << studyIndex+1 << "\tof:\t" << numberStudies << endl;
-		allResults->StartStopwatch();
+		const unsigned int numberToys = (unsigned)numberStudies - studyIndex;
+		vector<double> realTimes, cpuTimes;
+		vector<vector<FitResult*> > toyResults = ToyPipeline::Run( ToyStudy::GenerateAndMinimise, (void*) this, theFunction, studySeed,
+				studyIndex, numberToys, realTimes, cpuTimes, &thisJournal );
 
-		ParameterSet* thisSet = new ParameterSet( *studyParameters );
+		for( unsigned int i=0; i< numberToys; ++i, ++studyIndex )
+		{
+			if( toyResults[i].empty() )
+			{
+				cerr << "No result from ToyStudy " << studyIndex+1 << "!\t Requesting another fit." << endl;
+				if( !fixedNumToys ) ++numberStudies;
+				continue;
+			}
+
+			FitResult* new_result = toyResults[i][0];
+			if( new_result->GetFitStatus() != 3 )
+			{
+				cerr << "Fit fell over!\t Requesting another fit." << endl;
+				if( !fixedNumToys ) ++numberStudies;
+			}
+
+			if( allResults->AddFitResult( new_result, false ) )
+			{
+				allResults->AddRealTime( realTimes[i] );
+				allResults->AddCPUTime( cpuTimes[i] );
+			}
+		}
+	}
+}
 
-		FitResult* new_result = FitAssembler::DoSafeFit( theMinimiser, theFunction, thisSet, pdfsAndData, allConstraints, false, OutputLevel );
+vector<FitResult*> ToyStudy::GenerateAndMinimise( void* input, const unsigned int studyIndex )
+{
+	ToyStudy* thisStudy = (ToyStudy*) input;
 
-		delete thisSet;
+	cout << "\n\n\t\tStarting ToyStudy\t\t" << studyIndex+1 << "\tof:\t" << thisStudy->numberStudies << endl;
 
-		//cout << "\n\nFinished Study" << endl;
+	ParameterSet* thisSet = new ParameterSet( *(thisStudy->studyParameters) );
 
-		TString this_filename = filename;
-		this_filename.Append("_S");
-		this_filename+=studyIndex; 
+	FitResult* new_result = FitAssembler::DoSafeFit( thisStudy->theMinimiser, thisStudy->theFunction, thisSet, thisStudy->pdfsAndData,
+			thisStudy->allConstraints, false, thisStudy->studyOutputLevel );
 
-		//	Have to explicitly call this to request the data be deleted between runs, not normally an issue but causes problems with large (pb) datasets
-		for( unsigned int i=0; i< pdfsAndData.size(); ++i )
-		{
-			TString this_filename2=this_filename;
-			this_filename2.Append("_D");
-			this_filename2+=i;
-			this_filename2.Append(".root");
-			if( saveAllToys ) ResultFormatter::MakeRootDataFile( this_filename2.Data(), vector<IDataSet*>(1, pdfsAndData[i]->GetDataSet()) );
-			//cout << "Removing DataSet Number: " << i << endl;
-			pdfsAndData[i]->ClearCache();
-		}
+	delete thisSet;
 
-		if( new_result->GetFitStatus() != 3 )
-		{
-			cerr << "Fit fell over!\t Requesting another fit." << endl;
-			if( !fixedNumToys ) ++numberStudies;
-		}
+	TString this_filename="filename_";
+	this_filename.Append("_S");
+	this_filename+=studyIndex;
 
-		allResults->AddFitResult( new_result );
+	//	Have to explicitly call this to request the data be deleted between runs, not normally an issue but causes problems with large (pb) datasets
+	for( unsigned int i=0; i< thisStudy->pdfsAndData.size(); ++i )
+	{
+		TString this_filename2=this_filename;
+		this_filename2.Append("_D");
+		this_filename2+=i;
+		this_filename2.Append(".root");
+		if( thisStudy->saveAllToys ) ResultFormatter::MakeRootDataFile( this_filename2.Data(), vector<IDataSet*>(1, thisStudy->pdfsAndData[i]->GetDataSet()) );
+		thisStudy->pdfsAndData[i]->ClearCache();
 	}
+
+	return vector<FitResult*>( 1, new_result );
 }
 
 //Get the result of the toy study
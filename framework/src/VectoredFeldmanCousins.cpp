@@ -4,15 +4,18 @@
 #include "FitAssembler.h"
 #include "ParameterSet.h"
 #include "RapidFitRandom.h"
+#include "ToyPipeline.h"
+#include "StudyJournal.h"
 #include <string>
 #include <iomanip>
+#include <sstream>
 
 using namespace::std;
 
 VectoredFeldmanCousins::VectoredFeldmanCousins( FitResultVector* input_GlobalResult, FitResultVector* ResultsForFC, unsigned int inputNuisenceModel, OutputConfiguration* new_makeOutput, MinimiserConfiguration* newMinimiser, FitFunctionConfiguration* newFunction, I_XMLConfigReader* new_xmlFile, vector< PDFWithData* > new_pdfsAndData ) : 
 	GlobalFitResult(), GlobalFitPhysicsParameters(), FitAtGridPoints(), cout_bak(NULL), cerr_bak(NULL), clog_bak(NULL), allPhaseSpaces(),
 	input_pdfsAndData(), controlled_parameters(), nuisenceModel(0), stored_pdfs(), stored_dataconfigs(), sWeighted_study(), sweight_error(), generate_n_events(0),
-	ParameterSetWithFreeParameters(), ParameterSetWithFixedParameters()
+	ParameterSetWithFreeParameters(), ParameterSetWithFixedParameters(), currentGridPoint(NULL), studyOutputLevel(-1)
 {
 	cout_bak = cout.rdbuf();
 	cerr_bak = cerr.rdbuf();
@@ -226,6 +229,21 @@ void VectoredFeldmanCousins::DoWholeStudy( int OutputLevel )
 
 	vector<FitResultVector*> temp_complete_vec;
 
+	studyOutputLevel = OutputLevel;
+	const unsigned int studySeed = ToyPipeline::StudySeed();
+
+	//	Each grid point is one block of the journal
+	string journalName( "FCStudy" );
+	for( unsigned int i=0; i< controlled_parameters.size(); ++i ) journalName.append( "_" + controlled_parameters[i] );
+	stringstream studyDefinition;
+	studyDefinition << setprecision(17) << "FCStudy " << numberStudies << " " << nuisenceModel;
+	for( unsigned int result_i=0; result_i < (unsigned)FitAtGridPoints->NumberResults(); ++result_i )
+	{
+		ResultParameterSet* gridPoint = FitAtGridPoints->GetFitResult( (int)result_i )->GetResultParameterSet();
+		for( unsigned int i=0; i< controlled_parameters.size(); ++i ) studyDefinition << " " << gridPoint->GetResultParameter( controlled_parameters[i] )->GetValue();
+	}
+	StudyJournal thisJournal( journalName + ".journal", studySeed, studyDefinition.str() );
+
 	for( unsigned int result_i=0; result_i < (unsigned)FitAtGridPoints->NumberResults(); ++result_i )
 	{
 		cout << "Running at Point: " << result_i+1 << " of: " << FitAtGridPoints->NumberResults() << endl;
@@ -252,119 +270,46 @@ void VectoredFeldmanCousins::DoWholeStudy( int OutputLevel )
 
 		unsigned int this_study = (unsigned)numberStudies;
 
-		for( unsigned short int dataset_num=0; dataset_num < this_study; ++dataset_num )
+		//	Toys are run in batches, any which fail are replaced by extra toys in the next batch
+		currentGridPoint = InputResult;
+		const unsigned int gridPointSeed = ToyPipeline::ToySeed( studySeed, result_i );
+		unsigned int dataset_num = 0;
+		while( dataset_num < this_study )
 		{
-			cout << "Generating and Fitting to Toy DataSet: " << dataset_num+1 << " of: " << this_study << endl;
-
-			cout << endl << "Generating Toy Dataset at this Coordinate" << endl;
-			cout << "Original DataSet was ";
-			if( !sWeighted_study ) cout << "NOT ";
-			cout << "an sWeighted Study" << endl;
-
-			ParameterSet* FittingParameterSetWithFreeParameters =  this->getParameterSet( ParameterSetWithFreeParameters, InputResult->GetResultParameterSet() );
-			ParameterSet* FittingParameterSetWithFixedParameters = this->getParameterSet( ParameterSetWithFixedParameters, InputResult->GetResultParameterSet() );
-
-			//	Generate and cache a set of data
-			this->SetOutput( -1 );//OutputLevel );
-			cout << "Generating Data With:" << endl;
-			FittingParameterSetWithFreeParameters->Print(); cout << endl;
-			vector<IDataSet*> dataset_p = this->GetNewDataSets( FittingParameterSetWithFreeParameters );
-			this->ResetOutput();
-			cout << "Storing The DataSet at this Coordinate" << endl;
-			this->SetOutput( -1 );//OutputLevel );
-			for( unsigned int i=0; i< pdfsAndData.size(); ++i )
-			{
-				pdfsAndData[i]->AddCachedData( dataset_p[i] );
-				pdfsAndData[i]->SetUseCache( true );
-			}
-			this->ResetOutput();
+			const unsigned int numberToys = this_study - dataset_num;
+			vector<double> realTimes, cpuTimes;
+			vector<vector<FitResult*> > toyResults = ToyPipeline::Run( VectoredFeldmanCousins::GenerateAndFitToy, (void*) this, theFunction, gridPointSeed,
+					dataset_num, numberToys, realTimes, cpuTimes, &thisJournal, result_i );
 
-			cout << endl << "Control Parameter(s) are:" << endl;
-			for( vector<string>::iterator param_i = controlled_parameters.begin(); param_i != controlled_parameters.end(); ++param_i )
+			for( unsigned int i=0; i< numberToys; ++i, ++dataset_num )
 			{
-				cout << *param_i << ", " ;
-			}
-			cout << endl;
-
-			grid_pointResultVector.push_back( GlobalFitResult );
-			FitResultVector* temp_vec = new FitResultVector( GlobalFitResult->GetAllNames() );
-			temp_vec->StartStopwatch();
-			cout << endl << "Fitting to the Dataset with Control Parameter(s) Fixed" << endl;
-			this->SetOutput( -1 );//OutputLevel );
-			cout << "Fitting With:" << endl;
-			FittingParameterSetWithFixedParameters->Print(); cout << endl;
-			FitResult* fit1Result = FitAssembler::DoSafeFit( theMinimiser, theFunction, FittingParameterSetWithFixedParameters, pdfsAndData, allConstraints, true, OutputLevel );
-			for( vector<string>::iterator param_i = controlled_parameters.begin(); param_i != controlled_parameters.end(); ++param_i )
-			{
-				fit1Result->GetResultParameterSet()->GetResultParameter( *param_i )->ForceType( "Fixed" );
-			}
-
-			this->ResetOutput();
-			if( fit1Result->GetFitStatus() != 3 )
-			{
-				cout << "Fit FAILED!!!!" << endl;
-				cout << endl << "Requesting additional toy dataset and not re-fitting to this one!" << endl;
-				for( unsigned int i=0; i< pdfsAndData.size(); ++i )
+				vector<FitResult*>& theseResults = toyResults[i];
+				if( theseResults.size() != 2 || theseResults[0]->GetFitStatus() != 3 || theseResults[1]->GetFitStatus() != 3 )
 				{
-					pdfsAndData[i]->ClearCache();
+					cout << "Fit FAILED for toy DataSet: " << dataset_num+1 << endl;
+					cout << "Requesting additional toy dataset" << endl;
+					while( !theseResults.empty() ) { delete theseResults.back(); theseResults.pop_back(); }
+					++this_study;
+					continue;
 				}
-				delete fit1Result; delete temp_vec;
-				//Remove the global result from the vector containing all results
-				grid_pointResultVector.pop_back();
-				++this_study;
-				if( FittingParameterSetWithFreeParameters != NULL ) delete FittingParameterSetWithFreeParameters;
-				if( FittingParameterSetWithFixedParameters != NULL ) delete FittingParameterSetWithFixedParameters;
-				continue;
-			}
-			temp_vec->AddFitResult( fit1Result );
-			grid_pointResultVector.push_back( temp_vec );
-			cout << "Fit Finished" << endl;
-
-			grid_pointResultVector.push_back( GlobalFitResult );
-			FitResultVector* temp_vec2 = new FitResultVector( GlobalFitResult->GetAllNames() );
-			temp_vec2->StartStopwatch();
-			cout << endl << "Fitting to the Dataset with Control Parameter(s) Free" << endl;
-			this->SetOutput( -1 );//OutputLevel );
-			FitResult* fit2Result = FitAssembler::DoSafeFit( theMinimiser, theFunction, FittingParameterSetWithFreeParameters, pdfsAndData, allConstraints, true, OutputLevel );
-			for( vector<string>::iterator param_i = controlled_parameters.begin(); param_i != controlled_parameters.end(); ++param_i )
-			{
-				fit2Result->GetResultParameterSet()->GetResultParameter( *param_i )->ForceType( "Free" );
-			}
-
-			if( fit2Result->GetFitStatus() != 3 )
-			{
-				this->ResetOutput();
-				cout << "Fit FAILED!!!!!" << endl;
-				cout << endl << "Requesting additional toy dataset" << endl;
-				for( unsigned int i=0; i< pdfsAndData.size(); ++i )
-				{
-					pdfsAndData[i]->ClearCache();
-				}
-				delete fit1Result; delete temp_vec;
-				delete fit2Result; delete temp_vec2;
-				//Remove the global result(s) and the fixed point result from this vector of all of the results
-				grid_pointResultVector.pop_back();
-				grid_pointResultVector.pop_back();
-				grid_pointResultVector.pop_back();
-				++this_study;
-				if( FittingParameterSetWithFreeParameters != NULL ) delete FittingParameterSetWithFreeParameters;
-				if( FittingParameterSetWithFixedParameters != NULL ) delete FittingParameterSetWithFixedParameters;
-				continue;
-			}
-			temp_vec2->AddFitResult( fit2Result );
-			grid_pointResultVector.push_back( temp_vec2 );
-			this->ResetOutput();
-			cout << "Fit Finished" << endl;
 
-			cout << endl << "Removing cached DataSet" << endl << endl;
-			for( unsigned int i=0; i< pdfsAndData.size(); ++i )
-			{
-				pdfsAndData[i]->ClearCache();
+				//	The pipeline times whole toys, this is shared between the two fits
+				grid_pointResultVector.push_back( GlobalFitResult );
+				FitResultVector* temp_vec = new FitResultVector( GlobalFitResult->GetAllNames() );
+				temp_vec->AddFitResult( theseResults[0], false );
+				temp_vec->AddRealTime( realTimes[i]/2. );
+				temp_vec->AddCPUTime( cpuTimes[i]/2. );
+				grid_pointResultVector.push_back( temp_vec );
+
+				grid_pointResultVector.push_back( GlobalFitResult );
+				FitResultVector* temp_vec2 = new FitResultVector( GlobalFitResult->GetAllNames() );
+				temp_vec2->AddFitResult( theseResults[1], false );
+				temp_vec2->AddRealTime( realTimes[i]/2. );
+				temp_vec2->AddCPUTime( cpuTimes[i]/2. );
+				grid_pointResultVector.push_back( temp_vec2 );
 			}
-
-			if( FittingParameterSetWithFreeParameters != NULL ) delete FittingParameterSetWithFreeParameters;
-			if( FittingParameterSetWithFixedParameters != NULL ) delete FittingParameterSetWithFixedParameters;
 		}
+		currentGridPoint = NULL;
 
 		cout << "Storing the Result for All toys at this grid point" << endl;
 		FitResultVector* allGridPointResult = new FitResultVector( grid_pointResultVector );
@@ -374,6 +319,94 @@ void VectoredFeldmanCousins::DoWholeStudy( int OutputLevel )
 	allResults = new FitResultVector( temp_complete_vec );
 }
 
+vector<FitResult*> VectoredFeldmanCousins::GenerateAndFitToy( void* input, const unsigned int dataset_num )
+{
+	VectoredFeldmanCousins* thisStudy = (VectoredFeldmanCousins*) input;
+	FitResult* InputResult = thisStudy->currentGridPoint;
+	vector<PDFWithData*>& pdfsAndData = thisStudy->pdfsAndData;
+	vector<FitResult*> theseResults;
+
+	cout << "Generating and Fitting to Toy DataSet: " << dataset_num+1 << endl;
+
+	cout << endl << "Generating Toy Dataset at this Coordinate" << endl;
+	cout << "Original DataSet was ";
+	if( !thisStudy->sWeighted_study ) cout << "NOT ";
+	cout << "an sWeighted Study" << endl;
+
+	ParameterSet* FittingParameterSetWithFreeParameters =  thisStudy->getParameterSet( thisStudy->ParameterSetWithFreeParameters, InputResult->GetResultParameterSet() );
+	ParameterSet* FittingParameterSetWithFixedParameters = thisStudy->getParameterSet( thisStudy->ParameterSetWithFixedParameters, InputResult->GetResultParameterSet() );
+
+	//	Generate and cache a set of data
+	thisStudy->SetOutput( -1 );//OutputLevel );
+	cout << "Generating Data With:" << endl;
+	FittingParameterSetWithFreeParameters->Print(); cout << endl;
+	vector<IDataSet*> dataset_p = thisStudy->GetNewDataSets( FittingParameterSetWithFreeParameters );
+	thisStudy->ResetOutput();
+	cout << "Storing The DataSet at this Coordinate" << endl;
+	thisStudy->SetOutput( -1 );//OutputLevel );
+	for( unsigned int i=0; i< pdfsAndData.size(); ++i )
+	{
+		pdfsAndData[i]->AddCachedData( dataset_p[i] );
+		pdfsAndData[i]->SetUseCache( true );
+	}
+	thisStudy->ResetOutput();
+
+	cout << endl << "Control Parameter(s) are:" << endl;
+	for( vector<string>::iterator param_i = thisStudy->controlled_parameters.begin(); param_i != thisStudy->controlled_parameters.end(); ++param_i )
+	{
+		cout << *param_i << ", " ;
+	}
+	cout << endl;
+
+	cout << endl << "Fitting to the Dataset with Control Parameter(s) Fixed" << endl;
+	thisStudy->SetOutput( -1 );//OutputLevel );
+	cout << "Fitting With:" << endl;
+	FittingParameterSetWithFixedParameters->Print(); cout << endl;
+	FitResult* fit1Result = FitAssembler::DoSafeFit( thisStudy->theMinimiser, thisStudy->theFunction, FittingParameterSetWithFixedParameters, pdfsAndData,
+			thisStudy->allConstraints, true, thisStudy->studyOutputLevel );
+	for( vector<string>::iterator param_i = thisStudy->controlled_parameters.begin(); param_i != thisStudy->controlled_parameters.end(); ++param_i )
+	{
+		fit1Result->GetResultParameterSet()->GetResultParameter( *param_i )->ForceType( "Fixed" );
+	}
+	theseResults.push_back( fit1Result );
+	thisStudy->ResetOutput();
+
+	if( fit1Result->GetFitStatus() != 3 )
+	{
+		cout << "Fit FAILED!!!!" << endl;
+		cout << endl << "Not re-fitting to this toy dataset!" << endl;
+	}
+	else
+	{
+		cout << "Fit Finished" << endl;
+
+		cout << endl << "Fitting to the Dataset with Control Parameter(s) Free" << endl;
+		thisStudy->SetOutput( -1 );//OutputLevel );
+		FitResult* fit2Result = FitAssembler::DoSafeFit( thisStudy->theMinimiser, thisStudy->theFunction, FittingParameterSetWithFreeParameters, pdfsAndData,
+				thisStudy->allConstraints, true, thisStudy->studyOutputLevel );
+		for( vector<string>::iterator param_i = thisStudy->controlled_parameters.begin(); param_i != thisStudy->controlled_parameters.end(); ++param_i )
+		{
+			fit2Result->GetResultParameterSet()->GetResultParameter( *param_i )->ForceType( "Free" );
+		}
+		theseResults.push_back( fit2Result );
+		thisStudy->ResetOutput();
+
+		if( fit2Result->GetFitStatus() != 3 ) cout << "Fit FAILED!!!!!" << endl;
+		else cout << "Fit Finished" << endl;
+	}
+
+	cout << endl << "Removing cached DataSet" << endl << endl;
+	for( unsigned int i=0; i< pdfsAndData.size(); ++i )
+	{
+		pdfsAndData[i]->ClearCache();
+	}
+
+	if( FittingParameterSetWithFreeParameters != NULL ) delete FittingParameterSetWithFreeParameters;
+	if( FittingParameterSetWithFixedParameters != NULL ) delete FittingParameterSetWithFixedParameters;
+
+	return theseResults;
+}
+
 void VectoredFeldmanCousins::SetOutput( int OutputLevel )
 {
 	//	If the user wanted silence we point the Std Output Streams to /dev/null
@@ -398,6 +398,10 @@ FitFunctionConfiguration * XMLObjectGenerator::MakeFitFunction( XMLTag * Functio
 				{
 					thisConfig->FixedIntegrationPoints = (unsigned)XMLTag::GetIntegerValue( functionInfo[childIndex] );
 				}
+				else if ( functionInfo[childIndex]->GetName() == "IntegrationPrecision" )
+				{
+					thisConfig->IntegrationPrecision = XMLTag::GetDoubleValue( functionInfo[childIndex] );
+				}
 				else if ( functionInfo[childIndex]->GetName() == "WeightName" )
 				{
 					hasWeight = true;
@@ -530,6 +534,8 @@ IPDF * XMLObjectGenerator::GetNamedPDF( XMLTag * InputTag, PhaseSpaceBoundary* I
 	unsigned int configParamNum=0;
 	unsigned int subParamNum=0;
 
+	IPDF* proxyPDF=NULL;
+
 	//Load the PDF configuration
 	for ( unsigned int configIndex = 0; configIndex < pdfConfig.size(); ++configIndex )
 	{
@@ -594,6 +600,17 @@ IPDF * XMLObjectGenerator::GetNamedPDF( XMLTag * InputTag, PhaseSpaceBoundary* I
 			configurator->AddDaughterPDF( thisPDF );
 			delete thisPDF;
 		}
+		else if( pdfConfig[configIndex]->GetName() == "NormalisationProxy" )
+		{
+			vector<XMLTag*> proxyConfig = pdfConfig[configIndex]->GetChildren();
+			if( proxyConfig.size() != 1 )
+			{
+				cerr << "NormalisationProxy should contain exactly one PDF" << endl;
+				exit(-5624);
+			}
+			if( proxyPDF != NULL ) delete proxyPDF;
+			proxyPDF = XMLObjectGenerator::GetPDF( proxyConfig[0], InputBoundary, overloadConfigurator, thisParameterSet, false );
+		}
 		else
 		{
 			cerr << "(1)Unrecognised PDF configuration: " << pdfConfig[configIndex]->GetName() << endl;
@@ -654,6 +671,13 @@ IPDF * XMLObjectGenerator::GetNamedPDF( XMLTag * InputTag, PhaseSpaceBoundary* I
 	//Check if the name is recognised as a PDF
 	returnable_NamedPDF = ClassLookUp::LookUpPDFName( name, configurator );
 
+	//	The integrator keeps its own copy
+	if( proxyPDF != NULL )
+	{
+		returnable_NamedPDF->GetPDFIntegrator()->SetNormalisationProxy( proxyPDF );
+		delete proxyPDF;
+	}
+
 	return returnable_NamedPDF;
 }
 
@@ -764,7 +788,7 @@ DataSetConfiguration * XMLObjectGenerator::MakeDataSetConfiguration( XMLTag * Da
 			{
 				cutString = XMLTag::GetStringValue( dataComponents[dataIndex] );
 			}
-			else if ( name == "FileName" || name == "NTuplePath" )
+			else if ( name == "FileName" || name == "NTuplePath" || name == "EventCache" || name == "StreamChunkSize" )
 			{
 				argumentNames.push_back(name);
 				dataArguments.push_back( XMLTag::GetStringValue( dataComponents[dataIndex] ) );
@@ -1356,6 +1380,10 @@ CompPlotter_config* XMLObjectGenerator::getCompPlotterConfigs( XMLTag* CompTag )
 		{
 			projectionIntegratorConfig->FixedIntegrationPoints = (unsigned)XMLTag::GetIntegerValue( projComps[childIndex] );
 		}
+		else if( projComps[childIndex]->GetName() == "IntegrationPrecision" )
+		{
+			projectionIntegratorConfig->IntegrationPrecision = XMLTag::GetDoubleValue( projComps[childIndex] );
+		}
 		else if( projComps[childIndex]->GetName() == "UseGSLNumericalIntegration" )
 		{
 			projectionIntegratorConfig->useGSLIntegrator =  XMLTag::GetBooleanValue( projComps[childIndex] );
@@ -1568,7 +1596,7 @@ PDFWithData * XMLObjectGenerator::GetPDFWithData( XMLTag * DataTag, XMLTag * Fit
 			{
 				cutString = XMLTag::GetStringValue( dataComponents[dataIndex] );
 			}
-			else if ( name == "FileName" || name == "NTuplePath" )
+			else if ( name == "FileName" || name == "NTuplePath" || name == "EventCache" || name == "StreamChunkSize" )
 			{
 				argumentNames.push_back(name);
 				dataArguments.push_back( XMLTag::GetStringValue( dataComponents[dataIndex] ) );
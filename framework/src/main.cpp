@@ -17,6 +17,8 @@
 #include "Mathematics.h"
 #include "FitAssembler.h"
 #include "ToyStudy.h"
+#include "ToyPipeline.h"
+#include "StudyJournal.h"
 #include "I_XMLConfigReader.h"
 #include "XMLConfigReader.h"
 #include "MultiXMLConfigReader.h"
@@ -50,6 +52,7 @@
 #include "MultiDimChi2.h"
 #include "RapidFitRandom.h"
 #include "FitFractionCalculator.h"
+#include "Bs2JpsiPhi_Angluar_Terms.h"
 ///  System Headers
 #include <string>
 #include <vector>
@@ -150,6 +153,11 @@ int RapidFit( vector<string> input )
 		exit(0);
 	}
 
+	if( thisConfig->testBatchFunctionsFlag )
+	{
+		exit( testBatchFunctions() );
+	}
+
 	if( DebugClass::DebugThisClass( "main" ) )
 	{
 		cout << endl;
@@ -158,6 +166,12 @@ int RapidFit( vector<string> input )
 
 	ConfigureRapidFit( thisConfig );
 
+	ScanStudies::SetWorkers( thisConfig->numberWorkers, thisConfig->threadsPerWorker );
+	ToyPipeline::SetWorkers( thisConfig->numberWorkers, thisConfig->threadsPerWorker );
+	ScanStudies::SetWarmStart( thisConfig->WarmStartScansFlag, thisConfig->WarmStartScanErrorsFlag );
+	StudyJournal::SetResume( thisConfig->resumeFlag );
+	if( thisConfig->xmlFile != NULL ) StudyJournal::SetStudyConfiguration( thisConfig->xmlFile->GetXML(), thisConfig->CommandLineParamvector );
+
 	if( DebugClass::DebugThisClass( "main" ) )
 	{
 		cout << endl;
@@ -1347,6 +1361,15 @@ int testIntegrator( RapidFitConfiguration* config )
 	return 0;
 }
 
+int testBatchFunctions()
+{
+	int failures=0;
+	if( !Mathematics::TestCerfBatch() ) ++failures;
+	if( !Bs2JpsiPhi_Angular_Terms::TestAngleFactorsBatch() ) ++failures;
+	cout << endl << failures << " of the batch function checks failed" << endl;
+	return failures;
+}
+
 int saveOneDataSet( RapidFitConfiguration* config )
 {
 	//Make a file containing toy data from the PDF
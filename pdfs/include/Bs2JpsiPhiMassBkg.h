@@ -21,6 +21,10 @@ class Bs2JpsiPhiMassBkg : public BasePDF
 		//Calculate the PDF value
 		virtual double Evaluate(DataPoint*);
 
+		//Analytic derivative of the normalised log-likelihood
+		virtual bool GetAnalyticGradient() const;
+		virtual void EvaluateGradient( DataPoint*, PhaseSpaceBoundary*, const vector<string>&, double* );
+
 	protected:
 		//Calculate the PDF normalisation
 		virtual double Normalisation(PhaseSpaceBoundary*);
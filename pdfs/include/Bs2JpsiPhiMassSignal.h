@@ -24,6 +24,10 @@ class Bs2JpsiPhiMassSignal : public BasePDF
 		vector<string> PDFComponents();
 		double EvaluateComponent( DataPoint*, ComponentRef* );
 
+		//Analytic derivative of the normalised log-likelihood
+		bool GetAnalyticGradient() const;
+		void EvaluateGradient( DataPoint*, PhaseSpaceBoundary*, const vector<string>&, double* );
+
 	protected:
 		//Calculate the PDF normalisation
 		virtual double Normalisation(PhaseSpaceBoundary*);
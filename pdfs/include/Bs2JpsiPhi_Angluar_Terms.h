@@ -85,6 +85,61 @@ class Bs2JpsiPhi_Angular_Terms
 		//...........................
 		static double HangleFactorReASA0( vector<double> input );
 
+
+
+		//------------------------------------------------------
+		// Batched versions of the above, filling all of the angle factors for many events in one pass
+
+		/*!
+		 * Position of each angle factor in the output of the batch functions
+		 */
+		enum AngleFactorIndex
+		{
+			Factor_A0A0=0,
+			Factor_APAP,
+			Factor_ATAT,
+			Factor_ImAPAT,
+			Factor_ReA0AP,
+			Factor_ImA0AT,
+			Factor_ASAS,
+			Factor_ReASAP,
+			Factor_ImASAT,
+			Factor_ReASA0,
+			NumberAngleFactors
+		};
+
+		/*!
+		 * @brief Calculate all of the angle factors in the transversity basis for numberEvents events
+		 *
+		 * The sin/cos of each angle are calculated once per event and shared between all of the factors.
+		 * When built with AVX2 enabled (RAPIDFIT_USE_AVX2 in CMake, "make avx2", or -march=native) 4 events are processed at a time, otherwise this falls back to scalar code.
+		 * No memory is allocated.
+		 *
+		 * @param cosTheta     Array of numberEvents values of cosTheta
+		 * @param cosPsi       Array of numberEvents values of cosPsi
+		 * @param phi          Array of numberEvents values of phi
+		 * @param numberEvents Number of events to process
+		 * @param output       Array of NumberAngleFactors pointers, each to an array of at least numberEvents doubles, in the order of AngleFactorIndex
+		 */
+		static void TangleFactorsBatch( const double* cosTheta, const double* cosPsi, const double* phi, const unsigned int numberEvents, double* const* output );
+
+		/*!
+		 * @brief Calculate all of the angle factors in the helicity basis for numberEvents events
+		 *
+		 * As TangleFactorsBatch, with the input cosThetaK, cosThetaL and phi
+		 */
+		static void HangleFactorsBatch( const double* cosThetaK, const double* cosThetaL, const double* phi, const unsigned int numberEvents, double* const* output );
+
+		/*!
+		 * @brief Check TangleFactorsBatch and HangleFactorsBatch against the functions for one factor of one event above, run with fitting --testBatchFunctions
+		 *
+		 * The block of events isn't a multiple of 4 long, so an AVX2 build checks both the 4 event and the 1 event code.
+		 * The largest differences found are printed.
+		 *
+		 * @return true if every factor agrees to 1E-12
+		 */
+		static bool TestAngleFactorsBatch();
+
 };
 
 #endif
@@ -42,6 +42,7 @@ class Bs2JpsiPhi_Signal_v8 : public BasePDF
 		virtual double EvaluateForNumericIntegral(DataPoint*);
 		virtual double Evaluate(DataPoint*);
 		virtual double EvaluateTimeOnly(DataPoint*);
+		virtual void EvaluateBatch( const EventBlock&, double* );
 		virtual bool SetPhysicsParameters(ParameterSet*);
 		virtual vector<string> GetDoNotIntegrateList();
 
@@ -70,6 +71,25 @@ class Bs2JpsiPhi_Signal_v8 : public BasePDF
 		//void prepareTimeFac();
 		void SetupAngularTerms();
 
+		/*!
+		 * @brief Calculate the angle factors (A0A0_value etc.) for this event
+		 */
+		void CalculateAngleFactors( DataPoint* );
+
+		/*!
+		 * @brief The body of Evaluate, called once the angle factors for this event have been calculated
+		 */
+		double EvaluateWithAngleFactors( DataPoint* );
+
+		/*!
+		 * @brief Look up the slots of the Observables used per event if this DataPoint has a different layout to the last one
+		 */
+		inline void CheckSlots( DataPoint* measurement )
+		{
+			if( measurement->GetLayoutID() != slotLayoutID ) this->ResolveSlots( measurement );
+		}
+		void ResolveSlots( DataPoint* );
+
 		unsigned int timeBinNum;
 
 		DataPoint* _datapoint;
@@ -127,6 +147,10 @@ class Bs2JpsiPhi_Signal_v8 : public BasePDF
 		ObservableRef cthetalName;
 		ObservableRef phihName;
 
+		size_t slotLayoutID;			// DataPoint layout the slots below were found for
+		int timeSlot;				// slot of the proper time
+		int angleSlot[3];			// slots of the 3 angles in the basis being used, in the order expected by Bs2JpsiPhi_Angular_Terms
+
 		ObservableRef BetaName;
 		bool _useBetaParameter;
 		bool _useMultiplePhis;
@@ -160,6 +184,13 @@ class Bs2JpsiPhi_Signal_v8 : public BasePDF
 		double ImASAT_value;
 		double ReASA0_value;
 
+		vector<double> angleFactorBuffer;	// angle factors for a whole EventBlock, one block of events per factor
+		vector<double> timeFactorBuffer;	// Exp for gamma_l and gamma_h, ExpCos and ExpSin for a whole EventBlock, one block of events each
+
+		// time primitives of the current event of EvaluateBatch, used once by preCalculateTimeFactors
+		bool useBatchTimeFactors;
+		double batchExpL, batchExpH, batchExpCos, batchExpSin;
+
 		// Measured Event Observables
 		double t;
 		int tag;
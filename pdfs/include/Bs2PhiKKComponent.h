@@ -30,6 +30,11 @@ class Bs2PhiKKComponent
 		typedef std::array<std::complex<double>,2> amplitude_t;
 		amplitude_t Amplitude(const datapoint_t&) const; // {KK_M, Phi_angle, cos_theta1, cos_theta2}
 		amplitude_t Amplitude(const datapoint_t&, const std::string) const; // Same but with an option "even" or "odd"
+		// Amplitude(datapoint) = sum_i Couplings()[i] * AmplitudeTerms(datapoint)[i], for both the B and Bbar decays
+		unsigned int NumberOfTerms() const; // One per helicity, or one if non-resonant
+		void AmplitudeTerms(const datapoint_t&, std::complex<double>*, std::complex<double>*) const; // datapoint, B terms, Bbar terms
+		void Couplings(std::complex<double>*) const;
+		std::vector<ObservableRef> GetCouplingParameters() const; // The parameters which only enter through Couplings()
 		static double mBs;
 		static double mK;
 		static double mpi;
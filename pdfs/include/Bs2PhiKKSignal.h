@@ -25,6 +25,11 @@ class Bs2PhiKKSignal : public BasePDF
 		// Extra stuff
 		double EvaluateComponent(DataPoint*, ComponentRef* );
 		std::vector<std::string> PDFComponents();
+		// Amplitude terms for the numerical normalisation
+		unsigned int GetNumberAmplitudeTerms() const;
+		void EvaluateAmplitudeTerms(DataPoint*, std::complex<double>*, double&);
+		std::vector<std::string> GetAmplitudeCouplingNames() const;
+		double ContractAmplitudeIntegrals(const std::vector<std::complex<double>>&);
 	private:
 		typedef double (Bs2PhiKKSignal::*MsqFunc_t)(const Bs2PhiKKComponent::datapoint_t&, const std::string&) const;
 		std::map<std::string,Bs2PhiKKComponent> components; // Iterable list of amplitude components
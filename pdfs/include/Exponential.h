@@ -23,6 +23,10 @@ class Exponential : public BasePDF
 		//Calculate the PDF value
 		double Evaluate(DataPoint*);
 
+		//Analytic derivative of the normalised log-likelihood, only available while the resolution parameters are fixed
+		bool GetAnalyticGradient() const;
+		void EvaluateGradient( DataPoint*, PhaseSpaceBoundary*, const vector<string>&, double* );
+
 	protected:
 		//Calculate the PDF normalisation
 		double Normalisation(DataPoint*, PhaseSpaceBoundary*);
@@ -36,6 +40,7 @@ class Exponential : public BasePDF
 		ObservableRef tauName;		// decay constant 1
 		ObservableRef timeName;		// proper time
 		ObservableRef timeConst;
+		vector<ObservableRef> resolutionParameterNames;	// parameters added by the resolution model
 
 		double tau;
 		double gamma;
@@ -269,7 +269,12 @@ Bd2JpsiKstar_sWave::~Bd2JpsiKstar_sWave()
 bool Bd2JpsiKstar_sWave::SetPhysicsParameters( ParameterSet * NewParameterSet )
 {
 	normalisationCacheValid = false;
-	evaluationCacheValid = false;
+	//	The cached amplitudes and strong phases only need recalculating when one of them has moved
+	if( ParameterChanged( Apara_sqName ) || ParameterChanged( Aperp_sqName ) || ParameterChanged( As_sqName )
+		|| ParameterChanged( delta_paraName ) || ParameterChanged( delta_perpName ) || ParameterChanged( delta_sName ) )
+	{
+		evaluationCacheValid = false;
+	}
 	bool isOK = allParameters.SetPhysicsParameters(NewParameterSet);
 	// Physics parameters (the stuff you want to extract from the physics model by plugging in the experimental measurements)
 	gamma      = allParameters.GetPhysicsParameter( gammaName )->GetValue();
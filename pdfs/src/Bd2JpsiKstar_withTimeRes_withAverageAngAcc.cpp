@@ -106,7 +106,12 @@ Bd2JpsiKstar_withTimeRes_withAverageAngAcc::~Bd2JpsiKstar_withTimeRes_withAverag
 bool Bd2JpsiKstar_withTimeRes_withAverageAngAcc::SetPhysicsParameters( ParameterSet * NewParameterSet )
 {
 	normalisationCacheValid = false;
-	evaluationCacheValid = false;
+	//	The cached amplitudes and strong phases only need recalculating when one of them has moved
+	if( ParameterChanged( Apara_sqName ) || ParameterChanged( Aperp_sqName )
+		|| ParameterChanged( delta_paraName ) || ParameterChanged( delta_perpName ) )
+	{
+		evaluationCacheValid = false;
+	}
 	bool isOK = allParameters.SetPhysicsParameters(NewParameterSet);
 	// Physics parameters (the stuff you want to extract from the physics model by plugging in the experimental measurements)
 	gamma      = allParameters.GetPhysicsParameter( gammaName )->GetValue();
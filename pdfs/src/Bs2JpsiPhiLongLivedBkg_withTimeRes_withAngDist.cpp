@@ -64,6 +64,11 @@ void Bs2JpsiPhiLongLivedBkg_withTimeRes_withAngDist::MakePrototypes()
 	parameterNames.push_back( f_NoJpsiName );
 
 	allParameters = ParameterSet(parameterNames);
+
+	//	f_NoJpsi only mixes angular distributions which are each normalised analytically, so it never moves the time integral
+	vector<string> cacheNames( parameterNames );
+	cacheNames.pop_back();
+	this->SetCacheDependencies( cacheNames );
 }
 
 //Destructor
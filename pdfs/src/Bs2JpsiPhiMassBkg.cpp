@@ -75,6 +75,43 @@ double Bs2JpsiPhiMassBkg::Evaluate(DataPoint * measurement)
   	return val;
 }
 
+bool Bs2JpsiPhiMassBkg::GetAnalyticGradient() const
+{
+	return !this->GetNumericalNormalisation();
+}
+
+//	d/dalpha of ln( exp(-alpha*m) * alpha / ( exp(-alpha*mlow) - exp(-alpha*mhigh) ) ), the scale factor cancels
+void Bs2JpsiPhiMassBkg::EvaluateGradient( DataPoint * measurement, PhaseSpaceBoundary * boundary, const vector<string>& Names, double* gradient )
+{
+	for( unsigned int i=0; i< Names.size(); ++i ) gradient[i] = 0.;
+
+	const int alphaSlot = this->GetGradientSlot( Names, alphaM_prName );
+	if( alphaSlot < 0 ) return;
+
+	double mass = measurement->GetObservable( recoMassName )->GetValue();
+
+	IConstraint * massBound = boundary->GetConstraint( constraint_recoMassName );
+	if ( massBound->GetUnit() == "NameNotFoundError" )
+	{
+		//	The normalisation is constant in this case
+		gradient[alphaSlot] = -mass;
+		return;
+	}
+	double mlow = massBound->GetMinimum();
+	double mhigh = massBound->GetMaximum();
+
+	if( fabs( alphaM_pr - 0. ) < DOUBLE_TOLERANCE )
+	{
+		//	Limit of the expression below as alpha -> 0
+		gradient[alphaSlot] = 0.5*( mlow + mhigh ) - mass;
+	}
+	else
+	{
+		//	Written relative to mlow to avoid overflow for large masses
+		double expHigh = exp( -alphaM_pr*( mhigh - mlow ) );
+		gradient[alphaSlot] = -mass + ( mlow - mhigh*expHigh ) / ( 1. - expHigh ) + inv_alphaM_pr;
+	}
+}
 
 double Bs2JpsiPhiMassBkg::Normalisation(PhaseSpaceBoundary * boundary)
 {
@@ -143,6 +143,52 @@ double Bs2JpsiPhiMassSignal::Evaluate(DataPoint * measurement)
 	return returnValue;
 }
 
+bool Bs2JpsiPhiMassSignal::GetAnalyticGradient() const
+{
+	return !this->GetNumericalNormalisation();
+}
+
+//	The normalisation is fixed to 1, so this is simply the derivative of ln( Evaluate )
+void Bs2JpsiPhiMassSignal::EvaluateGradient( DataPoint * measurement, PhaseSpaceBoundary * boundary, const vector<string>& Names, double* gradient )
+{
+	(void)boundary;
+	for( unsigned int i=0; i< Names.size(); ++i ) gradient[i] = 0.;
+
+	// Get the physics parameters
+	double f_sig_m1  = allParameters.GetPhysicsParameter( f_sig_m1Name )->GetValue();
+	double sigma_m1 = allParameters.GetPhysicsParameter( sigma_m1Name )->GetValue();
+	double sigma_m2 = allParameters.GetPhysicsParameter( sigma_m2Name )->GetValue();
+	double m_Bs = allParameters.GetPhysicsParameter( m_BsName )->GetValue();
+
+	// Get the observable
+	double mass = measurement->GetObservable( recoMassName )->GetValue();
+
+	double deltaM = mass - m_Bs;
+	double deltaMsq = deltaM*deltaM;
+	double gauss1 = exp( -deltaMsq / ( 2. * sigma_m1 * sigma_m1 ) ) / (sigma_m1*sqrt(2.*TMath::Pi()));
+	double gauss2 = exp( -deltaMsq / ( 2. * sigma_m2 * sigma_m2 ) ) / (sigma_m2*sqrt(2.*TMath::Pi()));
+
+	//	Same switch as in Evaluate
+	double weight1 = f_sig_m1, weight2 = 1. - f_sig_m1;
+	if( f_sig_m1 > 0.9999 ) { weight1 = 1.; weight2 = 0.; }
+
+	double term1 = weight1 * gauss1;
+	double term2 = weight2 * gauss2;
+	double total = term1 + term2;
+
+	//	d gauss / d sigma = gauss * ( deltaM^2/sigma^3 - 1/sigma ),  d gauss / d m_Bs = gauss * deltaM / sigma^2
+	int slot = this->GetGradientSlot( Names, f_sig_m1Name );
+	if( slot >= 0 && f_sig_m1 <= 0.9999 ) gradient[slot] = ( gauss1 - gauss2 ) / total;
+
+	slot = this->GetGradientSlot( Names, sigma_m1Name );
+	if( slot >= 0 ) gradient[slot] = term1 * ( deltaMsq / ( sigma_m1*sigma_m1*sigma_m1 ) - 1./sigma_m1 ) / total;
+
+	slot = this->GetGradientSlot( Names, sigma_m2Name );
+	if( slot >= 0 ) gradient[slot] = term2 * ( deltaMsq / ( sigma_m2*sigma_m2*sigma_m2 ) - 1./sigma_m2 ) / total;
+
+	slot = this->GetGradientSlot( Names, m_BsName );
+	if( slot >= 0 ) gradient[slot] = ( term1 / ( sigma_m1*sigma_m1 ) + term2 / ( sigma_m2*sigma_m2 ) ) * deltaM / total;
+}
 
 // Normalisation
 double Bs2JpsiPhiMassSignal::Normalisation(PhaseSpaceBoundary * boundary)
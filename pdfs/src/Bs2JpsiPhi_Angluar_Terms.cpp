@@ -7,6 +7,10 @@
 #include <cmath>
 #include <cstdlib>
 #include <iostream>
+#include <algorithm>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
 using namespace::std;
 
@@ -331,3 +335,284 @@ double Bs2JpsiPhi_Angular_Terms::HangleFactorReASA0( vector<double> input )
 	return 8.0*Mathematics::Third() *Mathematics::Root_3() * sinsqthetaL * costhetaK * Mathematics::Global_Frac() * 0.5;
 }
 
+
+//------------------------------------------------------
+// Batched angle factors
+
+//	Events processed per chunk, the sin/cos of phi for a chunk are held on the stack
+static const unsigned int angleFactorChunk = 64;
+
+//	All of the transversity factors for one event given the shared trig
+static inline void TangleFactorsOne( const double cosTheta, const double cosPsi, const double sinPhi, const double cosPhi, double* const* output, const unsigned int i )
+{
+	const double gf = Mathematics::Global_Frac();
+
+	const double sinSqTheta = 1. - cosTheta*cosTheta;
+	const double sin2Theta = 2. * cosTheta * sqrt( sinSqTheta );
+	const double sinSqPsi = 1. - cosPsi*cosPsi;
+	const double sinPsi = sqrt( sinSqPsi );
+	const double sin2Psi = 2. * cosPsi * sinPsi;
+	const double sin2Phi = 2. * sinPhi * cosPhi;
+
+	const double evenTerm = 1. - sinSqTheta * cosPhi*cosPhi;
+
+	output[Bs2JpsiPhi_Angular_Terms::Factor_A0A0][i] = 2. * cosPsi*cosPsi * evenTerm * gf;
+	output[Bs2JpsiPhi_Angular_Terms::Factor_APAP][i] = sinSqPsi * ( 1. - sinSqTheta * sinPhi*sinPhi ) * gf;
+	output[Bs2JpsiPhi_Angular_Terms::Factor_ATAT][i] = sinSqPsi * sinSqTheta * gf;
+	output[Bs2JpsiPhi_Angular_Terms::Factor_ImAPAT][i] = -1. * sinSqPsi * sin2Theta * sinPhi * gf;
+	output[Bs2JpsiPhi_Angular_Terms::Factor_ReA0AP][i] = Mathematics::_Over_SQRT_2() * sin2Psi * sinSqTheta * sin2Phi * gf;
+	output[Bs2JpsiPhi_Angular_Terms::Factor_ImA0AT][i] = Mathematics::_Over_SQRT_2() * sin2Psi * sin2Theta * cosPhi * gf;
+	output[Bs2JpsiPhi_Angular_Terms::Factor_ASAS][i] = 2.0*Mathematics::Third() * evenTerm * gf;
+	output[Bs2JpsiPhi_Angular_Terms::Factor_ReASAP][i] = Mathematics::Root_6()*Mathematics::Third() * sinPsi * sinSqTheta * sin2Phi * gf;
+	output[Bs2JpsiPhi_Angular_Terms::Factor_ImASAT][i] = Mathematics::Root_6()*Mathematics::Third() * sinPsi * sin2Theta * cosPhi * gf;
+	output[Bs2JpsiPhi_Angular_Terms::Factor_ReASA0][i] = 4.0*Mathematics::Root_3()*Mathematics::Third() * cosPsi * evenTerm * gf;
+}
+
+//	All of the helicity factors for one event given the shared trig
+static inline void HangleFactorsOne( const double cosThetaK, const double cosThetaL, const double sinPhi, const double cosPhi, double* const* output, const unsigned int i )
+{
+	const double gf = Mathematics::Global_Frac() * 0.5;
+
+	const double sinSqThetaK = 1. - cosThetaK*cosThetaK;
+	const double sinThetaK = sqrt( sinSqThetaK );
+	const double sin2ThetaK = 2. * cosThetaK * sinThetaK;
+	const double cosSqThetaL = cosThetaL*cosThetaL;
+	const double sinSqThetaL = 1. - cosSqThetaL;
+	const double sin2ThetaL = 2. * cosThetaL * sqrt( sinSqThetaL );
+	const double sin2Phi = 2. * sinPhi * cosPhi;
+	const double cos2Phi = cosPhi*cosPhi - sinPhi*sinPhi;
+
+	const double transverseEven = sinSqThetaK * ( 1. + cosSqThetaL );
+	const double transverseOdd = sinSqThetaL * sinSqThetaK * cos2Phi;
+
+	output[Bs2JpsiPhi_Angular_Terms::Factor_A0A0][i] = 4. * cosThetaK*cosThetaK * sinSqThetaL * gf;
+	output[Bs2JpsiPhi_Angular_Terms::Factor_APAP][i] = ( transverseEven - transverseOdd ) * gf;
+	output[Bs2JpsiPhi_Angular_Terms::Factor_ATAT][i] = ( transverseEven + transverseOdd ) * gf;
+	output[Bs2JpsiPhi_Angular_Terms::Factor_ImAPAT][i] = 2. * sinSqThetaK * sinSqThetaL * sin2Phi * gf;
+	output[Bs2JpsiPhi_Angular_Terms::Factor_ReA0AP][i] = -Mathematics::Root_2() * sin2ThetaK * sin2ThetaL * cosPhi * gf;
+	output[Bs2JpsiPhi_Angular_Terms::Factor_ImA0AT][i] = Mathematics::Root_2() * sin2ThetaK * sin2ThetaL * sinPhi * gf;
+	output[Bs2JpsiPhi_Angular_Terms::Factor_ASAS][i] = 4.0*Mathematics::Third() * sinSqThetaL * gf;
+	output[Bs2JpsiPhi_Angular_Terms::Factor_ReASAP][i] = -2.0*Mathematics::Third() * Mathematics::Root_6() * sin2ThetaL * sinThetaK * cosPhi * gf;
+	output[Bs2JpsiPhi_Angular_Terms::Factor_ImASAT][i] = 2.0*Mathematics::Third() * Mathematics::Root_6() * sin2ThetaL * sinThetaK * sinPhi * gf;
+	output[Bs2JpsiPhi_Angular_Terms::Factor_ReASA0][i] = 8.0*Mathematics::Third() * Mathematics::Root_3() * sinSqThetaL * cosThetaK * gf;
+}
+
+#ifdef __AVX2__
+//	As TangleFactorsOne for the 4 events starting at i
+static inline void TangleFactorsFour( const double* cosTheta_in, const double* cosPsi_in, const double* sinPhi_in, const double* cosPhi_in, double* const* output, const unsigned int i )
+{
+	const __m256d one = _mm256_set1_pd( 1. );
+	const __m256d two = _mm256_set1_pd( 2. );
+	const __m256d gf = _mm256_set1_pd( Mathematics::Global_Frac() );
+
+	const __m256d cosTheta = _mm256_loadu_pd( cosTheta_in );
+	const __m256d cosPsi = _mm256_loadu_pd( cosPsi_in );
+	const __m256d sinPhi = _mm256_loadu_pd( sinPhi_in );
+	const __m256d cosPhi = _mm256_loadu_pd( cosPhi_in );
+
+	const __m256d sinSqTheta = _mm256_sub_pd( one, _mm256_mul_pd( cosTheta, cosTheta ) );
+	const __m256d sin2Theta = _mm256_mul_pd( _mm256_mul_pd( two, cosTheta ), _mm256_sqrt_pd( sinSqTheta ) );
+	const __m256d sinSqPsi = _mm256_sub_pd( one, _mm256_mul_pd( cosPsi, cosPsi ) );
+	const __m256d sinPsi = _mm256_sqrt_pd( sinSqPsi );
+	const __m256d sin2Psi = _mm256_mul_pd( _mm256_mul_pd( two, cosPsi ), sinPsi );
+	const __m256d sin2Phi = _mm256_mul_pd( _mm256_mul_pd( two, sinPhi ), cosPhi );
+
+	const __m256d evenTerm = _mm256_sub_pd( one, _mm256_mul_pd( sinSqTheta, _mm256_mul_pd( cosPhi, cosPhi ) ) );
+	const __m256d sinSqPsi_gf = _mm256_mul_pd( sinSqPsi, gf );
+
+	const __m256d A0A0 = _mm256_mul_pd( _mm256_mul_pd( _mm256_mul_pd( two, _mm256_mul_pd( cosPsi, cosPsi ) ), evenTerm ), gf );
+	const __m256d APAP = _mm256_mul_pd( sinSqPsi_gf, _mm256_sub_pd( one, _mm256_mul_pd( sinSqTheta, _mm256_mul_pd( sinPhi, sinPhi ) ) ) );
+	const __m256d ATAT = _mm256_mul_pd( sinSqPsi_gf, sinSqTheta );
+	const __m256d ImAPAT = _mm256_mul_pd( _mm256_set1_pd( -1. ), _mm256_mul_pd( sinSqPsi_gf, _mm256_mul_pd( sin2Theta, sinPhi ) ) );
+	const __m256d ReA0AP = _mm256_mul_pd( _mm256_set1_pd( Mathematics::_Over_SQRT_2() ), _mm256_mul_pd( _mm256_mul_pd( sin2Psi, sinSqTheta ), _mm256_mul_pd( sin2Phi, gf ) ) );
+	const __m256d ImA0AT = _mm256_mul_pd( _mm256_set1_pd( Mathematics::_Over_SQRT_2() ), _mm256_mul_pd( _mm256_mul_pd( sin2Psi, sin2Theta ), _mm256_mul_pd( cosPhi, gf ) ) );
+	const __m256d ASAS = _mm256_mul_pd( _mm256_set1_pd( 2.0*Mathematics::Third() ), _mm256_mul_pd( evenTerm, gf ) );
+	const __m256d ReASAP = _mm256_mul_pd( _mm256_set1_pd( Mathematics::Root_6()*Mathematics::Third() ), _mm256_mul_pd( _mm256_mul_pd( sinPsi, sinSqTheta ), _mm256_mul_pd( sin2Phi, gf ) ) );
+	const __m256d ImASAT = _mm256_mul_pd( _mm256_set1_pd( Mathematics::Root_6()*Mathematics::Third() ), _mm256_mul_pd( _mm256_mul_pd( sinPsi, sin2Theta ), _mm256_mul_pd( cosPhi, gf ) ) );
+	const __m256d ReASA0 = _mm256_mul_pd( _mm256_set1_pd( 4.0*Mathematics::Root_3()*Mathematics::Third() ), _mm256_mul_pd( _mm256_mul_pd( cosPsi, evenTerm ), gf ) );
+
+	_mm256_storeu_pd( output[Bs2JpsiPhi_Angular_Terms::Factor_A0A0]+i, A0A0 );
+	_mm256_storeu_pd( output[Bs2JpsiPhi_Angular_Terms::Factor_APAP]+i, APAP );
+	_mm256_storeu_pd( output[Bs2JpsiPhi_Angular_Terms::Factor_ATAT]+i, ATAT );
+	_mm256_storeu_pd( output[Bs2JpsiPhi_Angular_Terms::Factor_ImAPAT]+i, ImAPAT );
+	_mm256_storeu_pd( output[Bs2JpsiPhi_Angular_Terms::Factor_ReA0AP]+i, ReA0AP );
+	_mm256_storeu_pd( output[Bs2JpsiPhi_Angular_Terms::Factor_ImA0AT]+i, ImA0AT );
+	_mm256_storeu_pd( output[Bs2JpsiPhi_Angular_Terms::Factor_ASAS]+i, ASAS );
+	_mm256_storeu_pd( output[Bs2JpsiPhi_Angular_Terms::Factor_ReASAP]+i, ReASAP );
+	_mm256_storeu_pd( output[Bs2JpsiPhi_Angular_Terms::Factor_ImASAT]+i, ImASAT );
+	_mm256_storeu_pd( output[Bs2JpsiPhi_Angular_Terms::Factor_ReASA0]+i, ReASA0 );
+}
+
+//	As HangleFactorsOne for the 4 events starting at i
+static inline void HangleFactorsFour( const double* cosThetaK_in, const double* cosThetaL_in, const double* sinPhi_in, const double* cosPhi_in, double* const* output, const unsigned int i )
+{
+	const __m256d one = _mm256_set1_pd( 1. );
+	const __m256d two = _mm256_set1_pd( 2. );
+	const __m256d gf = _mm256_set1_pd( Mathematics::Global_Frac() * 0.5 );
+
+	const __m256d cosThetaK = _mm256_loadu_pd( cosThetaK_in );
+	const __m256d cosThetaL = _mm256_loadu_pd( cosThetaL_in );
+	const __m256d sinPhi = _mm256_loadu_pd( sinPhi_in );
+	const __m256d cosPhi = _mm256_loadu_pd( cosPhi_in );
+
+	const __m256d sinSqThetaK = _mm256_sub_pd( one, _mm256_mul_pd( cosThetaK, cosThetaK ) );
+	const __m256d sinThetaK = _mm256_sqrt_pd( sinSqThetaK );
+	const __m256d sin2ThetaK = _mm256_mul_pd( _mm256_mul_pd( two, cosThetaK ), sinThetaK );
+	const __m256d cosSqThetaL = _mm256_mul_pd( cosThetaL, cosThetaL );
+	const __m256d sinSqThetaL = _mm256_sub_pd( one, cosSqThetaL );
+	const __m256d sin2ThetaL = _mm256_mul_pd( _mm256_mul_pd( two, cosThetaL ), _mm256_sqrt_pd( sinSqThetaL ) );
+	const __m256d sin2Phi = _mm256_mul_pd( _mm256_mul_pd( two, sinPhi ), cosPhi );
+	const __m256d cos2Phi = _mm256_sub_pd( _mm256_mul_pd( cosPhi, cosPhi ), _mm256_mul_pd( sinPhi, sinPhi ) );
+
+	const __m256d transverseEven = _mm256_mul_pd( sinSqThetaK, _mm256_add_pd( one, cosSqThetaL ) );
+	const __m256d transverseOdd = _mm256_mul_pd( _mm256_mul_pd( sinSqThetaL, sinSqThetaK ), cos2Phi );
+	const __m256d sin2K2L_gf = _mm256_mul_pd( _mm256_mul_pd( sin2ThetaK, sin2ThetaL ), gf );
+	const __m256d sin2LK_gf = _mm256_mul_pd( _mm256_mul_pd( sin2ThetaL, sinThetaK ), gf );
+
+	const __m256d A0A0 = _mm256_mul_pd( _mm256_set1_pd( 4. ), _mm256_mul_pd( _mm256_mul_pd( cosThetaK, cosThetaK ), _mm256_mul_pd( sinSqThetaL, gf ) ) );
+	const __m256d APAP = _mm256_mul_pd( _mm256_sub_pd( transverseEven, transverseOdd ), gf );
+	const __m256d ATAT = _mm256_mul_pd( _mm256_add_pd( transverseEven, transverseOdd ), gf );
+	const __m256d ImAPAT = _mm256_mul_pd( two, _mm256_mul_pd( _mm256_mul_pd( sinSqThetaK, sinSqThetaL ), _mm256_mul_pd( sin2Phi, gf ) ) );
+	const __m256d ReA0AP = _mm256_mul_pd( _mm256_set1_pd( -Mathematics::Root_2() ), _mm256_mul_pd( sin2K2L_gf, cosPhi ) );
+	const __m256d ImA0AT = _mm256_mul_pd( _mm256_set1_pd( Mathematics::Root_2() ), _mm256_mul_pd( sin2K2L_gf, sinPhi ) );
+	const __m256d ASAS = _mm256_mul_pd( _mm256_set1_pd( 4.0*Mathematics::Third() ), _mm256_mul_pd( sinSqThetaL, gf ) );
+	const __m256d ReASAP = _mm256_mul_pd( _mm256_set1_pd( -2.0*Mathematics::Third()*Mathematics::Root_6() ), _mm256_mul_pd( sin2LK_gf, cosPhi ) );
+	const __m256d ImASAT = _mm256_mul_pd( _mm256_set1_pd( 2.0*Mathematics::Third()*Mathematics::Root_6() ), _mm256_mul_pd( sin2LK_gf, sinPhi ) );
+	const __m256d ReASA0 = _mm256_mul_pd( _mm256_set1_pd( 8.0*Mathematics::Third()*Mathematics::Root_3() ), _mm256_mul_pd( _mm256_mul_pd( sinSqThetaL, cosThetaK ), gf ) );
+
+	_mm256_storeu_pd( output[Bs2JpsiPhi_Angular_Terms::Factor_A0A0]+i, A0A0 );
+	_mm256_storeu_pd( output[Bs2JpsiPhi_Angular_Terms::Factor_APAP]+i, APAP );
+	_mm256_storeu_pd( output[Bs2JpsiPhi_Angular_Terms::Factor_ATAT]+i, ATAT );
+	_mm256_storeu_pd( output[Bs2JpsiPhi_Angular_Terms::Factor_ImAPAT]+i, ImAPAT );
+	_mm256_storeu_pd( output[Bs2JpsiPhi_Angular_Terms::Factor_ReA0AP]+i, ReA0AP );
+	_mm256_storeu_pd( output[Bs2JpsiPhi_Angular_Terms::Factor_ImA0AT]+i, ImA0AT );
+	_mm256_storeu_pd( output[Bs2JpsiPhi_Angular_Terms::Factor_ASAS]+i, ASAS );
+	_mm256_storeu_pd( output[Bs2JpsiPhi_Angular_Terms::Factor_ReASAP]+i, ReASAP );
+	_mm256_storeu_pd( output[Bs2JpsiPhi_Angular_Terms::Factor_ImASAT]+i, ImASAT );
+	_mm256_storeu_pd( output[Bs2JpsiPhi_Angular_Terms::Factor_ReASA0]+i, ReASA0 );
+}
+#endif
+
+void Bs2JpsiPhi_Angular_Terms::TangleFactorsBatch( const double* cosTheta, const double* cosPsi, const double* phi, const unsigned int numberEvents, double* const* output )
+{
+	double sinPhi[angleFactorChunk];
+	double cosPhi[angleFactorChunk];
+
+	for( unsigned int chunkStart=0; chunkStart< numberEvents; chunkStart+=angleFactorChunk )
+	{
+		const unsigned int chunkSize = min( angleFactorChunk, numberEvents-chunkStart );
+
+		//	The only transcendental functions needed, everything else follows from the cosines
+		for( unsigned int i=0; i< chunkSize; ++i )
+		{
+			sinPhi[i] = sin( phi[chunkStart+i] );
+			cosPhi[i] = cos( phi[chunkStart+i] );
+		}
+
+		unsigned int i=0;
+#ifdef __AVX2__
+		for( ; i+4 <= chunkSize; i+=4 )
+		{
+			TangleFactorsFour( cosTheta+chunkStart+i, cosPsi+chunkStart+i, sinPhi+i, cosPhi+i, output, chunkStart+i );
+		}
+#endif
+		for( ; i< chunkSize; ++i )
+		{
+			TangleFactorsOne( cosTheta[chunkStart+i], cosPsi[chunkStart+i], sinPhi[i], cosPhi[i], output, chunkStart+i );
+		}
+	}
+}
+
+void Bs2JpsiPhi_Angular_Terms::HangleFactorsBatch( const double* cosThetaK, const double* cosThetaL, const double* phi, const unsigned int numberEvents, double* const* output )
+{
+	double sinPhi[angleFactorChunk];
+	double cosPhi[angleFactorChunk];
+
+	for( unsigned int chunkStart=0; chunkStart< numberEvents; chunkStart+=angleFactorChunk )
+	{
+		const unsigned int chunkSize = min( angleFactorChunk, numberEvents-chunkStart );
+
+		for( unsigned int i=0; i< chunkSize; ++i )
+		{
+			sinPhi[i] = sin( phi[chunkStart+i] );
+			cosPhi[i] = cos( phi[chunkStart+i] );
+		}
+
+		unsigned int i=0;
+#ifdef __AVX2__
+		for( ; i+4 <= chunkSize; i+=4 )
+		{
+			HangleFactorsFour( cosThetaK+chunkStart+i, cosThetaL+chunkStart+i, sinPhi+i, cosPhi+i, output, chunkStart+i );
+		}
+#endif
+		for( ; i< chunkSize; ++i )
+		{
+			HangleFactorsOne( cosThetaK[chunkStart+i], cosThetaL[chunkStart+i], sinPhi[i], cosPhi[i], output, chunkStart+i );
+		}
+	}
+}
+
+bool Bs2JpsiPhi_Angular_Terms::TestAngleFactorsBatch()
+{
+	const double tolerance = 1E-12;
+
+	//	16 full chunks and 3 more events, the angles are spread over their whole range including the end points
+	const unsigned int numberEvents = 16*angleFactorChunk + 3;
+	vector<double> angle0( numberEvents ), angle1( numberEvents ), angle2( numberEvents );
+	for( unsigned int i=0; i< numberEvents; ++i )
+	{
+		angle0[i] = -1. + 2. * ( ( i*37 ) % numberEvents ) / ( numberEvents-1. );
+		angle1[i] = -1. + 2. * ( ( i*101 ) % numberEvents ) / ( numberEvents-1. );
+		angle2[i] = Mathematics::Pi() * ( -1. + 2. * ( ( i*211 ) % numberEvents ) / ( numberEvents-1. ) );
+	}
+
+	typedef double (*OneFactor)( vector<double> );
+	const OneFactor transversity[NumberAngleFactors] = { TangleFactorA0A0, TangleFactorAPAP, TangleFactorATAT, TangleFactorImAPAT, TangleFactorReA0AP,
+		TangleFactorImA0AT, TangleFactorASAS, TangleFactorReASAP, TangleFactorImASAT, TangleFactorReASA0 };
+	const OneFactor helicity[NumberAngleFactors] = { HangleFactorA0A0, HangleFactorAPAP, HangleFactorATAT, HangleFactorImAPAT, HangleFactorReA0AP,
+		HangleFactorImA0AT, HangleFactorASAS, HangleFactorReASAP, HangleFactorImASAT, HangleFactorReASA0 };
+
+	vector<double> allFactors( NumberAngleFactors * numberEvents );
+	double* factors[NumberAngleFactors];
+	for( unsigned int j=0; j< NumberAngleFactors; ++j ) factors[j] = &(allFactors[j*numberEvents]);
+
+#ifdef __AVX2__
+	cout << "Bs2JpsiPhi_Angular_Terms batch angle factors (AVX2 build, 4 events at a time), " << numberEvents << " events:" << endl;
+#else
+	cout << "Bs2JpsiPhi_Angular_Terms batch angle factors (scalar build), " << numberEvents << " events:" << endl;
+#endif
+
+	bool passed = true;
+	for( unsigned int basis=0; basis< 2; ++basis )
+	{
+		if( basis == 0 ) TangleFactorsBatch( &(angle0[0]), &(angle1[0]), &(angle2[0]), numberEvents, factors );
+		else HangleFactorsBatch( &(angle0[0]), &(angle1[0]), &(angle2[0]), numberEvents, factors );
+
+		double worst=0.;
+		unsigned int worstFactor=0, worstEvent=0;
+		for( unsigned int i=0; i< numberEvents; ++i )
+		{
+			vector<double> input( 3, 0. );
+			input[0] = angle0[i]; input[1] = angle1[i]; input[2] = angle2[i];
+			for( unsigned int j=0; j< NumberAngleFactors; ++j )
+			{
+				const double expected = basis == 0 ? transversity[j]( input ) : helicity[j]( input );
+				const double difference = fabs( factors[j][i] - expected );
+				if( difference > worst || !( difference == difference ) )
+				{
+					worst = difference;
+					worstFactor = j;
+					worstEvent = i;
+				}
+			}
+		}
+
+		const bool thisPassed = worst < tolerance;
+		passed = passed && thisPassed;
+		cout << "	" << ( basis == 0 ? "TangleFactorsBatch" : "HangleFactorsBatch" ) << ": largest difference to the single event functions " << worst
+			<< " in factor " << worstFactor << " of event " << worstEvent << ", " << ( thisPassed ? "PASSED" : "FAILED" ) << endl;
+	}
+	cout << "	tolerance " << tolerance << endl;
+
+	return passed;
+}
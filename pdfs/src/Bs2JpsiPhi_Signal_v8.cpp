@@ -63,6 +63,7 @@ Bs2JpsiPhi_Signal_v8::Bs2JpsiPhi_Signal_v8(PDFConfigurator* configurator) : Base
 	cthetalName			( configurator->getName("helcosthetaL") ), 
 	phihName			( configurator->getName("helphi") ), 
 	BetaName			( configurator->getName("beta") ), 
+	slotLayoutID(0), timeSlot(-1),
 	// Other things
 	_useEventResolution(false), 
 	//_useTimeAcceptance(false), 
@@ -87,9 +88,11 @@ Bs2JpsiPhi_Signal_v8::Bs2JpsiPhi_Signal_v8(PDFConfigurator* configurator) : Base
 	intExpL_stored(), intExpH_stored(), intExpSin_stored(), intExpCos_stored(),//, timeAcc(NULL),
 	CachedA1(), CachedA2(), CachedA3(), CachedA4(), CachedA5(), CachedA6(), CachedA7(), CachedA8(), CachedA9(), CachedA10(),
 	_fitDirectlyForApara(false), performingComponentProjection(false), _useDoubleTres(false), _useTripleTres(false), _useNewPhisres(false), resolutionModel(NULL),
-	_useBetaParameter(false), _useMultiplePhis(false), RequireInterference(true)
+	_useBetaParameter(false), _useMultiplePhis(false), RequireInterference(true), angleFactorBuffer(),
+	timeFactorBuffer(), useBatchTimeFactors(false), batchExpL(), batchExpH(), batchExpCos(), batchExpSin()
 {
 	componentIndex = 0;
+	angleSlot[0] = -1; angleSlot[1] = -1; angleSlot[2] = -1;
 
 	bool isCopy = configurator->hasConfigurationValue( "RAPIDFIT_SAYS_THIS_IS_A_COPY", "True" );
 
@@ -470,62 +473,188 @@ double Bs2JpsiPhi_Signal_v8::EvaluateForNumericIntegral(DataPoint * measurement)
 
 double Bs2JpsiPhi_Signal_v8::Evaluate(DataPoint * measurement)
 {
-	_datapoint = measurement;
+	useBatchTimeFactors = false;
 
-	//Let the resolution model pull out its specific obsrvables first.
-	//This can only be the case if event resolution is used (so far)
-	resolutionModel->setObservables( measurement );
-	_mistagCalibModel->setObservables( measurement );
+	this->CheckSlots( measurement );
 
-	_eventIsTagged = _mistagCalibModel->eventIsTagged();
+	this->CalculateAngleFactors( measurement );
+
+	return this->EvaluateWithAngleFactors( measurement );
+}
 
-	vector<double> angularData;
+//.............................................................
+//Calculate the PDF value for a block of events, the angle factors for the whole block are calculated in one pass
 
+void Bs2JpsiPhi_Signal_v8::EvaluateBatch( const EventBlock& Input, double* out )
+{
+	const double* angle0 = NULL;
+	const double* angle1 = NULL;
+	const double* angle2 = NULL;
 	if( !_useHelicityBasis )
 	{
-		angularData.push_back( measurement->GetObservable( cosThetaName )->GetValue() );
-		angularData.push_back( measurement->GetObservable( cosPsiName )->GetValue() );
-		angularData.push_back( measurement->GetObservable( phiName )->GetValue() );
-
-		A0A0_value = Bs2JpsiPhi_Angular_Terms::TangleFactorA0A0( angularData );
-		APAP_value = Bs2JpsiPhi_Angular_Terms::TangleFactorAPAP( angularData );
-		ATAT_value = Bs2JpsiPhi_Angular_Terms::TangleFactorATAT( angularData );
-		ASAS_value = Bs2JpsiPhi_Angular_Terms::TangleFactorASAS( angularData );
-		ImAPAT_value = Bs2JpsiPhi_Angular_Terms::TangleFactorImAPAT( angularData );
-		ReA0AP_value = Bs2JpsiPhi_Angular_Terms::TangleFactorReA0AP( angularData );
-		ImA0AT_value = Bs2JpsiPhi_Angular_Terms::TangleFactorImA0AT( angularData );
-		ReASAP_value = Bs2JpsiPhi_Angular_Terms::TangleFactorReASAP( angularData );
-		ImASAT_value = Bs2JpsiPhi_Angular_Terms::TangleFactorImASAT( angularData );
-		ReASA0_value = Bs2JpsiPhi_Angular_Terms::TangleFactorReASA0( angularData );
+		angle0 = Input.GetColumn( cosThetaName );
+		angle1 = Input.GetColumn( cosPsiName );
+		angle2 = Input.GetColumn( phiName );
 	}
 	else
 	{
-		angularData.push_back( measurement->GetObservable( cthetakName )->GetValue() );
-		angularData.push_back( measurement->GetObservable( cthetalName )->GetValue() );
-		angularData.push_back( measurement->GetObservable( phihName )->GetValue() );
+		angle0 = Input.GetColumn( cthetakName );
+		angle1 = Input.GetColumn( cthetalName );
+		angle2 = Input.GetColumn( phihName );
+	}
+
+	//	Data not stored in columns
+	if( angle0 == NULL || angle1 == NULL || angle2 == NULL )
+	{
+		BasePDF::EvaluateBatch( Input, out );
+		return;
+	}
+
+	const unsigned int numberEvents = Input.GetNumberEvents();
+	if( numberEvents == 0 ) return;
+
+	angleFactorBuffer.resize( Bs2JpsiPhi_Angular_Terms::NumberAngleFactors * numberEvents );
+	double* factors[Bs2JpsiPhi_Angular_Terms::NumberAngleFactors];
+	for( unsigned int i=0; i< Bs2JpsiPhi_Angular_Terms::NumberAngleFactors; ++i ) factors[i] = &(angleFactorBuffer[i*numberEvents]);
+
+	if( !_useHelicityBasis ) Bs2JpsiPhi_Angular_Terms::TangleFactorsBatch( angle0, angle1, angle2, numberEvents, factors );
+	else Bs2JpsiPhi_Angular_Terms::HangleFactorsBatch( angle0, angle1, angle2, numberEvents, factors );
+
+	//	The time primitives for the whole block, a resolution model without batch functions falls back to its scalar ones
+	const double* timeColumn = Input.GetColumn( timeName );
+	double* expLBatch = NULL;
+	double* expHBatch = NULL;
+	double* expCosBatch = NULL;
+	double* expSinBatch = NULL;
+	if( timeColumn != NULL )
+	{
+		timeFactorBuffer.resize( 4 * numberEvents );
+		expLBatch = &(timeFactorBuffer[0]);
+		expHBatch = &(timeFactorBuffer[numberEvents]);
+		expCosBatch = &(timeFactorBuffer[2*numberEvents]);
+		expSinBatch = &(timeFactorBuffer[3*numberEvents]);
 
-		A0A0_value = Bs2JpsiPhi_Angular_Terms::HangleFactorA0A0( angularData );
-		APAP_value = Bs2JpsiPhi_Angular_Terms::HangleFactorAPAP( angularData );
-		ATAT_value = Bs2JpsiPhi_Angular_Terms::HangleFactorATAT( angularData );
-		ASAS_value = Bs2JpsiPhi_Angular_Terms::HangleFactorASAS( angularData );
-		ImAPAT_value = Bs2JpsiPhi_Angular_Terms::HangleFactorImAPAT( angularData );
-		ReA0AP_value = Bs2JpsiPhi_Angular_Terms::HangleFactorReA0AP( angularData );
-		ImA0AT_value = Bs2JpsiPhi_Angular_Terms::HangleFactorImA0AT( angularData );
-		ReASAP_value = Bs2JpsiPhi_Angular_Terms::HangleFactorReASAP( angularData );
-		ImASAT_value = Bs2JpsiPhi_Angular_Terms::HangleFactorImASAT( angularData );
-		ReASA0_value = Bs2JpsiPhi_Angular_Terms::HangleFactorReASA0( angularData );
+		resolutionModel->ExpBatch( Input, timeColumn, gamma_l(), expLBatch );
+		resolutionModel->ExpBatch( Input, timeColumn, gamma_h(), expHBatch );
+		if( RequireInterference ) resolutionModel->ExpCosSinBatch( Input, timeColumn, gamma(), delta_ms, expCosBatch, expSinBatch );
 	}
 
+	for( unsigned int i=0; i< numberEvents; ++i )
+	{
+		A0A0_value = factors[Bs2JpsiPhi_Angular_Terms::Factor_A0A0][i];
+		APAP_value = factors[Bs2JpsiPhi_Angular_Terms::Factor_APAP][i];
+		ATAT_value = factors[Bs2JpsiPhi_Angular_Terms::Factor_ATAT][i];
+		ASAS_value = factors[Bs2JpsiPhi_Angular_Terms::Factor_ASAS][i];
+		ImAPAT_value = factors[Bs2JpsiPhi_Angular_Terms::Factor_ImAPAT][i];
+		ReA0AP_value = factors[Bs2JpsiPhi_Angular_Terms::Factor_ReA0AP][i];
+		ImA0AT_value = factors[Bs2JpsiPhi_Angular_Terms::Factor_ImA0AT][i];
+		ReASAP_value = factors[Bs2JpsiPhi_Angular_Terms::Factor_ReASAP][i];
+		ImASAT_value = factors[Bs2JpsiPhi_Angular_Terms::Factor_ImASAT][i];
+		ReASA0_value = factors[Bs2JpsiPhi_Angular_Terms::Factor_ReASA0][i];
+
+		if( timeColumn != NULL )
+		{
+			useBatchTimeFactors = true;
+			batchExpL = expLBatch[i];
+			batchExpH = expHBatch[i];
+			batchExpCos = RequireInterference ? expCosBatch[i] : 0.;
+			batchExpSin = RequireInterference ? expSinBatch[i] : 0.;
+		}
+
+		DataPoint* measurement = Input.GetDataPoint( i );
+		this->CheckSlots( measurement );
+		out[i] = this->EvaluateWithAngleFactors( measurement );
+	}
+	useBatchTimeFactors = false;
+}
+
+//.............................................................
+//Calculate the angle factors for one event, these are written straight into the cached members
+
+void Bs2JpsiPhi_Signal_v8::CalculateAngleFactors( DataPoint* measurement )
+{
+	double* factors[Bs2JpsiPhi_Angular_Terms::NumberAngleFactors];
+	factors[Bs2JpsiPhi_Angular_Terms::Factor_A0A0] = &A0A0_value;
+	factors[Bs2JpsiPhi_Angular_Terms::Factor_APAP] = &APAP_value;
+	factors[Bs2JpsiPhi_Angular_Terms::Factor_ATAT] = &ATAT_value;
+	factors[Bs2JpsiPhi_Angular_Terms::Factor_ASAS] = &ASAS_value;
+	factors[Bs2JpsiPhi_Angular_Terms::Factor_ImAPAT] = &ImAPAT_value;
+	factors[Bs2JpsiPhi_Angular_Terms::Factor_ReA0AP] = &ReA0AP_value;
+	factors[Bs2JpsiPhi_Angular_Terms::Factor_ImA0AT] = &ImA0AT_value;
+	factors[Bs2JpsiPhi_Angular_Terms::Factor_ReASAP] = &ReASAP_value;
+	factors[Bs2JpsiPhi_Angular_Terms::Factor_ImASAT] = &ImASAT_value;
+	factors[Bs2JpsiPhi_Angular_Terms::Factor_ReASA0] = &ReASA0_value;
+
+	const double angle0 = measurement->value( (unsigned)angleSlot[0] );
+	const double angle1 = measurement->value( (unsigned)angleSlot[1] );
+	const double angle2 = measurement->value( (unsigned)angleSlot[2] );
+
+	if( !_useHelicityBasis ) Bs2JpsiPhi_Angular_Terms::TangleFactorsBatch( &angle0, &angle1, &angle2, 1, factors );
+	else Bs2JpsiPhi_Angular_Terms::HangleFactorsBatch( &angle0, &angle1, &angle2, 1, factors );
+}
+
+//.............................................................
+//Find where the observables used for every event sit in DataPoints with this layout
+
+void Bs2JpsiPhi_Signal_v8::ResolveSlots( DataPoint* measurement )
+{
+	vector<ObservableRef*> wanted;
+	wanted.push_back( &timeName );
+	if( !_useHelicityBasis )
+	{
+		wanted.push_back( &cosThetaName );
+		wanted.push_back( &cosPsiName );
+		wanted.push_back( &phiName );
+	}
+	else
+	{
+		wanted.push_back( &cthetakName );
+		wanted.push_back( &cthetalName );
+		wanted.push_back( &phihName );
+	}
+
+	vector<int> slots;
+	for( unsigned int i=0; i< wanted.size(); ++i )
+	{
+		slots.push_back( measurement->GetSlot( *(wanted[i]) ) );
+		if( slots.back() < 0 )
+		{
+			cerr << "Bs2JpsiPhi_Signal_v8: Observable " << wanted[i]->Name() << " not found in DataPoint" << endl;
+			throw(-20);
+		}
+	}
+
+	timeSlot = slots[0];
+	angleSlot[0] = slots[1];
+	angleSlot[1] = slots[2];
+	angleSlot[2] = slots[3];
+	slotLayoutID = measurement->GetLayoutID();
+}
+
+//.............................................................
+//Calculate the PDF value once the angle factors are known
+
+double Bs2JpsiPhi_Signal_v8::EvaluateWithAngleFactors(DataPoint * measurement)
+{
+	_datapoint = measurement;
+
+	//Let the resolution model pull out its specific obsrvables first.
+	//This can only be the case if event resolution is used (so far)
+	resolutionModel->setObservables( measurement );
+	_mistagCalibModel->setObservables( measurement );
+
+	_eventIsTagged = _mistagCalibModel->eventIsTagged();
+
 	// Get observables into member variables
-	t = measurement->GetObservable( timeName )->GetValue() ; // - timeOffset ;
+	t = measurement->value( (unsigned)timeSlot ) ; // - timeOffset ;
 
 	//Get anglular quantities
 	double angAcceptanceFactor = 0 ;
 	if( _useHelicityBasis )
 	{
-		Observable* thetaK_obs = measurement->GetObservable( cthetakName );
-		Observable* thetaL_obs = measurement->GetObservable( cthetalName );
-		Observable* hphi_obs = measurement->GetObservable( phihName );
+		Observable* thetaK_obs = measurement->GetObservable( (unsigned)angleSlot[0] );
+		Observable* thetaL_obs = measurement->GetObservable( (unsigned)angleSlot[1] );
+		Observable* hphi_obs = measurement->GetObservable( (unsigned)angleSlot[2] );
 		ctheta_k   = thetaK_obs->GetValue();
 		phi_h      = hphi_obs->GetValue();
 		ctheta_l   = thetaL_obs->GetValue();
@@ -534,9 +663,9 @@ double Bs2JpsiPhi_Signal_v8::Evaluate(DataPoint * measurement)
 	}
 	else
 	{
-		Observable* theta_obs = measurement->GetObservable( cosThetaName );
-		Observable* psi_obs = measurement->GetObservable( cosPsiName );
-		Observable* phi_obs = measurement->GetObservable( phiName );
+		Observable* theta_obs = measurement->GetObservable( (unsigned)angleSlot[0] );
+		Observable* psi_obs = measurement->GetObservable( (unsigned)angleSlot[1] );
+		Observable* phi_obs = measurement->GetObservable( (unsigned)angleSlot[2] );
 		ctheta_tr = theta_obs->GetValue();
 		phi_tr    = phi_obs->GetValue();
 		ctheta_1  = psi_obs->GetValue();
@@ -588,51 +717,19 @@ double Bs2JpsiPhi_Signal_v8::Evaluate(DataPoint * measurement)
 double Bs2JpsiPhi_Signal_v8::EvaluateTimeOnly(DataPoint * measurement)
 {
 	_datapoint = measurement;
+	useBatchTimeFactors = false;
 
 	resolutionModel->setObservables( measurement );
 	_mistagCalibModel->setObservables( measurement );
 
 	_eventIsTagged = _mistagCalibModel->eventIsTagged();
 
-	vector<double> angularData;
+	this->CheckSlots( measurement );
 
-	if( !_useHelicityBasis )
-	{
-		angularData.push_back( measurement->GetObservable( cosThetaName )->GetValue() );
-		angularData.push_back( measurement->GetObservable( cosPsiName )->GetValue() );
-		angularData.push_back( measurement->GetObservable( phiName )->GetValue() );
-
-		A0A0_value = Bs2JpsiPhi_Angular_Terms::TangleFactorA0A0( angularData );
-		APAP_value = Bs2JpsiPhi_Angular_Terms::TangleFactorAPAP( angularData );
-		ATAT_value = Bs2JpsiPhi_Angular_Terms::TangleFactorATAT( angularData );
-		ASAS_value = Bs2JpsiPhi_Angular_Terms::TangleFactorASAS( angularData );
-		ImAPAT_value = Bs2JpsiPhi_Angular_Terms::TangleFactorImAPAT( angularData );
-		ReA0AP_value = Bs2JpsiPhi_Angular_Terms::TangleFactorReA0AP( angularData );
-		ImA0AT_value = Bs2JpsiPhi_Angular_Terms::TangleFactorImA0AT( angularData );
-		ReASAP_value = Bs2JpsiPhi_Angular_Terms::TangleFactorReASAP( angularData );
-		ImASAT_value = Bs2JpsiPhi_Angular_Terms::TangleFactorImASAT( angularData );
-		ReASA0_value = Bs2JpsiPhi_Angular_Terms::TangleFactorReASA0( angularData );
-	}
-	else
-	{
-		angularData.push_back( measurement->GetObservable( cthetakName )->GetValue() );
-		angularData.push_back( measurement->GetObservable( cthetalName )->GetValue() );
-		angularData.push_back( measurement->GetObservable( phihName )->GetValue() );
-
-		A0A0_value = Bs2JpsiPhi_Angular_Terms::HangleFactorA0A0( angularData );
-		APAP_value = Bs2JpsiPhi_Angular_Terms::HangleFactorAPAP( angularData );
-		ATAT_value = Bs2JpsiPhi_Angular_Terms::HangleFactorATAT( angularData );
-		ASAS_value = Bs2JpsiPhi_Angular_Terms::HangleFactorASAS( angularData );
-		ImAPAT_value = Bs2JpsiPhi_Angular_Terms::HangleFactorImAPAT( angularData );
-		ReA0AP_value = Bs2JpsiPhi_Angular_Terms::HangleFactorReA0AP( angularData );
-		ImA0AT_value = Bs2JpsiPhi_Angular_Terms::HangleFactorImA0AT( angularData );
-		ReASAP_value = Bs2JpsiPhi_Angular_Terms::HangleFactorReASAP( angularData );
-		ImASAT_value = Bs2JpsiPhi_Angular_Terms::HangleFactorImASAT( angularData );
-		ReASA0_value = Bs2JpsiPhi_Angular_Terms::HangleFactorReASA0( angularData );
-	}
+	this->CalculateAngleFactors( measurement );
 
 	// Get observables into member variables
-	t = measurement->GetObservable( timeName )->GetValue() ; // - timeOffset ;
+	t = measurement->value( (unsigned)timeSlot ) ; // - timeOffset ;
 
 	double returnValue = this->diffXsecTimeOnly( );
 
@@ -709,6 +806,19 @@ double Bs2JpsiPhi_Signal_v8::Normalisation(DataPoint * measurement, PhaseSpaceBo
 // Pre calculate the time integrals : this is becaue these functions are called many times for each event due to the 10 angular terms
 void Bs2JpsiPhi_Signal_v8::preCalculateTimeFactors()
 {
+	//	Already calculated for the whole block by EvaluateBatch
+	if( useBatchTimeFactors )
+	{
+		useBatchTimeFactors = false;
+		expL_stored = batchExpL;
+		expH_stored = batchExpH;
+		expSin_stored = ( _eventIsTagged && RequireInterference ) ? batchExpSin : 0.;
+		expCos_stored = ( _eventIsTagged && RequireInterference ) ? batchExpCos : 0.;
+		_Expsinh_dGt = expL() - expH();
+		_Expcosh_dGt = expL() + expH();
+		return;
+	}
+
 	expL_stored = resolutionModel->Exp( t, gamma_l() );
 	expH_stored = resolutionModel->Exp( t, gamma_h() );
 
@@ -246,6 +246,44 @@ Bs2PhiKKComponent::amplitude_t Bs2PhiKKComponent::Amplitude(const datapoint_t& d
 	massPart *= fraction.value * OFBF(mKK);
 	return {massPart*angularPart[false], massPart*angularPart[true]};
 }
+// The parts of the amplitude which don't depend on the couplings
+unsigned int Bs2PhiKKComponent::NumberOfTerms() const
+{
+	return Ahel.empty() ? 1 : Ahel.size();
+}
+void Bs2PhiKKComponent::AmplitudeTerms(const datapoint_t& datapoint, std::complex<double>* BTerms, std::complex<double>* BbarTerms) const
+{
+	double mKK = datapoint[0];
+	double phi = datapoint[1];
+	double ctheta_1 = datapoint[2];
+	double ctheta_2 = datapoint[3];
+	std::complex<double> massPart = KKLineShape->massShape(mKK) * OFBF(mKK);
+	if(Ahel.empty()) // Must be non-resonant
+	{
+		BTerms[0] = massPart;
+		BbarTerms[0] = massPart;
+		return;
+	}
+	unsigned int i = 0;
+	for(const auto& A : Ahel)
+	{
+		BTerms[i] = massPart * F(A.first, phi, ctheta_1, ctheta_2);
+		BbarTerms[i] = massPart * F(A.first, -phi, -ctheta_1, -ctheta_2);
+		i++;
+	}
+}
+// The coefficients of the terms above, in the same order
+void Bs2PhiKKComponent::Couplings(std::complex<double>* couplings) const
+{
+	if(Ahel.empty())
+	{
+		couplings[0] = fraction.value;
+		return;
+	}
+	unsigned int i = 0;
+	for(const auto& A : Ahel)
+		couplings[i++] = fraction.value * A.second;
+}
 // Update everything from the parameter set
 void Bs2PhiKKComponent::SetPhysicsParameters(ParameterSet* fitpars)
 {
@@ -334,4 +372,12 @@ vector<ObservableRef> Bs2PhiKKComponent::GetPhysicsParameters() const
 			parameters.push_back(par.name);
 	return parameters;
 }
-
+vector<ObservableRef> Bs2PhiKKComponent::GetCouplingParameters() const
+{
+	vector<ObservableRef> parameters;
+	parameters.push_back(fraction.name);
+	for(const auto& set: {magsqs,phases})
+		for(const auto& par: set)
+			parameters.push_back(par.name);
+	return parameters;
+}
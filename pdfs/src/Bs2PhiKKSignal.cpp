@@ -205,6 +205,65 @@ Bs2PhiKKComponent::datapoint_t Bs2PhiKKSignal::ReadDataPoint(DataPoint* measurem
 	phi+=M_PI;
 	return {mKK, phi, ctheta_1, ctheta_2};
 }
+/*Amplitude terms************************************************************/
+// The PDF is p1stp3 × acceptance × [(|A|²+|Ā|²)(1/ΓL+1/ΓH) + 2Re(ĀA*)(1/ΓL−1/ΓH)] with A = Σ c_i b_i and Ā = Σ c_i b̄_i
+// The terms are all of the b_i followed by all of the b̄_i
+unsigned int Bs2PhiKKSignal::GetNumberAmplitudeTerms() const
+{
+	// The convolution mixes different points
+	if(convolve) return 0;
+	unsigned int n = 0;
+	for(const auto& comp : components)
+		n += comp.second.NumberOfTerms();
+	return 2*n;
+}
+void Bs2PhiKKSignal::EvaluateAmplitudeTerms(DataPoint* measurement, std::complex<double>* terms, double& weight)
+{
+	const Bs2PhiKKComponent::datapoint_t datapoint = ReadDataPoint(measurement);
+	const unsigned int n = GetNumberAmplitudeTerms()/2;
+	unsigned int i = 0;
+	for(const auto& comp : components)
+	{
+		comp.second.AmplitudeTerms(datapoint, terms+i, terms+n+i);
+		i += comp.second.NumberOfTerms();
+	}
+	weight = p1stp3(datapoint[0]) * Acceptance(datapoint);
+}
+std::vector<std::string> Bs2PhiKKSignal::GetAmplitudeCouplingNames() const
+{
+	std::vector<std::string> names = {dGsGs.name.Name()};
+	for(const auto& comp : components)
+		for(const auto& par : comp.second.GetCouplingParameters())
+			names.push_back(par.Name());
+	return names;
+}
+double Bs2PhiKKSignal::ContractAmplitudeIntegrals(const std::vector<std::complex<double>>& integrals)
+{
+	if(outofrange)
+		return 1e-100;
+	const unsigned int n = GetNumberAmplitudeTerms()/2;
+	std::vector<std::complex<double>> couplings(n);
+	unsigned int i = 0;
+	for(const auto& comp : components)
+	{
+		comp.second.Couplings(&couplings[i]);
+		i += comp.second.NumberOfTerms();
+	}
+	// Same factors as TimeIntegratedMsq
+	double GH = (2 - dGsGs.value);
+	double GL = (2 + dGsGs.value);
+	const unsigned int N = 2*n;
+	std::complex<double> total(0, 0);
+	for(unsigned int k = 0; k < n; k++)
+		for(unsigned int l = 0; l < n; l++)
+		{
+			std::complex<double> cc = couplings[k] * std::conj(couplings[l]);
+			std::complex<double> termone = integrals[k*N+l] + integrals[(n+k)*N+(n+l)];
+			std::complex<double> termtwo = 2. * integrals[(n+k)*N+l];
+			total += cc * (termone * (1./GL + 1./GH) + termtwo * (1./GL - 1./GH));
+		}
+	return std::real(total);
+}
 /*Calculate matrix elements***************************************************/
 // Total |M|²: coherent sum of all amplitudes
 double Bs2PhiKKSignal::TotalMsq(const Bs2PhiKKComponent::datapoint_t& datapoint, const std::string& dummy) const
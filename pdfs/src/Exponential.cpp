@@ -24,6 +24,7 @@ Exponential::Exponential( PDFConfigurator* configurator) :
 	// Observables
 	, timeName      ( configurator->getName("time") )
 	, timeConst	( configurator->getName("time") )
+	, resolutionParameterNames()
 	//objects used in XML
 	, tau(), gamma()
 {
@@ -37,6 +38,7 @@ Exponential::Exponential( const Exponential &copy ) :
 	, tauName ( copy.tauName )
 	, timeName ( copy.timeName )
 	, timeConst ( copy.timeConst )
+	, resolutionParameterNames ( copy.resolutionParameterNames )
 	, resolutionModel( NULL )
 	, tau ( copy.tau )
 	, gamma ( copy.gamma )
@@ -56,7 +58,13 @@ void Exponential::MakePrototypes()
 	vector<string> parameterNames;
 	parameterNames.push_back( tauName );
 
-	resolutionModel->addParameters( parameterNames );
+	vector<string> resolutionParameters;
+	resolutionModel->addParameters( resolutionParameters );
+	for( unsigned int i=0; i< resolutionParameters.size(); ++i )
+	{
+		parameterNames.push_back( resolutionParameters[i] );
+		resolutionParameterNames.push_back( ObservableRef( resolutionParameters[i] ) );
+	}
 
 	allParameters = ParameterSet(parameterNames);
 }
@@ -136,3 +144,37 @@ double Exponential::Normalisation( DataPoint * measurement, PhaseSpaceBoundary *
 	return resolutionModel->ExpInt( tlow, thigh, gamma );
 }
 
+bool Exponential::GetAnalyticGradient() const
+{
+	if( this->GetNumericalNormalisation() ) return false;
+
+	//	The resolution model only provides derivatives with respect to gamma
+	for( unsigned int i=0; i< resolutionParameterNames.size(); ++i )
+	{
+		if( !allParameters.GetPhysicsParameter( resolutionParameterNames[i] )->isFixed() ) return false;
+	}
+
+	return true;
+}
+
+//	d/dtau of ln( Exp( time, 1/tau ) / ExpInt( tlow, thigh, 1/tau ) ), both taken from the dual versions of the resolution model
+void Exponential::EvaluateGradient( DataPoint * measurement, PhaseSpaceBoundary * boundary, const vector<string>& Names, double* gradient )
+{
+	for( unsigned int i=0; i< Names.size(); ++i ) gradient[i] = 0.;
+
+	const int tauSlot = this->GetGradientSlot( Names, tauName );
+	if( tauSlot < 0 ) return;
+
+	time = measurement->GetObservable( timeName )->GetValue();
+
+	IConstraint* timeC = boundary->GetConstraint( timeConst );
+	double tlow = timeC->GetMinimum();
+	double thigh = timeC->GetMaximum();
+
+	const ResolutionDual gammaDual = 1. / ResolutionDual::Variable( tau, 0 );
+
+	const ResolutionDual value = resolutionModel->ExpDual( time, gammaDual );
+	const ResolutionDual norm = resolutionModel->ExpIntDual( tlow, thigh, gammaDual );
+
+	gradient[tauSlot] = value.GetDerivative( 0 ) / value.GetValue() - norm.GetDerivative( 0 ) / norm.GetValue();
+}
@@ -0,0 +1,247 @@
+#!/bin/bash
+#
+#	Run the tests described in the .test files in this directory and check their outputs
+#
+#	./run_tests.sh			run every test
+#	./run_tests.sh columnar_fit	run only the named tests
+#
+#	The fitter is $FITTING, by default the one built in this checkout, the comparisons need root in the PATH
+#	The output of each run is kept in <test>_Output/<run>.log
+
+cd "$(dirname "$0")"
+
+FITTING=${FITTING:-../../bin/fitting}
+ALL_TESTS="columnar_fit event_cache_fit stream_fit cached_components_fit qmc_fit envelope_toy parallel_hesse_fit toy_study"
+
+failed_tests=""
+
+#	Run the fitter, keeping its output in the log of this run
+#	run_fitting <test> <run> <arguments...>
+run_fitting()
+{
+	local test=$1 run=$2
+	shift 2
+	mkdir -p ${test}_Output
+	echo "	$FITTING $*"
+	$FITTING "$@" > ${test}_Output/${run}.log 2>&1
+}
+
+#	compare <test> <file1> <file2> <tree> <branches> <tolerance> [absolute]
+compare()
+{
+	local test=$1
+	root -l -b -q "compare_outputs.C(\"$2\",\"$3\",\"$4\",\"$5\",$6,${7:-false})" > ${test}_Output/compare.log 2>&1
+	cat ${test}_Output/compare.log | grep -v '^$' | grep -v '^Processing'
+	tail -n 1 ${test}_Output/compare.log | grep -q '^PASSED' || fail $test
+}
+
+#	expect <test> <run> <pattern>, the log of the run has to contain the pattern
+expect()
+{
+	grep -q "$3" $1_Output/$2.log || { echo "	$1_Output/$2.log doesn't contain \"$3\""; fail $1; }
+}
+
+#	result <test> <run>, the flat ntuple of the fit result of the run
+result()
+{
+	ls $1_Output/$2/Global_Fit_Result_*.root 2>/dev/null | tail -n 1
+}
+
+fail()
+{
+	echo "$1: FAILED"
+	failed_tests="$failed_tests $1"
+}
+
+#	The toy all of the fits use, made once
+make_data()
+{
+	if [ ! -f mass_toy.root ]
+	then
+		run_fitting mass_toy generate -f mass_toy.xml --saveOneDataSet mass_toy.root --SendOutput mass_toy_Output
+	fi
+	[ -f mass_toy.root ] || { echo "Could not make mass_toy.root, see mass_toy_Output/generate.log"; exit 1; }
+}
+
+#	See columnar_fit.test
+test_columnar_fit()
+{
+	rm -f columnar_fit_trace.root columnar_fit_1thread_trace.root
+	run_fitting columnar_fit threads8 -f columnar_fit.xml --SendOutput columnar_fit_Output/threads8
+	run_fitting columnar_fit threads1 -f columnar_fit.xml --SendOutput columnar_fit_Output/threads1 \
+		--OverrideXML /RapidFit/FitFunction/Threads 1 --OverrideXML /RapidFit/FitFunction/Trace columnar_fit_1thread_trace.root
+	compare columnar_fit columnar_fit_trace.root columnar_fit_1thread_trace.root Trace_0 "" 0.
+}
+
+#	See event_cache_fit.test
+test_event_cache_fit()
+{
+	[ -f columnar_fit_trace.root ] || test_columnar_fit
+	rm -rf event_cache event_cache_fit_trace.root
+	mkdir event_cache
+	run_fitting event_cache_fit write -f event_cache_fit.xml --SendOutput event_cache_fit_Output/write
+	expect event_cache_fit write "Wrote event cache: event_cache/mass_toy.root_"
+	compare event_cache_fit columnar_fit_trace.root event_cache_fit_trace.root Trace_0 "" 0.
+
+	rm -f event_cache_fit_trace.root
+	run_fitting event_cache_fit read -f event_cache_fit.xml --SendOutput event_cache_fit_Output/read
+	expect event_cache_fit read "Added 100000 events for ROOT file: mass_toy.root from event cache"
+	compare event_cache_fit columnar_fit_trace.root event_cache_fit_trace.root Trace_0 "" 0.
+}
+
+#	See stream_fit.test
+test_stream_fit()
+{
+	[ -f columnar_fit_trace.root ] || test_columnar_fit
+	rm -rf stream_cache stream_fit_trace.root stream_fit_1thread_trace.root
+	mkdir stream_cache
+	run_fitting stream_fit threads8 -f stream_fit.xml --SendOutput stream_fit_Output/threads8
+	expect stream_fit threads8 "Wrote event cache: stream_cache/mass_toy.root_"
+	run_fitting stream_fit threads1 -f stream_fit.xml --SendOutput stream_fit_Output/threads1 \
+		--OverrideXML /RapidFit/FitFunction/Threads 1 --OverrideXML /RapidFit/FitFunction/Trace stream_fit_1thread_trace.root
+	compare stream_fit stream_fit_trace.root stream_fit_1thread_trace.root Trace_0 "" 0.
+
+	#	The chunks are summed separately, so the NLL only agrees with the fit in memory up to rounding
+	compare stream_fit "$(result columnar_fit threads8)" "$(result stream_fit threads8)" RapidFitResult "_value$" 1E-4
+	compare stream_fit "$(result columnar_fit threads8)" "$(result stream_fit threads8)" RapidFitResult "^NLL$" 1E-8
+}
+
+#	See cached_components_fit.test
+test_cached_components_fit()
+{
+	[ -f columnar_fit_trace.root ] || test_columnar_fit
+	rm -f cached_components_fit_trace.root
+	run_fitting cached_components_fit threads8 -f cached_components_fit.xml --SendOutput cached_components_fit_Output/threads8
+	compare cached_components_fit columnar_fit_trace.root cached_components_fit_trace.root Trace_0 "" 0.
+}
+
+#	See qmc_fit.test
+test_qmc_fit()
+{
+	[ -f columnar_fit_trace.root ] || test_columnar_fit
+	run_fitting qmc_fit threads8 -f qmc_fit.xml --SendOutput qmc_fit_Output/threads8
+	expect qmc_fit threads8 "Numerical Integration Precision:"
+
+	#	Largest error of any integral during the fit, from the table printed after the fit
+	local table=$(awk '/^Numerical Integration Precision:/{t=1;next} t&&/^PDF/{next} t&&NF==0{t=0} t' qmc_fit_Output/threads8.log)
+	echo "$table"
+	if echo "$table" | grep -q "at the maximum number of points"
+	then
+		echo "	Some integrals didn't reach the precision asked for"
+		fail qmc_fit
+	fi
+	local worst=$(echo "$table" | awk 'BEGIN{w=0} {if($NF+0>w) w=$NF+0} END{print w}')
+	awk -v w=$worst 'BEGIN{exit !(w <= 1E-5)}' || { echo "	Largest error $worst is more than 1E-5"; fail qmc_fit; }
+
+	#	An error of e on the normalisation moves the NLL of each event by at most e
+	local events=100000
+	local tolerance=$(awk -v w=$worst -v n=$events 'BEGIN{print w*n}')
+	compare qmc_fit "$(result columnar_fit threads8)" "$(result qmc_fit threads8)" RapidFitResult "^NLL$" $tolerance true
+}
+
+#	efficiency <test> <run>, accepted events / trials from the log of the run
+efficiency()
+{
+	awk '/^Data generation:/{print $3/$6}' $1_Output/$2.log | tail -n 1
+}
+
+#	See envelope_toy.test
+test_envelope_toy()
+{
+	run_fitting envelope_toy single -f envelope_toy.xml --saveOneDataSet envelope_toy_single.root --SendOutput envelope_toy_Output/single \
+		--OverrideXML /RapidFit/ToFit/DataSet/NumberEvents 9999
+	run_fitting envelope_toy envelope -f envelope_toy.xml --saveOneDataSet envelope_toy.root --SendOutput envelope_toy_Output/envelope
+	expect envelope_toy envelope "AcceptReject: envelope of"
+	grep -q "don't follow the PDF" envelope_toy_Output/envelope.log && { echo "	The events don't follow the PDF over the envelope"; fail envelope_toy; }
+
+	local single=$(efficiency envelope_toy single) envelope=$(efficiency envelope_toy envelope)
+	echo "	Efficiency with a single maximum: $single, with the envelope: $envelope"
+	awk -v e=$single 'BEGIN{exit !(e > 0 && e <= 0.06)}' || { echo "	Expected at most 0.06 with a single maximum"; fail envelope_toy; }
+	awk -v e=$envelope 'BEGIN{exit !(e >= 0.2)}' || { echo "	Expected at least 0.2 with the envelope"; fail envelope_toy; }
+}
+
+#	See parallel_hesse_fit.test
+test_parallel_hesse_fit()
+{
+	[ -f columnar_fit_trace.root ] || test_columnar_fit
+	run_fitting parallel_hesse_fit threads8 -f parallel_hesse_fit.xml --SendOutput parallel_hesse_fit_Output/threads8
+	expect parallel_hesse_fit threads8 "Minuit2 ParallelHessian finished:.*Status: 3"
+	compare parallel_hesse_fit "$(result columnar_fit threads8)" "$(result parallel_hesse_fit threads8)" RapidFitResult "_value$" 1E-12
+	compare parallel_hesse_fit "$(result columnar_fit threads8)" "$(result parallel_hesse_fit threads8)" RapidFitResult "_error$" 1E-2
+}
+
+#	interrupt <test> <run> <seconds> <arguments...>, run the fitter and kill it and its workers after the given time
+interrupt()
+{
+	local test=$1 run=$2 seconds=$3
+	shift 3
+	mkdir -p ${test}_Output
+	echo "	$FITTING $*	stopped after $seconds s"
+	setsid $FITTING "$@" > ${test}_Output/${run}.log 2>&1 &
+	local pid=$!
+	sleep $seconds
+	kill -KILL -- -$pid 2>/dev/null
+	wait $pid 2>/dev/null
+}
+
+#	resumed <test> <run> <total>, check that the run was resumed from some but not all of the steps of the study
+resumed()
+{
+	local finished=$(awk '/^StudyJournal: Resuming from/{print $4}' $1_Output/$2.log | tail -n 1)
+	echo "	Resumed from ${finished:-0} of $3 finished steps"
+	if [ -z "$finished" ] || [ "$finished" -eq 0 ] || [ "$finished" -ge $3 ]
+	then
+		echo "	The study wasn't stopped part way, the resume wasn't tested"
+		fail $1
+	fi
+}
+
+#	See toy_study.test
+test_toy_study()
+{
+	rm -f ToyStudy.journal LLScan_f_sig.journal pullPlots.root LLScanData.root
+
+	#	The toys have their own seeds, so they don't depend on the number of workers
+	SECONDS=0
+	run_fitting toy_study workers4 -f toy_study.xml --workers 4 --SendOutput toy_study_Output/workers4
+	local toyTime=$SECONDS
+	mv pullPlots.root toy_study_Output/workers4.root
+	run_fitting toy_study workers1 -f toy_study.xml --workers 1 --SendOutput toy_study_Output/workers1
+	mv pullPlots.root toy_study_Output/workers1.root
+	compare toy_study toy_study_Output/workers4.root toy_study_Output/workers1.root RapidFitResult "" 0.
+
+	#	Stop the study half way through and carry on from its journal
+	interrupt toy_study stopped $(( toyTime / 2 + 1 )) -f toy_study.xml --workers 4 --SendOutput toy_study_Output/stopped
+	rm -f pullPlots.root
+	run_fitting toy_study resumed -f toy_study.xml --workers 4 --resume --SendOutput toy_study_Output/resumed
+	resumed toy_study resumed 20
+	mv pullPlots.root toy_study_Output/resumed.root
+	compare toy_study toy_study_Output/workers4.root toy_study_Output/resumed.root RapidFitResult "" 0.
+
+	#	The same for an LL scan, starting every point from the XML so the points don't depend on which finished first
+	SECONDS=0
+	run_fitting toy_study scan -f toy_study.xml --doLLscan --workers 4 --threadsPerWorker 1 --DontWarmStartScans --SendOutput toy_study_Output/scan
+	local scanTime=$SECONDS
+	mv LLScanData.root toy_study_Output/scan.root
+	interrupt toy_study scan_stopped $(( scanTime / 2 + 1 )) -f toy_study.xml --doLLscan --workers 4 --threadsPerWorker 1 --DontWarmStartScans --SendOutput toy_study_Output/scan_stopped
+	rm -f LLScanData.root
+	run_fitting toy_study scan_resumed -f toy_study.xml --doLLscan --workers 4 --threadsPerWorker 1 --DontWarmStartScans --resume --SendOutput toy_study_Output/scan_resumed
+	resumed toy_study scan_resumed 20
+	mv LLScanData.root toy_study_Output/scan_resumed.root
+	compare toy_study toy_study_Output/scan.root toy_study_Output/scan_resumed.root RapidFitResult "" 0.
+}
+
+make_data
+
+for test in ${@:-$ALL_TESTS}
+do
+	echo "$test:"
+	test_$test
+done
+
+if [ -n "$failed_tests" ]
+then
+	echo "FAILED:$failed_tests"
+	exit 1
+fi
+echo "All tests PASSED"